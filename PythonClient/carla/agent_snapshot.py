@@ -0,0 +1,165 @@
+# Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma de
+# Barcelona (UAB), and the INTEL Visual Computing Lab.
+#
+# This work is licensed under the terms of the MIT license.
+# For a copy, see <https://opensource.org/licenses/MIT>.
+
+"""
+Decoding of the compact non-player agents snapshots (see
+"CompactNonPlayerAgentsInfo" in CarlaSettings.ini). Must match
+"Util/CarlaServer/.../AgentSnapshotEncoder.h".
+"""
+
+
+from collections import namedtuple
+
+
+try:
+    import numpy
+except ImportError:
+    raise RuntimeError('cannot import numpy, make sure numpy package is installed')
+
+
+VERSION = 1
+
+FLAG_SAME_IDS = 1 << 0
+FLAG_QUANTIZED = 1 << 1
+FLAG_DELTA = 1 << 2
+
+AGENT_TYPES = {
+    10: 'Vehicle',
+    20: 'Pedestrian',
+    30: 'SpeedLimitSign',
+    41: 'TrafficLightGreen',
+    42: 'TrafficLightYellow',
+    43: 'TrafficLightRed'
+}
+
+
+AgentDescription = namedtuple('AgentDescription', [
+    'id',
+    'type',
+    'box_extent',
+    'location',
+    'orientation',
+    'forward_speed'])
+AgentDescription.__doc__ = """
+Everything about an agent that is not sent every frame. For traffic signs and
+lights, location and orientation are their transform; forward_speed is the
+speed limit of the speed limit signs.
+"""
+
+
+class AgentSnapshot(object):
+    """
+    Non-player agents of a frame. Vehicles and pedestrians are given as numpy
+    arrays, the i-th element of each array belongs to the agent ids[i]:
+
+      ids             (N,) uint32
+      locations       (N, 3) float32, in centimeters
+      orientations    (N, 3) float32, unit vectors
+      forward_speeds  (N,) float32, in km/h
+
+    Unless quantized, the arrays are read-only views of the message data.
+
+    descriptions is a dict {id: AgentDescription} with every agent present in
+    the scene, traffic signs and lights included.
+    """
+
+    def __init__(self, ids, locations, orientations, forward_speeds, descriptions):
+        self.ids = ids
+        self.locations = locations
+        self.orientations = orientations
+        self.forward_speeds = forward_speeds
+        self.descriptions = descriptions
+
+
+class _Reader(object):
+    def __init__(self, data):
+        self._data = data
+        self.offset = 0
+
+    def read(self, dtype, count):
+        dtype = numpy.dtype(dtype)
+        if count == 0:
+            return numpy.empty(0, dtype=dtype)
+        array = numpy.frombuffer(self._data, dtype=dtype, count=count, offset=self.offset)
+        self.offset += array.nbytes
+        return array
+
+    def align(self):
+        self.offset += (4 - self.offset % 4) % 4
+
+
+class AgentSnapshotDecoder(object):
+    """
+    Decodes the snapshots of a single episode, keeps the state needed to
+    decode the next frame.
+    """
+
+    def __init__(self):
+        self.descriptions = {}
+        self._ids = numpy.empty(0, dtype='<u4')
+        self._locations = None
+        self._orientations = None
+        self._forward_speeds = None
+
+    def decode(self, data):
+        """Return the AgentSnapshot encoded in data."""
+        reader = _Reader(data)
+        header = [int(value) for value in reader.read('<u4', 5)]
+        version, flags, number_of_descriptions, number_of_removed, count = header
+        if version != VERSION:
+            raise RuntimeError('unsupported agent snapshot version %d' % version)
+        location_step = float(reader.read('<f4', 1)[0])
+        self._read_descriptions(reader, number_of_descriptions)
+        for agent_id in reader.read('<u4', number_of_removed):
+            self.descriptions.pop(int(agent_id), None)
+        if not flags & FLAG_SAME_IDS:
+            self._ids = reader.read('<u4', count)
+        if not flags & FLAG_QUANTIZED:
+            self._locations = None
+            locations = reader.read('<f4', 3 * count).reshape(count, 3)
+            orientations = reader.read('<f4', 3 * count).reshape(count, 3)
+            forward_speeds = reader.read('<f4', count)
+        else:
+            if not flags & FLAG_DELTA:
+                self._locations = reader.read('<i4', 3 * count).reshape(count, 3).copy()
+                self._orientations = reader.read('<i2', 3 * count).reshape(count, 3).copy()
+                self._forward_speeds = reader.read('<i2', count).copy()
+            else:
+                index = numpy.arange(count)
+                mask = reader.read('u1', (count + 7) // 8)
+                changed = ((mask[index >> 3] >> (index & 7)) & 1).astype(bool)
+                reader.align()
+                number_of_changed = int(numpy.count_nonzero(changed))
+                self._locations[changed] += reader.read('<i2', 3 * number_of_changed).reshape(-1, 3)
+                self._orientations[changed] = reader.read('<i2', 3 * number_of_changed).reshape(-1, 3)
+                self._forward_speeds[changed] = reader.read('<i2', number_of_changed)
+            reader.align()
+            locations = (self._locations * location_step).astype(numpy.float32)
+            orientations = (self._orientations / 32767.0).astype(numpy.float32)
+            forward_speeds = (self._forward_speeds * 0.01).astype(numpy.float32)
+        return AgentSnapshot(
+            self._ids,
+            locations,
+            orientations,
+            forward_speeds,
+            self.descriptions)
+
+    def _read_descriptions(self, reader, count):
+        ids = reader.read('<u4', count)
+        types = reader.read('<u4', count)
+        box_extents = reader.read('<f4', 3 * count).reshape(count, 3)
+        locations = reader.read('<f4', 3 * count).reshape(count, 3)
+        orientations = reader.read('<f4', 3 * count).reshape(count, 3)
+        forward_speeds = reader.read('<f4', count)
+        for i in range(count):
+            agent_id = int(ids[i])
+            self.descriptions[agent_id] = AgentDescription(
+                agent_id,
+                AGENT_TYPES.get(int(types[i]), 'Unknown'),
+                box_extents[i],
+                locations[i],
+                orientations[i],
+                float(forward_speeds[i]))
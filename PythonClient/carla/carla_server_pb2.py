@@ -19,7 +19,7 @@ DESCRIPTOR = _descriptor.FileDescriptor(
   name='carla_server.proto',
   package='carla_server',
   syntax='proto3',
-  serialized_pb=_b('\n\x12\x63\x61rla_server.proto\x12\x0c\x63\x61rla_server\"+\n\x08Vector3D\x12\t\n\x01x\x18\x01 \x01(\x02\x12\t\n\x01y\x18\x02 \x01(\x02\x12\t\n\x01z\x18\x03 \x01(\x02\"b\n\tTransform\x12(\n\x08location\x18\x01 \x01(\x0b\x32\x16.carla_server.Vector3D\x12+\n\x0borientation\x18\x02 \x01(\x0b\x32\x16.carla_server.Vector3D\"x\n\x07Vehicle\x12*\n\ttransform\x18\x01 \x01(\x0b\x32\x17.carla_server.Transform\x12*\n\nbox_extent\x18\x02 \x01(\x0b\x32\x16.carla_server.Vector3D\x12\x15\n\rforward_speed\x18\x03 \x01(\x02\"{\n\nPedestrian\x12*\n\ttransform\x18\x01 \x01(\x0b\x32\x17.carla_server.Transform\x12*\n\nbox_extent\x18\x02 \x01(\x0b\x32\x16.carla_server.Vector3D\x12\x15\n\rforward_speed\x18\x03 \x01(\x02\"\x94\x01\n\x0cTrafficLight\x12*\n\ttransform\x18\x01 \x01(\x0b\x32\x17.carla_server.Transform\x12/\n\x05state\x18\x02 \x01(\x0e\x32 .carla_server.TrafficLight.State\"\'\n\x05State\x12\t\n\x05GREEN\x10\x00\x12\n\n\x06YELLOW\x10\x01\x12\x07\n\x03RED\x10\x02\"Q\n\x0eSpeedLimitSign\x12*\n\ttransform\x18\x01 \x01(\x0b\x32\x17.carla_server.Transform\x12\x13\n\x0bspeed_limit\x18\x02 \x01(\x02\"\xe5\x01\n\x05\x41gent\x12\n\n\x02id\x18\x01 \x01(\x07\x12(\n\x07vehicle\x18\x02 \x01(\x0b\x32\x15.carla_server.VehicleH\x00\x12.\n\npedestrian\x18\x03 \x01(\x0b\x32\x18.carla_server.PedestrianH\x00\x12\x33\n\rtraffic_light\x18\x04 \x01(\x0b\x32\x1a.carla_server.TrafficLightH\x00\x12\x38\n\x10speed_limit_sign\x18\x05 \x01(\x0b\x32\x1c.carla_server.SpeedLimitSignH\x00\x42\x07\n\x05\x61gent\"%\n\x11RequestNewEpisode\x12\x10\n\x08ini_file\x18\x01 \x01(\t\"G\n\x10SceneDescription\x12\x33\n\x12player_start_spots\x18\x01 \x03(\x0b\x32\x17.carla_server.Transform\"/\n\x0c\x45pisodeStart\x12\x1f\n\x17player_start_spot_index\x18\x01 \x01(\r\"\x1d\n\x0c\x45pisodeReady\x12\r\n\x05ready\x18\x01 \x01(\x08\"^\n\x07\x43ontrol\x12\r\n\x05steer\x18\x01 \x01(\x02\x12\x10\n\x08throttle\x18\x02 \x01(\x02\x12\r\n\x05\x62rake\x18\x03 \x01(\x02\x12\x12\n\nhand_brake\x18\x04 \x01(\x08\x12\x0f\n\x07reverse\x18\x05 \x01(\x08\"\x8a\x04\n\x0cMeasurements\x12\x1a\n\x12platform_timestamp\x18\x01 \x01(\r\x12\x16\n\x0egame_timestamp\x18\x02 \x01(\r\x12J\n\x13player_measurements\x18\x03 \x01(\x0b\x32-.carla_server.Measurements.PlayerMeasurements\x12.\n\x11non_player_agents\x18\x04 \x03(\x0b\x32\x13.carla_server.Agent\x1a\xc9\x02\n\x12PlayerMeasurements\x12*\n\ttransform\x18\x01 \x01(\x0b\x32\x17.carla_server.Transform\x12,\n\x0c\x61\x63\x63\x65leration\x18\x03 \x01(\x0b\x32\x16.carla_server.Vector3D\x12\x15\n\rforward_speed\x18\x04 \x01(\x02\x12\x1a\n\x12\x63ollision_vehicles\x18\x05 \x01(\x02\x12\x1d\n\x15\x63ollision_pedestrians\x18\x06 \x01(\x02\x12\x17\n\x0f\x63ollision_other\x18\x07 \x01(\x02\x12\x1e\n\x16intersection_otherlane\x18\x08 \x01(\x02\x12\x1c\n\x14intersection_offroad\x18\t \x01(\x02\x12\x30\n\x11\x61utopilot_control\x18\n \x01(\x0b\x32\x15.carla_server.ControlB\x03\xf8\x01\x01\x62\x06proto3')
+  serialized_pb=_b('\n\x12\x63\x61rla_server.proto\x12\x0c\x63\x61rla_server\"+\n\x08Vector3D\x12\t\n\x01x\x18\x01 \x01(\x02\x12\t\n\x01y\x18\x02 \x01(\x02\x12\t\n\x01z\x18\x03 \x01(\x02\"b\n\tTransform\x12(\n\x08location\x18\x01 \x01(\x0b\x32\x16.carla_server.Vector3D\x12+\n\x0borientation\x18\x02 \x01(\x0b\x32\x16.carla_server.Vector3D\"x\n\x07Vehicle\x12*\n\ttransform\x18\x01 \x01(\x0b\x32\x17.carla_server.Transform\x12*\n\nbox_extent\x18\x02 \x01(\x0b\x32\x16.carla_server.Vector3D\x12\x15\n\rforward_speed\x18\x03 \x01(\x02\"{\n\nPedestrian\x12*\n\ttransform\x18\x01 \x01(\x0b\x32\x17.carla_server.Transform\x12*\n\nbox_extent\x18\x02 \x01(\x0b\x32\x16.carla_server.Vector3D\x12\x15\n\rforward_speed\x18\x03 \x01(\x02\"\x94\x01\n\x0cTrafficLight\x12*\n\ttransform\x18\x01 \x01(\x0b\x32\x17.carla_server.Transform\x12/\n\x05state\x18\x02 \x01(\x0e\x32 .carla_server.TrafficLight.State\"\'\n\x05State\x12\t\n\x05GREEN\x10\x00\x12\n\n\x06YELLOW\x10\x01\x12\x07\n\x03RED\x10\x02\"Q\n\x0eSpeedLimitSign\x12*\n\ttransform\x18\x01 \x01(\x0b\x32\x17.carla_server.Transform\x12\x13\n\x0bspeed_limit\x18\x02 \x01(\x02\"\xe5\x01\n\x05\x41gent\x12\n\n\x02id\x18\x01 \x01(\x07\x12(\n\x07vehicle\x18\x02 \x01(\x0b\x32\x15.carla_server.VehicleH\x00\x12.\n\npedestrian\x18\x03 \x01(\x0b\x32\x18.carla_server.PedestrianH\x00\x12\x33\n\rtraffic_light\x18\x04 \x01(\x0b\x32\x1a.carla_server.TrafficLightH\x00\x12\x38\n\x10speed_limit_sign\x18\x05 \x01(\x0b\x32\x1c.carla_server.SpeedLimitSignH\x00\x42\x07\n\x05\x61gent\"E\n\x11RequestNewEpisode\x12\x10\n\x08ini_file\x18\x01 \x01(\t\x12\x1e\n\x16keep_agent_connections\x18\x02 \x01(\x08\"G\n\x10SceneDescription\x12\x33\n\x12player_start_spots\x18\x01 \x03(\x0b\x32\x17.carla_server.Transform\"/\n\x0c\x45pisodeStart\x12\x1f\n\x17player_start_spot_index\x18\x01 \x01(\r\"\xf9\x01\n\x0c\x45pisodeReady\x12\r\n\x05ready\x18\x01 \x01(\x08\x12 \n\x18number_of_sensor_streams\x18\x02 \x01(\r\x12\x1d\n\x15shared_memory_streams\x18\x03 \x01(\x08\x12\x1e\n\x16\x61gent_connections_kept\x18\x04 \x01(\x08\x12\x1a\n\x12\x66irst_frame_number\x18\x05 \x01(\x04\x12\x30\n\x06phases\x18\x06 \x03(\x0b\x32 .carla_server.EpisodeReady.Phase\x1a+\n\x05Phase\x12\x0c\n\x04name\x18\x01 \x01(\t\x12\x14\n\x0cmilliseconds\x18\x02 \x01(\x02\"\xbd\x01\n\x14WorldSnapshotRequest\x12\x37\n\x04save\x18\x01 \x01(\x0b\x32\'.carla_server.WorldSnapshotRequest.SaveH\x00\x12=\n\x07restore\x18\x02 \x01(\x0b\x32*.carla_server.WorldSnapshotRequest.RestoreH\x00\x1a\x06\n\x04Save\x1a\x1b\n\x07Restore\x12\x10\n\x08snapshot\x18\x01 \x01(\x0c\x42\x08\n\x06\x61\x63tion\"\x89\x01\n\x0cWorldRequest\x12\x36\n\x0bnew_episode\x18\x10 \x01(\x0b\x32\x1f.carla_server.RequestNewEpisodeH\x00\x12\x36\n\x08snapshot\x18\x11 \x01(\x0b\x32\".carla_server.WorldSnapshotRequestH\x00\x42\t\n\x07request\"N\n\rWorldSnapshot\x12\x0f\n\x07success\x18\x01 \x01(\x08\x12\x10\n\x08snapshot\x18\x02 \x01(\x0c\x12\x1a\n\x12\x66irst_frame_number\x18\x03 \x01(\x04\"t\n\x07\x43ontrol\x12\r\n\x05steer\x18\x01 \x01(\x02\x12\x10\n\x08throttle\x18\x02 \x01(\x02\x12\r\n\x05\x62rake\x18\x03 \x01(\x02\x12\x12\n\nhand_brake\x18\x04 \x01(\x08\x12\x0f\n\x07reverse\x18\x05 \x01(\x08\x12\x14\n\x0c\x66rame_number\x18\x06 \x01(\x04\"S\n\x0f\x46rameTimestamps\x12\x0c\n\x04tick\x18\x01 \x01(\x04\x12\x10\n\x08readback\x18\x02 \x01(\x04\x12\x0e\n\x06queued\x18\x03 \x01(\x04\x12\x10\n\x08\x65ncoding\x18\x04 \x01(\x04\"\xfd\x04\n\x0cMeasurements\x12\x1a\n\x12platform_timestamp\x18\x01 \x01(\r\x12\x16\n\x0egame_timestamp\x18\x02 \x01(\r\x12J\n\x13player_measurements\x18\x03 \x01(\x0b\x32-.carla_server.Measurements.PlayerMeasurements\x12.\n\x11non_player_agents\x18\x04 \x03(\x0b\x32\x13.carla_server.Agent\x12\x14\n\x0c\x66rame_number\x18\x05 \x01(\x04\x12\"\n\x1anon_player_agents_snapshot\x18\x06 \x01(\x0c\x12\x37\n\x10\x66rame_timestamps\x18\x07 \x01(\x0b\x32\x1d.carla_server.FrameTimestamps\x1a\xc9\x02\n\x12PlayerMeasurements\x12*\n\ttransform\x18\x01 \x01(\x0b\x32\x17.carla_server.Transform\x12,\n\x0c\x61\x63\x63\x65leration\x18\x03 \x01(\x0b\x32\x16.carla_server.Vector3D\x12\x15\n\rforward_speed\x18\x04 \x01(\x02\x12\x1a\n\x12\x63ollision_vehicles\x18\x05 \x01(\x02\x12\x1d\n\x15\x63ollision_pedestrians\x18\x06 \x01(\x02\x12\x17\n\x0f\x63ollision_other\x18\x07 \x01(\x02\x12\x1e\n\x16intersection_otherlane\x18\x08 \x01(\x02\x12\x1c\n\x14intersection_offroad\x18\t \x01(\x02\x12\x30\n\x11\x61utopilot_control\x18\n \x01(\x0b\x32\x15.carla_server.ControlB\x03\xf8\x01\x01\x62\x06proto3')
 )
 
 
@@ -377,6 +377,13 @@ _REQUESTNEWEPISODE = _descriptor.Descriptor(
       message_type=None, enum_type=None, containing_type=None,
       is_extension=False, extension_scope=None,
       options=None),
+    _descriptor.FieldDescriptor(
+      name='keep_agent_connections', full_name='carla_server.RequestNewEpisode.keep_agent_connections', index=1,
+      number=2, type=8, cpp_type=7, label=1,
+      has_default_value=False, default_value=False,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
   ],
   extensions=[
   ],
@@ -390,7 +397,7 @@ _REQUESTNEWEPISODE = _descriptor.Descriptor(
   oneofs=[
   ],
   serialized_start=894,
-  serialized_end=931,
+  serialized_end=963,
 )
 
 
@@ -420,8 +427,8 @@ _SCENEDESCRIPTION = _descriptor.Descriptor(
   extension_ranges=[],
   oneofs=[
   ],
-  serialized_start=933,
-  serialized_end=1004,
+  serialized_start=965,
+  serialized_end=1036,
 )
 
 
@@ -451,11 +458,48 @@ _EPISODESTART = _descriptor.Descriptor(
   extension_ranges=[],
   oneofs=[
   ],
-  serialized_start=1006,
-  serialized_end=1053,
+  serialized_start=1038,
+  serialized_end=1085,
 )
 
 
+_EPISODEREADY_PHASE = _descriptor.Descriptor(
+  name='Phase',
+  full_name='carla_server.EpisodeReady.Phase',
+  filename=None,
+  file=DESCRIPTOR,
+  containing_type=None,
+  fields=[
+    _descriptor.FieldDescriptor(
+      name='name', full_name='carla_server.EpisodeReady.Phase.name', index=0,
+      number=1, type=9, cpp_type=9, label=1,
+      has_default_value=False, default_value=_b("").decode('utf-8'),
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
+    _descriptor.FieldDescriptor(
+      name='milliseconds', full_name='carla_server.EpisodeReady.Phase.milliseconds', index=1,
+      number=2, type=2, cpp_type=6, label=1,
+      has_default_value=False, default_value=float(0),
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
+  ],
+  extensions=[
+  ],
+  nested_types=[],
+  enum_types=[
+  ],
+  options=None,
+  is_extendable=False,
+  syntax='proto3',
+  extension_ranges=[],
+  oneofs=[
+  ],
+  serialized_start=1294,
+  serialized_end=1337,
+)
+
 _EPISODEREADY = _descriptor.Descriptor(
   name='EpisodeReady',
   full_name='carla_server.EpisodeReady',
@@ -470,6 +514,221 @@ _EPISODEREADY = _descriptor.Descriptor(
       message_type=None, enum_type=None, containing_type=None,
       is_extension=False, extension_scope=None,
       options=None),
+    _descriptor.FieldDescriptor(
+      name='number_of_sensor_streams', full_name='carla_server.EpisodeReady.number_of_sensor_streams', index=1,
+      number=2, type=13, cpp_type=3, label=1,
+      has_default_value=False, default_value=0,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
+    _descriptor.FieldDescriptor(
+      name='shared_memory_streams', full_name='carla_server.EpisodeReady.shared_memory_streams', index=2,
+      number=3, type=8, cpp_type=7, label=1,
+      has_default_value=False, default_value=False,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
+    _descriptor.FieldDescriptor(
+      name='agent_connections_kept', full_name='carla_server.EpisodeReady.agent_connections_kept', index=3,
+      number=4, type=8, cpp_type=7, label=1,
+      has_default_value=False, default_value=False,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
+    _descriptor.FieldDescriptor(
+      name='first_frame_number', full_name='carla_server.EpisodeReady.first_frame_number', index=4,
+      number=5, type=4, cpp_type=4, label=1,
+      has_default_value=False, default_value=0,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
+    _descriptor.FieldDescriptor(
+      name='phases', full_name='carla_server.EpisodeReady.phases', index=5,
+      number=6, type=11, cpp_type=10, label=3,
+      has_default_value=False, default_value=[],
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
+  ],
+  extensions=[
+  ],
+  nested_types=[_EPISODEREADY_PHASE, ],
+  enum_types=[
+  ],
+  options=None,
+  is_extendable=False,
+  syntax='proto3',
+  extension_ranges=[],
+  oneofs=[
+  ],
+  serialized_start=1088,
+  serialized_end=1337,
+)
+
+
+_WORLDSNAPSHOTREQUEST_SAVE = _descriptor.Descriptor(
+  name='Save',
+  full_name='carla_server.WorldSnapshotRequest.Save',
+  filename=None,
+  file=DESCRIPTOR,
+  containing_type=None,
+  fields=[
+  ],
+  extensions=[
+  ],
+  nested_types=[],
+  enum_types=[
+  ],
+  options=None,
+  is_extendable=False,
+  syntax='proto3',
+  extension_ranges=[],
+  oneofs=[
+  ],
+  serialized_start=1484,
+  serialized_end=1490,
+)
+
+_WORLDSNAPSHOTREQUEST_RESTORE = _descriptor.Descriptor(
+  name='Restore',
+  full_name='carla_server.WorldSnapshotRequest.Restore',
+  filename=None,
+  file=DESCRIPTOR,
+  containing_type=None,
+  fields=[
+    _descriptor.FieldDescriptor(
+      name='snapshot', full_name='carla_server.WorldSnapshotRequest.Restore.snapshot', index=0,
+      number=1, type=12, cpp_type=9, label=1,
+      has_default_value=False, default_value=_b(""),
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
+  ],
+  extensions=[
+  ],
+  nested_types=[],
+  enum_types=[
+  ],
+  options=None,
+  is_extendable=False,
+  syntax='proto3',
+  extension_ranges=[],
+  oneofs=[
+  ],
+  serialized_start=1492,
+  serialized_end=1519,
+)
+
+_WORLDSNAPSHOTREQUEST = _descriptor.Descriptor(
+  name='WorldSnapshotRequest',
+  full_name='carla_server.WorldSnapshotRequest',
+  filename=None,
+  file=DESCRIPTOR,
+  containing_type=None,
+  fields=[
+    _descriptor.FieldDescriptor(
+      name='save', full_name='carla_server.WorldSnapshotRequest.save', index=0,
+      number=1, type=11, cpp_type=10, label=1,
+      has_default_value=False, default_value=None,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
+    _descriptor.FieldDescriptor(
+      name='restore', full_name='carla_server.WorldSnapshotRequest.restore', index=1,
+      number=2, type=11, cpp_type=10, label=1,
+      has_default_value=False, default_value=None,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
+  ],
+  extensions=[
+  ],
+  nested_types=[_WORLDSNAPSHOTREQUEST_SAVE, _WORLDSNAPSHOTREQUEST_RESTORE, ],
+  enum_types=[
+  ],
+  options=None,
+  is_extendable=False,
+  syntax='proto3',
+  extension_ranges=[],
+  oneofs=[
+    _descriptor.OneofDescriptor(
+      name='action', full_name='carla_server.WorldSnapshotRequest.action',
+      index=0, containing_type=None, fields=[]),
+  ],
+  serialized_start=1340,
+  serialized_end=1529,
+)
+
+
+_WORLDREQUEST = _descriptor.Descriptor(
+  name='WorldRequest',
+  full_name='carla_server.WorldRequest',
+  filename=None,
+  file=DESCRIPTOR,
+  containing_type=None,
+  fields=[
+    _descriptor.FieldDescriptor(
+      name='new_episode', full_name='carla_server.WorldRequest.new_episode', index=0,
+      number=16, type=11, cpp_type=10, label=1,
+      has_default_value=False, default_value=None,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
+    _descriptor.FieldDescriptor(
+      name='snapshot', full_name='carla_server.WorldRequest.snapshot', index=1,
+      number=17, type=11, cpp_type=10, label=1,
+      has_default_value=False, default_value=None,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
+  ],
+  extensions=[
+  ],
+  nested_types=[],
+  enum_types=[
+  ],
+  options=None,
+  is_extendable=False,
+  syntax='proto3',
+  extension_ranges=[],
+  oneofs=[
+    _descriptor.OneofDescriptor(
+      name='request', full_name='carla_server.WorldRequest.request',
+      index=0, containing_type=None, fields=[]),
+  ],
+  serialized_start=1532,
+  serialized_end=1669,
+)
+
+
+_WORLDSNAPSHOT = _descriptor.Descriptor(
+  name='WorldSnapshot',
+  full_name='carla_server.WorldSnapshot',
+  filename=None,
+  file=DESCRIPTOR,
+  containing_type=None,
+  fields=[
+    _descriptor.FieldDescriptor(
+      name='success', full_name='carla_server.WorldSnapshot.success', index=0,
+      number=1, type=8, cpp_type=7, label=1,
+      has_default_value=False, default_value=False,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
+    _descriptor.FieldDescriptor(
+      name='snapshot', full_name='carla_server.WorldSnapshot.snapshot', index=1,
+      number=2, type=12, cpp_type=9, label=1,
+      has_default_value=False, default_value=_b(""),
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
+    _descriptor.FieldDescriptor(
+      name='first_frame_number', full_name='carla_server.WorldSnapshot.first_frame_number', index=2,
+      number=3, type=4, cpp_type=4, label=1,
+      has_default_value=False, default_value=0,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
   ],
   extensions=[
   ],
@@ -482,8 +741,8 @@ _EPISODEREADY = _descriptor.Descriptor(
   extension_ranges=[],
   oneofs=[
   ],
-  serialized_start=1055,
-  serialized_end=1084,
+  serialized_start=1671,
+  serialized_end=1749,
 )
 
 
@@ -529,6 +788,65 @@ _CONTROL = _descriptor.Descriptor(
       message_type=None, enum_type=None, containing_type=None,
       is_extension=False, extension_scope=None,
       options=None),
+    _descriptor.FieldDescriptor(
+      name='frame_number', full_name='carla_server.Control.frame_number', index=5,
+      number=6, type=4, cpp_type=4, label=1,
+      has_default_value=False, default_value=0,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
+  ],
+  extensions=[
+  ],
+  nested_types=[],
+  enum_types=[
+  ],
+  options=None,
+  is_extendable=False,
+  syntax='proto3',
+  extension_ranges=[],
+  oneofs=[
+  ],
+  serialized_start=1751,
+  serialized_end=1867,
+)
+
+
+_FRAMETIMESTAMPS = _descriptor.Descriptor(
+  name='FrameTimestamps',
+  full_name='carla_server.FrameTimestamps',
+  filename=None,
+  file=DESCRIPTOR,
+  containing_type=None,
+  fields=[
+    _descriptor.FieldDescriptor(
+      name='tick', full_name='carla_server.FrameTimestamps.tick', index=0,
+      number=1, type=4, cpp_type=4, label=1,
+      has_default_value=False, default_value=0,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
+    _descriptor.FieldDescriptor(
+      name='readback', full_name='carla_server.FrameTimestamps.readback', index=1,
+      number=2, type=4, cpp_type=4, label=1,
+      has_default_value=False, default_value=0,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
+    _descriptor.FieldDescriptor(
+      name='queued', full_name='carla_server.FrameTimestamps.queued', index=2,
+      number=3, type=4, cpp_type=4, label=1,
+      has_default_value=False, default_value=0,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
+    _descriptor.FieldDescriptor(
+      name='encoding', full_name='carla_server.FrameTimestamps.encoding', index=3,
+      number=4, type=4, cpp_type=4, label=1,
+      has_default_value=False, default_value=0,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
   ],
   extensions=[
   ],
@@ -541,8 +859,8 @@ _CONTROL = _descriptor.Descriptor(
   extension_ranges=[],
   oneofs=[
   ],
-  serialized_start=1086,
-  serialized_end=1180,
+  serialized_start=1869,
+  serialized_end=1952,
 )
 
 
@@ -628,8 +946,8 @@ _MEASUREMENTS_PLAYERMEASUREMENTS = _descriptor.Descriptor(
   extension_ranges=[],
   oneofs=[
   ],
-  serialized_start=1376,
-  serialized_end=1705,
+  serialized_start=2263,
+  serialized_end=2592,
 )
 
 _MEASUREMENTS = _descriptor.Descriptor(
@@ -667,6 +985,27 @@ _MEASUREMENTS = _descriptor.Descriptor(
       message_type=None, enum_type=None, containing_type=None,
       is_extension=False, extension_scope=None,
       options=None),
+    _descriptor.FieldDescriptor(
+      name='frame_number', full_name='carla_server.Measurements.frame_number', index=4,
+      number=5, type=4, cpp_type=4, label=1,
+      has_default_value=False, default_value=0,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
+    _descriptor.FieldDescriptor(
+      name='non_player_agents_snapshot', full_name='carla_server.Measurements.non_player_agents_snapshot', index=5,
+      number=6, type=12, cpp_type=9, label=1,
+      has_default_value=False, default_value=_b(""),
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
+    _descriptor.FieldDescriptor(
+      name='frame_timestamps', full_name='carla_server.Measurements.frame_timestamps', index=6,
+      number=7, type=11, cpp_type=10, label=1,
+      has_default_value=False, default_value=None,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      options=None),
   ],
   extensions=[
   ],
@@ -679,8 +1018,8 @@ _MEASUREMENTS = _descriptor.Descriptor(
   extension_ranges=[],
   oneofs=[
   ],
-  serialized_start=1183,
-  serialized_end=1705,
+  serialized_start=1955,
+  serialized_end=2592,
 )
 
 _TRANSFORM.fields_by_name['location'].message_type = _VECTOR3D
@@ -710,12 +1049,33 @@ _AGENT.oneofs_by_name['agent'].fields.append(
   _AGENT.fields_by_name['speed_limit_sign'])
 _AGENT.fields_by_name['speed_limit_sign'].containing_oneof = _AGENT.oneofs_by_name['agent']
 _SCENEDESCRIPTION.fields_by_name['player_start_spots'].message_type = _TRANSFORM
+_EPISODEREADY_PHASE.containing_type = _EPISODEREADY
+_EPISODEREADY.fields_by_name['phases'].message_type = _EPISODEREADY_PHASE
+_WORLDSNAPSHOTREQUEST_SAVE.containing_type = _WORLDSNAPSHOTREQUEST
+_WORLDSNAPSHOTREQUEST_RESTORE.containing_type = _WORLDSNAPSHOTREQUEST
+_WORLDSNAPSHOTREQUEST.fields_by_name['save'].message_type = _WORLDSNAPSHOTREQUEST_SAVE
+_WORLDSNAPSHOTREQUEST.fields_by_name['restore'].message_type = _WORLDSNAPSHOTREQUEST_RESTORE
+_WORLDSNAPSHOTREQUEST.oneofs_by_name['action'].fields.append(
+  _WORLDSNAPSHOTREQUEST.fields_by_name['save'])
+_WORLDSNAPSHOTREQUEST.fields_by_name['save'].containing_oneof = _WORLDSNAPSHOTREQUEST.oneofs_by_name['action']
+_WORLDSNAPSHOTREQUEST.oneofs_by_name['action'].fields.append(
+  _WORLDSNAPSHOTREQUEST.fields_by_name['restore'])
+_WORLDSNAPSHOTREQUEST.fields_by_name['restore'].containing_oneof = _WORLDSNAPSHOTREQUEST.oneofs_by_name['action']
+_WORLDREQUEST.fields_by_name['new_episode'].message_type = _REQUESTNEWEPISODE
+_WORLDREQUEST.fields_by_name['snapshot'].message_type = _WORLDSNAPSHOTREQUEST
+_WORLDREQUEST.oneofs_by_name['request'].fields.append(
+  _WORLDREQUEST.fields_by_name['new_episode'])
+_WORLDREQUEST.fields_by_name['new_episode'].containing_oneof = _WORLDREQUEST.oneofs_by_name['request']
+_WORLDREQUEST.oneofs_by_name['request'].fields.append(
+  _WORLDREQUEST.fields_by_name['snapshot'])
+_WORLDREQUEST.fields_by_name['snapshot'].containing_oneof = _WORLDREQUEST.oneofs_by_name['request']
 _MEASUREMENTS_PLAYERMEASUREMENTS.fields_by_name['transform'].message_type = _TRANSFORM
 _MEASUREMENTS_PLAYERMEASUREMENTS.fields_by_name['acceleration'].message_type = _VECTOR3D
 _MEASUREMENTS_PLAYERMEASUREMENTS.fields_by_name['autopilot_control'].message_type = _CONTROL
 _MEASUREMENTS_PLAYERMEASUREMENTS.containing_type = _MEASUREMENTS
 _MEASUREMENTS.fields_by_name['player_measurements'].message_type = _MEASUREMENTS_PLAYERMEASUREMENTS
 _MEASUREMENTS.fields_by_name['non_player_agents'].message_type = _AGENT
+_MEASUREMENTS.fields_by_name['frame_timestamps'].message_type = _FRAMETIMESTAMPS
 DESCRIPTOR.message_types_by_name['Vector3D'] = _VECTOR3D
 DESCRIPTOR.message_types_by_name['Transform'] = _TRANSFORM
 DESCRIPTOR.message_types_by_name['Vehicle'] = _VEHICLE
@@ -727,7 +1087,11 @@ DESCRIPTOR.message_types_by_name['RequestNewEpisode'] = _REQUESTNEWEPISODE
 DESCRIPTOR.message_types_by_name['SceneDescription'] = _SCENEDESCRIPTION
 DESCRIPTOR.message_types_by_name['EpisodeStart'] = _EPISODESTART
 DESCRIPTOR.message_types_by_name['EpisodeReady'] = _EPISODEREADY
+DESCRIPTOR.message_types_by_name['WorldSnapshotRequest'] = _WORLDSNAPSHOTREQUEST
+DESCRIPTOR.message_types_by_name['WorldRequest'] = _WORLDREQUEST
+DESCRIPTOR.message_types_by_name['WorldSnapshot'] = _WORLDSNAPSHOT
 DESCRIPTOR.message_types_by_name['Control'] = _CONTROL
+DESCRIPTOR.message_types_by_name['FrameTimestamps'] = _FRAMETIMESTAMPS
 DESCRIPTOR.message_types_by_name['Measurements'] = _MEASUREMENTS
 _sym_db.RegisterFileDescriptor(DESCRIPTOR)
 
@@ -802,11 +1166,56 @@ EpisodeStart = _reflection.GeneratedProtocolMessageType('EpisodeStart', (_messag
 _sym_db.RegisterMessage(EpisodeStart)
 
 EpisodeReady = _reflection.GeneratedProtocolMessageType('EpisodeReady', (_message.Message,), dict(
+
+  Phase = _reflection.GeneratedProtocolMessageType('Phase', (_message.Message,), dict(
+    DESCRIPTOR = _EPISODEREADY_PHASE,
+    __module__ = 'carla_server_pb2'
+    # @@protoc_insertion_point(class_scope:carla_server.EpisodeReady.Phase)
+    ))
+  ,
   DESCRIPTOR = _EPISODEREADY,
   __module__ = 'carla_server_pb2'
   # @@protoc_insertion_point(class_scope:carla_server.EpisodeReady)
   ))
 _sym_db.RegisterMessage(EpisodeReady)
+_sym_db.RegisterMessage(EpisodeReady.Phase)
+
+WorldSnapshotRequest = _reflection.GeneratedProtocolMessageType('WorldSnapshotRequest', (_message.Message,), dict(
+
+  Save = _reflection.GeneratedProtocolMessageType('Save', (_message.Message,), dict(
+    DESCRIPTOR = _WORLDSNAPSHOTREQUEST_SAVE,
+    __module__ = 'carla_server_pb2'
+    # @@protoc_insertion_point(class_scope:carla_server.WorldSnapshotRequest.Save)
+    ))
+  ,
+
+  Restore = _reflection.GeneratedProtocolMessageType('Restore', (_message.Message,), dict(
+    DESCRIPTOR = _WORLDSNAPSHOTREQUEST_RESTORE,
+    __module__ = 'carla_server_pb2'
+    # @@protoc_insertion_point(class_scope:carla_server.WorldSnapshotRequest.Restore)
+    ))
+  ,
+  DESCRIPTOR = _WORLDSNAPSHOTREQUEST,
+  __module__ = 'carla_server_pb2'
+  # @@protoc_insertion_point(class_scope:carla_server.WorldSnapshotRequest)
+  ))
+_sym_db.RegisterMessage(WorldSnapshotRequest)
+_sym_db.RegisterMessage(WorldSnapshotRequest.Save)
+_sym_db.RegisterMessage(WorldSnapshotRequest.Restore)
+
+WorldRequest = _reflection.GeneratedProtocolMessageType('WorldRequest', (_message.Message,), dict(
+  DESCRIPTOR = _WORLDREQUEST,
+  __module__ = 'carla_server_pb2'
+  # @@protoc_insertion_point(class_scope:carla_server.WorldRequest)
+  ))
+_sym_db.RegisterMessage(WorldRequest)
+
+WorldSnapshot = _reflection.GeneratedProtocolMessageType('WorldSnapshot', (_message.Message,), dict(
+  DESCRIPTOR = _WORLDSNAPSHOT,
+  __module__ = 'carla_server_pb2'
+  # @@protoc_insertion_point(class_scope:carla_server.WorldSnapshot)
+  ))
+_sym_db.RegisterMessage(WorldSnapshot)
 
 Control = _reflection.GeneratedProtocolMessageType('Control', (_message.Message,), dict(
   DESCRIPTOR = _CONTROL,
@@ -815,6 +1224,13 @@ Control = _reflection.GeneratedProtocolMessageType('Control', (_message.Message,
   ))
 _sym_db.RegisterMessage(Control)
 
+FrameTimestamps = _reflection.GeneratedProtocolMessageType('FrameTimestamps', (_message.Message,), dict(
+  DESCRIPTOR = _FRAMETIMESTAMPS,
+  __module__ = 'carla_server_pb2'
+  # @@protoc_insertion_point(class_scope:carla_server.FrameTimestamps)
+  ))
+_sym_db.RegisterMessage(FrameTimestamps)
+
 Measurements = _reflection.GeneratedProtocolMessageType('Measurements', (_message.Message,), dict(
 
   PlayerMeasurements = _reflection.GeneratedProtocolMessageType('PlayerMeasurements', (_message.Message,), dict(
@@ -10,6 +10,7 @@ import struct
 
 from contextlib import contextmanager
 
+from . import image_codec
 from . import sensor
 from . import settings
 from . import tcp
@@ -25,22 +26,38 @@ VehicleControl = carla_protocol.Control
 
 
 @contextmanager
-def make_carla_client(host, world_port, timeout=15):
+def make_carla_client(host, world_port, timeout=15, keep_agent_connections=False):
     """Context manager for creating and connecting a CarlaClient."""
-    with util.make_connection(CarlaClient, host, world_port, timeout) as client:
+    with util.make_connection(CarlaClient, host, world_port, timeout, keep_agent_connections) as client:
         yield client
 
 
 class CarlaClient(object):
-    """The CARLA client. Manages communications with the CARLA server."""
+    """
+    The CARLA client. Manages communications with the CARLA server.
 
-    def __init__(self, host, world_port, timeout=15):
+    With keep_agent_connections, the server is asked to keep the measurements,
+    control, and sensor streams open across episodes, saving the reconnection
+    on every new episode.
+    """
+
+    def __init__(self, host, world_port, timeout=15, keep_agent_connections=False):
+        self._host = host
+        self._world_port = world_port
+        self._timeout = timeout
+        self._keep_agent_connections = keep_agent_connections
         self._world_client = tcp.TCPClient(host, world_port, timeout)
-        self._stream_client = tcp.TCPClient(host, world_port + 1, timeout)
+        self._stream_client = None
         self._control_client = tcp.TCPClient(host, world_port + 2, timeout)
+        self._sensor_clients = []
         self._current_settings = None
         self._is_episode_requested = False
         self._sensor_names = []
+        self._agent_snapshot_decoder = None
+        self.agent_snapshot = None
+        self.episode_start_phases = []
+        self._frame_number = 0
+        self._first_frame_number = 0
 
     def connect(self, connection_attempts=10):
         """
@@ -50,8 +67,7 @@ class CarlaClient(object):
 
     def disconnect(self):
         """Disconnect from server."""
-        self._control_client.disconnect()
-        self._stream_client.disconnect()
+        self._disconnect_agent_clients()
         self._world_client.disconnect()
 
     def connected(self):
@@ -80,6 +96,8 @@ class CarlaClient(object):
         "load_settings".
 
         This function waits until the server answers with an EpisodeReady.
+        The time the server took in each phase of starting the episode is
+        stored in "episode_start_phases" as a list of (name, milliseconds).
         """
         if self._current_settings is None:
             raise RuntimeError('no settings loaded, cannot start episode')
@@ -100,9 +118,29 @@ class CarlaClient(object):
             pb_message.ParseFromString(data)
             if not pb_message.ready:
                 raise RuntimeError('cannot start episode: server failed to start episode')
+            self.agent_snapshot = None
+            self.episode_start_phases = [(p.name, p.milliseconds) for p in pb_message.phases]
+            self._frame_number = 0
+            self._first_frame_number = pb_message.first_frame_number
+            if pb_message.agent_connections_kept and self._stream_client is not None:
+                # The compact snapshots keep depending on the previous ones.
+                return
             # We can start the agent clients now.
+            self._agent_snapshot_decoder = None
+            self._disconnect_agent_clients()
+            stream_client_type = tcp.TCPClient
+            if pb_message.shared_memory_streams:
+                from . import shared_memory
+                stream_client_type = shared_memory.SharedMemoryClient
+            make_stream_client = lambda port: stream_client_type(self._host, port, self._timeout)
+            self._stream_client = make_stream_client(self._world_port + 1)
             self._stream_client.connect()
             self._control_client.connect()
+            self._sensor_clients = [
+                _SensorStreamClient(make_stream_client(self._world_port + 3 + index))
+                for index in range(pb_message.number_of_sensor_streams)]
+            for sensor_client in self._sensor_clients:
+                sensor_client.connect()
             # Set again the status for no episode requested
         finally:
             self._is_episode_requested = False
@@ -112,14 +150,33 @@ class CarlaClient(object):
         Read the data sent from the server this frame. The episode must be
         started. Return a pair containing the protobuf object containing the
         measurements followed by the raw data of the sensors.
+
+        If the server sends the compact non-player agents info, the agents of
+        this frame are decoded into "agent_snapshot" (requires numpy).
+
+        With shared memory streams, the raw data of the images is a view over
+        the shared memory, valid until the next call.
         """
-        # Read measurements.
-        data = self._stream_client.read()
-        if not data:
-            raise RuntimeError('failed to read data from server')
-        pb_message = carla_protocol.Measurements()
-        pb_message.ParseFromString(data)
+        # Read measurements, skipping those left from the previous episode on
+        # kept connections.
+        while True:
+            data = self._stream_client.read()
+            if not data:
+                raise RuntimeError('failed to read data from server')
+            pb_message = carla_protocol.Measurements()
+            pb_message.ParseFromString(_to_bytes(data))
+            if pb_message.frame_number >= self._first_frame_number:
+                break
+            if pb_message.non_player_agents_snapshot:
+                self._decode_agent_snapshot(pb_message.non_player_agents_snapshot)
+            if not self._sensor_clients:
+                self._stream_client.read()
+        self._frame_number = pb_message.frame_number
+        if pb_message.non_player_agents_snapshot:
+            self._decode_agent_snapshot(pb_message.non_player_agents_snapshot)
         # Read sensor data.
+        if self._sensor_clients:
+            return pb_message, self._read_sensor_streams(pb_message.frame_number)
         raw_sensor_data = self._stream_client.read()
         return pb_message, self._parse_raw_sensor_data(raw_sensor_data)
 
@@ -129,9 +186,17 @@ class CarlaClient(object):
 
         If synchronous mode was requested, the server will pause the simulation
         until this message is received.
+
+        The control is tagged as the reply to the last measurements read,
+        unless it has a frame_number already. With ControlLookahead, the server
+        applies it that many frames later.
         """
         if isinstance(args[0] if args else None, carla_protocol.Control):
             pb_message = args[0]
+            if not pb_message.frame_number:
+                pb_message = carla_protocol.Control()
+                pb_message.CopyFrom(args[0])
+                pb_message.frame_number = self._frame_number
         else:
             pb_message = carla_protocol.Control()
             pb_message.steer = kwargs.get('steer', 0.0)
@@ -139,19 +204,63 @@ class CarlaClient(object):
             pb_message.brake = kwargs.get('brake', 0.0)
             pb_message.hand_brake = kwargs.get('hand_brake', False)
             pb_message.reverse = kwargs.get('reverse', False)
+            pb_message.frame_number = kwargs.get('frame_number', self._frame_number)
         self._control_client.write(pb_message.SerializeToString())
 
+    def save_snapshot(self):
+        """
+        Save the state of the world while the episode is running. Return the
+        snapshot, bytes opaque to the client to be restored later with
+        "restore_snapshot", in this or another episode of the same level.
+
+        In synchronous mode the server answers while waiting for the control,
+        call it after "read_data" or "send_control".
+        """
+        pb_message = carla_protocol.WorldRequest()
+        pb_message.snapshot.save.SetInParent()
+        pb_message = self._request_world_snapshot(pb_message)
+        if not pb_message.success:
+            raise RuntimeError('server failed to save the world snapshot')
+        return pb_message.snapshot
+
+    def restore_snapshot(self, snapshot):
+        """
+        Restore a state of the world saved by "save_snapshot". The data of the
+        frames sent before is discarded by "read_data".
+
+        In synchronous mode, read the data of the restored world next instead
+        of sending the control.
+        """
+        pb_message = carla_protocol.WorldRequest()
+        pb_message.snapshot.restore.snapshot = snapshot
+        pb_message = self._request_world_snapshot(pb_message)
+        if not pb_message.success:
+            raise RuntimeError('server failed to restore the world snapshot')
+        self._first_frame_number = pb_message.first_frame_number
+
+    def _request_world_snapshot(self, pb_message):
+        if self._stream_client is None:
+            raise RuntimeError('no episode running, cannot save or restore the world')
+        self._world_client.write(pb_message.SerializeToString())
+        data = self._world_client.read()
+        if not data:
+            raise RuntimeError('failed to read data from server')
+        pb_message = carla_protocol.WorldSnapshot()
+        pb_message.ParseFromString(data)
+        return pb_message
+
     def _request_new_episode(self, carla_settings):
         """
         Internal function to request a new episode. Prepare the client for a new
-        episode by disconnecting agent clients.
+        episode by disconnecting agent clients, unless the server is asked to
+        keep them.
         """
-        # Disconnect agent clients.
-        self._stream_client.disconnect()
-        self._control_client.disconnect()
+        if not self._keep_agent_connections:
+            self._disconnect_agent_clients()
         # Send new episode request.
-        pb_message = carla_protocol.RequestNewEpisode()
-        pb_message.ini_file = str(carla_settings)
+        pb_message = carla_protocol.WorldRequest()
+        pb_message.new_episode.ini_file = str(carla_settings)
+        pb_message.new_episode.keep_agent_connections = self._keep_agent_connections
         self._world_client.write(pb_message.SerializeToString())
         # Read scene description.
         data = self._world_client.read()
@@ -165,6 +274,34 @@ class CarlaClient(object):
         self._is_episode_requested = True
         return pb_message
 
+    def _disconnect_agent_clients(self):
+        for sensor_client in self._sensor_clients:
+            sensor_client.disconnect()
+        self._sensor_clients = []
+        self._control_client.disconnect()
+        if self._stream_client is not None:
+            self._stream_client.disconnect()
+            self._stream_client = None
+
+    def _decode_agent_snapshot(self, data):
+        if self._agent_snapshot_decoder is None:
+            from . import agent_snapshot
+            self._agent_snapshot_decoder = agent_snapshot.AgentSnapshotDecoder()
+        self.agent_snapshot = self._agent_snapshot_decoder.decode(data)
+
+    def _read_sensor_streams(self, frame_number):
+        """
+        Return a dict of {'sensor_name': sensor_data, ...} with the data of
+        each sensor stream matching frame_number. Sensors whose data for this
+        frame was dropped by the server are missing from the dict.
+        """
+        result = {}
+        for name, sensor_client in zip(self._sensor_names, self._sensor_clients):
+            raw_data = sensor_client.read(frame_number)
+            if raw_data is not None:
+                result[name] = next(self._iterate_sensor_data(raw_data))
+        return result
+
     def _parse_raw_sensor_data(self, raw_data):
         """Return a dict of {'sensor_name': sensor_data, ...}."""
         return dict((name, data) for name, data in zip(
@@ -174,17 +311,67 @@ class CarlaClient(object):
     @staticmethod
     def _iterate_sensor_data(raw_data):
         # At this point the only sensors available are images, the raw_data
-        # consists of images only.
+        # consists of images only. The high half of the type word holds the
+        # codec, compressed images carry their size in bytes after it.
         image_types = ['None', 'SceneFinal', 'Depth', 'SemanticSegmentation']
         gettype = lambda id: image_types[id] if len(image_types) > id else 'Unknown'
-        getval = lambda index: struct.unpack('<L', raw_data[index*4:index*4+4])[0]
+        getval = lambda index: struct.unpack_from('<L', raw_data, index * 4)[0]
         total_size = len(raw_data) / 4
         index = 0
         while index < total_size:
             width = getval(index)
             height = getval(index + 1)
-            image_type = gettype(getval(index + 2))
-            begin = index + 3
-            end = begin + width * height
-            index = end
-            yield sensor.Image(width, height, image_type, raw_data[begin*4:end*4])
+            type_and_codec = getval(index + 2)
+            image_type = gettype(type_and_codec & 0xFFFF)
+            codec = type_and_codec >> 16
+            if codec == image_codec.CODEC_NONE:
+                begin = index + 3
+                end = begin + width * height
+                index = end
+                data = raw_data[begin*4:end*4]
+            else:
+                size = getval(index + 3)
+                begin = 4 * (index + 4)
+                index += 4 + (size + 3) // 4
+                data = image_codec.decompress(codec, width, height, raw_data[begin:begin+size])
+            yield sensor.Image(width, height, image_type, data)
+
+
+def _to_bytes(data):
+    return data.tobytes() if isinstance(data, memoryview) else data
+
+
+class _SensorStreamClient(object):
+    """
+    Client of a single sensor stream. Each message is tagged with the frame
+    number of the measurements it belongs to, followed by the raw data of the
+    sensor.
+    """
+
+    def __init__(self, client):
+        self._client = client
+        self._pending = None
+
+    def connect(self):
+        self._client.connect()
+
+    def read(self, frame_number):
+        """
+        Return the raw data of the given frame_number, or None if the server
+        dropped it.
+        """
+        while True:
+            if self._pending is None:
+                data = self._client.read()
+                self._pending = (struct.unpack_from('<Q', data)[0], data[8:])
+            pending_frame, raw_data = self._pending
+            if pending_frame > frame_number:
+                # Belongs to a later frame, keep it for the next read.
+                return None
+            self._pending = None
+            if pending_frame == frame_number:
+                return raw_data
+
+    def disconnect(self):
+        self._pending = None
+        self._client.disconnect()
@@ -0,0 +1,49 @@
+# Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma de
+# Barcelona (UAB), and the INTEL Visual Computing Lab.
+#
+# This work is licensed under the terms of the MIT license.
+# For a copy, see <https://opensource.org/licenses/MIT>.
+
+"""
+Decoding of the images compressed by the server (see "CompressImages" in
+CarlaSettings.ini). Must match "Util/CarlaServer/.../ImageCompressor.h".
+"""
+
+
+import zlib
+
+
+CODEC_NONE = 0
+CODEC_DEFLATE_SUB = 1
+CODEC_DEFLATE_DEPTH = 2
+
+
+def decompress(codec, width, height, data):
+    """Return the raw BGRA bytes of an image compressed with codec."""
+    if codec == CODEC_NONE:
+        return data
+
+    try:
+        import numpy
+    except ImportError:
+        raise RuntimeError('cannot import numpy, make sure numpy package is installed')
+
+    planes = numpy.frombuffer(zlib.decompress(data), dtype=numpy.uint8)
+    planes = numpy.reshape(planes, (4, height, width))
+    if codec == CODEC_DEFLATE_SUB:
+        # Each byte is stored as the difference with the one to its left.
+        array = numpy.cumsum(planes, axis=2, dtype=numpy.uint8)
+        return numpy.ascontiguousarray(numpy.transpose(array, (1, 2, 0))).tobytes()
+    elif codec == CODEC_DEFLATE_DEPTH:
+        # Each pixel is stored as the difference with the one to its left, as
+        # the 32-bit integer R | G << 8 | B << 16 | A << 24.
+        residuals = planes.astype(numpy.uint32)
+        residuals = residuals[0] | (residuals[1] << 8) | (residuals[2] << 16) | (residuals[3] << 24)
+        values = numpy.cumsum(residuals, axis=1, dtype=numpy.uint32)
+        array = numpy.empty((height, width, 4), dtype=numpy.uint8)
+        array[:, :, 0] = (values >> 16) & 0xFF
+        array[:, :, 1] = (values >> 8) & 0xFF
+        array[:, :, 2] = values & 0xFF
+        array[:, :, 3] = values >> 24
+        return array.tobytes()
+    raise ValueError('unknown image codec %d' % codec)
@@ -40,6 +40,7 @@ class Camera(Sensor):
         self.CameraRotationPitch = 0
         self.CameraRotationRoll = 0
         self.CameraRotationYaw = 0
+        self.CompressImages = False
         self.set(**kwargs)
 
     def set(self, **kwargs):
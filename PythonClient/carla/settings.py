@@ -35,7 +35,19 @@ class CarlaSettings(object):
     def __init__(self, **kwargs):
         # [CARLA/Server]
         self.SynchronousMode = True
+        self.ControlLookahead = None
         self.SendNonPlayerAgentsInfo = False
+        self.CompactNonPlayerAgentsInfo = None
+        self.QuantizeNonPlayerAgentsInfo = None
+        self.NonPlayerAgentsMaxDistance = None
+        self.NonPlayerAgentsMaxCount = None
+        self.NonPlayerAgentsFrustumCamera = None
+        self.NonPlayerAgentsTypes = None
+        self.SeparateSensorStreams = None
+        self.StreamBufferDepth = None
+        self.BlockWhenStreamBufferFull = None
+        self.SharedMemoryStreams = None
+        self.SharedMemoryCapacity = None
         # [CARLA/LevelSettings]
         self.PlayerVehicle = None
         self.NumberOfVehicles = 20
@@ -43,6 +55,9 @@ class CarlaSettings(object):
         self.WeatherId = -1
         self.SeedVehicles = None
         self.SeedPedestrians = None
+        self.UseSpatialIndexForAI = None
+        # [CARLA/SceneCapture]
+        self.ReadbackLatency = None
         self.randomize_weather()
         self.set(**kwargs)
         self._cameras = []
@@ -89,16 +104,31 @@ class CarlaSettings(object):
 
         add_section(S_SERVER, self, [
             'SynchronousMode',
-            'SendNonPlayerAgentsInfo'])
+            'ControlLookahead',
+            'SendNonPlayerAgentsInfo',
+            'CompactNonPlayerAgentsInfo',
+            'QuantizeNonPlayerAgentsInfo',
+            'NonPlayerAgentsMaxDistance',
+            'NonPlayerAgentsMaxCount',
+            'NonPlayerAgentsFrustumCamera',
+            'NonPlayerAgentsTypes',
+            'SeparateSensorStreams',
+            'StreamBufferDepth',
+            'BlockWhenStreamBufferFull',
+            'SharedMemoryStreams',
+            'SharedMemoryCapacity'])
         add_section(S_LEVEL, self, [
             'NumberOfVehicles',
             'NumberOfPedestrians',
             'WeatherId',
             'SeedVehicles',
-            'SeedPedestrians'])
+            'SeedPedestrians',
+            'UseSpatialIndexForAI'])
 
         ini.add_section(S_CAPTURE)
         ini.set(S_CAPTURE, 'Cameras', ','.join(c.CameraName for c in self._cameras))
+        add_section(S_CAPTURE, self, [
+            'ReadbackLatency'])
 
         for camera in self._cameras:
             add_section(S_CAPTURE + '/' + camera.CameraName, camera, [
@@ -111,7 +141,8 @@ class CarlaSettings(object):
                 'CameraPositionZ',
                 'CameraRotationPitch',
                 'CameraRotationRoll',
-                'CameraRotationYaw'])
+                'CameraRotationYaw',
+                'CompressImages'])
 
         if sys.version_info >= (3, 0):
             text = io.StringIO()
@@ -0,0 +1,94 @@
+# Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma de
+# Barcelona (UAB), and the INTEL Visual Computing Lab.
+#
+# This work is licensed under the terms of the MIT license.
+# For a copy, see <https://opensource.org/licenses/MIT>.
+
+"""
+Client of the streams written to shared memory (see "SharedMemoryStreams" in
+CarlaSettings.ini). Must match "Util/CarlaServer/.../SharedMemoryServer.h".
+"""
+
+import mmap
+import os
+import struct
+
+from . import tcp
+
+
+MAGIC = 0x4d485343
+VERSION = 1
+HEADER_SIZE = 64
+
+
+class SharedMemoryClient(tcp.TCPClient):
+    """
+    Reads the messages of a stream from a ring in shared memory, the socket
+    only carries the notifications. Only for clients running on the same
+    machine as the server (Linux only).
+
+    Each message read is a memoryview over the shared memory, numpy arrays
+    can be created on top of it without copying (e.g., numpy.frombuffer). The
+    memory is released back to the server on the next read after the last
+    message of a region, so these views must not be used after reading the
+    next frame; copy the data to keep it.
+    """
+
+    def __init__(self, host, port, timeout):
+        super(SharedMemoryClient, self).__init__(host, port, timeout)
+        self._mapping = None
+        self._ring = None
+        self._region = None
+        self._cursor = 0
+
+    def connect(self, connection_attempts=10):
+        super(SharedMemoryClient, self).connect(connection_attempts)
+        name = super(SharedMemoryClient, self).read().decode('utf-8')
+        path = os.path.join('/dev/shm', name.lstrip('/'))
+        try:
+            with open(path, 'rb') as shm_file:
+                self._mapping = mmap.mmap(shm_file.fileno(), 0, access=mmap.ACCESS_READ)
+        except (IOError, OSError) as exception:
+            self.disconnect()
+            self._reraise_exception_as_tcp_error('failed to map shared memory "%s"' % path, exception)
+        magic, version, capacity = struct.unpack_from('<LLQ', self._mapping, 0)
+        if magic != MAGIC or version != VERSION:
+            self.disconnect()
+            raise tcp.TCPConnectionError(self._logprefix + 'invalid shared memory "%s"' % path)
+        self._ring = memoryview(self._mapping)[HEADER_SIZE:HEADER_SIZE + capacity]
+
+    def disconnect(self):
+        self._region = None
+        self._ring = None
+        if self._mapping is not None:
+            try:
+                self._mapping.close()
+            except BufferError:
+                # Views handed out still alive, unmapped once collected.
+                pass
+            self._mapping = None
+        super(SharedMemoryClient, self).disconnect()
+
+    def read(self):
+        """
+        Read the next message, a memoryview valid until the memory is
+        released.
+        """
+        if self._region is None or self._cursor >= len(self._region):
+            self._next_region()
+        size = struct.unpack_from('<L', self._region, self._cursor)[0]
+        begin = self._cursor + 4
+        self._cursor = begin + size
+        if self._cursor > len(self._region):
+            raise tcp.TCPConnectionError(self._logprefix + 'invalid message in shared memory')
+        return self._region[begin:self._cursor]
+
+    def _next_region(self):
+        if self._region is not None:
+            # Done with the previous one.
+            self._region = None
+            self.write(b'')
+        notification = super(SharedMemoryClient, self).read()
+        offset, size = struct.unpack('<QQ', notification)
+        self._region = self._ring[offset:offset + size]
+        self._cursor = 0
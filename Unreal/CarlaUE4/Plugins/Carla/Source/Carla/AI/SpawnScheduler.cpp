@@ -0,0 +1,85 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "SpawnScheduler.h"
+
+#include "HAL/PlatformTime.h"
+
+#include "AI/VehicleSpawnerBase.h"
+#include "AI/WalkerSpawnerBase.h"
+#include "Game/CarlaGameState.h"
+#include "Game/DynamicActorsIndex.h"
+
+void FSpawnScheduler::Tick(
+    const ACarlaGameState &GameState,
+    AVehicleSpawnerBase *VehicleSpawner,
+    AWalkerSpawnerBase *WalkerSpawner)
+{
+  bool bSpawnVehicles = (VehicleSpawner != nullptr) && VehicleSpawner->HasVehiclesToSpawn();
+  bool bSpawnWalkers = (WalkerSpawner != nullptr) && WalkerSpawner->HasWalkersToSpawn();
+  if (bSpawnVehicles || bSpawnWalkers) {
+    const double Deadline = FPlatformTime::Seconds() + BudgetSeconds;
+    Occupancy = &GameState.GetDynamicActorsIndex();
+    SpawnedThisFrame.Reset();
+    // Take turns, at least one spawn each per frame.
+    while (bSpawnVehicles || bSpawnWalkers) {
+      if (bSpawnVehicles) {
+        bSpawnVehicles = VehicleSpawner->TrySpawnNextVehicle(*this);
+      }
+      if (bSpawnWalkers) {
+        bSpawnWalkers = WalkerSpawner->TrySpawnNextWalker(*this);
+      }
+      if ((BudgetSeconds > 0.0f) && (FPlatformTime::Seconds() >= Deadline)) {
+        break;
+      }
+    }
+    Occupancy = nullptr;
+  }
+  UpdateProgress(VehicleSpawner, WalkerSpawner);
+}
+
+bool FSpawnScheduler::IsOccupied(const FVector &Location, const float Radius) const
+{
+  check(Occupancy != nullptr);
+  bool bOccupied = false;
+  Occupancy->GetGrid().ForEachInRadius(Location, Radius, [&](int32, float) {
+    bOccupied = true;
+  });
+  if (bOccupied) {
+    return true;
+  }
+  const float RadiusSquared = Radius * Radius;
+  for (const FVector &Spawned : SpawnedThisFrame) {
+    if (FVector::DistSquared(Spawned, Location) <= RadiusSquared) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void FSpawnScheduler::UpdateProgress(
+    const AVehicleSpawnerBase *VehicleSpawner,
+    const AWalkerSpawnerBase *WalkerSpawner)
+{
+  int32 Spawned = 0;
+  int32 Pending = 0;
+  if (VehicleSpawner != nullptr) {
+    Spawned += VehicleSpawner->GetNumberOfSpawnedVehicles();
+    Pending += VehicleSpawner->GetNumberOfPendingVehicles();
+  }
+  if (WalkerSpawner != nullptr) {
+    Spawned += WalkerSpawner->GetCurrentNumberOfWalkers();
+    Pending += WalkerSpawner->GetNumberOfPendingWalkers();
+  }
+  const bool bWasPopulating = bIsPopulating;
+  bIsPopulating = (Pending > 0);
+  if (bIsPopulating) {
+    CARLA_LOG_RATE_LIMITED(LogCarla, Log, 1.0, TEXT("Spawning agents: %d of %d"), Spawned, Spawned + Pending);
+  } else if (bWasPopulating) {
+    UE_LOG(LogCarla, Log, TEXT("Spawned %d agents"), Spawned);
+  }
+}
@@ -0,0 +1,68 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "Util/NonCopyable.h"
+
+class ACarlaGameState;
+class AVehicleSpawnerBase;
+class AWalkerSpawnerBase;
+class FDynamicActorsIndex;
+
+/// Spawns the agents the vehicle and walker spawners have pending, taking
+/// turns, a few every frame within a time budget so a big population does not
+/// stall a single frame.
+///
+/// Spawners ask IsOccupied() before spawning at a location, so locations
+/// taken by the player or other agents are skipped instead of failing to
+/// spawn there. The agents already present are looked up in the dynamic
+/// actors index of the game state, shared with everyone querying it that
+/// frame.
+class CARLA_API FSpawnScheduler : private NonCopyable
+{
+public:
+
+  /// Time spent spawning every frame, in milliseconds. If zero, everything
+  /// pending is spawned at once.
+  void SetBudget(float Milliseconds)
+  {
+    BudgetSeconds = FMath::Max(0.0f, Milliseconds) / 1e3f;
+  }
+
+  /// Spawn what the spawners have pending until the budget of this frame runs
+  /// out.
+  void Tick(const ACarlaGameState &GameState, AVehicleSpawnerBase *VehicleSpawner, AWalkerSpawnerBase *WalkerSpawner);
+
+  /// Whether the spawners are still spawning their initial population, as of
+  /// the last Tick.
+  bool IsPopulating() const
+  {
+    return bIsPopulating;
+  }
+
+  /// During Tick, whether any agent is within @a Radius of @a Location.
+  bool IsOccupied(const FVector &Location, float Radius) const;
+
+  /// During Tick, an agent was spawned at @a Location.
+  void AddOccupied(const FVector &Location)
+  {
+    SpawnedThisFrame.Add(Location);
+  }
+
+private:
+
+  void UpdateProgress(const AVehicleSpawnerBase *VehicleSpawner, const AWalkerSpawnerBase *WalkerSpawner);
+
+  float BudgetSeconds = 0.0f;
+
+  bool bIsPopulating = false;
+
+  /// During Tick, the agents present at the beginning of the frame.
+  const FDynamicActorsIndex *Occupancy = nullptr;
+
+  TArray<FVector> SpawnedThisFrame;
+};
@@ -92,6 +92,16 @@ void ATrafficLightBase::SwitchTrafficLightState()
   }
 }
 
+void ATrafficLightBase::RestoreTrafficLightState(
+    const ETrafficLightState InState,
+    const TArray<AWheeledVehicleAIController *> &WaitingVehicles)
+{
+  State = InState;
+  Vehicles = WaitingVehicles;
+  SetTrafficSignState(ToTrafficSignState(State));
+  OnTrafficLightStateChanged(State);
+}
+
 void ATrafficLightBase::NotifyWheeledVehicle(ACarlaWheeledVehicle *Vehicle)
 {
   if (IsValid(Vehicle)) {
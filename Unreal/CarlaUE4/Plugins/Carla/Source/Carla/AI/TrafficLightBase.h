@@ -48,6 +48,19 @@ public:
   UFUNCTION(Category = "Traffic Light", BlueprintCallable)
   void NotifyWheeledVehicle(ACarlaWheeledVehicle *Vehicle);
 
+  /// Controllers of the vehicles waiting for the light to turn green.
+  const TArray<AWheeledVehicleAIController *> &GetWaitingVehicles() const
+  {
+    return Vehicles;
+  }
+
+  /// Restore the state of the light and the vehicles waiting for it without
+  /// notifying them, their own state is restored separately (see
+  /// ACarlaGameModeBase::RestoreWorldSnapshot).
+  void RestoreTrafficLightState(
+      ETrafficLightState InState,
+      const TArray<AWheeledVehicleAIController *> &WaitingVehicles);
+
 protected:
 
   UFUNCTION(Category = "Traffic Light", BlueprintImplementableEvent)
@@ -7,8 +7,11 @@
 #include "Carla.h"
 #include "VehicleSpawnerBase.h"
 
+#include "AI/SpawnScheduler.h"
 #include "AI/WheeledVehicleAIController.h"
 #include "CarlaWheeledVehicle.h"
+#include "Game/CarlaGameInstance.h"
+#include "Util/EpisodeStartTimer.h"
 #include "Util/RandomEngine.h"
 
 #include "Engine/PlayerStartPIE.h"
@@ -54,24 +57,7 @@ void AVehicleSpawnerBase::BeginPlay()
 
   UE_LOG(LogCarla, Log, TEXT("Found %d positions for spawning vehicles"), SpawnPoints.Num());
 
-  if (SpawnPoints.Num() < NumberOfVehicles) {
-    bSpawnVehicles = false;
-    UE_LOG(LogCarla, Error, TEXT("We don't have enough spawn points for vehicles!"));
-  }
-
-  if (bSpawnVehicles) {
-    const int32 MaximumNumberOfAttempts = 4 * NumberOfVehicles;
-    int32 NumberOfAttempts = 0;
-    while ((NumberOfVehicles > Vehicles.Num()) && (NumberOfAttempts < MaximumNumberOfAttempts)) {
-      // Try to spawn one vehicle.
-      TryToSpawnRandomVehicle();
-      ++NumberOfAttempts;
-    }
-
-    if (NumberOfVehicles > Vehicles.Num()) {
-      UE_LOG(LogCarla, Error, TEXT("Requested %d vehicles, but we were only able to spawn %d"), NumberOfVehicles, Vehicles.Num());
-    }
-  }
+  SpawnVehicles();
 }
 
 void AVehicleSpawnerBase::SetNumberOfVehicles(const int32 Count)
@@ -84,17 +70,63 @@ void AVehicleSpawnerBase::SetNumberOfVehicles(const int32 Count)
   }
 }
 
-void AVehicleSpawnerBase::TryToSpawnRandomVehicle()
+void AVehicleSpawnerBase::SpawnVehicles()
 {
-  auto SpawnPoint = GetRandomSpawnPoint();
-  if ((SpawnPoint != nullptr)) {
-      SpawnVehicleAtSpawnPoint(*SpawnPoint);
-  } else {
-    UE_LOG(LogCarla, Error, TEXT("Unable to find spawn point"));
+  if (bSpawnVehicles && (SpawnPoints.Num() < NumberOfVehicles)) {
+    bSpawnVehicles = false;
+    UE_LOG(LogCarla, Error, TEXT("We don't have enough spawn points for vehicles!"));
+  }
+
+  // Every spawn point is tried once, the occupied ones are skipped.
+  PendingSpawnPoints.Reset();
+  if (bSpawnVehicles) {
+    PendingSpawnPoints = SpawnPoints;
+    GetRandomEngine()->Shuffle(PendingSpawnPoints);
+  }
+}
+
+bool AVehicleSpawnerBase::TrySpawnNextVehicle(FSpawnScheduler &Scheduler)
+{
+  FEpisodeStartTimer::FScopedPhase Phase(UCarlaGameInstance::FindEpisodeStartTimer(this), "SpawnVehicles");
+  while (HasVehiclesToSpawn()) {
+    const APlayerStart *SpawnPoint = PendingSpawnPoints.Pop(false);
+    if (SpawnPoint == nullptr) {
+      continue;
+    }
+    const FVector Location = SpawnPoint->GetActorLocation();
+    if (!Scheduler.IsOccupied(Location, SpawnClearance)) {
+      if (SpawnVehicleAtSpawnPoint(*SpawnPoint)) {
+        Scheduler.AddOccupied(Location);
+      }
+      break;
+    }
+  }
+  if (HasVehiclesToSpawn()) {
+    return true;
+  }
+  if (NumberOfVehicles > Vehicles.Num()) {
+    UE_LOG(LogCarla, Error, TEXT("Requested %d vehicles, but we were only able to spawn %d"), NumberOfVehicles, Vehicles.Num());
+  }
+  PendingSpawnPoints.Reset();
+  return false;
+}
+
+void AVehicleSpawnerBase::DestroyVehicles()
+{
+  for (auto *Vehicle : Vehicles) {
+    auto Controller = GetController(Vehicle);
+    if (Controller != nullptr) {
+      Controller->Destroy();
+    }
+    if (VehicleIsValid(Vehicle)) {
+      Vehicle->Destroy();
+    }
   }
+  Vehicles.Reset();
+  PendingSpawnPoints.Reset();
 }
 
-void AVehicleSpawnerBase::SpawnVehicleAtSpawnPoint(
+bool AVehicleSpawnerBase::SpawnVehicleAtSpawnPoint(
     const APlayerStart &SpawnPoint)
 {
   ACarlaWheeledVehicle *Vehicle;
@@ -108,11 +140,13 @@ void AVehicleSpawnerBase::SpawnVehicleAtSpawnPoint(
       Controller->SetRoadMap(GetRoadMap());
       Controller->SetAutopilot(true);
       Vehicles.Add(Vehicle);
+      return true;
     } else {
       UE_LOG(LogCarla, Error, TEXT("Something went wrong creating the controller for the new vehicle"));
       Vehicle->Destroy();
     }
   }
+  return false;
 }
 
 APlayerStart *AVehicleSpawnerBase::GetRandomSpawnPoint()
@@ -11,6 +11,7 @@
 
 class ACarlaWheeledVehicle;
 class APlayerStart;
+class FSpawnScheduler;
 
 UCLASS(Abstract)
 class CARLA_API AVehicleSpawnerBase : public AActorWithRandomEngine
@@ -30,13 +31,34 @@ protected:
   UFUNCTION(BlueprintImplementableEvent)
   void SpawnVehicle(const FTransform &SpawnTransform, ACarlaWheeledVehicle *&SpawnedCharacter);
 
-  //UFUNCTION(BlueprintImplementableEvent)
-  void TryToSpawnRandomVehicle();
-
 public:
 
   void SetNumberOfVehicles(int32 Count);
 
+  /// Queue the vehicles missing up to the number of vehicles at the spawn
+  /// points in random order, done at begin play. The spawn scheduler spawns
+  /// them in the next frames. For a new episode without reloading the level,
+  /// destroy the vehicles and set the seed first to place them as a freshly
+  /// loaded level would.
+  void SpawnVehicles();
+
+  bool HasVehiclesToSpawn() const
+  {
+    return GetNumberOfPendingVehicles() > 0;
+  }
+
+  /// Number of vehicles queued by SpawnVehicles still to spawn, at most.
+  int32 GetNumberOfPendingVehicles() const
+  {
+    return FMath::Min(FMath::Max(0, NumberOfVehicles - Vehicles.Num()), PendingSpawnPoints.Num());
+  }
+
+  /// Spawn the next vehicle queued at a spawn point not occupied, see
+  /// FSpawnScheduler. Returns whether there are vehicles left to spawn.
+  bool TrySpawnNextVehicle(FSpawnScheduler &Scheduler);
+
+  void DestroyVehicles();
+
   int32 GetNumberOfSpawnedVehicles() const
   {
     return Vehicles.Num();
@@ -61,7 +83,8 @@ protected:
 
   APlayerStart* GetRandomSpawnPoint();
 
-  void SpawnVehicleAtSpawnPoint(const APlayerStart &SpawnPoint);
+  /// Returns whether the vehicle was spawned.
+  bool SpawnVehicleAtSpawnPoint(const APlayerStart &SpawnPoint);
 
   UPROPERTY()
   URoadMap *RoadMap;
@@ -74,9 +97,18 @@ protected:
   UPROPERTY(Category = "Vehicle Spawner", EditAnywhere, meta = (EditCondition = bSpawnVehicles, ClampMin = "1"))
   int32 NumberOfVehicles = 10;
 
+  /** Minimum distance in centimeters from a spawn point to the player or any
+    * other agent to spawn a vehicle there. */
+  UPROPERTY(Category = "Vehicle Spawner", EditAnywhere, meta = (EditCondition = bSpawnVehicles, ClampMin = "0"))
+  float SpawnClearance = 400.0f;
+
   UPROPERTY(Category = "Vechicle Spawner", VisibleAnywhere, AdvancedDisplay)
   TArray<APlayerStart *> SpawnPoints;
 
+  /** Spawn points not tried yet, the next one is the last. */
+  UPROPERTY()
+  TArray<APlayerStart *> PendingSpawnPoints;
+
   UPROPERTY(Category = "Vehicle Spawner", BlueprintReadOnly, VisibleAnywhere, AdvancedDisplay)
   TArray<ACarlaWheeledVehicle *> Vehicles;
 };
@@ -14,6 +14,10 @@
 #include "WheeledVehicle.h"
 #include "WheeledVehicleMovementComponent.h"
 
+#include "Game/CarlaGameInstance.h"
+#include "Game/CarlaGameState.h"
+#include "Settings/CarlaSettings.h"
+
 #ifdef CARLA_AI_WALKERS_EXTRA_LOG
 #  include <DrawDebugHelpers.h>
 #  define LOG_AI_WALKER(Verbosity, Text) UE_LOG(LogCarla, Verbosity, TEXT("Walker %s " Text), *GetPawn()->GetName());
@@ -28,6 +32,7 @@ static constexpr float PREVISION_TIME_IN_SECONDS = 5.0f;
 static constexpr float WALKER_SIGHT_RADIUS = 500.0f;
 static constexpr float WALKER_PERIPHERAL_VISION_ANGLE_IN_DEGREES = 90.0f;
 static constexpr float VEHICLE_SAFETY_RADIUS = 400.0f;
+static constexpr float SENSE_INTERVAL_IN_SECONDS = 0.2f;
 
 // =============================================================================
 // -- PawnPath -----------------------------------------------------------------
@@ -133,6 +138,29 @@ static bool IntersectsWithVehicle(const APawn &Self, const TArray<AActor *> &Act
   return false;
 }
 
+/// Same as above but looking up the vehicles in @a ActorsIndex, within the
+/// sight cone the perception component would use.
+static bool IntersectsWithVehicle(const APawn &Self, const FDynamicActorsIndex &ActorsIndex)
+{
+  const FVector Location = Self.GetActorLocation();
+  const FVector Forward = Self.GetActorForwardVector();
+  const float CosPeripheralVisionAngle =
+      FMath::Cos(FMath::DegreesToRadians(WALKER_PERIPHERAL_VISION_ANGLE_IN_DEGREES));
+  bool bIntersect = false;
+  ActorsIndex.GetGrid().ForEachInRadius(Location, WALKER_SIGHT_RADIUS, [&](int32 Index, float) {
+    if (bIntersect || (ActorsIndex.GetKind(Index) == FDynamicActorsIndex::EKind::Walker)) {
+      return;
+    }
+    const auto *Vehicle = Cast<AWheeledVehicle>(&ActorsIndex.GetActor(Index));
+    const FVector Direction = (ActorsIndex.GetLocation(Index) - Location).GetSafeNormal();
+    bIntersect =
+        (Vehicle != nullptr) &&
+        (FVector::DotProduct(Direction, Forward) >= CosPeripheralVisionAngle) &&
+        PawnPath::Intersect(Self, *Vehicle);
+  });
+  return bIntersect;
+}
+
 // =============================================================================
 // -- AWalkerAIController ------------------------------------------------------
 // =============================================================================
@@ -166,6 +194,17 @@ void AWalkerAIController::Possess(APawn *aPawn)
   Super::Possess(aPawn);
   check(aPawn != nullptr);
   aPawn->OnTakeAnyDamage.AddDynamic(this, &AWalkerAIController::OnPawnTookDamage);
+
+  const auto *GameInstance = Cast<UCarlaGameInstance>(GetGameInstance());
+  if ((GameInstance != nullptr) && GameInstance->GetCarlaSettings().bUseSpatialIndexForAI) {
+    GetPerceptionComponent()->SetSenseEnabled(UAISense_Sight::StaticClass(), false);
+    GetWorldTimerManager().SetTimer(
+        SenseTimerHandle,
+        this,
+        &AWalkerAIController::SenseVehiclesInIndex,
+        SENSE_INTERVAL_IN_SECONDS,
+        true);
+  }
 }
 
 void AWalkerAIController::Tick(float DeltaSeconds)
@@ -198,6 +237,7 @@ FPathFollowingRequestResult AWalkerAIController::MoveTo(
       *MoveRequest.GetGoalLocation().ToString());
 #endif // CARLA_AI_WALKERS_EXTRA_LOG
   Status = EWalkerStatus::Moving;
+  Destination = MoveRequest.GetGoalLocation();
   return Super::MoveTo(MoveRequest, OutPath);
 }
 
@@ -224,6 +264,18 @@ void AWalkerAIController::SenseActors(const TArray<AActor *> Actors)
   }
 }
 
+void AWalkerAIController::SenseVehiclesInIndex()
+{
+  const auto *aPawn = GetPawn();
+  const auto *GameState = GetWorld()->GetGameState<ACarlaGameState>();
+  if ((Status == EWalkerStatus::Moving) &&
+      (aPawn != nullptr) &&
+      (GameState != nullptr) &&
+      IntersectsWithVehicle(*aPawn, GameState->GetDynamicActorsIndex())) {
+    TryPauseMovement();
+  }
+}
+
 void AWalkerAIController::TryResumeMovement()
 {
   if (Status != EWalkerStatus::Moving) {
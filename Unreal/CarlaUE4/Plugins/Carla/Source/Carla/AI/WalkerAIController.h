@@ -49,8 +49,18 @@ public:
     return Status;
   }
 
+  /// Location the walker was last requested to move to.
+  const FVector &GetDestination() const
+  {
+    return Destination;
+  }
+
 private:
 
+  /// Look for vehicles in the dynamic actors index instead of relying on the
+  /// perception component, see UCarlaSettings::bUseSpatialIndexForAI.
+  void SenseVehiclesInIndex();
+
   void TryResumeMovement();
 
   void TryPauseMovement(bool bItWasRunOver = false);
@@ -63,4 +73,9 @@ private:
 
   UPROPERTY(VisibleAnywhere)
   EWalkerStatus Status = EWalkerStatus::Unknown;
+
+  UPROPERTY(VisibleAnywhere)
+  FVector Destination = FVector::ZeroVector;
+
+  FTimerHandle SenseTimerHandle;
 };
@@ -10,7 +10,11 @@
 #include "Components/BoxComponent.h"
 #include "EngineUtils.h"
 #include "GameFramework/Character.h"
+#include "GameFramework/CharacterMovementComponent.h"
 
+#include "Game/CarlaGameInstance.h"
+#include "SpawnScheduler.h"
+#include "Util/EpisodeStartTimer.h"
 #include "Util/RandomEngine.h"
 #include "WalkerAIController.h"
 #include "WalkerSpawnPoint.h"
@@ -45,6 +49,33 @@ static EWalkerStatus GetWalkerStatus(ACharacter *Walker)
   return (Controller == nullptr ? EWalkerStatus::Invalid : Controller->GetWalkerStatus());
 }
 
+static void DestroyAll(TArray<ACharacter *> &Walkers)
+{
+  for (auto *Walker : Walkers) {
+    auto Controller = GetController(Walker);
+    if (Controller != nullptr) {
+      Controller->Destroy();
+    }
+    if (WalkerIsValid(Walker)) {
+      Walker->Destroy();
+    }
+  }
+  Walkers.Reset();
+}
+
+static void SaveWalkers(
+    const TArray<ACharacter *> &Walkers,
+    TArray<AWalkerSpawnerBase::FWalkerSnapshot> &Snapshots)
+{
+  Snapshots.Reset();
+  for (auto *Walker : Walkers) {
+    const auto *Controller = GetController(Walker);
+    if (Controller != nullptr) {
+      Snapshots.Add({Walker->GetActorTransform(), Walker->GetVelocity(), Controller->GetDestination()});
+    }
+  }
+}
+
 // =============================================================================
 // -- Constructor and destructor -----------------------------------------------
 // =============================================================================
@@ -70,7 +101,6 @@ void AWalkerSpawnerBase::BeginPlay()
   Walkers.Reserve(NumberOfWalkers);
 
   // Find spawn points present in level.
-  TArray<AWalkerSpawnPointBase *> BeginSpawnPoints;
   for (TActorIterator<AWalkerSpawnPointBase> It(GetWorld()); It; ++It) {
     BeginSpawnPoints.Add(*It);
     AWalkerSpawnPoint *SpawnPoint = Cast<AWalkerSpawnPoint>(*It);
@@ -88,28 +118,13 @@ void AWalkerSpawnerBase::BeginPlay()
     UE_LOG(LogCarla, Warning, TEXT("Requested %d walkers, but we only have %d spawn points. Some will fail to spawn."), NumberOfWalkers, BeginSpawnPoints.Num());
   }
 
-  GetRandomEngine()->Shuffle(BeginSpawnPoints);
-
-  if (bSpawnWalkers && bSpawnWalkersAtBeginPlay) {
-    uint32 Count = 0u;
-    for (auto i = 0; i < NumberOfWalkers; ++i) {
-      if (TryToSpawnWalkerAt(*BeginSpawnPoints[i % BeginSpawnPoints.Num()])) {
-        ++Count;
-      }
-    }
-    UE_LOG(LogCarla, Log, TEXT("Spawned %d walkers at begin play."), Count);
-  }
+  SpawnWalkers();
 }
 
 void AWalkerSpawnerBase::Tick(float DeltaTime)
 {
   Super::Tick(DeltaTime);
 
-  if (bSpawnWalkers && (NumberOfWalkers > GetCurrentNumberOfWalkers())) {
-    // Try to spawn one walker.
-    TryToSpawnWalkerAt(GetRandomSpawnPoint());
-  }
-
   if (WalkersBlackList.Num() > 0) {
     // If still stuck in the black list, just kill it.
     const int32 Index = (++CurrentIndexToCheck % WalkersBlackList.Num());
@@ -163,6 +178,80 @@ void AWalkerSpawnerBase::SetNumberOfWalkers(const int32 Count)
   }
 }
 
+void AWalkerSpawnerBase::SpawnWalkers()
+{
+  // Shuffle a copy, the same seed has to give the same walkers every time.
+  auto ShuffledSpawnPoints = BeginSpawnPoints;
+  GetRandomEngine()->Shuffle(ShuffledSpawnPoints);
+
+  PendingSpawnPoints.Reset();
+  NumberOfWalkersSpawnedAtBeginPlay = 0;
+  if (bSpawnWalkers && bSpawnWalkersAtBeginPlay && (ShuffledSpawnPoints.Num() > 0)) {
+    // With more walkers than spawn points, the points are used again if free
+    // by then.
+    for (auto i = NumberOfWalkers - 1; i >= 0; --i) {
+      PendingSpawnPoints.Add(ShuffledSpawnPoints[i % ShuffledSpawnPoints.Num()]);
+    }
+  }
+}
+
+bool AWalkerSpawnerBase::TrySpawnNextWalker(FSpawnScheduler &Scheduler)
+{
+  FEpisodeStartTimer::FScopedPhase Phase(UCarlaGameInstance::FindEpisodeStartTimer(this), "SpawnWalkers");
+  if (PendingSpawnPoints.Num() > 0) {
+    // Every walker queued is tried once, the ones missing are replaced during
+    // the game.
+    const AWalkerSpawnPointBase *SpawnPoint = PendingSpawnPoints.Pop(false);
+    if ((SpawnPoint != nullptr) &&
+        !Scheduler.IsOccupied(SpawnPoint->GetActorLocation(), SpawnClearance) &&
+        TryToSpawnWalkerAt(*SpawnPoint)) {
+      Scheduler.AddOccupied(SpawnPoint->GetActorLocation());
+      ++NumberOfWalkersSpawnedAtBeginPlay;
+    }
+    if (PendingSpawnPoints.Num() == 0) {
+      UE_LOG(LogCarla, Log, TEXT("Spawned %d walkers at begin play."), NumberOfWalkersSpawnedAtBeginPlay);
+    }
+    return HasWalkersToSpawn();
+  }
+  if (!HasWalkersToSpawn()) {
+    return false;
+  }
+  // Replace a walker gone, give up for this frame at the first failure.
+  const auto &SpawnPoint = GetRandomSpawnPoint();
+  if (Scheduler.IsOccupied(SpawnPoint.GetActorLocation(), SpawnClearance) ||
+      !TryToSpawnWalkerAt(SpawnPoint)) {
+    return false;
+  }
+  Scheduler.AddOccupied(SpawnPoint.GetActorLocation());
+  return HasWalkersToSpawn();
+}
+
+void AWalkerSpawnerBase::DestroyWalkers()
+{
+  DestroyAll(Walkers);
+  DestroyAll(WalkersBlackList);
+  PendingSpawnPoints.Reset();
+  CurrentIndexToCheck = 0u;
+}
+
+void AWalkerSpawnerBase::SaveSnapshot(FSnapshot &Snapshot)
+{
+  SaveWalkers(Walkers, Snapshot.Walkers);
+  SaveWalkers(WalkersBlackList, Snapshot.WalkersBlackList);
+  Snapshot.RandomState = GetRandomEngine()->GetState();
+  Snapshot.CurrentIndexToCheck = CurrentIndexToCheck;
+}
+
+void AWalkerSpawnerBase::RestoreSnapshot(const FSnapshot &Snapshot)
+{
+  DestroyWalkers();
+  RestoreWalkers(Snapshot.Walkers, Walkers);
+  RestoreWalkers(Snapshot.WalkersBlackList, WalkersBlackList);
+  // Spawning may have drawn numbers from the engine, restore it last.
+  GetRandomEngine()->SetState(Snapshot.RandomState);
+  CurrentIndexToCheck = Snapshot.CurrentIndexToCheck;
+}
+
 const AWalkerSpawnPointBase &AWalkerSpawnerBase::GetRandomSpawnPoint()
 {
   check(SpawnPoints.Num() > 0);
@@ -186,11 +275,23 @@ bool AWalkerSpawnerBase::TryToSpawnWalkerAt(const AWalkerSpawnPointBase &SpawnPo
     return false;
   }
 
+  auto *Walker = SpawnWalkerWithDestination(SpawnPoint.GetActorTransform(), Destination);
+  if (Walker == nullptr) {
+    return false;
+  }
+  Walkers.Add(Walker);
+  return true;
+}
+
+ACharacter *AWalkerSpawnerBase::SpawnWalkerWithDestination(
+    const FTransform &Transform,
+    const FVector &Destination)
+{
   // Spawn walker.
   ACharacter *Walker;
-  SpawnWalker(SpawnPoint.GetActorTransform(), Walker);
+  SpawnWalker(Transform, Walker);
   if (!WalkerIsValid(Walker)) {
-    return false;
+    return nullptr;
   }
 
   // Assign controller.
@@ -200,13 +301,28 @@ bool AWalkerSpawnerBase::TryToSpawnWalkerAt(const AWalkerSpawnPointBase &SpawnPo
   if (Controller == nullptr) { // Sometimes fails...
     UE_LOG(LogCarla, Error, TEXT("Something went wrong creating the controller for the new walker"));
     Walker->Destroy();
-    return false;
+    return nullptr;
   }
 
-  // Add walker and set destination.
-  Walkers.Add(Walker);
+  // Set destination.
   Controller->MoveToLocation(Destination);
-  return true;
+  return Walker;
+}
+
+void AWalkerSpawnerBase::RestoreWalkers(
+    const TArray<FWalkerSnapshot> &Snapshots,
+    TArray<ACharacter *> &WalkerList)
+{
+  for (auto &Snapshot : Snapshots) {
+    auto *Walker = SpawnWalkerWithDestination(Snapshot.Transform, Snapshot.Destination);
+    if (Walker != nullptr) {
+      Walker->GetCharacterMovement()->Velocity = Snapshot.Velocity;
+      WalkerList.Add(Walker);
+    }
+  }
+  if (WalkerList.Num() < Snapshots.Num()) {
+    UE_LOG(LogCarla, Warning, TEXT("Restored %d walkers out of %d"), WalkerList.Num(), Snapshots.Num());
+  }
 }
 
 bool AWalkerSpawnerBase::TrySetDestination(ACharacter &Walker)
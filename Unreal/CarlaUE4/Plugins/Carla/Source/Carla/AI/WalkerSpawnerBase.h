@@ -11,6 +11,7 @@
 
 class AWalkerSpawnPoint;
 class AWalkerSpawnPointBase;
+class FSpawnScheduler;
 class UBoxComponent;
 
 /// Base class for spawning walkers. Implement SpawnWalker in derived
@@ -18,6 +19,8 @@ class UBoxComponent;
 ///
 /// Walkers are spawned at a random AWalkerSpawnPoint present in the level, and
 /// walk until its destination is reached at another random AWalkerSpawnPoint.
+/// The spawn scheduler of the game mode spawns them, and replaces the ones
+/// gone during the game.
 UCLASS(Abstract)
 class CARLA_API AWalkerSpawnerBase : public AActorWithRandomEngine
 {
@@ -63,6 +66,73 @@ public:
 
   void SetNumberOfWalkers(int32 Count);
 
+  /// Queue the walkers at random begin play spawn points, done at begin play.
+  /// The spawn scheduler spawns them in the next frames. For a new episode
+  /// without reloading the level, destroy the walkers and set the seed first
+  /// to place them as a freshly loaded level would.
+  void SpawnWalkers();
+
+  /// Whether walkers are queued by SpawnWalkers, or missing during the game.
+  bool HasWalkersToSpawn() const
+  {
+    return (PendingSpawnPoints.Num() > 0) || (bSpawnWalkers && (NumberOfWalkers > GetCurrentNumberOfWalkers()));
+  }
+
+  /// Number of walkers queued by SpawnWalkers still to spawn.
+  int32 GetNumberOfPendingWalkers() const
+  {
+    return PendingSpawnPoints.Num();
+  }
+
+  /// Spawn the next walker queued, or one missing at a random spawn point,
+  /// if not occupied, see FSpawnScheduler. Returns whether to keep trying
+  /// this frame.
+  bool TrySpawnNextWalker(FSpawnScheduler &Scheduler);
+
+  void DestroyWalkers();
+
+  /// A walker as saved in a world snapshot.
+  struct FWalkerSnapshot
+  {
+    FTransform Transform;
+
+    FVector Velocity = FVector::ZeroVector;
+
+    FVector Destination = FVector::ZeroVector;
+
+    friend FArchive &operator<<(FArchive &Ar, FWalkerSnapshot &Snapshot)
+    {
+      Ar << Snapshot.Transform << Snapshot.Velocity << Snapshot.Destination;
+      return Ar;
+    }
+  };
+
+  /// The walkers, where they are heading, and the state of the random engine
+  /// (see ACarlaGameModeBase::SaveWorldSnapshot).
+  struct FSnapshot
+  {
+    TArray<FWalkerSnapshot> Walkers;
+
+    TArray<FWalkerSnapshot> WalkersBlackList;
+
+    uint32 RandomState = 0u;
+
+    uint32 CurrentIndexToCheck = 0u;
+
+    friend FArchive &operator<<(FArchive &Ar, FSnapshot &Snapshot)
+    {
+      Ar << Snapshot.Walkers << Snapshot.WalkersBlackList;
+      Ar << Snapshot.RandomState << Snapshot.CurrentIndexToCheck;
+      return Ar;
+    }
+  };
+
+  void SaveSnapshot(FSnapshot &Snapshot);
+
+  /// Replace the walkers by the ones saved in @a Snapshot, spawned again
+  /// where they were and heading to the same destinations.
+  void RestoreSnapshot(const FSnapshot &Snapshot);
+
   int32 GetCurrentNumberOfWalkers() const
   {
     return Walkers.Num() + WalkersBlackList.Num();
@@ -84,6 +154,12 @@ private:
 
   bool TryToSpawnWalkerAt(const AWalkerSpawnPointBase &SpawnPoint);
 
+  /// Spawn a walker with its controller and send it to @a Destination.
+  /// Returns null on failure.
+  ACharacter *SpawnWalkerWithDestination(const FTransform &Transform, const FVector &Destination);
+
+  void RestoreWalkers(const TArray<FWalkerSnapshot> &Snapshots, TArray<ACharacter *> &WalkerList);
+
   bool TrySetDestination(ACharacter &Walker);
 
   /// @}
@@ -102,13 +178,28 @@ private:
   UPROPERTY(Category = "Walker Spawner", EditAnywhere, meta = (EditCondition = bSpawnWalkers, ClampMin = "1"))
   int32 NumberOfWalkers = 10;
 
+  /** Minimum distance in centimeters from a spawn point to the player or any
+    * other agent to spawn a walker there. */
+  UPROPERTY(Category = "Walker Spawner", EditAnywhere, meta = (EditCondition = bSpawnWalkers, ClampMin = "0"))
+  float SpawnClearance = 100.0f;
+
   /** Minimum walk distance in centimeters. */
   UPROPERTY(Category = "Walker Spawner", EditAnywhere, meta = (EditCondition = bSpawnWalkers))
   float MinimumWalkDistance = 1500.0f;
 
+  UPROPERTY(Category = "Walker Spawner", VisibleAnywhere, AdvancedDisplay)
+  TArray<AWalkerSpawnPointBase *> BeginSpawnPoints;
+
   UPROPERTY(Category = "Walker Spawner", VisibleAnywhere, AdvancedDisplay)
   TArray<AWalkerSpawnPoint *> SpawnPoints;
 
+  /** Begin play spawn points queued, the next one is the last. */
+  UPROPERTY()
+  TArray<AWalkerSpawnPointBase *> PendingSpawnPoints;
+
+  /** Walkers spawned from the queue so far. */
+  int32 NumberOfWalkersSpawnedAtBeginPlay = 0;
+
   UPROPERTY(Category = "Walker Spawner", VisibleAnywhere, AdvancedDisplay)
   TArray<ACharacter *> Walkers;
 
@@ -12,7 +12,10 @@
 #include "WheeledVehicleMovementComponent.h"
 
 #include "CarlaWheeledVehicle.h"
+#include "Game/CarlaGameInstance.h"
+#include "Game/CarlaGameState.h"
 #include "MapGen/RoadMap.h"
+#include "Settings/CarlaSettings.h"
 
 // =============================================================================
 // -- Static local methods -----------------------------------------------------
@@ -34,10 +37,30 @@ static bool RayTrace(const AActor &Actor, const FVector &Start, const FVector &E
   return Success && OutHit.bBlockingHit;
 }
 
+/// Whether any vehicle, walker, or the player other than @a Vehicle is within
+/// @a Radius of the segment from @a Start to @a End.
+static bool IsThereAnyActorAlong(
+    const FDynamicActorsIndex &ActorsIndex,
+    const ACarlaWheeledVehicle &Vehicle,
+    const FVector &Start,
+    const FVector &End,
+    const float Radius)
+{
+  bool bFound = false;
+  ActorsIndex.GetGrid().ForEachAlongSegment(Start, End, Radius, [&](int32 Index, float) {
+    bFound |= (&ActorsIndex.GetActor(Index) != &Vehicle);
+  });
+  return bFound;
+}
+
+/// If @a GameState is not null, its dynamic actors index is used to skip the
+/// ray traces when no actor is near the path. Obstacles that are not in the
+/// index (anything else than vehicles and walkers) are missed in that case.
 static bool IsThereAnObstacleAhead(
     const ACarlaWheeledVehicle &Vehicle,
     const float Speed,
-    const FVector &Direction)
+    const FVector &Direction,
+    const ACarlaGameState *GameState)
 {
   const auto ForwardVector = Vehicle.GetVehicleOrientation();
   const auto VehicleBounds = Vehicle.GetVehicleBoundsExtent();
@@ -53,6 +76,14 @@ static bool IsThereAnObstacleAhead(
   const FVector StartLeft = StartCenter + (FVector(-ForwardVector.Y, ForwardVector.X, ForwardVector.Z) * 100.0f);
   const FVector EndLeft = StartLeft + Direction * (Distance + VehicleBounds.X / 2.0f);
 
+  // The side rays are 1m away from the center one, and actors are indexed by
+  // their center, add room for a vehicle's half length.
+  constexpr float BroadPhaseRadius = 100.0f + 300.0f;
+  if ((GameState != nullptr) &&
+      !IsThereAnyActorAlong(GameState->GetDynamicActorsIndex(), Vehicle, StartCenter, EndCenter, BroadPhaseRadius)) {
+    return false;
+  }
+
   return
       RayTrace(Vehicle, StartCenter, EndCenter) ||
       RayTrace(Vehicle, StartRight, EndRight) ||
@@ -88,6 +119,8 @@ void AWheeledVehicleAIController::Possess(APawn *aPawn)
   check(Vehicle != nullptr);
   MaximumSteerAngle = Vehicle->GetMaximumSteerAngle();
   check(MaximumSteerAngle > 0.0f);
+  const auto *GameInstance = Cast<UCarlaGameInstance>(GetGameInstance());
+  bUseDynamicActorsIndex = (GameInstance != nullptr) && GameInstance->GetCarlaSettings().bUseSpatialIndexForAI;
   ConfigureAutopilot(bAutopilotEnabled);
 }
 
@@ -126,6 +159,13 @@ void AWheeledVehicleAIController::ConfigureAutopilot(const bool Enable)
           ECarlaWheeledVehicleState::AutopilotOff);
 }
 
+void AWheeledVehicleAIController::ResetAutopilot()
+{
+  ConfigureAutopilot(bAutopilotEnabled);
+  AutopilotControl = FAutopilotControl();
+  SpeedLimit = GetClass()->GetDefaultObject<AWheeledVehicleAIController>()->SpeedLimit;
+}
+
 // =============================================================================
 // -- Traffic ------------------------------------------------------------------
 // =============================================================================
@@ -137,6 +177,47 @@ void AWheeledVehicleAIController::SetFixedRoute(const TArray<FVector> &Locations
   }
 }
 
+// =============================================================================
+// -- World snapshot -----------------------------------------------------------
+// =============================================================================
+
+void AWheeledVehicleAIController::SaveSnapshot(FSnapshot &Snapshot) const
+{
+  check(Vehicle != nullptr);
+  auto *Root = Cast<UPrimitiveComponent>(Vehicle->GetRootComponent());
+  Snapshot.Transform = Vehicle->GetActorTransform();
+  if (Root != nullptr) {
+    Snapshot.LinearVelocity = Root->GetPhysicsLinearVelocity();
+    Snapshot.AngularVelocity = Root->GetPhysicsAngularVelocity();
+  }
+  Snapshot.bAutopilot = bAutopilotEnabled;
+  Snapshot.SpeedLimit = SpeedLimit;
+  Snapshot.TrafficLightState = static_cast<uint8>(TrafficLightState);
+  Snapshot.Targets.Reset();
+  for (auto Queue = TargetLocations; !Queue.empty(); Queue.pop()) {
+    Snapshot.Targets.Add(Queue.front());
+  }
+}
+
+void AWheeledVehicleAIController::RestoreSnapshot(const FSnapshot &Snapshot)
+{
+  check(Vehicle != nullptr);
+  auto *Root = Cast<UPrimitiveComponent>(Vehicle->GetRootComponent());
+  Vehicle->SetActorTransform(Snapshot.Transform, false, nullptr, ETeleportType::TeleportPhysics);
+  if (Root != nullptr) {
+    Root->SetPhysicsLinearVelocity(Snapshot.LinearVelocity);
+    Root->SetPhysicsAngularVelocity(Snapshot.AngularVelocity);
+  }
+  SetAutopilot(Snapshot.bAutopilot);
+  SpeedLimit = Snapshot.SpeedLimit;
+  TrafficLightState = static_cast<ETrafficLightState>(Snapshot.TrafficLightState);
+  decltype(TargetLocations) Queue;
+  for (auto &Location : Snapshot.Targets) {
+    Queue.emplace(Location);
+  }
+  TargetLocations.swap(Queue);
+}
+
 // =============================================================================
 // -- AI -----------------------------------------------------------------------
 // =============================================================================
@@ -168,11 +249,15 @@ void AWheeledVehicleAIController::TickAutopilotController()
 
   const auto Speed = Vehicle->GetVehicleForwardSpeed();
 
+  const auto *GameState = (bUseDynamicActorsIndex ?
+      GetWorld()->GetGameState<ACarlaGameState>() :
+      nullptr);
+
   float Throttle;
   if (TrafficLightState != ETrafficLightState::Green) {
     Vehicle->SetAIVehicleState(ECarlaWheeledVehicleState::WaitingForRedLight);
     Throttle = Stop(Speed);
-  } else if (IsThereAnObstacleAhead(*Vehicle, Speed, Direction)) {
+  } else if (IsThereAnObstacleAhead(*Vehicle, Speed, Direction, GameState)) {
     Vehicle->SetAIVehicleState(ECarlaWheeledVehicleState::ObstacleAhead);
     Throttle = Stop(Speed);
   } else {
@@ -136,6 +136,10 @@ public:
     ConfigureAutopilot(!bAutopilotEnabled);
   }
 
+  /// Forget the route, the traffic light, the speed limit and the inputs, as
+  /// if the vehicle had just been spawned. The autopilot stays on or off.
+  void ResetAutopilot();
+
 private:
 
   void ConfigureAutopilot(bool Enable);
@@ -179,6 +183,45 @@ public:
   UFUNCTION(Category = "Wheeled Vehicle Controller", BlueprintCallable)
   void SetFixedRoute(const TArray<FVector> &Locations);
 
+  /// @}
+  // ===========================================================================
+  /// @name World snapshot
+  // ===========================================================================
+  /// @{
+public:
+
+  /// The transform and velocity of the possessed vehicle and the state of
+  /// the autopilot, as saved in a world snapshot (see
+  /// ACarlaGameModeBase::SaveWorldSnapshot).
+  struct FSnapshot
+  {
+    FTransform Transform;
+
+    FVector LinearVelocity = FVector::ZeroVector;
+
+    FVector AngularVelocity = FVector::ZeroVector;
+
+    bool bAutopilot = false;
+
+    float SpeedLimit = 0.0f;
+
+    /// An ETrafficLightState, not validated when loaded.
+    uint8 TrafficLightState = 0u;
+
+    TArray<FVector> Targets;
+
+    friend FArchive &operator<<(FArchive &Ar, FSnapshot &Snapshot)
+    {
+      Ar << Snapshot.Transform << Snapshot.LinearVelocity << Snapshot.AngularVelocity;
+      Ar << Snapshot.bAutopilot << Snapshot.SpeedLimit << Snapshot.TrafficLightState << Snapshot.Targets;
+      return Ar;
+    }
+  };
+
+  void SaveSnapshot(FSnapshot &Snapshot) const;
+
+  void RestoreSnapshot(const FSnapshot &Snapshot);
+
   /// @}
   // ===========================================================================
   /// @name AI
@@ -241,6 +284,11 @@ private:
   UPROPERTY(VisibleAnywhere)
   float MaximumSteerAngle = -1.0f;
 
+  /// Look for obstacles in the dynamic actors index of the game state before
+  /// tracing rays, see UCarlaSettings::bUseSpatialIndexForAI.
+  UPROPERTY(VisibleAnywhere)
+  bool bUseDynamicActorsIndex = false;
+
   FAutopilotControl AutopilotControl;
 
   std::queue<FVector> TargetLocations;
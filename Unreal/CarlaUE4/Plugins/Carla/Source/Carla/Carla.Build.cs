@@ -34,6 +34,8 @@ public class Carla : ModuleRules
         "CoreUObject",
         "Engine",
         "PhysXVehicles",
+        "RenderCore",
+        "RHI",
         "Slate",
         "SlateCore"
         // ... add private dependencies that you statically link with here ...
@@ -112,8 +114,13 @@ public class Carla : ModuleRules
       PublicAdditionalLibraries.Add(Path.Combine(CarlaServerInstallPath, "lib", GetLibName("boost_system")));
       PublicAdditionalLibraries.Add(Path.Combine(CarlaServerInstallPath, "lib", GetLibName("protobuf")));
       PublicAdditionalLibraries.Add(Path.Combine(CarlaServerInstallPath, "lib", GetLibName(CarlaServerLib)));
+      // shm_open, used by the shared memory streams.
+      PublicAdditionalLibraries.Add("rt");
     }
 
+    // CarlaServer compresses images with zlib, use the engine's copy.
+    AddEngineThirdPartyPrivateStaticDependencies(Target, "zlib");
+
     // Include path.
     string CarlaServerIncludePath = Path.Combine(CarlaServerInstallPath, "include");
     PublicIncludePaths.Add(CarlaServerIncludePath);
@@ -20,6 +20,28 @@ DECLARE_LOG_CATEGORY_EXTERN(LogCarlaServer, Log, All);
 // #define CARLA_TAGGER_EXTRA_LOG
 #endif // WITH_EDITOR
 
+/// Like UE_LOG, but logs at most once every @a Seconds from this call site.
+/// The messages in between are suppressed, their number is appended to the
+/// next one logged. Not thread-safe, for call sites run by a single thread
+/// (e.g., the game thread).
+#define CARLA_LOG_RATE_LIMITED(CategoryName, Verbosity, Seconds, Format, ...) \
+  do { \
+    static double CarlaLogNextTime = 0.0; \
+    static uint32 CarlaLogSuppressed = 0u; \
+    const double CarlaLogNow = FPlatformTime::Seconds(); \
+    if (CarlaLogNow >= CarlaLogNextTime) { \
+      CarlaLogNextTime = CarlaLogNow + (Seconds); \
+      if (CarlaLogSuppressed > 0u) { \
+        UE_LOG(CategoryName, Verbosity, Format TEXT(" (%u similar messages suppressed)"), ##__VA_ARGS__, CarlaLogSuppressed); \
+        CarlaLogSuppressed = 0u; \
+      } else { \
+        UE_LOG(CategoryName, Verbosity, Format, ##__VA_ARGS__); \
+      } \
+    } else { \
+      ++CarlaLogSuppressed; \
+    } \
+  } while (0)
+
 class FCarlaModule : public IModuleInterface
 {
 public:
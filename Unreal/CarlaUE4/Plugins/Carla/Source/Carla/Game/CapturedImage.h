@@ -6,12 +6,14 @@
 
 #pragma once
 
+#include "CapturedImagePool.h"
 #include "Settings/PostProcessEffect.h"
 #include "CapturedImage.generated.h"
 
 /// Bitmap and meta info of a scene capture.
 ///
-/// The bitmap may be empty if the capture failed.
+/// The bitmap lives in a slab of a FCapturedImagePool, it may be missing if
+/// the capture failed.
 USTRUCT()
 struct FCapturedImage
 {
@@ -26,6 +28,35 @@ struct FCapturedImage
   UPROPERTY(VisibleAnywhere)
   EPostProcessEffect PostProcessEffect = EPostProcessEffect::INVALID;
 
+  /// Whether the server should compress the image before sending it.
   UPROPERTY(VisibleAnywhere)
-  TArray<FColor> BitMap;
+  bool bCompress = false;
+
+  /// Frame (GFrameCounter) at which the image was captured, zero if there is
+  /// no image available yet.
+  uint64 FrameNumber = 0u;
+
+  /// Game time-stamp of the frame the image was captured.
+  UPROPERTY(VisibleAnywhere)
+  int32 GameTimeStamp = 0;
+
+  /// Time-stamp (see CarlaServer::GetTimestamp) at which the bitmap was read
+  /// back from the GPU, zero if it was not.
+  uint64 ReadbackTimestamp = 0u;
+
+  TRefCountPtr<FCapturedImageSlab> Slab;
+
+  FCapturedImageKey GetKey() const
+  {
+    FCapturedImageKey Key;
+    Key.SizeX = SizeX;
+    Key.SizeY = SizeY;
+    Key.PostProcessEffect = PostProcessEffect;
+    return Key;
+  }
+
+  bool HasBitMap() const
+  {
+    return Slab.IsValid() && (Slab->BitMap.Num() > 0);
+  }
 };
@@ -0,0 +1,84 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "CapturedImagePool.h"
+
+// =============================================================================
+// -- FCapturedImageSlab -------------------------------------------------------
+// =============================================================================
+
+FCapturedImageSlab::FCapturedImageSlab(const FCapturedImageKey &InKey) :
+  Key(InKey)
+{
+  BitMap.SetNumUninitialized(Key.SizeX * Key.SizeY);
+}
+
+uint32 FCapturedImageSlab::AddRef()
+{
+  return RefCount.Increment();
+}
+
+uint32 FCapturedImageSlab::Release()
+{
+  const int32 Refs = RefCount.Decrement();
+  check(Refs >= 0);
+  if (Refs == 0) {
+    // Nobody else is referencing this slab, we can safely move the pool out
+    // of it. The pool may be destroyed at the end of this scope, so the slab
+    // must not be touched after returning it.
+    auto Owner = MoveTemp(Pool);
+    check(Owner.IsValid());
+    Owner->Return(*this);
+  }
+  return Refs;
+}
+
+// =============================================================================
+// -- FCapturedImagePool -------------------------------------------------------
+// =============================================================================
+
+void FCapturedImagePool::Reserve(const FCapturedImageKey &Key, const uint32 Count)
+{
+  FScopeLock Lock(&Mutex);
+  auto &FreeList = FreeSlabs.FindOrAdd(Key);
+  for (auto i = 0u; i < Count; ++i) {
+    FreeList.Add(&AllocateSlab(Key));
+  }
+}
+
+TRefCountPtr<FCapturedImageSlab> FCapturedImagePool::Acquire(const FCapturedImageKey &Key)
+{
+  FCapturedImageSlab *Slab = nullptr;
+  {
+    FScopeLock Lock(&Mutex);
+    auto &FreeList = FreeSlabs.FindOrAdd(Key);
+    if (FreeList.Num() > 0) {
+      Slab = FreeList.Pop(false);
+      Hits.Increment();
+    } else {
+      Slab = &AllocateSlab(Key);
+      Misses.Increment();
+    }
+  }
+  check(Slab != nullptr);
+  check(Slab->RefCount.GetValue() == 0);
+  Slab->Pool = AsShared();
+  return TRefCountPtr<FCapturedImageSlab>(Slab);
+}
+
+FCapturedImageSlab &FCapturedImagePool::AllocateSlab(const FCapturedImageKey &Key)
+{
+  // Must be called with the mutex locked.
+  Slabs.Emplace(new FCapturedImageSlab(Key));
+  return *Slabs.Last();
+}
+
+void FCapturedImagePool::Return(FCapturedImageSlab &Slab)
+{
+  FScopeLock Lock(&Mutex);
+  FreeSlabs.FindOrAdd(Slab.GetKey()).Add(&Slab);
+}
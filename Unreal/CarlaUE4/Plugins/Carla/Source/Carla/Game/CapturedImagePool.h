@@ -0,0 +1,119 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "Settings/PostProcessEffect.h"
+#include "Util/NonCopyable.h"
+
+class FCapturedImagePool;
+
+/// Identifies the kind of images a slab can hold.
+struct FCapturedImageKey
+{
+  uint32 SizeX = 0u;
+
+  uint32 SizeY = 0u;
+
+  EPostProcessEffect PostProcessEffect = EPostProcessEffect::INVALID;
+
+  bool operator==(const FCapturedImageKey &Other) const
+  {
+    return (SizeX == Other.SizeX) &&
+           (SizeY == Other.SizeY) &&
+           (PostProcessEffect == Other.PostProcessEffect);
+  }
+
+  friend uint32 GetTypeHash(const FCapturedImageKey &Key)
+  {
+    return HashCombine(
+        HashCombine(GetTypeHash(Key.SizeX), GetTypeHash(Key.SizeY)),
+        GetTypeHash(PostProcessEffect::ToUInt(Key.PostProcessEffect)));
+  }
+};
+
+/// Pre-sized bitmap owned by a FCapturedImagePool. Slabs are ref-counted
+/// (usable with TRefCountPtr), when the last reference is released the slab
+/// goes back to the pool's free list. References may be released from any
+/// thread.
+class CARLA_API FCapturedImageSlab : private NonCopyable
+{
+public:
+
+  TArray<FColor> BitMap;
+
+  const FCapturedImageKey &GetKey() const
+  {
+    return Key;
+  }
+
+  uint32 AddRef();
+
+  uint32 Release();
+
+private:
+
+  friend class FCapturedImagePool;
+
+  explicit FCapturedImageSlab(const FCapturedImageKey &InKey);
+
+  const FCapturedImageKey Key;
+
+  FThreadSafeCounter RefCount;
+
+  /// Keeps the pool alive while the slab is in use.
+  TSharedPtr<FCapturedImagePool, ESPMode::ThreadSafe> Pool;
+};
+
+/// Per-episode pool of image bitmaps. Capture readback writes into slabs
+/// acquired from this pool, and the server returns them after the images have
+/// been sent, so steady-state ticks do not allocate memory for images.
+///
+/// Slabs are keyed by size and post-processing effect; the pool grows on a
+/// miss and never shrinks.
+class CARLA_API FCapturedImagePool
+  : public TSharedFromThis<FCapturedImagePool, ESPMode::ThreadSafe>,
+    private NonCopyable
+{
+public:
+
+  /// Pre-allocate @a Count slabs of the given @a Key.
+  void Reserve(const FCapturedImageKey &Key, uint32 Count);
+
+  /// Get a free slab of the given @a Key, a new one is allocated if there is
+  /// none available.
+  TRefCountPtr<FCapturedImageSlab> Acquire(const FCapturedImageKey &Key);
+
+  /// Number of acquisitions served by a recycled slab.
+  int32 GetNumberOfHits() const
+  {
+    return Hits.GetValue();
+  }
+
+  /// Number of acquisitions that required allocating a new slab.
+  int32 GetNumberOfMisses() const
+  {
+    return Misses.GetValue();
+  }
+
+private:
+
+  friend class FCapturedImageSlab;
+
+  FCapturedImageSlab &AllocateSlab(const FCapturedImageKey &Key);
+
+  void Return(FCapturedImageSlab &Slab);
+
+  FCriticalSection Mutex;
+
+  TArray<TUniquePtr<FCapturedImageSlab>> Slabs;
+
+  TMap<FCapturedImageKey, TArray<FCapturedImageSlab *>> FreeSlabs;
+
+  FThreadSafeCounter Hits;
+
+  FThreadSafeCounter Misses;
+};
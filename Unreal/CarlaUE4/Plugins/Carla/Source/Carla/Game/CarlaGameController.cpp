@@ -7,18 +7,26 @@
 #include "Carla.h"
 #include "CarlaGameController.h"
 
+#include "CarlaGameModeBase.h"
 #include "CarlaVehicleController.h"
 
 #include "Settings/CarlaSettings.h"
-#include "CarlaServer.h"
+#include "Util/EpisodeStartTimer.h"
+
+#include "HAL/PlatformTime.h"
 
 using Errc = CarlaServer::ErrorCode;
 
 static constexpr bool BLOCKING = true;
 static constexpr bool NON_BLOCKING = false;
 
-CarlaGameController::CarlaGameController() :
+/// While blocking on the control, the world snapshot requests are checked
+/// every slice.
+static constexpr uint32 CONTROL_WAIT_SLICE_MS = 10u;
+
+CarlaGameController::CarlaGameController(FEpisodeStartTimer &InEpisodeStartTimer) :
   Server(nullptr),
+  EpisodeStartTimer(InEpisodeStartTimer),
   Player(nullptr) {}
 
 CarlaGameController::~CarlaGameController() {}
@@ -29,11 +37,15 @@ void CarlaGameController::Initialize(UCarlaSettings &InCarlaSettings)
 
   // Initialize server if missing.
   if (Server == nullptr) {
+    CarlaServer::ConfigureThreads(CarlaSettings->ServerThreads, CarlaSettings->ServerThreadsAffinity);
+    CarlaServer::ConfigureProfiler(*CarlaSettings);
     Server = MakeUnique<CarlaServer>(CarlaSettings->WorldPort, CarlaSettings->ServerTimeOut);
     if ((Errc::Success != Server->Connect()) ||
         (Errc::Success != Server->ReadNewEpisode(*CarlaSettings, BLOCKING))) {
       UE_LOG(LogCarlaServer, Warning, TEXT("Failed to initialize, server needs restart"));
       Server = nullptr;
+    } else {
+      EpisodeStartTimer.Start();
     }
   }
 }
@@ -42,6 +54,7 @@ APlayerStart *CarlaGameController::ChoosePlayerStart(
     const TArray<APlayerStart *> &AvailableStartSpots)
 {
   check(AvailableStartSpots.Num() > 0);
+  FEpisodeStartTimer::FScopedPhase Phase(&EpisodeStartTimer, "ChoosePlayerStart");
   // Send scene description.
   if (Server != nullptr) {
     if (Errc::Success != Server->SendSceneDescription(AvailableStartSpots, BLOCKING)) {
@@ -78,8 +91,10 @@ void CarlaGameController::BeginPlay()
   check(Player != nullptr);
   GameState = Cast<ACarlaGameState>(Player->GetWorld()->GetGameState());
   check(GameState != nullptr);
+  EpisodeStartTimer.Stop();
   if (Server != nullptr) {
-    if (Errc::Success != Server->SendEpisodeReady(BLOCKING)) {
+    check(CarlaSettings != nullptr);
+    if (Errc::Success != Server->SendEpisodeReady(*CarlaSettings, EpisodeStartTimer, BLOCKING)) {
       UE_LOG(LogCarlaServer, Warning, TEXT("Failed to read episode start, server needs restart"));
       Server = nullptr;
     }
@@ -91,6 +106,8 @@ void CarlaGameController::Tick(float DeltaSeconds)
   check(Player != nullptr);
   check(CarlaSettings != nullptr);
 
+  const uint64 TickTimestamp = CarlaServer::GetTimestamp();
+
   if (Server == nullptr) {
     UE_LOG(LogCarlaServer, Warning, TEXT("Client disconnected, server needs restart"));
     RestartLevel();
@@ -102,7 +119,8 @@ void CarlaGameController::Tick(float DeltaSeconds)
     auto ec = Server->ReadNewEpisode(*CarlaSettings, NON_BLOCKING);
     switch (ec) {
       case Errc::Success:
-        RestartLevel();
+        EpisodeStartTimer.Start();
+        RestartEpisode();
         return;
       case Errc::Error:
         Server = nullptr;
@@ -112,30 +130,110 @@ void CarlaGameController::Tick(float DeltaSeconds)
     }
   }
 
+  // Check if the client requested to save or restore the world.
+  {
+    bool bRestored;
+    if (Errc::Error == ServeWorldSnapshotRequest(bRestored)) {
+      Server = nullptr;
+      return;
+    }
+  }
+
   // Send measurements.
+  bool bMeasurementsSent = false;
   {
     check(GameState != nullptr);
-    if (Errc::Error == Server->SendMeasurements(
-            *GameState,
-            Player->GetPlayerState(),
-            CarlaSettings->bSendNonPlayerAgentsInfo)) {
+    auto ec = Server->SendMeasurements(
+        *GameState,
+        Player->GetPlayerState(),
+        CarlaSettings->bSendNonPlayerAgentsInfo,
+        TickTimestamp);
+    if (Errc::Error == ec) {
       Server = nullptr;
       return;
     }
+    bMeasurementsSent = (Errc::Success == ec);
   }
 
-  // Read control, block if the settings say so.
+  // Read control, block if the settings say so. The client only replies to
+  // measurements, so don't block if none were sent this frame. With control
+  // lookahead the control read is the reply to a frame sent earlier, the
+  // server blocks only if it did not arrive yet.
   {
-    const bool bShouldBlock = CarlaSettings->bSynchronousMode;
-    if (Errc::Error == Server->ReadControl(*Player, bShouldBlock)) {
+    const bool bShouldBlock = CarlaSettings->bSynchronousMode && bMeasurementsSent;
+    if (Errc::Error == ReadControl(bShouldBlock)) {
       Server = nullptr;
       return;
     }
   }
 }
 
+void CarlaGameController::RestartEpisode()
+{
+  auto *GameMode = Cast<ACarlaGameModeBase>(Player->GetWorld()->GetAuthGameMode());
+  if ((GameMode != nullptr) && GameMode->CanResetEpisodeInPlace()) {
+    GameMode->ResetEpisodeInPlace();
+  } else {
+    RestartLevel();
+  }
+}
+
 void CarlaGameController::RestartLevel()
 {
   UE_LOG(LogCarlaServer, Log, TEXT("Restarting the level..."));
+  // Ends in the InitGame of the new level.
+  EpisodeStartTimer.BeginPhase("LoadLevel");
   Player->RestartLevel();
 }
+
+CarlaServer::ErrorCode CarlaGameController::ServeWorldSnapshotRequest(bool &bRestored)
+{
+  bRestored = false;
+  bool bRestore;
+  TArray<uint8> Snapshot;
+  auto ec = Server->ReadWorldSnapshotRequest(bRestore, Snapshot, NON_BLOCKING);
+  if (Errc::Success != ec) {
+    return ec;
+  }
+  auto *GameMode = Cast<ACarlaGameModeBase>(Player->GetWorld()->GetAuthGameMode());
+  bool bSuccess = false;
+  if (GameMode == nullptr) {
+    UE_LOG(LogCarlaServer, Error, TEXT("World snapshots are not supported by this game mode"));
+  } else if (bRestore) {
+    bSuccess = bRestored = GameMode->RestoreWorldSnapshot(Snapshot);
+    Snapshot.Empty();
+  } else {
+    bSuccess = GameMode->SaveWorldSnapshot(Snapshot);
+  }
+  return Server->SendWorldSnapshot(bSuccess, Snapshot, BLOCKING);
+}
+
+CarlaServer::ErrorCode CarlaGameController::ReadControl(const bool bBlocking)
+{
+  if (!bBlocking) {
+    return Server->ReadControl(*Player, NON_BLOCKING);
+  }
+  // In synchronous mode the client may save or restore the world instead of
+  // replying with a control, so wait in slices serving those requests.
+  const double Start = FPlatformTime::Seconds();
+  for (;;) {
+    auto ec = Server->TryReadControl(*Player, CONTROL_WAIT_SLICE_MS);
+    if (Errc::TryAgain != ec) {
+      return ec;
+    }
+    bool bRestored;
+    ec = ServeWorldSnapshotRequest(bRestored);
+    if (Errc::Error == ec) {
+      return ec;
+    }
+    if (bRestored) {
+      // The frame we were waiting for does not exist anymore.
+      return Errc::TryAgain;
+    }
+    const double ElapsedMs = 1e3 * (FPlatformTime::Seconds() - Start);
+    if (ElapsedMs >= CarlaSettings->ServerTimeOut) {
+      CARLA_LOG_RATE_LIMITED(LogCarlaServer, Warning, 1.0, TEXT("No control received from the client this frame!"));
+      return Errc::TryAgain;
+    }
+  }
+}
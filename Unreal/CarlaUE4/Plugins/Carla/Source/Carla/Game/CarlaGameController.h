@@ -8,16 +8,20 @@
 
 #include "CarlaGameControllerBase.h"
 
+#include "CarlaServer.h"
+
 class ACarlaGameState;
+class FEpisodeStartTimer;
 class ACarlaVehicleController;
-class CarlaServer;
 
 /// Implements remote control of game and player.
 class CARLA_API CarlaGameController : public CarlaGameControllerBase
 {
 public:
 
-  explicit CarlaGameController();
+  /// @a EpisodeStartTimer is started on every new episode request, and
+  /// reported to the client with the EpisodeReady.
+  explicit CarlaGameController(FEpisodeStartTimer &EpisodeStartTimer);
 
   ~CarlaGameController();
 
@@ -33,10 +37,25 @@ public:
 
 private:
 
+  /// Start the episode requested in the level already loaded if the settings
+  /// allow it, otherwise reload the level.
+  void RestartEpisode();
+
   void RestartLevel();
 
+  /// Save or restore the world if the client requested it, @a bRestored is
+  /// set if the world was restored.
+  CarlaServer::ErrorCode ServeWorldSnapshotRequest(bool &bRestored);
+
+  /// Read the control of the player. While blocking, the world snapshot
+  /// requests that arrive in the meantime are served too; restoring the world
+  /// stops waiting for the control.
+  CarlaServer::ErrorCode ReadControl(bool bBlocking);
+
   TUniquePtr<CarlaServer> Server;
 
+  FEpisodeStartTimer &EpisodeStartTimer;
+
   ACarlaVehicleController *Player = nullptr;
 
   const ACarlaGameState *GameState = nullptr;
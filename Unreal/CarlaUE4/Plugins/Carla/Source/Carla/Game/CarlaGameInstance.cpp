@@ -25,10 +25,17 @@ void UCarlaGameInstance::InitializeGameControllerIfNotPresent(
 {
   if (GameController == nullptr) {
     if (CarlaSettings->bUseNetworking) {
-      GameController = MakeUnique<CarlaGameController>();
+      GameController = MakeUnique<CarlaGameController>(EpisodeStartTimer);
     } else {
       GameController = MakeUnique<MockGameController>(MockControllerSettings);
       UE_LOG(LogCarla, Log, TEXT("Using mock CARLA controller"));
     }
   }
 }
+
+FEpisodeStartTimer *UCarlaGameInstance::FindEpisodeStartTimer(const UObject *WorldContextObject)
+{
+  auto *World = (WorldContextObject != nullptr ? WorldContextObject->GetWorld() : nullptr);
+  auto *GameInstance = (World != nullptr ? Cast<UCarlaGameInstance>(World->GetGameInstance()) : nullptr);
+  return (GameInstance != nullptr ? &GameInstance->EpisodeStartTimer : nullptr);
+}
@@ -8,6 +8,7 @@
 
 #include "Engine/GameInstance.h"
 #include "CarlaGameControllerBase.h"
+#include "Util/EpisodeStartTimer.h"
 #include "CarlaGameInstance.generated.h"
 
 class UCarlaSettings;
@@ -47,6 +48,15 @@ public:
     return *CarlaSettings;
   }
 
+  FEpisodeStartTimer &GetEpisodeStartTimer()
+  {
+    return EpisodeStartTimer;
+  }
+
+  /// The episode start timer of the game instance of @a WorldContextObject,
+  /// if any.
+  static FEpisodeStartTimer *FindEpisodeStartTimer(const UObject *WorldContextObject);
+
   // Extra overload just for blueprints.
   UFUNCTION(BlueprintCallable)
   UCarlaSettings *GetCARLASettings()
@@ -60,4 +70,6 @@ private:
   UCarlaSettings *CarlaSettings;
 
   TUniquePtr<CarlaGameControllerBase> GameController;
+
+  FEpisodeStartTimer EpisodeStartTimer;
 };
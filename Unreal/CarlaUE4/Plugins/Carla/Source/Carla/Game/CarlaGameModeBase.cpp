@@ -12,15 +12,111 @@
 #include "EngineUtils.h"
 #include "GameFramework/PlayerStart.h"
 #include "SceneViewport.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
 
+#include "AI/TrafficLightBase.h"
+#include "AI/WheeledVehicleAIController.h"
 #include "CarlaGameInstance.h"
 #include "CarlaGameState.h"
 #include "CarlaHUD.h"
 #include "CarlaPlayerState.h"
 #include "CarlaVehicleController.h"
+#include "CarlaWheeledVehicle.h"
 #include "Settings/CarlaSettings.h"
 #include "Tagger.h"
 #include "TaggerDelegate.h"
+#include "Util/EpisodeStartTimer.h"
+#include "Util/RandomEngine.h"
+
+// =============================================================================
+// -- Static local methods -----------------------------------------------------
+// =============================================================================
+
+static const FCameraPostProcessParameters *GetOverridePostProcessParameters(
+    const UCarlaSettings &Settings)
+{
+  const auto *Weather = Settings.GetActiveWeatherDescription();
+  if ((Weather != nullptr) && (Weather->bOverrideCameraPostProcessParameters)) {
+    return &Weather->CameraPostProcessParameters;
+  }
+  return nullptr;
+}
+
+static bool AreEqual(const FCameraDescription &Lhs, const FCameraDescription &Rhs)
+{
+  return
+      (Lhs.ImageSizeX == Rhs.ImageSizeX) &&
+      (Lhs.ImageSizeY == Rhs.ImageSizeY) &&
+      (Lhs.Position == Rhs.Position) &&
+      (Lhs.Rotation == Rhs.Rotation) &&
+      (Lhs.PostProcessEffect == Rhs.PostProcessEffect) &&
+      (Lhs.FOVAngle == Rhs.FOVAngle) &&
+      (Lhs.bCompressImages == Rhs.bCompressImages);
+}
+
+/// The order matters, it is the order of the images sent.
+static bool AreEqual(
+    const TMap<FString, FCameraDescription> &Lhs,
+    const TMap<FString, FCameraDescription> &Rhs)
+{
+  if (Lhs.Num() != Rhs.Num()) {
+    return false;
+  }
+  auto RhsIt = Rhs.CreateConstIterator();
+  for (const auto &Item : Lhs) {
+    if ((Item.Key != RhsIt->Key) || !AreEqual(Item.Value, RhsIt->Value)) {
+      return false;
+    }
+    ++RhsIt;
+  }
+  return true;
+}
+
+static constexpr uint32 WORLD_SNAPSHOT_MAGIC = 0x57534E50u;
+
+static constexpr uint32 WORLD_SNAPSHOT_VERSION = 2u;
+
+/// The player first, then the vehicles in the order they were spawned. Null
+/// for the vehicles destroyed.
+static TArray<AWheeledVehicleAIController *> GetVehicleControllers(
+    AWheeledVehicleAIController *Player,
+    const AVehicleSpawnerBase *VehicleSpawner)
+{
+  TArray<AWheeledVehicleAIController *> Controllers;
+  Controllers.Add(Player);
+  if (VehicleSpawner != nullptr) {
+    for (auto *Vehicle : VehicleSpawner->GetVehicles()) {
+      auto *Controller = (IsValid(Vehicle) ? Vehicle->GetController() : nullptr);
+      Controllers.Add(Cast<AWheeledVehicleAIController>(Controller));
+    }
+  }
+  return Controllers;
+}
+
+static bool IsPossessingAVehicle(const AWheeledVehicleAIController *Controller)
+{
+  return IsValid(Controller) && Controller->IsPossessingAVehicle();
+}
+
+static bool IsValidTrafficLightState(const uint8 State)
+{
+  return State <= static_cast<uint8>(ETrafficLightState::Green);
+}
+
+/// In the order they were loaded, the same for every episode of the level.
+static TArray<ATrafficLightBase *> GetTrafficLights(UWorld *World)
+{
+  TArray<ATrafficLightBase *> TrafficLights;
+  for (TActorIterator<ATrafficLightBase> It(World); It; ++It) {
+    TrafficLights.Add(*It);
+  }
+  return TrafficLights;
+}
+
+// =============================================================================
+// -- ACarlaGameModeBase -------------------------------------------------------
+// =============================================================================
 
 ACarlaGameModeBase::ACarlaGameModeBase(const FObjectInitializer& ObjectInitializer) :
   Super(ObjectInitializer),
@@ -51,6 +147,10 @@ void ACarlaGameModeBase::InitGame(
       GameInstance != nullptr,
       TEXT("GameInstance is not a UCarlaGameInstance, did you forget to set it in the project settings?"));
 
+  auto &EpisodeStartTimer = GameInstance->GetEpisodeStartTimer();
+  EpisodeStartTimer.EndPhase("LoadLevel");
+  FEpisodeStartTimer::FScopedPhase Phase(&EpisodeStartTimer, "InitGame");
+
   GameInstance->InitializeGameControllerIfNotPresent(MockGameControllerSettings);
   GameController = &GameInstance->GetGameController();
   auto &CarlaSettings = GameInstance->GetCarlaSettings();
@@ -75,6 +175,9 @@ void ACarlaGameModeBase::InitGame(
     CarlaSettings.LogSettings();
   }
 
+  LevelPlayerVehicle = CarlaSettings.PlayerVehicle;
+  bLevelUsesSpatialIndexForAI = CarlaSettings.bUseSpatialIndexForAI;
+
   // Set default pawn class.
   if (!CarlaSettings.PlayerVehicle.IsEmpty()) {
     auto Class = FindObject<UClass>(ANY_PACKAGE, *CarlaSettings.PlayerVehicle);
@@ -114,10 +217,14 @@ void ACarlaGameModeBase::RestartPlayer(AController* NewPlayer)
     RegisterPlayer(*NewPlayer);
     return;
   } else if (UnOccupiedStartPoints.Num() > 0u) {
+    PlayerStartSpots = UnOccupiedStartPoints;
     check(GameController != nullptr);
     APlayerStart *StartSpot = GameController->ChoosePlayerStart(UnOccupiedStartPoints);
     if (StartSpot != nullptr) {
-      RestartPlayerAtPlayerStart(NewPlayer, StartSpot);
+      {
+        FEpisodeStartTimer::FScopedPhase Phase(&GameInstance->GetEpisodeStartTimer(), "SpawnPlayer");
+        RestartPlayerAtPlayerStart(NewPlayer, StartSpot);
+      }
       RegisterPlayer(*NewPlayer);
       return;
     }
@@ -145,20 +252,9 @@ void ACarlaGameModeBase::BeginPlay()
   // Setup semantic segmentation if necessary.
   if (CarlaSettings.bSemanticSegmentationEnabled) {
     TagActorsForSemanticSegmentation();
-    TaggerDelegate->SetSemanticSegmentationEnabled();
   }
 
-  // Change weather.
-  if (DynamicWeather != nullptr) {
-    const auto *Weather = CarlaSettings.GetActiveWeatherDescription();
-    if (Weather != nullptr) {
-      UE_LOG(LogCarla, Log, TEXT("Changing weather settings to \"%s\""), *Weather->Name);
-      DynamicWeather->SetWeatherDescription(*Weather);
-      DynamicWeather->RefreshWeather();
-    }
-  } else {
-    UE_LOG(LogCarla, Error, TEXT("Missing dynamic weather actor!"));
-  }
+  ChangeWeather();
 
   // Find road map.
   TActorIterator<ACityMapGenerator> It(GetWorld());
@@ -170,10 +266,9 @@ void ACarlaGameModeBase::BeginPlay()
     UE_LOG(LogCarla, Error, TEXT("Player controller is not a AWheeledVehicleAIController!"));
   }
 
-  // Setup other vehicles.
+  // Setup other vehicles and walkers.
+  ConfigureSpawners();
   if (VehicleSpawner != nullptr) {
-    VehicleSpawner->SetNumberOfVehicles(CarlaSettings.NumberOfVehicles);
-    VehicleSpawner->SetSeed(CarlaSettings.SeedVehicles);
     VehicleSpawner->SetRoadMap(RoadMap);
     if (PlayerController != nullptr) {
       PlayerController->SetRandomEngine(VehicleSpawner->GetRandomEngine());
@@ -181,24 +276,272 @@ void ACarlaGameModeBase::BeginPlay()
   } else {
     UE_LOG(LogCarla, Error, TEXT("Missing vehicle spawner actor!"));
   }
-
-  // Setup walkers.
-  if (WalkerSpawner != nullptr) {
-    WalkerSpawner->SetNumberOfWalkers(CarlaSettings.NumberOfPedestrians);
-    WalkerSpawner->SetSeed(CarlaSettings.SeedPedestrians);
-  } else {
+  if (WalkerSpawner == nullptr) {
     UE_LOG(LogCarla, Error, TEXT("Missing walker spawner actor!"));
   }
 
-  GameController->BeginPlay();
+  // The spawners queue their agents at begin play, see Tick.
+  bEpisodeReadyPending = true;
 }
 
 void ACarlaGameModeBase::Tick(float DeltaSeconds)
 {
   Super::Tick(DeltaSeconds);
+
+  const auto *CarlaGameState = GetGameState<ACarlaGameState>();
+  check(CarlaGameState != nullptr);
+  SpawnScheduler.Tick(*CarlaGameState, VehicleSpawner, WalkerSpawner);
+  if (bEpisodeReadyPending) {
+    // Hold the EpisodeReady, the client starts with every agent in place.
+    if (!SpawnScheduler.IsPopulating()) {
+      bEpisodeReadyPending = false;
+      GameController->BeginPlay();
+    }
+    return;
+  }
+
   GameController->Tick(DeltaSeconds);
 }
 
+bool ACarlaGameModeBase::CanResetEpisodeInPlace() const
+{
+  const auto &CarlaSettings = GameInstance->GetCarlaSettings();
+  if (!CarlaSettings.bResetInPlace) {
+    return false;
+  }
+  if ((PlayerController == nullptr) || !PlayerController->IsPossessingAVehicle() || (PlayerStartSpots.Num() == 0)) {
+    UE_LOG(LogCarla, Warning, TEXT("Cannot reset the episode in place, the player was not spawned at a player start"));
+    return false;
+  }
+  if ((CarlaSettings.PlayerVehicle != LevelPlayerVehicle) ||
+      (CarlaSettings.bUseSpatialIndexForAI != bLevelUsesSpatialIndexForAI)) {
+    UE_LOG(LogCarla, Log, TEXT("Player vehicle or spatial index changed, the level needs reloading"));
+    return false;
+  }
+  return true;
+}
+
+void ACarlaGameModeBase::ResetEpisodeInPlace()
+{
+  check(GameController != nullptr);
+  check(PlayerController != nullptr);
+  UE_LOG(LogCarla, Log, TEXT("Starting a new episode in place..."));
+  auto &CarlaSettings = GameInstance->GetCarlaSettings();
+  GameController->Initialize(CarlaSettings);
+  CarlaSettings.ValidateWeatherId();
+  CarlaSettings.LogSettings();
+
+  auto &EpisodeStartTimer = GameInstance->GetEpisodeStartTimer();
+
+  // Clear the way before moving the player, the start spots are free in a
+  // freshly loaded level too.
+  {
+    FEpisodeStartTimer::FScopedPhase Phase(&EpisodeStartTimer, "DestroyAgents");
+    if (VehicleSpawner != nullptr) {
+      VehicleSpawner->DestroyVehicles();
+    }
+    if (WalkerSpawner != nullptr) {
+      WalkerSpawner->DestroyWalkers();
+    }
+  }
+
+  // The game controller sends the scene description and reads the episode
+  // start, as when the level restarts the player.
+  APlayerStart *StartSpot = GameController->ChoosePlayerStart(PlayerStartSpots);
+  check(StartSpot != nullptr);
+
+  if (CaptureCamerasChanged()) {
+    UE_LOG(LogCarla, Log, TEXT("Cameras changed, attaching them again"));
+    PlayerController->RemoveSceneCaptureCameras();
+    AttachCaptureCamerasToPlayer();
+  }
+  {
+    FEpisodeStartTimer::FScopedPhase Phase(&EpisodeStartTimer, "ResetPlayer");
+    PlayerController->ResetEpisode(*StartSpot);
+  }
+
+  if (CarlaSettings.bSemanticSegmentationEnabled && !bLevelTaggedForSemanticSegmentation) {
+    TagActorsForSemanticSegmentation();
+  }
+
+  if (CarlaSettings.WeatherId != AppliedWeatherId) {
+    ChangeWeather();
+  }
+
+  // Same seeds, same agents as in a freshly loaded level.
+  ConfigureSpawners();
+  if (VehicleSpawner != nullptr) {
+    VehicleSpawner->SpawnVehicles();
+  }
+  if (WalkerSpawner != nullptr) {
+    WalkerSpawner->SpawnWalkers();
+  }
+
+  bEpisodeReadyPending = true;
+}
+
+bool ACarlaGameModeBase::SaveWorldSnapshot(TArray<uint8> &Snapshot)
+{
+  if (!IsPossessingAVehicle(PlayerController)) {
+    return false;
+  }
+  Snapshot.Reset();
+  FMemoryWriter Ar(Snapshot);
+  uint32 Magic = WORLD_SNAPSHOT_MAGIC;
+  uint32 Version = WORLD_SNAPSHOT_VERSION;
+  FString LevelName = GetWorld()->GetMapName();
+  Ar << Magic << Version << LevelName;
+
+  // Which vehicles are saved goes first, so restoring fails early if one is
+  // missing.
+  const auto Controllers = GetVehicleControllers(PlayerController, VehicleSpawner);
+  TArray<bool> Saved;
+  for (auto *Controller : Controllers) {
+    Saved.Add(IsPossessingAVehicle(Controller));
+  }
+  Ar << Saved;
+  for (auto i = 0; i < Controllers.Num(); ++i) {
+    if (Saved[i]) {
+      AWheeledVehicleAIController::FSnapshot VehicleSnapshot;
+      Controllers[i]->SaveSnapshot(VehicleSnapshot);
+      Ar << VehicleSnapshot;
+    }
+  }
+  ACarlaPlayerState::FSnapshot PlayerStateSnapshot;
+  PlayerController->GetPlayerState().SaveSnapshot(PlayerStateSnapshot);
+  Ar << PlayerStateSnapshot;
+
+  // The traffic lights refer to the vehicles waiting by their index above.
+  const auto TrafficLights = GetTrafficLights(GetWorld());
+  int32 NumberOfTrafficLights = TrafficLights.Num();
+  Ar << NumberOfTrafficLights;
+  for (auto *TrafficLight : TrafficLights) {
+    uint8 State = static_cast<uint8>(TrafficLight->GetTrafficLightState());
+    TArray<int32> WaitingVehicles;
+    for (auto *Controller : TrafficLight->GetWaitingVehicles()) {
+      const int32 Index = Controllers.Find(Controller);
+      if (Index != INDEX_NONE) {
+        WaitingVehicles.Add(Index);
+      }
+    }
+    Ar << State << WaitingVehicles;
+  }
+
+  bool bHasWalkers = (WalkerSpawner != nullptr);
+  Ar << bHasWalkers;
+  if (bHasWalkers) {
+    AWalkerSpawnerBase::FSnapshot WalkersSnapshot;
+    WalkerSpawner->SaveSnapshot(WalkersSnapshot);
+    Ar << WalkersSnapshot;
+  }
+  uint32 VehiclesRandomState = (VehicleSpawner != nullptr ? VehicleSpawner->GetRandomEngine()->GetState() : 0u);
+  Ar << VehiclesRandomState;
+  UE_LOG(LogCarla, Log, TEXT("Saved world snapshot of %d bytes"), Snapshot.Num());
+  return !Ar.IsError();
+}
+
+bool ACarlaGameModeBase::RestoreWorldSnapshot(const TArray<uint8> &Snapshot)
+{
+  if (!IsPossessingAVehicle(PlayerController)) {
+    return false;
+  }
+  FMemoryReader Ar(Snapshot);
+  uint32 Magic = 0u;
+  uint32 Version = 0u;
+  Ar << Magic << Version;
+  if (Ar.IsError() || (Magic != WORLD_SNAPSHOT_MAGIC) || (Version != WORLD_SNAPSHOT_VERSION)) {
+    UE_LOG(LogCarla, Error, TEXT("Invalid world snapshot"));
+    return false;
+  }
+  FString LevelName;
+  Ar << LevelName;
+  if (LevelName != GetWorld()->GetMapName()) {
+    UE_LOG(LogCarla, Error, TEXT("World snapshot saved in another level (%s)"), *LevelName);
+    return false;
+  }
+
+  // Read and validate the whole snapshot before changing anything, the bytes
+  // come from the client.
+  const auto Controllers = GetVehicleControllers(PlayerController, VehicleSpawner);
+  TArray<bool> Saved;
+  Ar << Saved;
+  bool bVehiclesMatch = !Ar.IsError() && (Saved.Num() == Controllers.Num());
+  for (auto i = 0; bVehiclesMatch && (i < Saved.Num()); ++i) {
+    bVehiclesMatch = !Saved[i] || IsPossessingAVehicle(Controllers[i]);
+  }
+  if (!bVehiclesMatch) {
+    UE_LOG(LogCarla, Error, TEXT("World snapshot does not match the vehicles present"));
+    return false;
+  }
+  bool bIsValid = true;
+  TArray<AWheeledVehicleAIController::FSnapshot> VehicleSnapshots;
+  VehicleSnapshots.SetNum(Controllers.Num());
+  for (auto i = 0; i < Controllers.Num(); ++i) {
+    if (Saved[i]) {
+      Ar << VehicleSnapshots[i];
+      bIsValid &= IsValidTrafficLightState(VehicleSnapshots[i].TrafficLightState);
+    }
+  }
+  ACarlaPlayerState::FSnapshot PlayerStateSnapshot;
+  Ar << PlayerStateSnapshot;
+
+  const auto TrafficLights = GetTrafficLights(GetWorld());
+  int32 NumberOfTrafficLights = 0;
+  Ar << NumberOfTrafficLights;
+  bIsValid &= (NumberOfTrafficLights >= 0) && (NumberOfTrafficLights <= TrafficLights.Num());
+  TArray<uint8> TrafficLightStates;
+  TArray<TArray<AWheeledVehicleAIController *>> WaitingVehicles;
+  for (auto i = 0; bIsValid && !Ar.IsError() && (i < NumberOfTrafficLights); ++i) {
+    uint8 State = 0u;
+    TArray<int32> WaitingVehicleIndices;
+    Ar << State << WaitingVehicleIndices;
+    bIsValid &= IsValidTrafficLightState(State);
+    TrafficLightStates.Add(State);
+    TArray<AWheeledVehicleAIController *> Waiting;
+    for (auto Index : WaitingVehicleIndices) {
+      bIsValid &= Controllers.IsValidIndex(Index);
+      if (bIsValid) {
+        Waiting.Add(Controllers[Index]);
+      }
+    }
+    WaitingVehicles.Add(MoveTemp(Waiting));
+  }
+
+  bool bHasWalkers = false;
+  Ar << bHasWalkers;
+  AWalkerSpawnerBase::FSnapshot WalkersSnapshot;
+  if (bHasWalkers) {
+    Ar << WalkersSnapshot;
+  }
+  uint32 VehiclesRandomState = 0u;
+  Ar << VehiclesRandomState;
+  if (!bIsValid || Ar.IsError() || !Ar.AtEnd()) {
+    UE_LOG(LogCarla, Error, TEXT("Invalid world snapshot, nothing restored"));
+    return false;
+  }
+
+  // Apply it.
+  for (auto i = 0; i < Controllers.Num(); ++i) {
+    if (Saved[i]) {
+      Controllers[i]->RestoreSnapshot(VehicleSnapshots[i]);
+    }
+  }
+  PlayerController->GetPlayerState().RestoreSnapshot(PlayerStateSnapshot);
+  for (auto i = 0; i < NumberOfTrafficLights; ++i) {
+    TrafficLights[i]->RestoreTrafficLightState(
+        static_cast<ETrafficLightState>(TrafficLightStates[i]),
+        WaitingVehicles[i]);
+  }
+  if (bHasWalkers && (WalkerSpawner != nullptr)) {
+    WalkerSpawner->RestoreSnapshot(WalkersSnapshot);
+  }
+  if (VehicleSpawner != nullptr) {
+    VehicleSpawner->GetRandomEngine()->SetState(VehiclesRandomState);
+  }
+  UE_LOG(LogCarla, Log, TEXT("Restored world snapshot"));
+  return true;
+}
+
 void ACarlaGameModeBase::RegisterPlayer(AController &NewPlayer)
 {
   check(GameController != nullptr);
@@ -214,22 +557,69 @@ void ACarlaGameModeBase::AttachCaptureCamerasToPlayer()
     UE_LOG(LogCarla, Warning, TEXT("Trying to add capture cameras but player is not a ACarlaVehicleController"));
     return;
   }
+  FEpisodeStartTimer::FScopedPhase Phase(&GameInstance->GetEpisodeStartTimer(), "CreateCameras");
   const auto &Settings = GameInstance->GetCarlaSettings();
-  const auto *Weather = Settings.GetActiveWeatherDescription();
-  const FCameraPostProcessParameters *OverridePostProcessParameters = nullptr;
-  if ((Weather != nullptr) && (Weather->bOverrideCameraPostProcessParameters)) {
-    OverridePostProcessParameters = &Weather->CameraPostProcessParameters;
-  }
+  const auto *OverridePostProcessParameters = GetOverridePostProcessParameters(Settings);
 
   for (const auto &Item : Settings.CameraDescriptions) {
-    PlayerController->AddSceneCaptureCamera(Item.Value, OverridePostProcessParameters);
+    PlayerController->AddSceneCaptureCamera(
+        Item.Value,
+        OverridePostProcessParameters,
+        Settings.ReadbackLatency);
   }
+
+  AttachedCameraDescriptions = Settings.CameraDescriptions;
+  AttachedCamerasPostProcessParameters = OverridePostProcessParameters;
+  AttachedCamerasReadbackLatency = Settings.ReadbackLatency;
+}
+
+bool ACarlaGameModeBase::CaptureCamerasChanged() const
+{
+  const auto &Settings = GameInstance->GetCarlaSettings();
+  return
+      !AreEqual(AttachedCameraDescriptions, Settings.CameraDescriptions) ||
+      (AttachedCamerasPostProcessParameters != GetOverridePostProcessParameters(Settings)) ||
+      (AttachedCamerasReadbackLatency != Settings.ReadbackLatency);
 }
 
 void ACarlaGameModeBase::TagActorsForSemanticSegmentation()
 {
   check(GetWorld() != nullptr);
+  FEpisodeStartTimer::FScopedPhase Phase(&GameInstance->GetEpisodeStartTimer(), "TagActorsForSemanticSegmentation");
   ATagger::TagActorsInLevel(*GetWorld(), true);
+  TaggerDelegate->SetSemanticSegmentationEnabled();
+  bLevelTaggedForSemanticSegmentation = true;
+}
+
+void ACarlaGameModeBase::ChangeWeather()
+{
+  FEpisodeStartTimer::FScopedPhase Phase(&GameInstance->GetEpisodeStartTimer(), "ChangeWeather");
+  const auto &CarlaSettings = GameInstance->GetCarlaSettings();
+  if (DynamicWeather != nullptr) {
+    const auto *Weather = CarlaSettings.GetActiveWeatherDescription();
+    if (Weather != nullptr) {
+      UE_LOG(LogCarla, Log, TEXT("Changing weather settings to \"%s\""), *Weather->Name);
+      DynamicWeather->SetWeatherDescription(*Weather);
+      DynamicWeather->RefreshWeather();
+    }
+  } else {
+    UE_LOG(LogCarla, Error, TEXT("Missing dynamic weather actor!"));
+  }
+  AppliedWeatherId = CarlaSettings.WeatherId;
+}
+
+void ACarlaGameModeBase::ConfigureSpawners()
+{
+  const auto &CarlaSettings = GameInstance->GetCarlaSettings();
+  SpawnScheduler.SetBudget(CarlaSettings.SpawnBudgetPerFrame);
+  if (VehicleSpawner != nullptr) {
+    VehicleSpawner->SetNumberOfVehicles(CarlaSettings.NumberOfVehicles);
+    VehicleSpawner->SetSeed(CarlaSettings.SeedVehicles);
+  }
+  if (WalkerSpawner != nullptr) {
+    WalkerSpawner->SetNumberOfWalkers(CarlaSettings.NumberOfPedestrians);
+    WalkerSpawner->SetSeed(CarlaSettings.SeedPedestrians);
+  }
 }
 
 APlayerStart *ACarlaGameModeBase::FindUnOccupiedStartPoints(
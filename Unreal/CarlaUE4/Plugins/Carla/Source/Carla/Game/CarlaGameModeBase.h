@@ -7,17 +7,20 @@
 #pragma once
 
 #include "GameFramework/GameModeBase.h"
+#include "AI/SpawnScheduler.h"
 #include "AI/VehicleSpawnerBase.h"
 #include "AI/WalkerSpawnerBase.h"
 #include "CarlaGameControllerBase.h"
 #include "DynamicWeather.h"
 #include "MockGameControllerSettings.h"
+#include "Settings/CameraDescription.h"
 #include "CarlaGameModeBase.generated.h"
 
 class ACarlaVehicleController;
 class APlayerStart;
 class ASceneCaptureCamera;
 class UTaggerDelegate;
+struct FCameraPostProcessParameters;
 
 /**
  *
@@ -39,6 +42,27 @@ public:
 
   virtual void Tick(float DeltaSeconds) override;
 
+  /// Whether the episode requested can start in the level already loaded,
+  /// i.e. the settings allow it and nothing requiring a reload changed.
+  bool CanResetEpisodeInPlace() const;
+
+  /// Start a new episode without reloading the level. The player start is
+  /// chosen among the ones found when the level was loaded, the non-player
+  /// agents are spawned again, and the weather, cameras, and tags are changed
+  /// only if needed.
+  void ResetEpisodeInPlace();
+
+  /// Save to @a Snapshot the state of the world that changes during an
+  /// episode: the vehicles and their autopilots, the walkers, the traffic
+  /// lights, the random engines of the spawners, and the player state.
+  bool SaveWorldSnapshot(TArray<uint8> &Snapshot);
+
+  /// Restore a state saved by SaveWorldSnapshot in this level, possibly in a
+  /// previous episode with the same number of vehicles. The whole snapshot is
+  /// validated first, it fails without changing anything if it is corrupt or
+  /// does not match the vehicles present.
+  bool RestoreWorldSnapshot(const TArray<uint8> &Snapshot);
+
 protected:
 
   /** Used only when networking is disabled. */
@@ -63,8 +87,16 @@ private:
 
   void AttachCaptureCamerasToPlayer();
 
+  /// Whether the cameras attached to the player differ from the ones in the
+  /// current settings.
+  bool CaptureCamerasChanged() const;
+
   void TagActorsForSemanticSegmentation();
 
+  void ChangeWeather();
+
+  void ConfigureSpawners();
+
   /// Iterate all the APlayerStart present in the world and add the ones with
   /// unoccupied locations to @a UnOccupiedStartPoints.
   ///
@@ -92,4 +124,30 @@ private:
 
   UPROPERTY()
   AWalkerSpawnerBase *WalkerSpawner;
+
+  FSpawnScheduler SpawnScheduler;
+
+  /// The game controller is notified that the episode began once every
+  /// non-player agent is spawned.
+  bool bEpisodeReadyPending = false;
+
+  // What the level was set up with, to tell what changed on a reset in place.
+
+  UPROPERTY()
+  TArray<APlayerStart *> PlayerStartSpots;
+
+  FString LevelPlayerVehicle;
+
+  bool bLevelUsesSpatialIndexForAI = false;
+
+  bool bLevelTaggedForSemanticSegmentation = false;
+
+  int32 AppliedWeatherId = -1;
+
+  UPROPERTY()
+  TMap<FString, FCameraDescription> AttachedCameraDescriptions;
+
+  const FCameraPostProcessParameters *AttachedCamerasPostProcessParameters = nullptr;
+
+  uint32 AttachedCamerasReadbackLatency = 0u;
 };
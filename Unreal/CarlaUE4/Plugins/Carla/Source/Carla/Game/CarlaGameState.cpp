@@ -7,6 +7,12 @@
 #include "Carla.h"
 #include "CarlaGameState.h"
 
-
-
-
+const FDynamicActorsIndex &ACarlaGameState::GetDynamicActorsIndex() const
+{
+  if (DynamicActorsIndexFrame != GFrameCounter) {
+    check(GetWorld() != nullptr);
+    DynamicActorsIndex.Rebuild(*GetWorld(), VehicleSpawner, WalkerSpawner);
+    DynamicActorsIndexFrame = GFrameCounter;
+  }
+  return DynamicActorsIndex;
+}
@@ -10,6 +10,7 @@
 #include "AI/TrafficSignBase.h"
 #include "AI/VehicleSpawnerBase.h"
 #include "AI/WalkerSpawnerBase.h"
+#include "DynamicActorsIndex.h"
 #include "CarlaGameState.generated.h"
 
 UCLASS()
@@ -39,6 +40,11 @@ public:
     TrafficSigns.Add(TrafficSign);
   }
 
+  /// Spatial index of the player, vehicles, and walkers. Built on first use
+  /// each frame and shared by everyone querying it that frame, do not keep
+  /// the actors it returns beyond the current frame.
+  const FDynamicActorsIndex &GetDynamicActorsIndex() const;
+
 private:
 
   friend class ACarlaGameModeBase;
@@ -51,4 +57,8 @@ private:
 
   UPROPERTY()
   TArray<ATrafficSignBase *> TrafficSigns;
+
+  mutable FDynamicActorsIndex DynamicActorsIndex;
+
+  mutable uint64 DynamicActorsIndexFrame = TNumericLimits<uint64>::Max();
 };
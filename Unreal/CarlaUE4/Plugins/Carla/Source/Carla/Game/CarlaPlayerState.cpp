@@ -50,6 +50,32 @@ void ACarlaPlayerState::CopyProperties(APlayerState *PlayerState)
   }
 }
 
+void ACarlaPlayerState::SaveSnapshot(FSnapshot &Snapshot) const
+{
+  Snapshot.GameTimeStamp = GameTimeStamp;
+  Snapshot.Transform = Transform;
+  Snapshot.ForwardSpeed = ForwardSpeed;
+  Snapshot.Acceleration = Acceleration;
+  Snapshot.CollisionIntensityCars = CollisionIntensityCars;
+  Snapshot.CollisionIntensityPedestrians = CollisionIntensityPedestrians;
+  Snapshot.CollisionIntensityOther = CollisionIntensityOther;
+  Snapshot.OtherLaneIntersectionFactor = OtherLaneIntersectionFactor;
+  Snapshot.OffRoadIntersectionFactor = OffRoadIntersectionFactor;
+}
+
+void ACarlaPlayerState::RestoreSnapshot(const FSnapshot &Snapshot)
+{
+  GameTimeStamp = Snapshot.GameTimeStamp;
+  Transform = Snapshot.Transform;
+  ForwardSpeed = Snapshot.ForwardSpeed;
+  Acceleration = Snapshot.Acceleration;
+  CollisionIntensityCars = Snapshot.CollisionIntensityCars;
+  CollisionIntensityPedestrians = Snapshot.CollisionIntensityPedestrians;
+  CollisionIntensityOther = Snapshot.CollisionIntensityOther;
+  OtherLaneIntersectionFactor = Snapshot.OtherLaneIntersectionFactor;
+  OffRoadIntersectionFactor = Snapshot.OffRoadIntersectionFactor;
+}
+
 void ACarlaPlayerState::RegisterCollision(
     AActor * /*Actor*/,
     AActor * /*OtherActor*/,
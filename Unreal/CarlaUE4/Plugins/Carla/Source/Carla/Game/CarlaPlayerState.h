@@ -207,6 +207,47 @@ public:
   }
 
   /// @}
+  // ===========================================================================
+  // -- World snapshot ---------------------------------------------------------
+  // ===========================================================================
+public:
+
+  /// The values accumulated during the episode, the images aside, as saved
+  /// in a world snapshot (see ACarlaGameModeBase::SaveWorldSnapshot).
+  struct FSnapshot
+  {
+    int32 GameTimeStamp = 0;
+
+    FTransform Transform;
+
+    float ForwardSpeed = 0.0f;
+
+    FVector Acceleration = FVector::ZeroVector;
+
+    float CollisionIntensityCars = 0.0f;
+
+    float CollisionIntensityPedestrians = 0.0f;
+
+    float CollisionIntensityOther = 0.0f;
+
+    float OtherLaneIntersectionFactor = 0.0f;
+
+    float OffRoadIntersectionFactor = 0.0f;
+
+    friend FArchive &operator<<(FArchive &Ar, FSnapshot &Snapshot)
+    {
+      Ar << Snapshot.GameTimeStamp;
+      Ar << Snapshot.Transform << Snapshot.ForwardSpeed << Snapshot.Acceleration;
+      Ar << Snapshot.CollisionIntensityCars << Snapshot.CollisionIntensityPedestrians << Snapshot.CollisionIntensityOther;
+      Ar << Snapshot.OtherLaneIntersectionFactor << Snapshot.OffRoadIntersectionFactor;
+      return Ar;
+    }
+  };
+
+  void SaveSnapshot(FSnapshot &Snapshot) const;
+
+  void RestoreSnapshot(const FSnapshot &Snapshot);
+
   // ===========================================================================
   // -- Modifiers --------------------------------------------------------------
   // ===========================================================================
@@ -12,11 +12,28 @@
 #include "CarlaPlayerState.h"
 #include "CarlaVehicleController.h"
 #include "CarlaWheeledVehicle.h"
+#include "NonPlayerAgentsFilter.h"
 #include "SceneCaptureCamera.h"
 #include "Settings/CarlaSettings.h"
+#include "Util/EpisodeStartTimer.h"
 
 #include <carla/carla_server.h>
 
+// =============================================================================
+// -- FPendingMeasurements -----------------------------------------------------
+// =============================================================================
+
+/// Measurements of a frame, kept until the images captured that frame are
+/// read back.
+struct FPendingMeasurements
+{
+  uint64 FrameNumber = 0u;
+
+  carla_measurements Values;
+
+  TArray<carla_agent> Agents;
+};
+
 // =============================================================================
 // -- Static local methods -----------------------------------------------------
 // =============================================================================
@@ -27,6 +44,8 @@ static CarlaServer::ErrorCode ParseErrorCode(const uint32 ErrorCode)
     return CarlaServer::Success;
   } else if (ErrorCode == CARLA_SERVER_TRY_AGAIN) {
     return CarlaServer::TryAgain;
+  } else if (ErrorCode == CARLA_SERVER_NOT_DUE) {
+    return CarlaServer::NotDue;
   } else {
     return CarlaServer::Error;
   }
@@ -62,17 +81,31 @@ static inline void Set(carla_transform &lhs, const FTransform &rhs)
   Set(lhs.orientation, rhs.GetRotation().GetForwardVector());
 }
 
-static void Set(carla_image &cImage, const FCapturedImage &uImage)
+static void ReleaseImageSlab(void *Slab)
+{
+  check(Slab != nullptr);
+  static_cast<FCapturedImageSlab *>(Slab)->Release();
+}
+
+static void Set(carla_image_lease &cLease, const FCapturedImage &uImage)
 {
-  if (uImage.BitMap.Num() > 0) {
+  auto &cImage = cLease.image;
+  if (uImage.HasBitMap()) {
     cImage.width = uImage.SizeX;
     cImage.height = uImage.SizeY;
     cImage.type = PostProcessEffect::ToUInt(uImage.PostProcessEffect);
-    cImage.data = &uImage.BitMap.GetData()->DWColor();
+    cImage.data = &uImage.Slab->BitMap.GetData()->DWColor();
+    cImage.compression = (uImage.bCompress ?
+        CARLA_SERVER_IMAGE_COMPRESSION_DEFLATE :
+        CARLA_SERVER_IMAGE_COMPRESSION_NONE);
+    // The slab is kept alive until the server is done with it.
+    uImage.Slab->AddRef();
+    cLease.release = ReleaseImageSlab;
+    cLease.user_data = uImage.Slab.GetReference();
 
 #ifdef CARLA_SERVER_EXTRA_LOG
     {
-      const auto Size = uImage.BitMap.Num();
+      const auto Size = uImage.Slab->BitMap.Num();
       UE_LOG(LogCarlaServer, Log, TEXT("Sending image %dx%d (%d) type %d"), cImage.width, cImage.height, Size, cImage.type);
     }
   } else {
@@ -149,11 +182,54 @@ static void SetBoxSpeedAndType(carla_agent &values, const ATrafficSignBase *Traf
 // -- CarlaServer --------------------------------------------------------------
 // =============================================================================
 
+void CarlaServer::ConfigureThreads(const uint32 MinNumberOfThreads, const TArray<int32> &CPUs)
+{
+  TArray<uint32> CPUIndices;
+  for (int32 CPU : CPUs) {
+    CPUIndices.Add(static_cast<uint32>(CPU));
+  }
+  carla_set_server_threads(
+      MinNumberOfThreads,
+      (CPUIndices.Num() > 0 ? CPUIndices.GetData() : nullptr),
+      CPUIndices.Num());
+}
+
+void CarlaServer::ConfigureProfiler(const UCarlaSettings &Settings)
+{
+  carla_set_profiler(Settings.bProfileServer, Settings.ProfilerTraceSeconds > 0u);
+}
+
+uint64 CarlaServer::GetTimestamp()
+{
+  return carla_get_timestamp();
+}
+
+void CarlaServer::ReportProfiler(const UCarlaSettings &Settings)
+{
+  if (!Settings.bProfileServer) {
+    return;
+  }
+  carla_print_profiler_summary();
+  if (Settings.ProfilerTraceSeconds > 0u) {
+    const FString Directory = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Profiling"));
+    IFileManager::Get().MakeDirectory(*Directory, true);
+    const FString FilePath = FPaths::Combine(Directory, TEXT("CarlaServerTrace.json"));
+    const int32 ec = carla_write_profiler_trace(TCHAR_TO_UTF8(*FilePath), 1000u * Settings.ProfilerTraceSeconds);
+    if (ec == CARLA_SERVER_SUCCESS) {
+      UE_LOG(LogCarlaServer, Log, TEXT("Profiler trace written to %s"), *FilePath);
+    } else {
+      UE_LOG(LogCarlaServer, Warning, TEXT("Failed to write profiler trace to %s"), *FilePath);
+    }
+  }
+}
+
 CarlaServer::CarlaServer(const uint32 InWorldPort, const uint32 InTimeOut) :
   WorldPort(InWorldPort),
   TimeOut(InTimeOut),
-  Server(carla_make_server()) {
+  Server(carla_make_server()),
+  AgentsFilter(MakeUnique<FNonPlayerAgentsFilter>()) {
   check(Server != nullptr);
+  PendingMeasurements.SetNum(ASceneCaptureCamera::GetMaxReadbackLatency() + 1u);
 }
 
 CarlaServer::~CarlaServer()
@@ -177,6 +253,8 @@ CarlaServer::ErrorCode CarlaServer::ReadNewEpisode(UCarlaSettings &Settings, con
   if (Success == ec) {
     auto IniFile = FString(values.ini_file_length, ANSI_TO_TCHAR(values.ini_file));
     UE_LOG(LogCarlaServer, Log, TEXT("Received new episode"));
+    // The previous episode is over.
+    ReportProfiler(Settings);
 #ifdef CARLA_SERVER_EXTRA_LOG
     UE_LOG(LogCarlaServer, Log, TEXT("Received CarlaSettings.ini:\n%s"), *IniFile);
 #endif // CARLA_SERVER_EXTRA_LOG
@@ -215,17 +293,58 @@ CarlaServer::ErrorCode CarlaServer::ReadEpisodeStart(uint32 &StartPositionIndex,
   return ec;
 }
 
-CarlaServer::ErrorCode CarlaServer::SendEpisodeReady(const bool bBlocking)
+CarlaServer::ErrorCode CarlaServer::SendEpisodeReady(
+    const UCarlaSettings &Settings,
+    const FEpisodeStartTimer &EpisodeStartTimer,
+    const bool bBlocking)
 {
   UE_LOG(LogCarlaServer, Log, TEXT("Ready to play, notifying client"));
-  const carla_episode_ready values = {true};
+  EpisodeFrameNumber = GFrameCounter;
+  carla_set_stream_buffering(Server, Settings.StreamBufferDepth, Settings.bBlockWhenStreamBufferFull);
+  carla_set_control_lookahead(Server, Settings.ControlLookahead);
+  carla_set_non_player_agents_encoding(
+      Server,
+      Settings.bCompactNonPlayerAgentsInfo,
+      Settings.bQuantizeNonPlayerAgentsInfo);
+  carla_set_observers(
+      Server,
+      Settings.ObserversPort,
+      Settings.MaxObservers,
+      Settings.ObserverBufferDepth,
+      Settings.bDisconnectSlowObservers);
+  AgentsFilter->Configure(Settings);
+  const uint32 NumberOfSensorStreams = (Settings.bSeparateSensorStreams ?
+      Settings.CameraDescriptions.Num() :
+      0u);
+  const uint32 SharedMemoryCapacity = (Settings.bSharedMemoryStreams ?
+      Settings.SharedMemoryCapacity * 1024u * 1024u :
+      0u);
+  TArray<carla_episode_phase> Phases;
+  for (const auto &Phase : EpisodeStartTimer.GetPhases()) {
+    Phases.Add({Phase.Name, static_cast<float>(Phase.Milliseconds)});
+  }
+  const carla_episode_ready values = {
+      true,
+      NumberOfSensorStreams,
+      SharedMemoryCapacity,
+      Phases.GetData(),
+      static_cast<uint32_t>(Phases.Num())};
   return ParseErrorCode(carla_write_episode_ready(Server, values, GetTimeOut(TimeOut, bBlocking)));
 }
 
 CarlaServer::ErrorCode CarlaServer::ReadControl(ACarlaVehicleController &Player, const bool bBlocking)
+{
+  auto ec = TryReadControl(Player, GetTimeOut(TimeOut, bBlocking));
+  if ((!bBlocking) && (TryAgain == ec)) {
+    CARLA_LOG_RATE_LIMITED(LogCarlaServer, Warning, 1.0, TEXT("No control received from the client this frame!"));
+  }
+  return ec;
+}
+
+CarlaServer::ErrorCode CarlaServer::TryReadControl(ACarlaVehicleController &Player, const uint32 TimeOutInMilliseconds)
 {
   carla_control values;
-  auto ec = ParseErrorCode(carla_read_control(Server, values, GetTimeOut(TimeOut, bBlocking)));
+  auto ec = ParseErrorCode(carla_read_control(Server, values, TimeOutInMilliseconds));
   if (Success == ec) {
     check(Player.IsPossessingAVehicle());
     auto Vehicle = Player.GetPossessedVehicle();
@@ -239,19 +358,51 @@ CarlaServer::ErrorCode CarlaServer::ReadControl(ACarlaVehicleController &Player,
         LogCarlaServer,
         Log,
         TEXT("Read control (%s): { Steer = %f, Throttle = %f, Brake = %f, Handbrake = %s, Reverse = %s }"),
-        (bBlocking ? TEXT("Sync") : TEXT("Async")),
+        (TimeOutInMilliseconds > 0u ? TEXT("Sync") : TEXT("Async")),
         values.steer,
         values.throttle,
         values.brake,
         (values.hand_brake ? TEXT("True") : TEXT("False")),
         (values.reverse ? TEXT("True") : TEXT("False")));
 #endif // CARLA_SERVER_EXTRA_LOG
-  } else if ((!bBlocking) && (TryAgain == ec)) {
-    UE_LOG(LogCarlaServer, Warning, TEXT("No control received from the client this frame!"));
   }
   return ec;
 }
 
+CarlaServer::ErrorCode CarlaServer::ReadWorldSnapshotRequest(
+    bool &bRestore,
+    TArray<uint8> &Snapshot,
+    const bool bBlocking)
+{
+  carla_world_snapshot_request values;
+  auto ec = ParseErrorCode(carla_read_world_snapshot_request(Server, values, GetTimeOut(TimeOut, bBlocking)));
+  if (Success == ec) {
+    bRestore = bRestoreRequested = values.restore;
+    Snapshot.SetNumUninitialized(bRestore ? values.snapshot_size : 0u);
+    if (Snapshot.Num() > 0) {
+      FMemory::Memcpy(Snapshot.GetData(), values.snapshot, Snapshot.Num());
+    }
+    UE_LOG(LogCarlaServer, Log, TEXT("Received world snapshot request: %s"), (bRestore ? TEXT("Restore") : TEXT("Save")));
+  }
+  return ec;
+}
+
+CarlaServer::ErrorCode CarlaServer::SendWorldSnapshot(
+    const bool bSuccess,
+    const TArray<uint8> &Snapshot,
+    const bool bBlocking)
+{
+  if (bSuccess && bRestoreRequested) {
+    // The images in flight show the world before restoring.
+    EpisodeFrameNumber = GFrameCounter + 1u;
+  }
+  carla_world_snapshot values;
+  values.success = bSuccess;
+  values.snapshot = reinterpret_cast<const char *>(Snapshot.GetData());
+  values.snapshot_size = Snapshot.Num();
+  return ParseErrorCode(carla_write_world_snapshot(Server, values, GetTimeOut(TimeOut, bBlocking)));
+}
+
 template <typename T>
 static void AddAgents(TArray<carla_agent> &Agents, const TArray<T> &Actors)
 {
@@ -267,9 +418,23 @@ static void AddAgents(TArray<carla_agent> &Agents, const TArray<T> &Actors)
 }
 
 static void GetAgentInfo(
+    FNonPlayerAgentsFilter &Filter,
     const ACarlaGameState &GameState,
+    const FTransform &PlayerTransform,
     TArray<carla_agent> &Agents)
 {
+  if (Filter.IsEnabled()) {
+    Filter.Update(GameState, PlayerTransform);
+    Agents.Reserve(
+        Filter.GetTrafficSigns().Num() +
+        Filter.GetWalkers().Num() +
+        Filter.GetVehicles().Num());
+    AddAgents(Agents, Filter.GetTrafficSigns());
+    AddAgents(Agents, Filter.GetWalkers());
+    AddAgents(Agents, Filter.GetVehicles());
+    return;
+  }
+
   const auto *WalkerSpawner = GameState.GetWalkerSpawner();
   const auto *VehicleSpawner = GameState.GetVehicleSpawner();
   const auto &TrafficSigns = GameState.GetTrafficSigns();
@@ -296,10 +461,16 @@ static void GetAgentInfo(
 CarlaServer::ErrorCode CarlaServer::SendMeasurements(
     const ACarlaGameState &GameState,
     const ACarlaPlayerState &PlayerState,
-    const bool bSendNonPlayerAgentsInfo)
+    const bool bSendNonPlayerAgentsInfo,
+    const uint64 TickTimestamp)
 {
   // Measurements.
-  carla_measurements values;
+  const uint64 FrameNumber = GFrameCounter;
+  auto &Current = PendingMeasurements[FrameNumber % PendingMeasurements.Num()];
+  Current.FrameNumber = FrameNumber;
+  auto &values = Current.Values;
+  values.tick_timestamp = TickTimestamp;
+  values.readback_timestamp = 0u;
   values.platform_timestamp = PlayerState.GetPlatformTimeStamp();
   values.game_timestamp = PlayerState.GetGameTimeStamp();
   auto &player = values.player_measurements;
@@ -317,26 +488,49 @@ CarlaServer::ErrorCode CarlaServer::SendMeasurements(
   Set(player.autopilot_control.hand_brake, PlayerState.GetHandBrake());
   Set(player.autopilot_control.reverse, PlayerState.GetCurrentGear() < 0);
 
-  TArray<carla_agent> Agents;
+  auto &Agents = Current.Agents;
+  Agents.Reset();
   if (bSendNonPlayerAgentsInfo) {
-    GetAgentInfo(GameState, Agents);
+    GetAgentInfo(*AgentsFilter, GameState, PlayerState.GetTransform(), Agents);
   }
   values.non_player_agents = (Agents.Num() > 0 ? Agents.GetData() : nullptr);
   values.number_of_non_player_agents = Agents.Num();
 
+  // Images, all of them are captured the same frame, but this may be a few
+  // frames ago if read back asynchronously.
+  const auto NumberOfImages = PlayerState.GetNumberOfImages();
+  FPendingMeasurements *Pending = &Current;
+  if (NumberOfImages > 0) {
+    const uint64 ImagesFrameNumber = PlayerState.GetImages()[0].FrameNumber;
+    Pending = &PendingMeasurements[ImagesFrameNumber % PendingMeasurements.Num()];
+    if ((ImagesFrameNumber < EpisodeFrameNumber) ||
+        (ImagesFrameNumber == 0u) ||
+        (Pending->FrameNumber != ImagesFrameNumber)) {
+      // Images not ready yet.
+      return TryAgain;
+    }
+    // The last image read back completes the frame.
+    for (const auto &Image : PlayerState.GetImages()) {
+      Pending->Values.readback_timestamp = FMath::Max(Pending->Values.readback_timestamp, Image.ReadbackTimestamp);
+    }
+  }
+
 #ifdef CARLA_SERVER_EXTRA_LOG
-  UE_LOG(LogCarlaServer, Log, TEXT("Sending data of %d agents"), values.number_of_non_player_agents);
+  UE_LOG(LogCarlaServer, Log, TEXT("Sending data of %d agents"), Pending->Values.number_of_non_player_agents);
 #endif // CARLA_SERVER_EXTRA_LOG
 
-  // Images.
-  const auto NumberOfImages = PlayerState.GetNumberOfImages();
-  TUniquePtr<carla_image[]> images;
+  Images.Reset();
   if (NumberOfImages > 0) {
-    images = MakeUnique<carla_image[]>(NumberOfImages);
+    Images.AddZeroed(NumberOfImages);
     for (auto i = 0; i < NumberOfImages; ++i) {
-      Set(images[i], PlayerState.GetImages()[i]);
+      check(PlayerState.GetImages()[i].FrameNumber == Pending->FrameNumber);
+      Set(Images[i], PlayerState.GetImages()[i]);
     }
   }
 
-  return ParseErrorCode(carla_write_measurements(Server, values, images.Get(), NumberOfImages));
+  return ParseErrorCode(carla_write_measurements_zero_copy(
+      Server,
+      Pending->Values,
+      (NumberOfImages > 0 ? Images.GetData() : nullptr),
+      NumberOfImages));
 }
@@ -9,7 +9,11 @@
 class ACarlaGameState;
 class ACarlaVehicleController;
 class APlayerStart;
+class FEpisodeStartTimer;
 class UCarlaSettings;
+struct carla_image_lease;
+class FNonPlayerAgentsFilter;
+struct FPendingMeasurements;
 
 /// Wrapper around carla_server API.
 class CARLA_API CarlaServer
@@ -19,9 +23,27 @@ public:
   enum ErrorCode {
     Success,
     TryAgain,
+    /// Nothing is due yet, waiting would not help (see TryReadControl).
+    NotDue,
     Error
   };
 
+  /// Configure the networking threads, shared by every server of the process
+  /// and kept alive between episodes. Call it before creating the server.
+  static void ConfigureThreads(uint32 MinNumberOfThreads, const TArray<int32> &CPUs);
+
+  /// Enable the profiler of the server as configured in @a Settings, shared by
+  /// every server of the process.
+  static void ConfigureProfiler(const UCarlaSettings &Settings);
+
+  /// Print the profiler summary, and write the trace if the settings ask for
+  /// it. Called at the end of every episode.
+  static void ReportProfiler(const UCarlaSettings &Settings);
+
+  /// Time-stamp of the clock the server stamps the stages of every frame
+  /// with, in nanoseconds. Can be called from any thread.
+  static uint64 GetTimestamp();
+
   explicit CarlaServer(uint32 WorldPort, uint32 TimeOutInMilliseconds);
 
   ~CarlaServer();
@@ -38,14 +60,42 @@ public:
 
   ErrorCode ReadEpisodeStart(uint32 &StartPositionIndex, bool bBlocking);
 
-  ErrorCode SendEpisodeReady(bool bBlocking);
+  /// Launches the agent server with the streams configured in @a Settings.
+  /// The non-player agents filter of @a Settings applies to the measurements
+  /// sent during this episode.
+  /// The phases of @a EpisodeStartTimer are reported to the client.
+  ErrorCode SendEpisodeReady(
+      const UCarlaSettings &Settings,
+      const FEpisodeStartTimer &EpisodeStartTimer,
+      bool bBlocking);
 
   ErrorCode ReadControl(ACarlaVehicleController &Player, bool bBlocking);
 
+  /// Same as above waiting up to @a TimeOutInMilliseconds, without warning if
+  /// no control arrived. Returns NotDue right away if, with control
+  /// lookahead, no control is due this frame.
+  ErrorCode TryReadControl(ACarlaVehicleController &Player, uint32 TimeOutInMilliseconds);
+
+  /// Read a request of the client to save the state of the world, or to
+  /// restore @a Snapshot if @a bRestore. Returns TryAgain if none.
+  ErrorCode ReadWorldSnapshotRequest(bool &bRestore, TArray<uint8> &Snapshot, bool bBlocking);
+
+  /// Reply to the last world snapshot request with the @a Snapshot saved,
+  /// empty when restoring. After a successful restore, the images captured
+  /// up to this frame are discarded.
+  ErrorCode SendWorldSnapshot(bool bSuccess, const TArray<uint8> &Snapshot, bool bBlocking);
+
+  /// Measurements are sent together with the images captured the same frame,
+  /// if the images are read back asynchronously the measurements are kept
+  /// until their images are ready. Returns TryAgain if nothing was sent.
+  ///
+  /// @a TickTimestamp is the time-stamp (see GetTimestamp) at which the game
+  /// started ticking this frame.
   ErrorCode SendMeasurements(
       const ACarlaGameState &GameState,
       const ACarlaPlayerState &PlayerState,
-      bool bSendNonPlayerAgentsInfo);
+      bool bSendNonPlayerAgentsInfo,
+      uint64 TickTimestamp);
 
 private:
 
@@ -54,4 +104,23 @@ private:
   const uint32 TimeOut;
 
   void* const Server;
+
+  const TUniquePtr<FNonPlayerAgentsFilter> AgentsFilter;
+
+  /// Frame the current episode started at. Images captured before belong to
+  /// the previous episode if it was reset in place.
+  uint64 EpisodeFrameNumber = 0u;
+
+  /// The last world snapshot request read is a restore.
+  bool bRestoreRequested = false;
+
+  /// @name Buffers reused every tick to avoid allocations.
+  /// @{
+
+  /// Ring of measurements indexed by frame number.
+  TArray<FPendingMeasurements> PendingMeasurements;
+
+  TArray<carla_image_lease> Images;
+
+  /// @}
 };
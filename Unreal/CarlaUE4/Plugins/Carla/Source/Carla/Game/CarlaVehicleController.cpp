@@ -7,14 +7,20 @@
 #include "Carla.h"
 #include "CarlaVehicleController.h"
 
+#include "Game/CarlaServer.h"
 #include "SceneCaptureCamera.h"
 
 #include "Components/BoxComponent.h"
 #include "EngineUtils.h"
 #include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerStart.h"
 #include "WheeledVehicle.h"
 #include "WheeledVehicleMovementComponent.h"
 
+/// Number of slabs reserved per camera. An image may be simultaneously in use
+/// by the readback, waiting to be sent, and being written to the socket.
+static constexpr uint32 NUMBER_OF_SLABS_PER_CAMERA = 3u;
+
 // =============================================================================
 // -- Constructor and destructor -----------------------------------------------
 // =============================================================================
@@ -58,22 +64,22 @@ void ACarlaVehicleController::Possess(APawn *aPawn)
 void ACarlaVehicleController::BeginPlay()
 {
   Super::BeginPlay();
+  SetUpImages();
+}
 
-  if (CarlaPlayerState != nullptr) {
-    CarlaPlayerState->Images.Empty();
-    const auto NumberOfCameras = SceneCaptureCameras.Num();
-    if (NumberOfCameras > 0) {
-      CarlaPlayerState->Images.AddDefaulted(NumberOfCameras);
-      for (auto i = 0; i < NumberOfCameras; ++i) {
-        auto *Camera = SceneCaptureCameras[i];
-        check(Camera != nullptr);
-        auto &Image = CarlaPlayerState->Images[i];
-        Image.SizeX = Camera->GetImageSizeX();
-        Image.SizeY = Camera->GetImageSizeY();
-        Image.PostProcessEffect = Camera->GetPostProcessEffect();
-      }
-    }
+void ACarlaVehicleController::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+  if (ImagePool.IsValid()) {
+    UE_LOG(
+        LogCarla,
+        Log,
+        TEXT("Image pool hits: %d, misses: %d"),
+        ImagePool->GetNumberOfHits(),
+        ImagePool->GetNumberOfMisses());
+    // Slabs still in use keep the pool alive until released.
+    ImagePool.Reset();
   }
+  Super::EndPlay(EndPlayReason);
 }
 
 void ACarlaVehicleController::Tick(float DeltaTime)
@@ -101,20 +107,57 @@ void ACarlaVehicleController::Tick(float DeltaTime)
     check(NumberOfCameras == CarlaPlayerState->Images.Num());
     for (auto i = 0; i < NumberOfCameras; ++i) {
       auto &Image = CarlaPlayerState->Images[i];
-      if (!SceneCaptureCameras[i]->ReadPixels(Image.BitMap)) {
-        Image.BitMap.Empty();
+      auto *Camera = SceneCaptureCameras[i];
+      Image.Slab = ImagePool->Acquire(Image.GetKey());
+      Image.FrameNumber = GFrameCounter;
+      Image.GameTimeStamp = CarlaPlayerState->GetGameTimeStamp();
+      Image.ReadbackTimestamp = 0u;
+      if (Camera->GetReadbackLatency() > 0u) {
+        // Image is replaced by the one captured ReadbackLatency frames ago.
+        Camera->ReadPixelsAsync(Image);
+      } else if (Camera->ReadPixels(Image.Slab->BitMap)) {
+        Image.ReadbackTimestamp = CarlaServer::GetTimestamp();
+      } else {
+        Image.Slab = nullptr;
       }
     }
   }
 }
 
+// =============================================================================
+// -- Episode ------------------------------------------------------------------
+// =============================================================================
+
+void ACarlaVehicleController::ResetEpisode(const APlayerStart &StartSpot)
+{
+  check(IsPossessingAVehicle());
+  auto Vehicle = GetPossessedVehicle();
+  Vehicle->SetActorTransform(StartSpot.GetActorTransform(), false, nullptr, ETeleportType::TeleportPhysics);
+  auto Root = Cast<UPrimitiveComponent>(Vehicle->GetRootComponent());
+  if (Root != nullptr) {
+    Root->SetPhysicsLinearVelocity(FVector::ZeroVector);
+    Root->SetPhysicsAngularVelocity(FVector::ZeroVector);
+  }
+  // Recreating the physics vehicle resets the wheels and the gear box.
+  Vehicle->GetVehicleMovementComponent()->RecreatePhysicsState();
+  // Clears the inputs too. Otherwise the autopilot would follow the route of
+  // the previous position, or wait for a red light that no longer applies.
+  ResetAutopilot();
+  CarlaPlayerState->Reset();
+  CarlaPlayerState->Transform = Vehicle->GetActorTransform();
+  CarlaPlayerState->ForwardSpeed = 0.0f;
+  CarlaPlayerState->Acceleration = FVector::ZeroVector;
+  SetUpImages();
+}
+
 // =============================================================================
 // -- Scene capture ------------------------------------------------------------
 // =============================================================================
 
 void ACarlaVehicleController::AddSceneCaptureCamera(
     const FCameraDescription &Description,
-    const FCameraPostProcessParameters *OverridePostProcessParameters)
+    const FCameraPostProcessParameters *OverridePostProcessParameters,
+    const uint32 ReadbackLatency)
 {
   auto Camera = GetWorld()->SpawnActor<ASceneCaptureCamera>(Description.Position, Description.Rotation);
   if (OverridePostProcessParameters != nullptr) {
@@ -122,6 +165,7 @@ void ACarlaVehicleController::AddSceneCaptureCamera(
   } else {
     Camera->Set(Description);
   }
+  Camera->SetReadbackLatency(ReadbackLatency);
   Camera->AttachToActor(GetPawn(), FAttachmentTransformRules::KeepRelativeTransform);
   Camera->SetOwner(GetPawn());
   AddTickPrerequisiteActor(Camera);
@@ -134,6 +178,17 @@ void ACarlaVehicleController::AddSceneCaptureCamera(
       *PostProcessEffect::ToString(Camera->GetPostProcessEffect()));
 }
 
+void ACarlaVehicleController::RemoveSceneCaptureCameras()
+{
+  for (auto *Camera : SceneCaptureCameras) {
+    if (Camera != nullptr) {
+      RemoveTickPrerequisiteActor(Camera);
+      Camera->Destroy();
+    }
+  }
+  SceneCaptureCameras.Empty();
+}
+
 // =============================================================================
 // -- Events -------------------------------------------------------------------
 // =============================================================================
@@ -155,6 +210,30 @@ void ACarlaVehicleController::OnCollisionEvent(
 // -- Other --------------------------------------------------------------------
 // =============================================================================
 
+void ACarlaVehicleController::SetUpImages()
+{
+  if (CarlaPlayerState != nullptr) {
+    CarlaPlayerState->Images.Empty();
+    // Slabs still in use keep the previous pool alive until released.
+    ImagePool = MakeShareable(new FCapturedImagePool());
+    const auto NumberOfCameras = SceneCaptureCameras.Num();
+    if (NumberOfCameras > 0) {
+      CarlaPlayerState->Images.AddDefaulted(NumberOfCameras);
+      for (auto i = 0; i < NumberOfCameras; ++i) {
+        auto *Camera = SceneCaptureCameras[i];
+        check(Camera != nullptr);
+        auto &Image = CarlaPlayerState->Images[i];
+        Image.SizeX = Camera->GetImageSizeX();
+        Image.SizeY = Camera->GetImageSizeY();
+        Image.PostProcessEffect = Camera->GetPostProcessEffect();
+        Image.bCompress = Camera->GetCompressImages();
+        // In-flight asynchronous readbacks hold a slab each.
+        ImagePool->Reserve(Image.GetKey(), NUMBER_OF_SLABS_PER_CAMERA + Camera->GetReadbackLatency());
+      }
+    }
+  }
+}
+
 void ACarlaVehicleController::IntersectPlayerWithRoadMap()
 {
   auto RoadMap = GetRoadMap();
@@ -7,10 +7,14 @@
 #pragma once
 
 #include "WheeledVehicleController.h"
+
+#include "CapturedImagePool.h"
+
 #include "CarlaVehicleController.generated.h"
 
 class ACarlaHUD;
 class ACarlaPlayerState;
+class APlayerStart;
 class ASceneCaptureCamera;
 struct FCameraDescription;
 
@@ -48,6 +52,8 @@ public:
 
   virtual void BeginPlay() override;
 
+  virtual void EndPlay(EEndPlayReason::Type EndPlayReason) override;
+
   virtual void Tick(float DeltaTime) override;
 
   /// @}
@@ -74,6 +80,30 @@ public:
     return *CarlaPlayerState;
   }
 
+  ACarlaPlayerState &GetPlayerState()
+  {
+    return *CarlaPlayerState;
+  }
+
+  /// Pool where the images of the scene capture cameras are read into, null
+  /// if not playing.
+  const FCapturedImagePool *GetImagePool() const
+  {
+    return ImagePool.Get();
+  }
+
+  /// @}
+  // ===========================================================================
+  /// @name Episode
+  // ===========================================================================
+  /// @{
+public:
+
+  /// Start a new episode without reloading the level: move the player to
+  /// @a StartSpot at rest, and reset the player state and the images of the
+  /// cameras attached at that point.
+  void ResetEpisode(const APlayerStart &StartSpot);
+
   /// @}
   // ===========================================================================
   /// @name Scene Capture
@@ -83,7 +113,10 @@ public:
 
   void AddSceneCaptureCamera(
       const FCameraDescription &CameraDescription,
-      const FCameraPostProcessParameters *OverridePostProcessParameters);
+      const FCameraPostProcessParameters *OverridePostProcessParameters,
+      uint32 ReadbackLatency);
+
+  void RemoveSceneCaptureCameras();
 
   /// @}
   // ===========================================================================
@@ -106,6 +139,10 @@ private:
   /// @{
 private:
 
+  /// Allocate the images of the cameras attached, and the pool they are read
+  /// into.
+  void SetUpImages();
+
   void IntersectPlayerWithRoadMap();
 
   /// @}
@@ -124,4 +161,6 @@ private:
   // Cast for quick access to the custom HUD.
   UPROPERTY()
   ACarlaHUD *CarlaHUD;
+
+  TSharedPtr<FCapturedImagePool, ESPMode::ThreadSafe> ImagePool;
 };
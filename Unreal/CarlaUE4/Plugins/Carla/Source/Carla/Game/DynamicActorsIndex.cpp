@@ -0,0 +1,54 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "DynamicActorsIndex.h"
+
+#include "GameFramework/Character.h"
+
+#include "AI/VehicleSpawnerBase.h"
+#include "AI/WalkerSpawnerBase.h"
+#include "CarlaWheeledVehicle.h"
+
+void FDynamicActorsIndex::Rebuild(
+    const UWorld &World,
+    const AVehicleSpawnerBase *VehicleSpawner,
+    const AWalkerSpawnerBase *WalkerSpawner)
+{
+  Grid.Reset();
+  Actors.Reset();
+  Kinds.Reset();
+  for (auto It = World.GetPlayerControllerIterator(); It; ++It) {
+    const APlayerController *Controller = It->Get();
+    if ((Controller != nullptr) && (Controller->GetPawn() != nullptr)) {
+      Add(*Controller->GetPawn(), EKind::Player);
+    }
+  }
+  if (VehicleSpawner != nullptr) {
+    for (ACarlaWheeledVehicle *Vehicle : VehicleSpawner->GetVehicles()) {
+      if (Vehicle != nullptr) {
+        Add(*Vehicle, EKind::Vehicle);
+      }
+    }
+  }
+  if (WalkerSpawner != nullptr) {
+    for (const auto *List : {&WalkerSpawner->GetWalkersWhiteList(), &WalkerSpawner->GetWalkersBlackList()}) {
+      for (ACharacter *Walker : *List) {
+        if (Walker != nullptr) {
+          Add(*Walker, EKind::Walker);
+        }
+      }
+    }
+  }
+  Grid.Build();
+}
+
+void FDynamicActorsIndex::Add(AActor &Actor, const EKind Kind)
+{
+  Grid.Add(Actor.GetActorLocation());
+  Actors.Add(&Actor);
+  Kinds.Add(Kind);
+}
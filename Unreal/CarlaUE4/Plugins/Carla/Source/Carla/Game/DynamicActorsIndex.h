@@ -0,0 +1,71 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "Util/NonCopyable.h"
+#include "Util/SpatialHashGrid.h"
+
+class AVehicleSpawnerBase;
+class AWalkerSpawnerBase;
+
+/// Spatial index of the actors that move around the level: the player, the
+/// spawned vehicles and the walkers. Meant to be rebuilt every tick, so
+/// queries are only valid during the frame the index was built.
+class CARLA_API FDynamicActorsIndex : private NonCopyable
+{
+public:
+
+  enum class EKind : uint8
+  {
+    Player,
+    Vehicle,
+    Walker
+  };
+
+  /// Index the player pawns of @a World and the actors of the spawners.
+  void Rebuild(
+      const UWorld &World,
+      const AVehicleSpawnerBase *VehicleSpawner,
+      const AWalkerSpawnerBase *WalkerSpawner);
+
+  int32 Num() const
+  {
+    return Grid.Num();
+  }
+
+  AActor &GetActor(int32 Index) const
+  {
+    return *Actors[Index];
+  }
+
+  EKind GetKind(int32 Index) const
+  {
+    return Kinds[Index];
+  }
+
+  /// Location of the actor when the index was built.
+  const FVector &GetLocation(int32 Index) const
+  {
+    return Grid.GetLocation(Index);
+  }
+
+  /// Queries, they return indices into this index, see FSpatialHashGrid.
+  const FSpatialHashGrid &GetGrid() const
+  {
+    return Grid;
+  }
+
+private:
+
+  void Add(AActor &Actor, EKind Kind);
+
+  FSpatialHashGrid Grid;
+
+  TArray<AActor *> Actors;
+
+  TArray<EKind> Kinds;
+};
@@ -0,0 +1,196 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "NonPlayerAgentsFilter.h"
+
+#include "GameFramework/Character.h"
+
+#include "CarlaGameState.h"
+#include "CarlaWheeledVehicle.h"
+#include "Settings/CarlaSettings.h"
+
+#include <algorithm>
+
+/// Radius in centimeters of the sphere tested against the camera frustum, an
+/// agent is kept if any part of it may be visible.
+static constexpr float FRUSTUM_MARGIN = 300.0f;
+
+static bool IsTrafficLight(const ATrafficSignBase &TrafficSign)
+{
+  switch (TrafficSign.GetTrafficSignState()) {
+    case ETrafficSignState::TrafficLightRed:
+    case ETrafficSignState::TrafficLightYellow:
+    case ETrafficSignState::TrafficLightGreen:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/// Visit the locations of @a Grid within @a MaxDistance of @a Origin, or all
+/// of them if @a MaxDistance is zero.
+template <typename F>
+static void ForEachInRange(
+    const FSpatialHashGrid &Grid,
+    const FVector &Origin,
+    const float MaxDistance,
+    F &&Callback)
+{
+  if (MaxDistance > 0.0f) {
+    Grid.ForEachInRadius(Origin, MaxDistance, Callback);
+  } else {
+    for (int32 Index = 0; Index < Grid.Num(); ++Index) {
+      Callback(Index, FVector::DistSquared(Grid.GetLocation(Index), Origin));
+    }
+  }
+}
+
+void FNonPlayerAgentsFilter::Configure(const UCarlaSettings &Settings)
+{
+  Description = Settings.NonPlayerAgentsFilter;
+  bUseFrustum = false;
+  if (!Description.FrustumCamera.IsEmpty()) {
+    const auto *Camera = Settings.CameraDescriptions.Find(Description.FrustumCamera);
+    if (Camera == nullptr) {
+      UE_LOG(LogCarlaServer, Error, TEXT("Non-player agents frustum camera \"%s\" not found, ignoring it"), *Description.FrustumCamera);
+    } else {
+      bUseFrustum = true;
+      CameraRelativeTransform = FTransform(Camera->Rotation, Camera->Position);
+      // The field of view is horizontal, the vertical one follows the aspect
+      // ratio of the image. Above 180 degrees the sides do not cull anything.
+      const float HalfFOV = FMath::DegreesToRadians(FMath::Min(Camera->FOVAngle, 179.0f)) / 2.0f;
+      TanHalfFOVX = FMath::Tan(HalfFOV);
+      TanHalfFOVY = TanHalfFOVX * Camera->ImageSizeY / Camera->ImageSizeX;
+      SecHalfFOVX = FMath::Sqrt(1.0f + TanHalfFOVX * TanHalfFOVX);
+      SecHalfFOVY = FMath::Sqrt(1.0f + TanHalfFOVY * TanHalfFOVY);
+    }
+  }
+  // Traffic signs are indexed again on the next update.
+  IndexedGameState = nullptr;
+}
+
+void FNonPlayerAgentsFilter::Update(
+    const ACarlaGameState &GameState,
+    const FTransform &PlayerTransform)
+{
+  Candidates.Reset();
+  TrafficSigns.Reset();
+  Walkers.Reset();
+  Vehicles.Reset();
+
+  const FVector Origin = PlayerTransform.GetLocation();
+  if (bUseFrustum) {
+    CameraTransform = CameraRelativeTransform * PlayerTransform;
+  }
+
+  if (Description.bTrafficLights || Description.bSpeedLimitSigns) {
+    UpdateStaticGrid(GameState);
+    ForEachInRange(StaticGrid, Origin, Description.MaxDistance, [&](int32 Index, float DistanceSquared) {
+      const ATrafficSignBase &TrafficSign = *StaticActors[Index];
+      const bool bWanted = (IsTrafficLight(TrafficSign) ?
+          Description.bTrafficLights :
+          Description.bSpeedLimitSigns);
+      if (bWanted && IsInFrustum(StaticGrid.GetLocation(Index))) {
+        AddCandidate(TrafficSign, EKind::TrafficSign, DistanceSquared);
+      }
+    });
+  }
+
+  if (Description.bVehicles || Description.bPedestrians) {
+    const auto &ActorsIndex = GameState.GetDynamicActorsIndex();
+    ForEachInRange(ActorsIndex.GetGrid(), Origin, Description.MaxDistance, [&](int32 Index, float DistanceSquared) {
+      EKind Kind;
+      switch (ActorsIndex.GetKind(Index)) {
+        case FDynamicActorsIndex::EKind::Vehicle:
+          if (!Description.bVehicles) {
+            return;
+          }
+          Kind = EKind::Vehicle;
+          break;
+        case FDynamicActorsIndex::EKind::Walker:
+          if (!Description.bPedestrians) {
+            return;
+          }
+          Kind = EKind::Walker;
+          break;
+        default:
+          return;
+      }
+      if (IsInFrustum(ActorsIndex.GetLocation(Index))) {
+        AddCandidate(ActorsIndex.GetActor(Index), Kind, DistanceSquared);
+      }
+    });
+  }
+
+  // Keep the closest ones, partial ordering is enough.
+  const int32 MaxCount = static_cast<int32>(Description.MaxCount);
+  if ((MaxCount > 0) && (Candidates.Num() > MaxCount)) {
+    std::nth_element(
+        Candidates.GetData(),
+        Candidates.GetData() + MaxCount,
+        Candidates.GetData() + Candidates.Num(),
+        [](const FCandidate &lhs, const FCandidate &rhs) {
+          return lhs.DistanceSquared < rhs.DistanceSquared;
+        });
+    Candidates.SetNum(MaxCount, false);
+  }
+
+  for (const FCandidate &Candidate : Candidates) {
+    switch (Candidate.Kind) {
+      case EKind::TrafficSign:
+        TrafficSigns.Add(static_cast<const ATrafficSignBase *>(Candidate.Actor));
+        break;
+      case EKind::Walker:
+        Walkers.Add(static_cast<const ACharacter *>(Candidate.Actor));
+        break;
+      case EKind::Vehicle:
+        Vehicles.Add(static_cast<const ACarlaWheeledVehicle *>(Candidate.Actor));
+        break;
+    }
+  }
+}
+
+void FNonPlayerAgentsFilter::UpdateStaticGrid(const ACarlaGameState &GameState)
+{
+  const auto &Source = GameState.GetTrafficSigns();
+  // Traffic signs register themselves at begin play, re-index if the level
+  // changed or more of them registered since.
+  if ((IndexedGameState == &GameState) && (StaticActors.Num() == Source.Num())) {
+    return;
+  }
+  IndexedGameState = &GameState;
+  StaticGrid.Reset();
+  StaticActors.Reset();
+  for (const auto *TrafficSign : Source) {
+    if (TrafficSign != nullptr) {
+      StaticGrid.Add(TrafficSign->GetActorLocation());
+      StaticActors.Add(TrafficSign);
+    }
+  }
+  StaticGrid.Build();
+}
+
+bool FNonPlayerAgentsFilter::IsInFrustum(const FVector &Location) const
+{
+  if (!bUseFrustum) {
+    return true;
+  }
+  // Camera space, X forward, Y right, Z up. A sphere is outside a side plane
+  // if its center is further than its radius.
+  const FVector Local = CameraTransform.InverseTransformPosition(Location);
+  return (Local.X >= -FRUSTUM_MARGIN) &&
+         (FMath::Abs(Local.Y) <= Local.X * TanHalfFOVX + FRUSTUM_MARGIN * SecHalfFOVX) &&
+         (FMath::Abs(Local.Z) <= Local.X * TanHalfFOVY + FRUSTUM_MARGIN * SecHalfFOVY);
+}
+
+void FNonPlayerAgentsFilter::AddCandidate(
+    const AActor &Actor,
+    const EKind Kind,
+    const float DistanceSquared)
+{
+  Candidates.Add({&Actor, Kind, DistanceSquared});
+}
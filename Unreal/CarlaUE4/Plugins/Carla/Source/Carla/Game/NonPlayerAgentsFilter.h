@@ -0,0 +1,130 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "Settings/NonPlayerAgentsFilterDescription.h"
+#include "Util/NonCopyable.h"
+#include "Util/SpatialHashGrid.h"
+
+class ACarlaGameState;
+class ACarlaWheeledVehicle;
+class ACharacter;
+class ATrafficSignBase;
+class UCarlaSettings;
+
+/// Selects the non-player agents sent to the client as described by a
+/// FNonPlayerAgentsFilterDescription.
+///
+/// If a maximum distance is given, agents are looked up in spatial hash grids
+/// instead of visiting every actor in the level. Traffic signs do not move,
+/// their grid is built once per level; vehicles and walkers are looked up in
+/// the dynamic actors index of the game state.
+class CARLA_API FNonPlayerAgentsFilter : private NonCopyable
+{
+public:
+
+  /// Set up the filter for a new episode, @a Settings is used to look up the
+  /// frustum camera.
+  void Configure(const UCarlaSettings &Settings);
+
+  bool IsEnabled() const
+  {
+    return Description.IsEnabled();
+  }
+
+  /// Select the agents of @a GameState for a player at @a PlayerTransform.
+  void Update(const ACarlaGameState &GameState, const FTransform &PlayerTransform);
+
+  /// @name Agents selected by the last update.
+  /// @{
+
+  const TArray<const ATrafficSignBase *> &GetTrafficSigns() const
+  {
+    return TrafficSigns;
+  }
+
+  const TArray<const ACharacter *> &GetWalkers() const
+  {
+    return Walkers;
+  }
+
+  const TArray<const ACarlaWheeledVehicle *> &GetVehicles() const
+  {
+    return Vehicles;
+  }
+
+  /// @}
+
+private:
+
+  enum class EKind : uint8
+  {
+    TrafficSign,
+    Walker,
+    Vehicle
+  };
+
+  struct FCandidate
+  {
+    const AActor *Actor;
+
+    EKind Kind;
+
+    float DistanceSquared;
+  };
+
+  void UpdateStaticGrid(const ACarlaGameState &GameState);
+
+  bool IsInFrustum(const FVector &Location) const;
+
+  void AddCandidate(const AActor &Actor, EKind Kind, float DistanceSquared);
+
+  FNonPlayerAgentsFilterDescription Description;
+
+  /// @name Frustum of the camera, if any.
+  /// @{
+
+  bool bUseFrustum = false;
+
+  FTransform CameraRelativeTransform;
+
+  FTransform CameraTransform;
+
+  float TanHalfFOVX = 1.0f;
+
+  float TanHalfFOVY = 1.0f;
+
+  float SecHalfFOVX = 1.0f;
+
+  float SecHalfFOVY = 1.0f;
+
+  /// @}
+
+  /// @name Spatial index of traffic signs, built once per level.
+  /// @{
+
+  const ACarlaGameState *IndexedGameState = nullptr;
+
+  FSpatialHashGrid StaticGrid;
+
+  TArray<const ATrafficSignBase *> StaticActors;
+
+  /// @}
+
+  /// @name Buffers reused every update.
+  /// @{
+
+  TArray<FCandidate> Candidates;
+
+  TArray<const ATrafficSignBase *> TrafficSigns;
+
+  TArray<const ACharacter *> Walkers;
+
+  TArray<const ACarlaWheeledVehicle *> Vehicles;
+
+  /// @}
+};
@@ -7,6 +7,8 @@
 #include "Carla.h"
 #include "SceneCaptureCamera.h"
 
+#include "Game/CarlaServer.h"
+
 #include "Components/DrawFrustumComponent.h"
 #include "Components/SceneCaptureComponent2D.h"
 #include "Components/StaticMeshComponent.h"
@@ -15,6 +17,7 @@
 #include "HighResScreenshot.h"
 #include "Materials/Material.h"
 #include "Paths.h"
+#include "RHICommandList.h"
 #include "StaticMeshResources.h"
 #include "TextureResource.h"
 
@@ -36,7 +39,10 @@ ASceneCaptureCamera::ASceneCaptureCamera(const FObjectInitializer& ObjectInitial
   Super(ObjectInitializer),
   SizeX(720u),
   SizeY(512u),
-  PostProcessEffect(EPostProcessEffect::SceneFinal)
+  PostProcessEffect(EPostProcessEffect::SceneFinal),
+  ReadbackLatency(0u),
+  bCompressImages(false),
+  ReadbackCount(0u)
 {
   PrimaryActorTick.bCanEverTick = true; /// @todo Does it need to tick?
   PrimaryActorTick.TickGroup = TG_PrePhysics;
@@ -116,9 +122,26 @@ void ASceneCaptureCamera::BeginPlay()
   CaptureComponent2D->UpdateContent();
   CaptureComponent2D->Activate();
 
+  // Setup asynchronous readback.
+  Readbacks.Empty();
+  ReadbackCount = 0u;
+  if (ReadbackLatency > 0u) {
+    Readbacks.SetNum(ReadbackLatency + 1u);
+  }
+
   Super::BeginPlay();
 }
 
+void ASceneCaptureCamera::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+  if (Readbacks.Num() > 0) {
+    // The render thread may still be referencing the in-flight readbacks.
+    FlushRenderingCommands();
+    Readbacks.Empty();
+  }
+  Super::EndPlay(EndPlayReason);
+}
+
 void ASceneCaptureCamera::SetImageSize(uint32 otherSizeX, uint32 otherSizeY)
 {
   SizeX = otherSizeX;
@@ -137,6 +160,13 @@ void ASceneCaptureCamera::SetPostProcessEffect(EPostProcessEffect otherPostProce
   }
 }
 
+void ASceneCaptureCamera::SetReadbackLatency(const uint32 InReadbackLatency)
+{
+  ReadbackLatency = (InReadbackLatency == 0u ?
+      0u :
+      FMath::Clamp(InReadbackLatency, GetMinReadbackLatency(), GetMaxReadbackLatency()));
+}
+
 void ASceneCaptureCamera::SetFOVAngle(const float FOVAngle)
 {
   check(CaptureComponent2D != nullptr);
@@ -154,6 +184,7 @@ void ASceneCaptureCamera::Set(const FCameraDescription &CameraDescription)
   SetImageSize(CameraDescription.ImageSizeX, CameraDescription.ImageSizeY);
   SetPostProcessEffect(CameraDescription.PostProcessEffect);
   SetFOVAngle(CameraDescription.FOVAngle);
+  bCompressImages = CameraDescription.bCompressImages;
 }
 
 void ASceneCaptureCamera::Set(
@@ -184,6 +215,114 @@ bool ASceneCaptureCamera::ReadPixels(TArray<FColor> &BitMap) const
   return RTResource->ReadPixels(BitMap, ReadPixelFlags);
 }
 
+bool ASceneCaptureCamera::ReadPixelsAsync(FCapturedImage &Image)
+{
+  check(ReadbackLatency >= GetMinReadbackLatency());
+  check(Readbacks.Num() == ReadbackLatency + 1u);
+  const uint64 Size = Readbacks.Num();
+
+  // Copy the current capture to the staging texture.
+  {
+    auto &Readback = Readbacks[ReadbackCount % Size];
+    Readback.Image = MoveTemp(Image);
+    EnqueueCopyToStagingTexture(Readback);
+  }
+
+  // Map the staging texture copied ReadbackLatency - 1 frames ago, at least one
+  // frame ago, by then the GPU should have finished with it.
+  if (ReadbackCount + 1u >= ReadbackLatency) {
+    EnqueueReadStagingTexture(Readbacks[(ReadbackCount + 1u - ReadbackLatency) % Size]);
+  }
+
+  bool bSuccess = false;
+  // Retrieve the image enqueued ReadbackLatency frames ago.
+  if (ReadbackCount >= ReadbackLatency) {
+    auto &Readback = Readbacks[(ReadbackCount - ReadbackLatency) % Size];
+    // Usually the render thread is done with it already, if not we wait.
+    Readback.Fence.Wait();
+    Image = MoveTemp(Readback.Image);
+    if (!Readback.bSucceeded) {
+      Image.Slab = nullptr;
+    }
+    bSuccess = true;
+  } else {
+    // Nothing to deliver yet, keep the meta info only.
+    Image = Readbacks[ReadbackCount % Size].Image;
+    Image.Slab = nullptr;
+    Image.FrameNumber = 0u;
+  }
+
+  ++ReadbackCount;
+  return bSuccess;
+}
+
+void ASceneCaptureCamera::EnqueueCopyToStagingTexture(FSceneCaptureReadback &Readback)
+{
+  Readback.bSucceeded = false;
+  FTextureRenderTargetResource* RTResource = CaptureRenderTarget->GameThread_GetRenderTargetResource();
+  if (RTResource == nullptr) {
+    UE_LOG(LogCarla, Error, TEXT("SceneCaptureCamera: Missing render target"));
+    // Without slab the staging texture won't be read.
+    Readback.Image.Slab = nullptr;
+    return;
+  }
+  FSceneCaptureReadback *ReadbackPtr = &Readback;
+  const uint32 Width = SizeX;
+  const uint32 Height = SizeY;
+  ENQUEUE_RENDER_COMMAND(FCarlaCopyToStagingTexture)(
+    [ReadbackPtr, RTResource, Width, Height](FRHICommandListImmediate &RHICmdList)
+    {
+      if (!ReadbackPtr->StagingTexture.IsValid()) {
+        FRHIResourceCreateInfo CreateInfo;
+        ReadbackPtr->StagingTexture = RHICreateTexture2D(
+            Width,
+            Height,
+            PF_B8G8R8A8,
+            1,
+            1,
+            TexCreate_CPUReadback,
+            CreateInfo);
+      }
+      RHICmdList.CopyToResolveTarget(
+          RTResource->GetRenderTargetTexture(),
+          ReadbackPtr->StagingTexture,
+          true,
+          FResolveParams());
+    });
+}
+
+void ASceneCaptureCamera::EnqueueReadStagingTexture(FSceneCaptureReadback &Readback)
+{
+  FSceneCaptureReadback *ReadbackPtr = &Readback;
+  const uint32 Width = SizeX;
+  const uint32 Height = SizeY;
+  ENQUEUE_RENDER_COMMAND(FCarlaReadStagingTexture)(
+    [ReadbackPtr, Width, Height](FRHICommandListImmediate &RHICmdList)
+    {
+      auto *Slab = ReadbackPtr->Image.Slab.GetReference();
+      if ((Slab == nullptr) || !ReadbackPtr->StagingTexture.IsValid()) {
+        return;
+      }
+      check(Slab->BitMap.Num() == Width * Height);
+      void *Data = nullptr;
+      int32 RowPitch = 0;
+      int32 MappedHeight = 0;
+      RHICmdList.MapStagingSurface(ReadbackPtr->StagingTexture, Data, RowPitch, MappedHeight);
+      if ((Data != nullptr) && (RowPitch >= static_cast<int32>(Width)) && (MappedHeight >= static_cast<int32>(Height))) {
+        // Rows of the staging surface may be padded.
+        const FColor *Source = static_cast<const FColor *>(Data);
+        FColor *Target = Slab->BitMap.GetData();
+        for (uint32 Row = 0u; Row < Height; ++Row) {
+          FMemory::Memcpy(Target + Row * Width, Source + Row * RowPitch, Width * sizeof(FColor));
+        }
+        ReadbackPtr->Image.ReadbackTimestamp = CarlaServer::GetTimestamp();
+        ReadbackPtr->bSucceeded = true;
+      }
+      RHICmdList.UnmapStagingSurface(ReadbackPtr->StagingTexture);
+    });
+  Readback.Fence.BeginFence();
+}
+
 void ASceneCaptureCamera::UpdateDrawFrustum()
 {
   if(DrawFrustum && CaptureComponent2D)
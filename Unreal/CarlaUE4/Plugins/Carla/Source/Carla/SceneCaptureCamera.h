@@ -7,7 +7,10 @@
 #pragma once
 
 #include "GameFramework/Actor.h"
+#include "RenderingThread.h"
+#include "RHIResources.h"
 #include "StaticMeshResources.h"
+#include "Game/CapturedImage.h"
 #include "Settings/CameraDescription.h"
 #include "SceneCaptureCamera.generated.h"
 
@@ -16,6 +19,21 @@ class USceneCaptureComponent2D;
 class UStaticMeshComponent;
 class UTextureRenderTarget2D;
 
+/// An image in-flight in the asynchronous readback.
+struct FSceneCaptureReadback
+{
+  FCapturedImage Image;
+
+  /// Only accessed on the render thread.
+  FTexture2DRHIRef StagingTexture;
+
+  /// Signals that the image has been read into its slab.
+  FRenderCommandFence Fence;
+
+  /// Written on the render thread before the fence is signaled.
+  bool bSucceeded = false;
+};
+
 /// Own SceneCapture, re-implementing some of the methods since ASceneCapture
 /// cannot be subclassed.
 UCLASS(hidecategories=(Collision, Attachment, Actor))
@@ -35,6 +53,8 @@ public:
 
   virtual void BeginPlay() override;
 
+  virtual void EndPlay(EEndPlayReason::Type EndPlayReason) override;
+
   uint32 GetImageSizeX() const
   {
     return SizeX;
@@ -50,6 +70,12 @@ public:
     return PostProcessEffect;
   }
 
+  /// Whether the images of this camera are compressed before sending them.
+  bool GetCompressImages() const
+  {
+    return bCompressImages;
+  }
+
   void SetImageSize(uint32 SizeX, uint32 SizeY);
 
   void SetPostProcessEffect(EPostProcessEffect PostProcessEffect);
@@ -64,10 +90,49 @@ public:
       const FCameraDescription &CameraDescription,
       const FCameraPostProcessParameters &OverridePostProcessParameters);
 
+  /// Minimum number of frames the asynchronous readback can be delayed. The
+  /// staging texture is mapped one frame after the copy, a delay of a single
+  /// frame would map it in the same frame and stall on the GPU.
+  static constexpr uint32 GetMinReadbackLatency()
+  {
+    return 2u;
+  }
+
+  /// Maximum number of frames the asynchronous readback can be delayed.
+  static constexpr uint32 GetMaxReadbackLatency()
+  {
+    return 2u;
+  }
+
+  uint32 GetReadbackLatency() const
+  {
+    return ReadbackLatency;
+  }
+
+  /// Number of frames the images are delayed when read back asynchronously,
+  /// zero for synchronous readback. Other values are clamped to
+  /// [GetMinReadbackLatency(), GetMaxReadbackLatency()]. Must be set before
+  /// BeginPlay.
+  void SetReadbackLatency(uint32 InReadbackLatency);
+
+  /// Read the pixels synchronously, flushes the rendering commands and blocks
+  /// until the GPU has finished.
   bool ReadPixels(TArray<FColor> &BitMap) const;
 
+  /// Read the pixels asynchronously. Enqueues a copy of the current capture to
+  /// a staging surface to be read later into @a Image's slab, and replaces
+  /// @a Image by the one enqueued ReadbackLatency frames ago, tags included.
+  ///
+  /// Returns false if there is no image ready yet, in that case @a Image has
+  /// no slab. If the readback failed, the returned image has no slab either.
+  bool ReadPixelsAsync(FCapturedImage &Image);
+
 private:
 
+  void EnqueueCopyToStagingTexture(FSceneCaptureReadback &Readback);
+
+  void EnqueueReadStagingTexture(FSceneCaptureReadback &Readback);
+
   /// Used to synchronize the DrawFrustumComponent with the
   /// SceneCaptureComponent2D settings.
   void UpdateDrawFrustum();
@@ -81,6 +146,18 @@ private:
   UPROPERTY(Category = "Scene Capture", EditAnywhere)
   EPostProcessEffect PostProcessEffect;
 
+  UPROPERTY(Category = "Scene Capture", EditAnywhere, meta = (ClampMax = "2"))
+  uint32 ReadbackLatency;
+
+  UPROPERTY(Category = "Scene Capture", EditAnywhere)
+  bool bCompressImages;
+
+  /// Ring of ReadbackLatency + 1 in-flight images.
+  TArray<FSceneCaptureReadback> Readbacks;
+
+  /// Number of frames enqueued to the asynchronous readback.
+  uint64 ReadbackCount;
+
   /** To display the 3d camera in the editor. */
   UPROPERTY()
   UStaticMeshComponent* MeshComp;
@@ -37,4 +37,11 @@ struct FCameraDescription
   /** Camera field of view (in degrees). */
   UPROPERTY(Category = "Camera Description", EditDefaultsOnly, meta=(DisplayName = "Field of View", ClampMin = "0.001", ClampMax = "360.0"))
   float FOVAngle = 90.0f;
+
+  /** Losslessly compress the images before sending them to the client. Saves
+    * bandwidth at the cost of CPU time in the server's networking thread,
+    * works best with depth and semantic segmentation images.
+    */
+  UPROPERTY(Category = "Camera Description", EditDefaultsOnly)
+  bool bCompressImages = false;
 };
@@ -10,6 +10,7 @@
 #include "UnrealMathUtility.h"
 
 #include "DynamicWeather.h"
+#include "SceneCaptureCamera.h"
 #include "Settings/CarlaSettings.h"
 #include "Util/IniFile.h"
 
@@ -68,6 +69,63 @@ static void GetCameraDescription(
   ConfigFile.GetInt(Section, TEXT("CameraRotationRoll"), Camera.Rotation.Roll);
   ConfigFile.GetInt(Section, TEXT("CameraRotationYaw"), Camera.Rotation.Yaw);
   ConfigFile.GetPostProcessEffect(Section, TEXT("PostProcessing"), Camera.PostProcessEffect);
+  ConfigFile.GetBool(Section, TEXT("CompressImages"), Camera.bCompressImages);
+}
+
+static void GetNonPlayerAgentsFilterDescription(
+    const MyIniFile &ConfigFile,
+    const TCHAR* Section,
+    FNonPlayerAgentsFilterDescription &Filter)
+{
+  ConfigFile.GetFloat(Section, TEXT("NonPlayerAgentsMaxDistance"), Filter.MaxDistance);
+  Filter.MaxDistance = FMath::Max(0.0f, Filter.MaxDistance);
+  ConfigFile.GetInt(Section, TEXT("NonPlayerAgentsMaxCount"), Filter.MaxCount);
+  ConfigFile.GetString(Section, TEXT("NonPlayerAgentsFrustumCamera"), Filter.FrustumCamera);
+  FString Types;
+  if (ConfigFile.GetFConfigFile().GetString(Section, TEXT("NonPlayerAgentsTypes"), Types)) {
+    TArray<FString> TypeNames;
+    Types.ParseIntoArray(TypeNames, TEXT(","), true);
+    Filter.bVehicles = false;
+    Filter.bPedestrians = false;
+    Filter.bTrafficLights = false;
+    Filter.bSpeedLimitSigns = false;
+    for (FString &Name : TypeNames) {
+      Name = Name.Trim().TrimTrailing();
+      if (Name == "Vehicles") {
+        Filter.bVehicles = true;
+      } else if (Name == "Pedestrians") {
+        Filter.bPedestrians = true;
+      } else if (Name == "TrafficLights") {
+        Filter.bTrafficLights = true;
+      } else if (Name == "SpeedLimitSigns") {
+        Filter.bSpeedLimitSigns = true;
+      } else {
+        UE_LOG(LogCarla, Error, TEXT("Invalid non-player agent type \"%s\" in INI file"), *Name);
+      }
+    }
+  }
+}
+
+static void GetCPUList(
+    const MyIniFile &ConfigFile,
+    const TCHAR* Section,
+    const TCHAR* Key,
+    TArray<int32> &CPUs)
+{
+  FString Value;
+  if (ConfigFile.GetFConfigFile().GetString(Section, Key, Value)) {
+    TArray<FString> Items;
+    Value.ParseIntoArray(Items, TEXT(","), true);
+    CPUs.Reset();
+    for (FString &Item : Items) {
+      Item = Item.Trim().TrimTrailing();
+      if (Item.IsNumeric() && (FCString::Atoi(*Item) >= 0)) {
+        CPUs.Add(FCString::Atoi(*Item));
+      } else {
+        UE_LOG(LogCarla, Error, TEXT("Invalid CPU \"%s\" in INI file"), *Item);
+      }
+    }
+  }
 }
 
 static void ValidateCameraDescription(FCameraDescription &Camera)
@@ -92,9 +150,30 @@ static void LoadSettingsFromConfig(
     ConfigFile.GetBool(S_CARLA_SERVER, TEXT("UseNetworking"), Settings.bUseNetworking);
     ConfigFile.GetInt(S_CARLA_SERVER, TEXT("WorldPort"), Settings.WorldPort);
     ConfigFile.GetInt(S_CARLA_SERVER, TEXT("ServerTimeOut"), Settings.ServerTimeOut);
+    ConfigFile.GetInt(S_CARLA_SERVER, TEXT("ServerThreads"), Settings.ServerThreads);
+    GetCPUList(ConfigFile, S_CARLA_SERVER, TEXT("ServerThreadsAffinity"), Settings.ServerThreadsAffinity);
+    ConfigFile.GetBool(S_CARLA_SERVER, TEXT("ProfileServer"), Settings.bProfileServer);
+    ConfigFile.GetInt(S_CARLA_SERVER, TEXT("ProfilerTraceSeconds"), Settings.ProfilerTraceSeconds);
+    ConfigFile.GetInt(S_CARLA_SERVER, TEXT("ObserversPort"), Settings.ObserversPort);
+    ConfigFile.GetInt(S_CARLA_SERVER, TEXT("MaxObservers"), Settings.MaxObservers);
+    ConfigFile.GetInt(S_CARLA_SERVER, TEXT("ObserverBufferDepth"), Settings.ObserverBufferDepth);
+    Settings.ObserverBufferDepth = FMath::Max(1u, Settings.ObserverBufferDepth);
+    ConfigFile.GetBool(S_CARLA_SERVER, TEXT("DisconnectSlowObservers"), Settings.bDisconnectSlowObservers);
   }
   ConfigFile.GetBool(S_CARLA_SERVER, TEXT("SynchronousMode"), Settings.bSynchronousMode);
+  ConfigFile.GetInt(S_CARLA_SERVER, TEXT("ControlLookahead"), Settings.ControlLookahead);
+  Settings.ControlLookahead = FMath::Min(Settings.ControlLookahead, 32u);
   ConfigFile.GetBool(S_CARLA_SERVER, TEXT("SendNonPlayerAgentsInfo"), Settings.bSendNonPlayerAgentsInfo);
+  ConfigFile.GetBool(S_CARLA_SERVER, TEXT("CompactNonPlayerAgentsInfo"), Settings.bCompactNonPlayerAgentsInfo);
+  ConfigFile.GetBool(S_CARLA_SERVER, TEXT("QuantizeNonPlayerAgentsInfo"), Settings.bQuantizeNonPlayerAgentsInfo);
+  GetNonPlayerAgentsFilterDescription(ConfigFile, S_CARLA_SERVER, Settings.NonPlayerAgentsFilter);
+  ConfigFile.GetBool(S_CARLA_SERVER, TEXT("SeparateSensorStreams"), Settings.bSeparateSensorStreams);
+  ConfigFile.GetInt(S_CARLA_SERVER, TEXT("StreamBufferDepth"), Settings.StreamBufferDepth);
+  Settings.StreamBufferDepth = FMath::Max(1u, Settings.StreamBufferDepth);
+  ConfigFile.GetBool(S_CARLA_SERVER, TEXT("BlockWhenStreamBufferFull"), Settings.bBlockWhenStreamBufferFull);
+  ConfigFile.GetBool(S_CARLA_SERVER, TEXT("SharedMemoryStreams"), Settings.bSharedMemoryStreams);
+  ConfigFile.GetInt(S_CARLA_SERVER, TEXT("SharedMemoryCapacity"), Settings.SharedMemoryCapacity);
+  Settings.SharedMemoryCapacity = FMath::Clamp(Settings.SharedMemoryCapacity, 1u, 4095u);
   // LevelSettings.
   ConfigFile.GetString(S_CARLA_LEVELSETTINGS, TEXT("PlayerVehicle"), Settings.PlayerVehicle);
   ConfigFile.GetInt(S_CARLA_LEVELSETTINGS, TEXT("NumberOfVehicles"), Settings.NumberOfVehicles);
@@ -102,7 +181,19 @@ static void LoadSettingsFromConfig(
   ConfigFile.GetInt(S_CARLA_LEVELSETTINGS, TEXT("WeatherId"), Settings.WeatherId);
   ConfigFile.GetInt(S_CARLA_LEVELSETTINGS, TEXT("SeedVehicles"), Settings.SeedVehicles);
   ConfigFile.GetInt(S_CARLA_LEVELSETTINGS, TEXT("SeedPedestrians"), Settings.SeedPedestrians);
+  ConfigFile.GetBool(S_CARLA_LEVELSETTINGS, TEXT("UseSpatialIndexForAI"), Settings.bUseSpatialIndexForAI);
+  ConfigFile.GetBool(S_CARLA_LEVELSETTINGS, TEXT("ResetInPlace"), Settings.bResetInPlace);
+  ConfigFile.GetFloat(S_CARLA_LEVELSETTINGS, TEXT("SpawnBudgetPerFrame"), Settings.SpawnBudgetPerFrame);
+  Settings.SpawnBudgetPerFrame = FMath::Max(0.0f, Settings.SpawnBudgetPerFrame);
   // SceneCapture.
+  ConfigFile.GetInt(S_CARLA_SCENECAPTURE, TEXT("ReadbackLatency"), Settings.ReadbackLatency);
+  if (Settings.ReadbackLatency > ASceneCaptureCamera::GetMaxReadbackLatency()) {
+    UE_LOG(LogCarla, Warning, TEXT("Readback latency of %d frames is too big, using %d"), Settings.ReadbackLatency, ASceneCaptureCamera::GetMaxReadbackLatency());
+    Settings.ReadbackLatency = ASceneCaptureCamera::GetMaxReadbackLatency();
+  } else if ((Settings.ReadbackLatency > 0u) && (Settings.ReadbackLatency < ASceneCaptureCamera::GetMinReadbackLatency())) {
+    UE_LOG(LogCarla, Warning, TEXT("Readback latency of %d frames is too small, using %d"), Settings.ReadbackLatency, ASceneCaptureCamera::GetMinReadbackLatency());
+    Settings.ReadbackLatency = ASceneCaptureCamera::GetMinReadbackLatency();
+  }
   FString Cameras;
   ConfigFile.GetString(S_CARLA_SCENECAPTURE, TEXT("Cameras"), Cameras);
   TArray<FString> CameraNames;
@@ -205,8 +296,43 @@ void UCarlaSettings::LogSettings() const
   UE_LOG(LogCarla, Log, TEXT("Networking = %s"), EnabledDisabled(bUseNetworking));
   UE_LOG(LogCarla, Log, TEXT("World Port = %d"), WorldPort);
   UE_LOG(LogCarla, Log, TEXT("Server Time-out = %d ms"), ServerTimeOut);
+  UE_LOG(LogCarla, Log, TEXT("Server Threads = %d"), ServerThreads);
+  FString CPUs;
+  for (int32 CPU : ServerThreadsAffinity) {
+    CPUs += (CPUs.IsEmpty() ? TEXT("") : TEXT(",")) + FString::FromInt(CPU);
+  }
+  UE_LOG(LogCarla, Log, TEXT("Server Threads Affinity = %s"), (CPUs.IsEmpty() ? TEXT("Any") : *CPUs));
+  UE_LOG(LogCarla, Log, TEXT("Profile Server = %s"), EnabledDisabled(bProfileServer));
+  UE_LOG(LogCarla, Log, TEXT("Profiler Trace = %d s"), ProfilerTraceSeconds);
   UE_LOG(LogCarla, Log, TEXT("Synchronous Mode = %s"), EnabledDisabled(bSynchronousMode));
+  UE_LOG(LogCarla, Log, TEXT("Control Lookahead = %d frames"), ControlLookahead);
   UE_LOG(LogCarla, Log, TEXT("Send Non-Player Agents Info = %s"), EnabledDisabled(bSendNonPlayerAgentsInfo));
+  UE_LOG(LogCarla, Log, TEXT("Compact Non-Player Agents Info = %s"), EnabledDisabled(bCompactNonPlayerAgentsInfo));
+  UE_LOG(LogCarla, Log, TEXT("Quantize Non-Player Agents Info = %s"), EnabledDisabled(bQuantizeNonPlayerAgentsInfo));
+  UE_LOG(LogCarla, Log, TEXT("Non-Player Agents Max Distance = %.0f cm"), NonPlayerAgentsFilter.MaxDistance);
+  UE_LOG(LogCarla, Log, TEXT("Non-Player Agents Max Count = %d"), NonPlayerAgentsFilter.MaxCount);
+  UE_LOG(LogCarla, Log, TEXT("Non-Player Agents Frustum Camera = %s"), (NonPlayerAgentsFilter.FrustumCamera.IsEmpty() ? TEXT("None") : *NonPlayerAgentsFilter.FrustumCamera));
+  UE_LOG(
+      LogCarla,
+      Log,
+      TEXT("Non-Player Agents Types = { Vehicles = %s, Pedestrians = %s, Traffic Lights = %s, Speed Limit Signs = %s }"),
+      EnabledDisabled(NonPlayerAgentsFilter.bVehicles),
+      EnabledDisabled(NonPlayerAgentsFilter.bPedestrians),
+      EnabledDisabled(NonPlayerAgentsFilter.bTrafficLights),
+      EnabledDisabled(NonPlayerAgentsFilter.bSpeedLimitSigns));
+  UE_LOG(LogCarla, Log, TEXT("Separate Sensor Streams = %s"), EnabledDisabled(bSeparateSensorStreams));
+  UE_LOG(LogCarla, Log, TEXT("Stream Buffer Depth = %d"), StreamBufferDepth);
+  UE_LOG(LogCarla, Log, TEXT("Block When Stream Buffer Full = %s"), EnabledDisabled(bBlockWhenStreamBufferFull));
+  UE_LOG(LogCarla, Log, TEXT("Shared Memory Streams = %s"), EnabledDisabled(bSharedMemoryStreams));
+  UE_LOG(LogCarla, Log, TEXT("Shared Memory Capacity = %d MiB"), SharedMemoryCapacity);
+  if (ObserversPort > 0u) {
+    UE_LOG(LogCarla, Log, TEXT("Observers Port = %d"), ObserversPort);
+  } else {
+    UE_LOG(LogCarla, Log, TEXT("Observers Port = Disabled"));
+  }
+  UE_LOG(LogCarla, Log, TEXT("Max Observers = %d"), MaxObservers);
+  UE_LOG(LogCarla, Log, TEXT("Observer Buffer Depth = %d"), ObserverBufferDepth);
+  UE_LOG(LogCarla, Log, TEXT("Disconnect Slow Observers = %s"), EnabledDisabled(bDisconnectSlowObservers));
   UE_LOG(LogCarla, Log, TEXT("[%s]"), S_CARLA_LEVELSETTINGS);
   UE_LOG(LogCarla, Log, TEXT("Player Vehicle        = %s"), (PlayerVehicle.IsEmpty() ? TEXT("Default") : *PlayerVehicle));
   UE_LOG(LogCarla, Log, TEXT("Number Of Vehicles    = %d"), NumberOfVehicles);
@@ -214,6 +340,13 @@ void UCarlaSettings::LogSettings() const
   UE_LOG(LogCarla, Log, TEXT("Weather Id = %d"), WeatherId);
   UE_LOG(LogCarla, Log, TEXT("Seed Vehicle Spawner = %d"), SeedVehicles);
   UE_LOG(LogCarla, Log, TEXT("Seed Pedestrian Spawner = %d"), SeedPedestrians);
+  UE_LOG(LogCarla, Log, TEXT("Spatial Index For AI = %s"), EnabledDisabled(bUseSpatialIndexForAI));
+  UE_LOG(LogCarla, Log, TEXT("Reset In Place = %s"), EnabledDisabled(bResetInPlace));
+  if (SpawnBudgetPerFrame > 0.0f) {
+    UE_LOG(LogCarla, Log, TEXT("Spawn Budget Per Frame = %.1f ms"), SpawnBudgetPerFrame);
+  } else {
+    UE_LOG(LogCarla, Log, TEXT("Spawn Budget Per Frame = Unlimited"));
+  }
   UE_LOG(LogCarla, Log, TEXT("Found %d available weather settings."), WeatherDescriptions.Num());
   for (auto i = 0; i < WeatherDescriptions.Num(); ++i) {
     UE_LOG(LogCarla, Log, TEXT("  * %d - %s"), i, *WeatherDescriptions[i].Name);
@@ -221,12 +354,14 @@ void UCarlaSettings::LogSettings() const
   UE_LOG(LogCarla, Log, TEXT("[%s]"), S_CARLA_SCENECAPTURE);
   UE_LOG(LogCarla, Log, TEXT("Added %d cameras."), CameraDescriptions.Num());
   UE_LOG(LogCarla, Log, TEXT("Semantic Segmentation = %s"), EnabledDisabled(bSemanticSegmentationEnabled));
+  UE_LOG(LogCarla, Log, TEXT("Readback Latency = %d frames"), ReadbackLatency);
   for (auto &Item : CameraDescriptions) {
     UE_LOG(LogCarla, Log, TEXT("[%s/%s]"), S_CARLA_SCENECAPTURE, *Item.Key);
     UE_LOG(LogCarla, Log, TEXT("Image Size = %dx%d"), Item.Value.ImageSizeX, Item.Value.ImageSizeY);
     UE_LOG(LogCarla, Log, TEXT("Camera Position = (%s)"), *Item.Value.Position.ToString());
     UE_LOG(LogCarla, Log, TEXT("Camera Rotation = (%s)"), *Item.Value.Rotation.ToString());
     UE_LOG(LogCarla, Log, TEXT("Post-Processing = %s"), *PostProcessEffect::ToString(Item.Value.PostProcessEffect));
+    UE_LOG(LogCarla, Log, TEXT("Image Compression = %s"), EnabledDisabled(Item.Value.bCompressImages));
   }
   UE_LOG(LogCarla, Log, TEXT("================================================================================"));
 }
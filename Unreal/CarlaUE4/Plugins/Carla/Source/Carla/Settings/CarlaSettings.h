@@ -7,6 +7,7 @@
 #pragma once
 
 #include "CameraDescription.h"
+#include "NonPlayerAgentsFilterDescription.h"
 #include "WeatherDescription.h"
 
 #include "UObject/NoExportTypes.h"
@@ -80,16 +81,118 @@ public:
   UPROPERTY(Category = "CARLA Server", VisibleAnywhere, meta = (EditCondition = bUseNetworking))
   uint32 ServerTimeOut = 10000u;
 
+  /** Minimum number of networking threads, started once and reused by every
+    * episode. Zero starts them on demand.
+    */
+  UPROPERTY(Category = "CARLA Server", VisibleAnywhere, meta = (EditCondition = bUseNetworking))
+  uint32 ServerThreads = 0u;
+
+  /** CPUs the networking threads are pinned to, empty to let them run on any
+    * CPU.
+    */
+  UPROPERTY(Category = "CARLA Server", VisibleAnywhere, meta = (EditCondition = bUseNetworking))
+  TArray<int32> ServerThreadsAffinity;
+
+  /** Profile the networking and encoding of the server, the latency
+    * percentiles are printed at the end of every episode.
+    */
+  UPROPERTY(Category = "CARLA Server", VisibleAnywhere, meta = (EditCondition = bUseNetworking))
+  bool bProfileServer = false;
+
+  /** If profiling, seconds at the end of every episode written as a Chrome
+    * trace to "Saved/Profiling/CarlaServerTrace.json". Zero disables the
+    * trace.
+    */
+  UPROPERTY(Category = "CARLA Server", VisibleAnywhere, meta = (EditCondition = bProfileServer))
+  uint32 ProfilerTraceSeconds = 0u;
+
   /** In synchronous mode, CARLA waits every tick until the control from the
     * client is received.
     */
   UPROPERTY(Category = "CARLA Server", VisibleAnywhere, meta = (EditCondition = bUseNetworking))
   bool bSynchronousMode = true;
 
+  /** Number of frames the simulation may run ahead of the client. The control
+    * replying to the measurements of frame N is applied once frame
+    * N + ControlLookahead has been sent. Zero applies the latest control.
+    */
+  UPROPERTY(Category = "CARLA Server", VisibleAnywhere, meta = (EditCondition = bUseNetworking, ClampMax = "32"))
+  uint32 ControlLookahead = 0u;
+
   /** Send info about every non-player agent in the scene every frame. */
   UPROPERTY(Category = "CARLA Server", VisibleAnywhere, meta = (EditCondition = bUseNetworking))
   bool bSendNonPlayerAgentsInfo = false;
 
+  /** Send the non-player agents packed in a compact snapshot: traffic signs
+    * and lights once per episode, vehicles and pedestrians as arrays.
+    */
+  UPROPERTY(Category = "CARLA Server", VisibleAnywhere, meta = (EditCondition = bSendNonPlayerAgentsInfo))
+  bool bCompactNonPlayerAgentsInfo = false;
+
+  /** Quantize the compact snapshot, and send only what changed since the
+    * previous frame.
+    */
+  UPROPERTY(Category = "CARLA Server", VisibleAnywhere, meta = (EditCondition = bCompactNonPlayerAgentsInfo))
+  bool bQuantizeNonPlayerAgentsInfo = false;
+
+  /** Restrict the non-player agents sent to the ones near the player or in
+    * view of a camera.
+    */
+  UPROPERTY(Category = "CARLA Server", VisibleAnywhere, meta = (EditCondition = bSendNonPlayerAgentsInfo))
+  FNonPlayerAgentsFilterDescription NonPlayerAgentsFilter;
+
+  /** Send each camera through its own stream (at WorldPort + 3 + camera
+    * index) instead of attaching the images to the measurements.
+    */
+  UPROPERTY(Category = "CARLA Server", VisibleAnywhere, meta = (EditCondition = bUseNetworking))
+  bool bSeparateSensorStreams = false;
+
+  /** Number of frames each stream to the client keeps while the client is not
+    * reading. When full, the oldest frame is dropped unless
+    * bBlockWhenStreamBufferFull is set.
+    */
+  UPROPERTY(Category = "CARLA Server", VisibleAnywhere, meta = (EditCondition = bUseNetworking, ClampMin = "1"))
+  uint32 StreamBufferDepth = 1u;
+
+  /** If the stream buffer is full, wait (up to the server time-out) until the
+    * client reads a frame instead of dropping the oldest one. Allows recording
+    * every frame without switching to synchronous mode.
+    */
+  UPROPERTY(Category = "CARLA Server", VisibleAnywhere, meta = (EditCondition = bUseNetworking))
+  bool bBlockWhenStreamBufferFull = false;
+
+  /** Write the measurements and the images to shared memory instead of
+    * sending them through the sockets, for clients running on the same
+    * machine. The sockets are used for notifications only.
+    */
+  UPROPERTY(Category = "CARLA Server", VisibleAnywhere, meta = (EditCondition = bUseNetworking))
+  bool bSharedMemoryStreams = false;
+
+  /** Size in MiB of the shared memory of each stream, must hold at least one
+    * frame (the measurements and every image attached to them).
+    */
+  UPROPERTY(Category = "CARLA Server", VisibleAnywhere, meta = (EditCondition = bSharedMemoryStreams, ClampMin = "1"))
+  uint32 SharedMemoryCapacity = 256u;
+
+  /** If not zero, read-only observers receive a copy of the measurements at
+    * this port, and of the i-th sensor stream at (ObserversPort + 1 + i).
+    */
+  UPROPERTY(Category = "CARLA Server", VisibleAnywhere, meta = (EditCondition = bUseNetworking))
+  uint32 ObserversPort = 0u;
+
+  /** Maximum number of observers per stream. */
+  UPROPERTY(Category = "CARLA Server", VisibleAnywhere, meta = (EditCondition = bUseNetworking))
+  uint32 MaxObservers = 4u;
+
+  /** Number of frames queued for each observer. When full, the observer misses
+    * frames, or is disconnected if bDisconnectSlowObservers is set.
+    */
+  UPROPERTY(Category = "CARLA Server", VisibleAnywhere, meta = (EditCondition = bUseNetworking, ClampMin = "1"))
+  uint32 ObserverBufferDepth = 4u;
+
+  UPROPERTY(Category = "CARLA Server", VisibleAnywhere, meta = (EditCondition = bUseNetworking))
+  bool bDisconnectSlowObservers = false;
+
   /// @}
   // ===========================================================================
   /// @name Level Settings
@@ -125,6 +228,29 @@ public:
   UPROPERTY(Category = "Level Settings", VisibleAnywhere)
   int32 SeedVehicles = 123456789;
 
+  /** Whether the AI of vehicles and walkers looks for nearby actors in the
+    * spatial index of the game state. Vehicles skip their obstacle ray traces
+    * if no vehicle or walker is ahead, and walkers look for approaching
+    * vehicles in the index instead of using the perception system.
+    */
+  UPROPERTY(Category = "Level Settings", VisibleAnywhere)
+  bool bUseSpatialIndexForAI = false;
+
+  /** Start new episodes in the level already loaded: the player is moved to
+    * the start spot, the non-player agents are spawned again, and the weather
+    * and cameras are changed only if needed. The level is still reloaded if
+    * the player vehicle or the spatial index setting change.
+    */
+  UPROPERTY(Category = "Level Settings", VisibleAnywhere)
+  bool bResetInPlace = false;
+
+  /** Time in milliseconds spent every frame spawning non-player agents. The
+    * EpisodeReady is held until they are all spawned. If zero, they are all
+    * spawned in the first frame.
+    */
+  UPROPERTY(Category = "Level Settings", VisibleAnywhere)
+  float SpawnBudgetPerFrame = 0.0f;
+
   /// @}
   // ===========================================================================
   /// @name Scene Capture
@@ -143,5 +269,14 @@ public:
   UPROPERTY(Category = "Scene Capture", VisibleAnywhere)
   bool bSemanticSegmentationEnabled = false;
 
+  /** Number of frames the images are delayed to read them back from the GPU
+    * asynchronously, without stalling the game thread. Measurements are
+    * delayed accordingly to match their images. If zero, images are read
+    * synchronously, which is slower but bit-exact reproducible. Otherwise it
+    * must be 2, one frame for the GPU copy and one for mapping it.
+    */
+  UPROPERTY(Category = "Scene Capture", VisibleAnywhere, meta = (ClampMax = "2"))
+  uint32 ReadbackLatency = 0u;
+
   /// @}
 };
@@ -0,0 +1,56 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "NonPlayerAgentsFilterDescription.generated.h"
+
+/// Which of the non-player agents are sent to the client. The filters are
+/// combined, an agent is sent only if it passes all of them.
+USTRUCT()
+struct FNonPlayerAgentsFilterDescription
+{
+  GENERATED_USTRUCT_BODY()
+
+  /** Send only the agents within this distance (in centimeters) of the
+    * player. Zero for no limit.
+    */
+  UPROPERTY(Category = "Non-Player Agents Filter", EditDefaultsOnly, meta=(ClampMin = "0.0"))
+  float MaxDistance = 0.0f;
+
+  /** Send at most this number of agents, the closest ones to the player. Zero
+    * for no limit.
+    */
+  UPROPERTY(Category = "Non-Player Agents Filter", EditDefaultsOnly)
+  uint32 MaxCount = 0u;
+
+  /** If not empty, send only the agents that may be visible in the frustum of
+    * the camera with this name.
+    */
+  UPROPERTY(Category = "Non-Player Agents Filter", EditDefaultsOnly)
+  FString FrustumCamera;
+
+  UPROPERTY(Category = "Non-Player Agents Filter", EditDefaultsOnly)
+  bool bVehicles = true;
+
+  UPROPERTY(Category = "Non-Player Agents Filter", EditDefaultsOnly)
+  bool bPedestrians = true;
+
+  UPROPERTY(Category = "Non-Player Agents Filter", EditDefaultsOnly)
+  bool bTrafficLights = true;
+
+  UPROPERTY(Category = "Non-Player Agents Filter", EditDefaultsOnly)
+  bool bSpeedLimitSigns = true;
+
+  /** Whether any agent may be discarded by this filter. */
+  bool IsEnabled() const
+  {
+    return (MaxDistance > 0.0f) ||
+           (MaxCount > 0u) ||
+           !FrustumCamera.IsEmpty() ||
+           !(bVehicles && bPedestrians && bTrafficLights && bSpeedLimitSigns);
+  }
+};
@@ -0,0 +1,106 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "EpisodeStartTimer.h"
+
+#include "HAL/PlatformTime.h"
+
+#include <cstring>
+
+// =============================================================================
+// -- FEpisodeStartTimer::FScopedPhase -----------------------------------------
+// =============================================================================
+
+FEpisodeStartTimer::FScopedPhase::FScopedPhase(
+    FEpisodeStartTimer *InTimer,
+    const ANSICHAR *InName) :
+  Timer(InTimer),
+  Name(InName),
+  BeginSeconds(FPlatformTime::Seconds()) {}
+
+FEpisodeStartTimer::FScopedPhase::~FScopedPhase()
+{
+  if (Timer != nullptr) {
+    Timer->AddPhase(Name, BeginSeconds, FPlatformTime::Seconds());
+  }
+}
+
+// =============================================================================
+// -- FEpisodeStartTimer -------------------------------------------------------
+// =============================================================================
+
+void FEpisodeStartTimer::Start()
+{
+  bIsRunning = true;
+  StartSeconds = FPlatformTime::Seconds();
+  TotalMilliseconds = 0.0;
+  Phases.Reset();
+  PendingPhaseName = nullptr;
+}
+
+void FEpisodeStartTimer::BeginPhase(const ANSICHAR *Name)
+{
+  PendingPhaseName = Name;
+  PendingPhaseBeginSeconds = FPlatformTime::Seconds();
+}
+
+void FEpisodeStartTimer::EndPhase(const ANSICHAR *Name)
+{
+  if ((PendingPhaseName != nullptr) && (std::strcmp(PendingPhaseName, Name) == 0)) {
+    AddPhase(Name, PendingPhaseBeginSeconds, FPlatformTime::Seconds());
+    PendingPhaseName = nullptr;
+  }
+}
+
+void FEpisodeStartTimer::Stop()
+{
+  if (!bIsRunning) {
+    return;
+  }
+  bIsRunning = false;
+  PendingPhaseName = nullptr;
+  TotalMilliseconds = 1e3 * (FPlatformTime::Seconds() - StartSeconds);
+  double Accounted = 0.0;
+  for (const auto &Phase : Phases) {
+    Accounted += Phase.Milliseconds;
+  }
+  Phases.Add({"Other", FMath::Max(0.0, TotalMilliseconds - Accounted)});
+
+  UE_LOG(LogCarlaServer, Log, TEXT("Episode started in %.1f ms:"), TotalMilliseconds);
+  for (const auto &Phase : Phases) {
+    UE_LOG(
+        LogCarlaServer,
+        Log,
+        TEXT("  %-28s %9.1f ms (%4.1f%%)"),
+        ANSI_TO_TCHAR(Phase.Name),
+        Phase.Milliseconds,
+        (TotalMilliseconds > 0.0 ? 100.0 * Phase.Milliseconds / TotalMilliseconds : 0.0));
+  }
+}
+
+void FEpisodeStartTimer::AddPhase(
+    const ANSICHAR *Name,
+    const double BeginSeconds,
+    const double EndSeconds)
+{
+  if (!bIsRunning) {
+    return;
+  }
+  // A phase begun before Start() counts from then on, e.g. when InitGame
+  // waits for the first episode request.
+  const double Milliseconds = 1e3 * (EndSeconds - FMath::Max(BeginSeconds, StartSeconds));
+  if (Milliseconds <= 0.0) {
+    return;
+  }
+  for (auto &Phase : Phases) {
+    if (std::strcmp(Phase.Name, Name) == 0) {
+      Phase.Milliseconds += Milliseconds;
+      return;
+    }
+  }
+  Phases.Add({Name, Milliseconds});
+}
@@ -0,0 +1,90 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+/// Breakdown of the time spent starting an episode, from reading the
+/// RequestNewEpisode to writing the EpisodeReady.
+///
+/// Lives in the game instance, the level may be loaded in between. Phases
+/// with the same name add up; outside Start() and Stop() nothing is recorded,
+/// so the same code can be timed on every call.
+class CARLA_API FEpisodeStartTimer : private NonCopyable
+{
+public:
+
+  struct FPhase
+  {
+    /// Static string, sent as is to the client.
+    const ANSICHAR *Name;
+
+    double Milliseconds;
+  };
+
+  /// Records the lifetime of the scope as a phase of @a Timer, if any.
+  class CARLA_API FScopedPhase : private NonCopyable
+  {
+  public:
+
+    FScopedPhase(FEpisodeStartTimer *InTimer, const ANSICHAR *InName);
+
+    ~FScopedPhase();
+
+  private:
+
+    FEpisodeStartTimer *Timer;
+
+    const ANSICHAR *Name;
+
+    double BeginSeconds;
+  };
+
+  /// Forget the previous episode and start timing a new one.
+  void Start();
+
+  bool IsRunning() const
+  {
+    return bIsRunning;
+  }
+
+  /// Begin a phase ending in a later frame, e.g. loading the level. Only one
+  /// at a time.
+  void BeginPhase(const ANSICHAR *Name);
+
+  /// End the phase begun with the same @a Name, if any.
+  void EndPhase(const ANSICHAR *Name);
+
+  /// Stop timing, add the time not accounted for by any phase as "Other", and
+  /// log the breakdown.
+  void Stop();
+
+  /// Phases of the last episode, in the order they ended.
+  const TArray<FPhase> &GetPhases() const
+  {
+    return Phases;
+  }
+
+  double GetTotalMilliseconds() const
+  {
+    return TotalMilliseconds;
+  }
+
+private:
+
+  void AddPhase(const ANSICHAR *Name, double BeginSeconds, double EndSeconds);
+
+  bool bIsRunning = false;
+
+  double StartSeconds = 0.0;
+
+  double TotalMilliseconds = 0.0;
+
+  TArray<FPhase> Phases;
+
+  const ANSICHAR *PendingPhaseName = nullptr;
+
+  double PendingPhaseBeginSeconds = 0.0;
+};
@@ -8,6 +8,7 @@
 #include "RandomEngine.h"
 
 #include <limits>
+#include <sstream>
 
 int32 URandomEngine::GenerateRandomSeed()
 {
@@ -17,3 +18,20 @@ int32 URandomEngine::GenerateRandomSeed()
       std::numeric_limits<int32>::max());
   return Distribution(RandomDevice);
 }
+
+// The standard engines only expose their state through the stream operators,
+// the state of a minstd_rand is a single number below 2^31.
+static_assert(std::minstd_rand::modulus <= std::numeric_limits<uint32>::max(), "Engine state does not fit");
+
+uint32 URandomEngine::GetState() const
+{
+  std::ostringstream Out;
+  Out << Engine;
+  return static_cast<uint32>(std::stoul(Out.str()));
+}
+
+void URandomEngine::SetState(const uint32 State)
+{
+  std::istringstream In(std::to_string(State));
+  In >> Engine;
+}
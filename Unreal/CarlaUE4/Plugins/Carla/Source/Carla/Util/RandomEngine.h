@@ -31,6 +31,12 @@ public:
     Engine.seed(InSeed);
   }
 
+  /// The state of the engine, to continue the same sequence later with
+  /// SetState (see world snapshots in ACarlaGameModeBase).
+  uint32 GetState() const;
+
+  void SetState(uint32 State);
+
   /// @}
   // ===========================================================================
   /// @name Uniform distribution
@@ -0,0 +1,44 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "SpatialHashGrid.h"
+
+void FSpatialHashGrid::Reset()
+{
+  Locations.Reset();
+  Entries.Reset();
+  BucketStart.Reset();
+}
+
+void FSpatialHashGrid::Build()
+{
+  // About two buckets per location keeps collisions rare.
+  const uint32 NumberOfBuckets =
+      FMath::RoundUpToPowerOfTwo(FMath::Max(2 * Locations.Num(), 16));
+  BucketStart.Reset();
+  BucketStart.AddZeroed(NumberOfBuckets + 1u);
+  Entries.Reset();
+  Entries.AddUninitialized(Locations.Num());
+
+  // Counting sort: count, prefix sum, scatter.
+  for (const FVector &Location : Locations) {
+    ++BucketStart[GetBucket(GetCell(Location)) + 1u];
+  }
+  for (uint32 i = 1u; i <= NumberOfBuckets; ++i) {
+    BucketStart[i] += BucketStart[i - 1u];
+  }
+  // Use the start of each bucket as insertion cursor, restored afterwards.
+  for (int32 Index = 0; Index < Locations.Num(); ++Index) {
+    const FIntPoint Cell = GetCell(Locations[Index]);
+    auto &Cursor = BucketStart[GetBucket(Cell)];
+    Entries[Cursor++] = {Index, Cell};
+  }
+  for (uint32 i = NumberOfBuckets; i > 0u; --i) {
+    BucketStart[i] = BucketStart[i - 1u];
+  }
+  BucketStart[0u] = 0;
+}
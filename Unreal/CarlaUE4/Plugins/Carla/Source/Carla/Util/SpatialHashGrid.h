@@ -0,0 +1,148 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+/// Uniform grid over the XY plane, hashed into a fixed number of buckets so
+/// it does not depend on the size of the map.
+///
+/// Locations are added in order and identified by their index, then Build()
+/// sorts them into buckets in linear time. The memory is kept between builds,
+/// rebuilding the grid every tick does not allocate once it reached its
+/// maximum size.
+class CARLA_API FSpatialHashGrid
+{
+public:
+
+  explicit FSpatialHashGrid(float InCellSize = 5000.0f) : CellSize(InCellSize) {}
+
+  float GetCellSize() const
+  {
+    return CellSize;
+  }
+
+  /// Number of locations added.
+  int32 Num() const
+  {
+    return Locations.Num();
+  }
+
+  const FVector &GetLocation(int32 Index) const
+  {
+    return Locations[Index];
+  }
+
+  /// Remove every location, keeping the memory.
+  void Reset();
+
+  /// Add a location, returns its index.
+  int32 Add(const FVector &Location)
+  {
+    return Locations.Add(Location);
+  }
+
+  /// Sort the locations added since the last Reset() into their cells. Needs
+  /// to be called before querying.
+  void Build();
+
+  /// Call @a Callback(Index, DistanceSquared) for every location within
+  /// @a Radius of @a Center. Only the cells overlapping the query are visited.
+  template <typename F>
+  void ForEachInRadius(const FVector &Center, float Radius, F &&Callback) const
+  {
+    const float RadiusSquared = Radius * Radius;
+    ForEachInBox(Center - FVector(Radius), Center + FVector(Radius), [&](int32 Index) {
+      const float DistanceSquared = FVector::DistSquared(Locations[Index], Center);
+      if (DistanceSquared <= RadiusSquared) {
+        Callback(Index, DistanceSquared);
+      }
+    });
+  }
+
+  /// Call @a Callback(Index, DistanceSquared) for every location within
+  /// @a Radius of the segment from @a Start to @a End, with the squared
+  /// distance to the segment.
+  template <typename F>
+  void ForEachAlongSegment(const FVector &Start, const FVector &End, float Radius, F &&Callback) const
+  {
+    const float RadiusSquared = Radius * Radius;
+    const FVector Min = Start.ComponentMin(End) - FVector(Radius);
+    const FVector Max = Start.ComponentMax(End) + FVector(Radius);
+    ForEachInBox(Min, Max, [&](int32 Index) {
+      const float DistanceSquared = FMath::PointDistToSegmentSquared(Locations[Index], Start, End);
+      if (DistanceSquared <= RadiusSquared) {
+        Callback(Index, DistanceSquared);
+      }
+    });
+  }
+
+private:
+
+  /// Call @a Callback(Index) for every location in the cells overlapping the
+  /// box from @a Min to @a Max (in XY), locations outside the box may be
+  /// visited too.
+  template <typename F>
+  void ForEachInBox(const FVector &Min, const FVector &Max, F &&Callback) const
+  {
+    const FIntPoint MinCell = GetCell(Min);
+    const FIntPoint MaxCell = GetCell(Max);
+    const int64 NumberOfCells =
+        static_cast<int64>(MaxCell.X - MinCell.X + 1) * static_cast<int64>(MaxCell.Y - MinCell.Y + 1);
+    if (NumberOfCells >= BucketStart.Num()) {
+      // The query covers the whole table, a linear scan is cheaper.
+      for (int32 Index = 0; Index < Locations.Num(); ++Index) {
+        Callback(Index);
+      }
+      return;
+    }
+    for (int32 X = MinCell.X; X <= MaxCell.X; ++X) {
+      for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y) {
+        const FIntPoint Cell(X, Y);
+        const uint32 Bucket = GetBucket(Cell);
+        for (int32 i = BucketStart[Bucket]; i < BucketStart[Bucket + 1u]; ++i) {
+          // Several cells may share a bucket, skip the ones of other cells so
+          // every location is visited once.
+          if (Entries[i].Cell == Cell) {
+            Callback(Entries[i].Index);
+          }
+        }
+      }
+    }
+  }
+
+  struct FEntry
+  {
+    int32 Index;
+
+    FIntPoint Cell;
+  };
+
+  FIntPoint GetCell(const FVector &Location) const
+  {
+    return {
+      FMath::FloorToInt(Location.X / CellSize),
+      FMath::FloorToInt(Location.Y / CellSize)};
+  }
+
+  uint32 GetBucket(const FIntPoint &Cell) const
+  {
+    const uint32 Hash =
+        (static_cast<uint32>(Cell.X) * 73856093u) ^
+        (static_cast<uint32>(Cell.Y) * 19349663u);
+    return Hash & (static_cast<uint32>(BucketStart.Num()) - 2u);
+  }
+
+  const float CellSize;
+
+  TArray<FVector> Locations;
+
+  /// Entries sorted by bucket.
+  TArray<FEntry> Entries;
+
+  /// Index in Entries of the first entry of each bucket, plus one past the
+  /// end. Its size is always a power of two plus one.
+  TArray<int32> BucketStart;
+};
@@ -0,0 +1,112 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "SpatialHashGrid.h"
+
+// Micro-benchmark of FSpatialHashGrid, run it from the console with
+//
+//   carla.BenchmarkSpatialIndex [MaxNumberOfActors]
+//
+// It simulates the per-tick work of the AI with the index: actors spread over
+// a 2x2 km map are moved and re-indexed, then every actor queries its
+// surroundings (a walker's sight radius) and the path ahead (a vehicle's
+// obstacle detection). The same queries by brute force are measured too.
+
+static constexpr float MAP_SIZE = 200000.0f;
+static constexpr float SIGHT_RADIUS = 500.0f;
+static constexpr float PATH_LENGTH = 5000.0f;
+static constexpr float PATH_RADIUS = 400.0f;
+static constexpr int32 NUMBER_OF_TICKS = 50;
+
+struct FSpatialHashGridBenchmarkResult
+{
+  double BuildMilliseconds = 0.0;
+
+  double QueriesMilliseconds = 0.0;
+
+  double BruteForceMilliseconds = 0.0;
+
+  int64 Hits = 0;
+};
+
+static FSpatialHashGridBenchmarkResult RunSpatialHashGridBenchmark(const int32 NumberOfActors)
+{
+  FRandomStream Random(NumberOfActors);
+  TArray<FVector> Locations;
+  TArray<FVector> Directions;
+  for (int32 i = 0; i < NumberOfActors; ++i) {
+    Locations.Add({Random.FRandRange(0.0f, MAP_SIZE), Random.FRandRange(0.0f, MAP_SIZE), 0.0f});
+    Directions.Add(FVector(Random.FRandRange(-1.0f, 1.0f), Random.FRandRange(-1.0f, 1.0f), 0.0f).GetSafeNormal());
+  }
+
+  FSpatialHashGridBenchmarkResult Result;
+  FSpatialHashGrid Grid;
+  int64 BruteForceHits = 0;
+  for (int32 Tick = 0; Tick < NUMBER_OF_TICKS; ++Tick) {
+    for (int32 i = 0; i < NumberOfActors; ++i) {
+      Locations[i] += Directions[i] * 100.0f;
+    }
+
+    const double Start = FPlatformTime::Seconds();
+    Grid.Reset();
+    for (const FVector &Location : Locations) {
+      Grid.Add(Location);
+    }
+    Grid.Build();
+    const double Built = FPlatformTime::Seconds();
+    for (int32 i = 0; i < NumberOfActors; ++i) {
+      auto Count = [&](int32 Index, float) { Result.Hits += (Index != i ? 1 : 0); };
+      Grid.ForEachInRadius(Locations[i], SIGHT_RADIUS, Count);
+      Grid.ForEachAlongSegment(Locations[i], Locations[i] + Directions[i] * PATH_LENGTH, PATH_RADIUS, Count);
+    }
+    const double Queried = FPlatformTime::Seconds();
+    for (int32 i = 0; i < NumberOfActors; ++i) {
+      const FVector End = Locations[i] + Directions[i] * PATH_LENGTH;
+      for (int32 j = 0; j < NumberOfActors; ++j) {
+        if (j != i) {
+          BruteForceHits += (FVector::DistSquared(Locations[j], Locations[i]) <= SIGHT_RADIUS * SIGHT_RADIUS ? 1 : 0);
+          BruteForceHits += (FMath::PointDistToSegmentSquared(Locations[j], Locations[i], End) <= PATH_RADIUS * PATH_RADIUS ? 1 : 0);
+        }
+      }
+    }
+    const double BruteForced = FPlatformTime::Seconds();
+
+    Result.BuildMilliseconds += 1e3 * (Built - Start);
+    Result.QueriesMilliseconds += 1e3 * (Queried - Built);
+    Result.BruteForceMilliseconds += 1e3 * (BruteForced - Queried);
+  }
+  check(BruteForceHits == Result.Hits);
+  Result.BuildMilliseconds /= NUMBER_OF_TICKS;
+  Result.QueriesMilliseconds /= NUMBER_OF_TICKS;
+  Result.BruteForceMilliseconds /= NUMBER_OF_TICKS;
+  Result.Hits /= NUMBER_OF_TICKS;
+  return Result;
+}
+
+static void BenchmarkSpatialHashGrid(const TArray<FString> &Args)
+{
+  const int32 MaxNumberOfActors = (Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 4000);
+  UE_LOG(LogCarla, Log, TEXT("Spatial index benchmark, average per tick over %d ticks"), NUMBER_OF_TICKS);
+  UE_LOG(LogCarla, Log, TEXT("  Actors   Build (ms)   Queries (ms)   Brute force (ms)   Hits"));
+  for (int32 NumberOfActors = 125; NumberOfActors <= MaxNumberOfActors; NumberOfActors *= 2) {
+    const auto Result = RunSpatialHashGridBenchmark(NumberOfActors);
+    UE_LOG(
+        LogCarla,
+        Log,
+        TEXT("  %6d   %10.3f   %12.3f   %16.3f   %lld"),
+        NumberOfActors,
+        Result.BuildMilliseconds,
+        Result.QueriesMilliseconds,
+        Result.BruteForceMilliseconds,
+        Result.Hits);
+  }
+}
+
+static FAutoConsoleCommand BenchmarkSpatialHashGridCommand(
+    TEXT("carla.BenchmarkSpatialIndex"),
+    TEXT("Measure the per-tick cost of the spatial index of dynamic actors against brute force, for a growing number of actors."),
+    FConsoleCommandWithArgsDelegate::CreateStatic(BenchmarkSpatialHashGrid));
@@ -28,11 +28,27 @@ extern "C" {
     float z;
   };
 
+#define CARLA_SERVER_IMAGE_COMPRESSION_NONE     0u
+#define CARLA_SERVER_IMAGE_COMPRESSION_DEFLATE  1u
+
   struct carla_image {
     uint32_t width;
     uint32_t height;
     uint32_t type;
     const uint32_t *data;
+    /** One of CARLA_SERVER_IMAGE_COMPRESSION_*. Images are compressed
+      * losslessly in the networking thread, never in the caller's thread. */
+    uint32_t compression;
+  };
+
+  /** An image whose pixel data is owned by the caller. The server does not
+    * copy the data, it keeps a reference to it until the image has been written
+    * to the socket (or discarded), and then calls release(user_data).
+    */
+  struct carla_image_lease {
+    struct carla_image image;
+    void (*release)(void *user_data);
+    void *user_data;
   };
 
   struct carla_transform {
@@ -101,8 +117,57 @@ extern "C" {
   /* -- carla_episode_ready ------------------------------------------------- */
   /* ======================================================================== */
 
+  struct carla_episode_phase {
+    /** Null-terminated name of the phase. */
+    const char *name;
+    float milliseconds;
+  };
+
+  /** @warning the phases are copied on carla_write_episode_ready, the array
+    * can be deleted afterwards.
+    */
   struct carla_episode_ready {
     bool ready;
+    /** If greater than zero, each image is sent through its own stream instead
+      * of together with the measurements. */
+    uint32_t number_of_sensor_streams;
+    /** If greater than zero, the measurements and sensor streams are written
+      * to shared memory rings of this many bytes, for clients running on the
+      * same machine (not supported on Windows). */
+    uint32_t shared_memory_capacity;
+    /** Time spent in each phase of starting the episode, reported to the
+      * client. */
+    const carla_episode_phase *phases;
+    uint32_t number_of_phases;
+  };
+
+  /* ======================================================================== */
+  /* -- carla_world_snapshot_request ---------------------------------------- */
+  /* ======================================================================== */
+
+  /** @warning the snapshot to restore is statically allocated inside
+    * CarlaServer, same as the ini file of carla_request_new_episode, it might
+    * be deleted on subsequent requests.
+    *
+    * Do NOT delete the char array.
+    */
+  struct carla_world_snapshot_request {
+    /** If false, save the state of the world, otherwise restore it. */
+    bool restore;
+    /** The state to restore, as previously saved. */
+    const char *snapshot;
+    uint32_t snapshot_size;
+  };
+
+  /* ======================================================================== */
+  /* -- carla_world_snapshot ------------------------------------------------ */
+  /* ======================================================================== */
+
+  struct carla_world_snapshot {
+    bool success;
+    /** The state saved, opaque to the client. Ignored when restoring. */
+    const char *snapshot;
+    uint32_t snapshot_size;
   };
 
   /* ======================================================================== */
@@ -156,6 +221,12 @@ extern "C" {
     /** Non-player agents. */
     const struct carla_agent *non_player_agents;
     uint32_t number_of_non_player_agents;
+    /** Time-stamp (see carla_get_timestamp) at which the game ticked this
+      * frame, zero if unknown. */
+    uint64_t tick_timestamp;
+    /** Time-stamp (see carla_get_timestamp) at which the images of this frame
+      * were read back, zero if unknown. */
+    uint64_t readback_timestamp;
   };
 
   /* ======================================================================== */
@@ -178,6 +249,7 @@ extern "C" {
   CARLA_SERVER_API const int32_t CARLA_SERVER_TRY_AGAIN;
   CARLA_SERVER_API const int32_t CARLA_SERVER_TIMED_OUT;
   CARLA_SERVER_API const int32_t CARLA_SERVER_OPERATION_ABORTED;
+  CARLA_SERVER_API const int32_t CARLA_SERVER_NOT_DUE;
 
   /* -- Creation and destruction -------------------------------------------- */
 
@@ -214,7 +286,10 @@ extern "C" {
   /* -- Write and read functions -------------------------------------------- */
 
   /** If the new episode request is received, blocks until the agent server is
-    * terminated.
+    * terminated. Unless the client asked to keep its agent connections, then
+    * the agent server keeps running until the episode is ready. Returns
+    * CARLA_SERVER_TRY_AGAIN while a world snapshot request is pending instead
+    * (see carla_read_world_snapshot_request).
     */
   CARLA_SERVER_API int32_t carla_read_request_new_episode(
       CarlaServerPtr self,
@@ -231,15 +306,150 @@ extern "C" {
       carla_episode_start &values,
       uint32_t timeout_milliseconds);
 
-  /** This launches the agent server. */
+  /** While an episode is running, the client may ask to save the state of the
+    * world, or to restore a state saved earlier in the same level, instead of
+    * requesting a new episode. The request is answered with
+    * carla_write_world_snapshot before any other is read.
+    *
+    * Return values:
+    *   CARLA_SERVER_SUCCESS A request was read.
+    *   CARLA_SERVER_TRY_AGAIN No request was received, or the client
+    *     requested a new episode instead.
+    */
+  CARLA_SERVER_API int32_t carla_read_world_snapshot_request(
+      CarlaServerPtr self,
+      carla_world_snapshot_request &values,
+      uint32_t timeout_milliseconds);
+
+  /** Reply to the last carla_world_snapshot_request. After a successful
+    * restore, the agent server discards the controls replying to frames
+    * written before, and the client is told to discard their measurements.
+    */
+  CARLA_SERVER_API int32_t carla_write_world_snapshot(
+      CarlaServerPtr self,
+      const carla_world_snapshot &values,
+      uint32_t timeout_milliseconds);
+
+  /** Configure the buffering of the streams sent to the agent, takes effect
+    * when the next agent server is launched. Each stream keeps up to depth
+    * frames not yet sent. When the buffer is full the oldest frame is dropped,
+    * or, if block_when_full is true, writing measurements waits up to the
+    * server time-out for the client to catch up. By default depth is 1 and
+    * only the latest frame is kept.
+    */
+  CARLA_SERVER_API void carla_set_stream_buffering(
+      CarlaServerPtr self,
+      uint32_t depth,
+      bool block_when_full);
+
+  /** Configure the synchronous mode, takes effect when the next agent server
+    * is launched. With a lookahead of zero (default) carla_read_control
+    * returns the latest control received. With a lookahead of K frames the
+    * server runs pipelined: each control is tagged with the frame of the
+    * measurements it replies to, and after the measurements of frame N are
+    * written carla_read_control returns the control replying to frame N - K,
+    * waiting for it if necessary. The simulation may thus run up to K frames
+    * ahead of the client while every control is still applied at the same
+    * frame. The streams keep at least K + 1 frames.
+    */
+  CARLA_SERVER_API void carla_set_control_lookahead(
+      CarlaServerPtr self,
+      uint32_t lookahead);
+
+  /** Configure how the non-player agents are encoded in the measurements,
+    * takes effect when the next agent server is launched. If compact is true,
+    * the agents are sent packed in the "non_player_agents_snapshot" field:
+    * static agents are sent once per episode and the rest as arrays of
+    * positions, orientations and speeds. If quantize is true too, these
+    * arrays are quantized and delta encoded between frames. By default agents
+    * are sent as protobuf messages in "non_player_agents".
+    */
+  CARLA_SERVER_API void carla_set_non_player_agents_encoding(
+      CarlaServerPtr self,
+      bool compact,
+      bool quantize);
+
+  /** Accept read-only observers of the agent streams, takes effect when the
+    * next agent server is launched. Up to max_observers clients per stream
+    * may connect and receive a copy of the measurements at port, and of the
+    * data of sensor stream i at port (port + 1 + i). Frames are encoded once
+    * for every client. Each observer has up to buffer_depth frames queued,
+    * when full it misses frames or, if disconnect_slow is true, it is
+    * disconnected; the controlling client is never slowed down. A port of 0
+    * disables the observers (default).
+    */
+  CARLA_SERVER_API void carla_set_observers(
+      CarlaServerPtr self,
+      uint32_t port,
+      uint32_t max_observers,
+      uint32_t buffer_depth,
+      bool disconnect_slow);
+
+  /** Configure the threads shared by every CARLA server instance of the
+    * process. These threads are started on demand and never destroyed, so
+    * episodes reuse them. number_of_threads is the minimum number of threads
+    * started (the pool grows if the servers need more threads running at the
+    * same time), cpus is a list of number_of_cpus CPU indices the threads
+    * are pinned to, or null to let them run on any CPU. Can be called at any
+    * time, ideally before the first server is created.
+    */
+  CARLA_SERVER_API void carla_set_server_threads(
+      uint32_t number_of_threads,
+      const uint32_t *cpus,
+      uint32_t number_of_cpus);
+
+  /** Nanoseconds of the monotonic clock used to time-stamp the stages each
+    * frame goes through (see carla_measurements). Only the differences
+    * between time-stamps are meaningful.
+    */
+  CARLA_SERVER_API uint64_t carla_get_timestamp();
+
+  /** Enable or disable the profiler of the library, process-wide. While
+    * enabled, the duration of every profiled scope (networking, encoding, C
+    * API calls) is recorded in a latency histogram. If trace is true too,
+    * every thread keeps the last scopes it ran for
+    * carla_write_profiler_trace. Disabled by default.
+    */
+  CARLA_SERVER_API void carla_set_profiler(bool enabled, bool trace);
+
+  /** Print the latency percentiles of every scope profiled since the last
+    * call, and reset them.
+    */
+  CARLA_SERVER_API void carla_print_profiler_summary();
+
+  /** Write to file_path the scopes run in the last milliseconds, as Chrome
+    * trace-event JSON (see chrome://tracing or Perfetto).
+    *
+    * Return values:
+    *   CARLA_SERVER_SUCCESS The trace was written.
+    *   Otherwise the error code of the failure, e.g. the file could not be
+    *     written.
+    */
+  CARLA_SERVER_API int32_t carla_write_profiler_trace(
+      const char *file_path,
+      uint32_t milliseconds);
+
+  /** This launches the agent server. If values.number_of_sensor_streams is
+    * greater than zero, each image is sent through its own stream at port
+    * (world_port + 3 + image index). If values.shared_memory_capacity is
+    * greater than zero, these streams only send notifications through the
+    * socket, the data is written to shared memory.
+    *
+    * If the client asked to keep its agent connections and the streams are
+    * the same as the previous episode's, the agent server is kept instead, and
+    * the client told so; frame numbers keep counting across episodes. */
   CARLA_SERVER_API int32_t carla_write_episode_ready(
       CarlaServerPtr self,
       const carla_episode_ready &values,
       const uint32_t timeout);
 
-  /** Return values:
+  /** Read the control to apply this frame (see carla_set_control_lookahead).
+    *
+    * Return values:
     *   CARLA_SERVER_SUCCESS A value was readed.
     *   CARLA_SERVER_TRY_AGAIN Nothing received yet.
+    *   CARLA_SERVER_NOT_DUE No control is due this frame, or the client
+    *     skipped it; returned right away, waiting longer would not help.
     *   CARLA_SERVER_OPERATION_ABORTED Agent server is missing.
     */
   CARLA_SERVER_API int32_t carla_read_control(
@@ -257,6 +467,23 @@ extern "C" {
       const struct carla_image *images,
       uint32_t number_of_images);
 
+  /** Same as carla_write_measurements, but the pixel data of the images is not
+    * copied. The data of each image must be kept alive and unmodified until the
+    * server calls the release callback of its lease.
+    *
+    * The release callback is called exactly once per lease, also if this
+    * function fails, and it may be called from a different thread.
+    *
+    * Return values:
+    *   CARLA_SERVER_SUCCESS Value was posted for sending.
+    *   CARLA_SERVER_OPERATION_ABORTED Agent server is missing.
+    */
+  CARLA_SERVER_API int32_t carla_write_measurements_zero_copy(
+      CarlaServerPtr self,
+      const carla_measurements &values,
+      const struct carla_image_lease *images,
+      uint32_t number_of_images);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "carla/LatencyHistogram.h"
+#include "carla/NonCopyable.h"
+#include "carla/Profiler.h"
+
+namespace carla {
+namespace benchmark {
+
+  /// Latency of one operation measured by a benchmark, in nanoseconds.
+  struct Result {
+    std::string name;
+    LatencyHistogram latency;
+    /// Bytes processed per operation, zero if it does not apply.
+    uint64_t bytes_per_operation = 0u;
+  };
+
+  /// Passed to every benchmark to measure and report its results.
+  class Runner : private NonCopyable {
+  public:
+
+    /// With @a quick, benchmarks run fewer iterations (see Iterations).
+    explicit Runner(bool quick) : _quick(quick) {}
+
+    /// Number of iterations to run, @a iterations scaled down if quick.
+    size_t Iterations(size_t iterations) const {
+      return _quick ? std::max<size_t>(1u, iterations / 10u) : iterations;
+    }
+
+    /// Time every one of Iterations(@a iterations) calls to @a operation,
+    /// after a few not timed to warm up, and report them as @a name.
+    template <typename F>
+    void Measure(const std::string &name, size_t iterations, uint64_t bytes_per_operation, F &&operation) {
+      iterations = Iterations(iterations);
+      for (auto i = 0u; i < std::max<size_t>(1u, iterations / 10u); ++i) {
+        operation();
+      }
+      Result result;
+      result.name = name;
+      result.bytes_per_operation = bytes_per_operation;
+      for (auto i = 0u; i < iterations; ++i) {
+        const auto begin = Profiler::Now();
+        operation();
+        result.latency.Add(Profiler::Now() - begin);
+      }
+      Report(std::move(result));
+    }
+
+    /// Report a result measured by the benchmark itself.
+    void Report(Result result);
+
+    const std::vector<Result> &results() const {
+      return _results;
+    }
+
+  private:
+
+    const bool _quick;
+
+    std::vector<Result> _results;
+  };
+
+  using BenchmarkFunction = std::function<void(Runner &)>;
+
+  struct RegisteredBenchmark {
+    const char *name;
+    BenchmarkFunction function;
+  };
+
+  /// Benchmarks registered so far, in order of registration.
+  std::vector<RegisteredBenchmark> &GetRegisteredBenchmarks();
+
+  /// Registers a benchmark to be run by main, see CARLA_BENCHMARK.
+  class Registration : private NonCopyable {
+  public:
+
+    Registration(const char *name, BenchmarkFunction function) {
+      GetRegisteredBenchmarks().push_back({name, std::move(function)});
+    }
+  };
+
+} // namespace benchmark
+} // namespace carla
+
+/// Define a benchmark, registered before main runs.
+#define CARLA_BENCHMARK(name) \
+    static void carla_benchmark_ ## name(::carla::benchmark::Runner &runner); \
+    static const ::carla::benchmark::Registration carla_benchmark_ ## name ## _registration( \
+        #name, carla_benchmark_ ## name); \
+    static void carla_benchmark_ ## name(::carla::benchmark::Runner &runner)
@@ -0,0 +1,101 @@
+#include "Benchmark.h"
+
+#include <carla/server/CarlaEncoder.h>
+#include <carla/server/FrameReader.h>
+#include <carla/server/MeasurementsEncoder.h>
+#include <carla/server/Protobuf.h>
+#include <carla/server/carla_server.pb.h>
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace carla::benchmark;
+using namespace carla::server;
+
+/// The encoder caches its messages per thread, so a single one is used.
+static CarlaEncoder &GetEncoder() {
+  static CarlaEncoder encoder;
+  return encoder;
+}
+
+static std::vector<carla_agent> MakeAgents(uint32_t count) {
+  std::vector<carla_agent> agents(count);
+  for (auto i = 0u; i < count; ++i) {
+    auto &agent = agents[i];
+    agent.id = i + 1u;
+    agent.type = (i % 2u == 0u ? CARLA_SERVER_AGENT_VEHICLE : CARLA_SERVER_AGENT_PEDESTRIAN);
+    agent.transform.location = {1.0f * i, 2.0f * i, 0.5f};
+    agent.transform.orientation = {1.0f, 0.0f, 0.0f};
+    agent.box_extent = {2.0f, 1.0f, 1.5f};
+    agent.forward_speed = 0.1f * i;
+  }
+  return agents;
+}
+
+/// Measurements encoded in a single message, and split among the workers of
+/// a MeasurementsEncoder, by number of non-player agents.
+CARLA_BENCHMARK(MeasurementsEncoding) {
+  for (auto count : {0u, 100u, 1000u, 10000u}) {
+    const auto agents = MakeAgents(count);
+    carla_measurements values = {};
+    values.non_player_agents = agents.data();
+    values.number_of_non_player_agents = count;
+    const auto iterations = (count < 1000u ? 10000u : 500u);
+    auto &encoder = GetEncoder();
+    const auto size = encoder.Encode(values, 1u).size();
+    runner.Measure("CarlaEncoder.Encode/" + std::to_string(count) + "_agents", iterations, size, [&]() {
+      encoder.Encode(values, 1u);
+    });
+    MeasurementsEncoder measurements_encoder;
+    std::vector<const_buffer> sequence;
+    runner.Measure("MeasurementsEncoder.Encode/" + std::to_string(count) + "_agents", iterations, size, [&]() {
+      sequence.clear();
+      measurements_encoder.Encode(values, 1u, FrameTimestamps(), sequence);
+    });
+  }
+}
+
+/// Decoding a control message in place, as the control stream does.
+CARLA_BENCHMARK(ControlDecoding) {
+  carla_server::Control control;
+  control.set_steer(0.5f);
+  control.set_throttle(1.0f);
+  control.set_frame_number(42u);
+  const auto message = control.SerializeAsString();
+  const auto view = carla::array_view::make_const(message.data(), message.size());
+  ControlMessage values;
+  runner.Measure("CarlaEncoder.Decode/control", 100000u, message.size(), [&]() {
+    GetEncoder().Decode(view, values);
+  });
+}
+
+/// Receiving and decoding a control message as the control stream reads it,
+/// in place from the read-ahead buffer of a FrameReader, and as the previous
+/// implementation did, reading the size and the message separately into a
+/// new buffer copied into a string.
+CARLA_BENCHMARK(ControlStreamDecoding) {
+  carla_server::Control control;
+  control.set_steer(0.5f);
+  control.set_throttle(1.0f);
+  control.set_brake(0.25f);
+  control.set_reverse(true);
+  const auto frame = Protobuf::Encode(control);
+  ControlMessage values;
+  runner.Measure("ControlStream.Decode/copying", 100000u, frame.size(), [&]() {
+    uint32_t size;
+    std::memcpy(&size, frame.data(), sizeof(size));
+    auto buffer = std::make_unique<char[]>(size);
+    std::memcpy(buffer.get(), frame.data() + sizeof(size), size);
+    const std::string message(buffer.get(), size);
+    GetEncoder().Decode(carla::array_view::make_const(message.data(), message.size()), values);
+  });
+  FrameReader reader;
+  runner.Measure("ControlStream.Decode/in_place", 100000u, frame.size(), [&]() {
+    auto buffer = reader.Prepare();
+    std::memcpy(boost::asio::buffer_cast<char *>(buffer), frame.data(), frame.size());
+    reader.Commit(frame.size());
+    GetEncoder().Decode(reader.Pop(), values);
+  });
+}
@@ -0,0 +1,65 @@
+#include "Benchmark.h"
+
+#include <carla/server/DoubleBuffer.h>
+
+#include <atomic>
+#include <thread>
+
+using namespace carla::benchmark;
+using namespace carla::server;
+using carla::Profiler;
+
+static const auto TIMEOUT = timeout_t::milliseconds(1000u);
+
+/// Latency from the writer releasing a value to the reader getting it. The
+/// writer writes its time-stamp, and waits for the reader before writing the
+/// next one (idle), or writes as fast as it can (contended).
+CARLA_BENCHMARK(DoubleBuffer) {
+  const auto iterations = runner.Iterations(100000u);
+  {
+    DoubleBuffer<uint64_t> buffer;
+    std::atomic<uint64_t> read{0u};
+    std::thread writer([&]() {
+      for (uint64_t i = 0u; i < iterations; ++i) {
+        *buffer.MakeWriter() = Profiler::Now();
+        while ((read.load() <= i) && !buffer.done()) {
+          std::this_thread::yield();
+        }
+      }
+    });
+    Result result;
+    result.name = "DoubleBuffer.Handoff/idle";
+    while (read.load() < iterations) {
+      auto reader = buffer.TryMakeReader(TIMEOUT);
+      if (reader == nullptr) {
+        break;
+      }
+      result.latency.Add(Profiler::Now() - *reader);
+      ++read;
+    }
+    buffer.set_done();
+    writer.join();
+    runner.Report(std::move(result));
+  }
+  {
+    DoubleBuffer<uint64_t> buffer;
+    std::atomic_bool done{false};
+    std::thread writer([&]() {
+      while (!done) {
+        *buffer.MakeWriter() = Profiler::Now();
+      }
+    });
+    Result result;
+    result.name = "DoubleBuffer.Handoff/contended";
+    for (auto i = 0u; i < iterations; ++i) {
+      auto reader = buffer.TryMakeReader(TIMEOUT);
+      if (reader == nullptr) {
+        break;
+      }
+      result.latency.Add(Profiler::Now() - *reader);
+    }
+    done = true;
+    writer.join();
+    runner.Report(std::move(result));
+  }
+}
@@ -0,0 +1,105 @@
+#include "Benchmark.h"
+#include "test/Loopback.h"
+
+#include <carla/server/AgentServer.h>
+#include <carla/server/CarlaEncoder.h>
+#include <carla/server/carla_server.pb.h>
+
+#include <boost/asio/read.hpp>
+
+#include <memory>
+#include <string>
+
+using namespace carla::benchmark;
+using namespace carla::server;
+using carla::Profiler;
+using boost::asio::ip::tcp;
+
+static constexpr uint32_t PORT = 4160u;
+static const auto TIMEOUT = boost::posix_time::seconds(10);
+
+/// Client of the measurements and control streams of an AgentServer.
+class AgentClient {
+public:
+
+  explicit AgentClient(uint32_t port)
+    : _measurements(Connect(port)),
+      _control(Connect(port + 1u)) {}
+
+  /// Read measurements until those of @a frame_number, the rest are from the
+  /// previous episode.
+  void ReadUntil(uint64_t frame_number) {
+    carla_server::Measurements measurements;
+    do {
+      uint32_t size = 0u;
+      boost::asio::read(_measurements, boost::asio::buffer(&size, sizeof(size)));
+      _data.resize(size);
+      boost::asio::read(_measurements, boost::asio::buffer(&_data[0], size));
+      measurements.ParseFromString(_data);
+    } while (measurements.frame_number() < frame_number);
+  }
+
+private:
+
+  /// Retries right away, the Python client waits a second between attempts.
+  tcp::socket Connect(uint32_t port) {
+    return ConnectLoopback(_service, port, std::chrono::microseconds(100));
+  }
+
+  boost::asio::io_service _service;
+
+  tcp::socket _measurements;
+
+  tcp::socket _control;
+
+  std::string _data;
+};
+
+static void WriteFrame(AgentServer &server) {
+  const carla_measurements measurements{};
+  server.WriteMeasurements(measurements, carla::const_array_view<carla_image>());
+}
+
+/// From the new episode being requested to the client receiving its first
+/// measurements, the level load aside. Either the agent server is destroyed
+/// and the client connects to a new one, or the agent server starts a new
+/// episode on the same connections.
+CARLA_BENCHMARK(EpisodeReset) {
+  CarlaEncoder encoder;
+  const auto iterations = runner.Iterations(200u);
+  {
+    StreamSettings settings;
+    Result result;
+    result.name = "EpisodeReset/reconnect";
+    std::unique_ptr<AgentServer> server;
+    std::unique_ptr<AgentClient> client;
+    for (auto i = 0u; i < iterations; ++i) {
+      const auto begin = Profiler::Now();
+      client = nullptr;
+      server = nullptr;
+      server = std::make_unique<AgentServer>(encoder, PORT, PORT + 1u, PORT + 2u, settings, TIMEOUT);
+      client = std::make_unique<AgentClient>(PORT);
+      WriteFrame(*server);
+      client->ReadUntil(1u);
+      result.latency.Add(Profiler::Now() - begin);
+    }
+    client = nullptr;
+    runner.Report(std::move(result));
+  }
+  {
+    StreamSettings settings;
+    settings.keep_connections = true;
+    Result result;
+    result.name = "EpisodeReset/keep_connections";
+    AgentServer server(encoder, PORT + 3u, PORT + 4u, PORT + 5u, settings, TIMEOUT);
+    AgentClient client(PORT + 3u);
+    for (auto i = 0u; i < iterations; ++i) {
+      const auto begin = Profiler::Now();
+      const auto first_frame_number = server.StartEpisode();
+      WriteFrame(server);
+      client.ReadUntil(first_frame_number);
+      result.latency.Add(Profiler::Now() - begin);
+    }
+    runner.Report(std::move(result));
+  }
+}
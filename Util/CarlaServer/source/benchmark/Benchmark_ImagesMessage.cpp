@@ -0,0 +1,31 @@
+#include "Benchmark.h"
+
+#include <carla/server/ImagesMessage.h>
+
+#include <string>
+#include <vector>
+
+using namespace carla::benchmark;
+using namespace carla::server;
+
+/// Copying the images into the message, as carla_write_measurements does.
+CARLA_BENCHMARK(ImagesMessage) {
+  const std::pair<uint32_t, uint32_t> sizes[] = {{320u, 240u}, {800u, 600u}, {1920u, 1080u}};
+  for (auto count : {1u, 4u}) {
+    for (const auto &size : sizes) {
+      const uint32_t width = size.first;
+      const uint32_t height = size.second;
+      const std::vector<uint32_t> data(width * height, 0xFF808080u);
+      std::vector<carla_image> images(count);
+      for (auto &image : images) {
+        image = {width, height, 1u, data.data(), CARLA_SERVER_IMAGE_COMPRESSION_NONE};
+      }
+      ImagesMessage message;
+      runner.Measure(
+          "ImagesMessage.Write/" + std::to_string(count) + "x" + std::to_string(width) + "x" + std::to_string(height),
+          200u,
+          count * data.size() * sizeof(uint32_t),
+          [&]() { message.Write(carla::array_view::make_const(images.data(), images.size())); });
+    }
+  }
+}
@@ -0,0 +1,45 @@
+#include "Benchmark.h"
+#include "test/Loopback.h"
+
+#include <carla/server/TCPServer.h>
+
+#include <boost/asio/read.hpp>
+
+#include <memory>
+#include <string>
+#include <thread>
+
+using namespace carla::benchmark;
+using namespace carla::server;
+using boost::asio::ip::tcp;
+
+static constexpr uint32_t PORT = 4150u;
+static const auto TIMEOUT = boost::posix_time::seconds(10);
+
+/// Writes of the server to a client reading as fast as it can, by message
+/// size.
+CARLA_BENCHMARK(TCPServer) {
+  std::thread client([]() {
+    boost::asio::io_service service;
+    auto socket = ConnectLoopback(service, PORT);
+    boost::system::error_code ec;
+    auto buffer = std::make_unique<char[]>(1u << 20u);
+    while (!ec) {
+      socket.read_some(boost::asio::buffer(buffer.get(), 1u << 20u), ec);
+    }
+  });
+  {
+    // Closes the connection on destruction, which lets the client finish.
+    TCPServer server;
+    if (!server.Connect(PORT, TIMEOUT)) {
+      for (auto size : {1u << 10u, 1u << 16u, 1u << 20u, 1u << 23u}) {
+        const std::string message(size, 'x');
+        const auto iterations = std::max(10u, (1u << 28u) / size / 4u);
+        runner.Measure("TCPServer.Write/" + std::to_string(size >> 10u) + "KiB", iterations, size, [&]() {
+          server.Write(boost::asio::buffer(message), TIMEOUT);
+        });
+      }
+    }
+  }
+  client.join();
+}
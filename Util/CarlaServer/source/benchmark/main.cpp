@@ -0,0 +1,126 @@
+#include "Benchmark.h"
+
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+using namespace carla::benchmark;
+
+static const char USAGE[] =
+    "Usage: benchmark_carlaserver [--filter=<substring>] [--json=<file>] [--quick]\n"
+    "  --filter  run only the benchmarks whose name contains <substring>\n"
+    "  --json    write the results to <file> as JSON, \"-\" for stdout\n"
+    "  --quick   run a tenth of the iterations, e.g. to check it works\n";
+
+// =============================================================================
+// -- Runner -------------------------------------------------------------------
+// =============================================================================
+
+std::vector<RegisteredBenchmark> &carla::benchmark::GetRegisteredBenchmarks() {
+  static std::vector<RegisteredBenchmark> benchmarks;
+  return benchmarks;
+}
+
+void Runner::Report(Result result) {
+  const auto &latency = result.latency;
+  std::cerr << std::left << std::setw(48) << result.name << std::right << std::fixed << std::setprecision(0)
+            << std::setw(12) << latency.mean() << " ns"
+            << std::setw(12) << latency.Percentile(50.0) << " ns p50"
+            << std::setw(12) << latency.Percentile(99.0) << " ns p99";
+  if ((result.bytes_per_operation > 0u) && (latency.mean() > 0.0)) {
+    const double mb_per_second = 1e3 * static_cast<double>(result.bytes_per_operation) / latency.mean();
+    std::cerr << std::setw(12) << std::setprecision(1) << mb_per_second << " MB/s";
+  }
+  std::cerr << std::endl;
+  _results.emplace_back(std::move(result));
+}
+
+// =============================================================================
+// -- JSON output --------------------------------------------------------------
+// =============================================================================
+
+static void WriteJson(std::ostream &out, const std::vector<Result> &results) {
+  const auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+  char date[32u];
+  std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+  out << std::fixed << std::setprecision(1);
+  out << "{\n  \"context\": {\n"
+      << "    \"date\": \"" << date << "\",\n"
+#ifdef NDEBUG
+      << "    \"build_type\": \"release\",\n"
+#else
+      << "    \"build_type\": \"debug\",\n"
+#endif // NDEBUG
+      << "    \"hardware_concurrency\": " << std::thread::hardware_concurrency() << "\n"
+      << "  },\n  \"benchmarks\": [";
+  for (auto i = 0u; i < results.size(); ++i) {
+    const auto &result = results[i];
+    const auto &latency = result.latency;
+    const double seconds = 1e-9 * latency.mean();
+    out << (i > 0u ? ",\n" : "\n")
+        << "    {\"name\": \"" << result.name << "\""
+        << ", \"iterations\": " << latency.count()
+        << ", \"mean_ns\": " << latency.mean()
+        << ", \"min_ns\": " << latency.min()
+        << ", \"p50_ns\": " << latency.Percentile(50.0)
+        << ", \"p99_ns\": " << latency.Percentile(99.0)
+        << ", \"p999_ns\": " << latency.Percentile(99.9)
+        << ", \"max_ns\": " << latency.max()
+        << ", \"operations_per_second\": " << (seconds > 0.0 ? 1.0 / seconds : 0.0)
+        << ", \"bytes_per_second\": "
+        << (seconds > 0.0 ? static_cast<double>(result.bytes_per_operation) / seconds : 0.0)
+        << "}";
+  }
+  out << "\n  ]\n}\n";
+}
+
+// =============================================================================
+// -- main ---------------------------------------------------------------------
+// =============================================================================
+
+int main(int argc, char **argv) {
+  std::string filter;
+  std::string json;
+  bool quick = false;
+  for (auto i = 1; i < argc; ++i) {
+    const std::string argument = argv[i];
+    if (argument.compare(0u, 9u, "--filter=") == 0) {
+      filter = argument.substr(9u);
+    } else if (argument.compare(0u, 7u, "--json=") == 0) {
+      json = argument.substr(7u);
+    } else if (argument == "--quick") {
+      quick = true;
+    } else {
+      std::cerr << USAGE;
+      return (argument == "--help" ? 0 : 1);
+    }
+  }
+
+  // The table goes to stderr, so the JSON can go to stdout. So does the log of
+  // the library, which writes to std::cout.
+  std::ostream stdout_stream(std::cout.rdbuf());
+  std::cout.rdbuf(std::cerr.rdbuf());
+  Runner runner(quick);
+  for (auto &benchmark : GetRegisteredBenchmarks()) {
+    if (filter.empty() || (std::string(benchmark.name).find(filter) != std::string::npos)) {
+      std::cerr << "-- " << benchmark.name << std::endl;
+      benchmark.function(runner);
+    }
+  }
+
+  if (json == "-") {
+    WriteJson(stdout_stream, runner.results());
+  } else if (!json.empty()) {
+    std::ofstream file(json);
+    WriteJson(file, runner.results());
+    if (!file) {
+      std::cerr << "failed to write " << json << std::endl;
+      return 1;
+    }
+  }
+  return 0;
+}
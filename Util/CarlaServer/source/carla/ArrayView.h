@@ -28,6 +28,10 @@ namespace detail {
     using iterator = value_type*;
     using const_iterator = const_value_type*;
 
+    ArrayView()
+        : _data(nullptr),
+          _size(0u) {}
+
     explicit ArrayView(T *data, size_type size)
         : _data(data),
           _size(size) {}
@@ -40,6 +44,8 @@ namespace detail {
         : _data(rhs.data()),
           _size(rhs.size()) {}
 
+    ArrayView &operator=(const ArrayView &) = default;
+
     bool empty() const {
       return _size == 0u;
     }
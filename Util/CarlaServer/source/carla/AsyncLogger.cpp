@@ -0,0 +1,219 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/AsyncLogger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace carla {
+namespace logging {
+
+  // ===========================================================================
+  // -- AsyncLogger::Entry -----------------------------------------------------
+  // ===========================================================================
+
+  /// Slot of the ring. The sequence tells whose turn it is: the slot is free
+  /// to reserve at position p when sequence == p, and ready to drain when
+  /// sequence == p + 1.
+  struct AsyncLogger::Entry {
+    std::atomic<uint64_t> sequence{0u};
+    bool error = false;
+    uint32_t size = 0u;
+    char text[MESSAGE_SIZE];
+  };
+
+  // ===========================================================================
+  // -- AsyncLogger ------------------------------------------------------------
+  // ===========================================================================
+
+  constexpr size_t AsyncLogger::CAPACITY;
+  constexpr size_t AsyncLogger::MESSAGE_SIZE;
+
+  static constexpr auto DRAIN_INTERVAL = std::chrono::milliseconds(10);
+
+  AsyncLogger &AsyncLogger::GetInstance() {
+    // Never destroyed, threads of the executor may still be logging at exit.
+    static AsyncLogger *instance = []() {
+      std::atexit([]() { GetInstance().StopAtExit(); });
+      return new AsyncLogger(std::cout, std::cerr);
+    }();
+    return *instance;
+  }
+
+  AsyncLogger::AsyncLogger(std::ostream &out, std::ostream &err)
+    : _out(out),
+      _err(err),
+      _ring(std::make_unique<Entry[]>(CAPACITY)) {
+    for (auto i = 0u; i < CAPACITY; ++i) {
+      _ring[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    SetAsynchronous(true);
+  }
+
+  AsyncLogger::~AsyncLogger() {
+    SetAsynchronous(false);
+    // Stopped by StopAtExit, the thread is finishing on its own.
+    if (_thread.joinable()) {
+      _thread.join();
+    }
+  }
+
+  void AsyncLogger::SetAsynchronous(const bool asynchronous) {
+    std::lock_guard<std::mutex> lock(_thread_mutex);
+    if (asynchronous == _asynchronous) {
+      return;
+    }
+    if (asynchronous) {
+      if (_thread.joinable()) {
+        _thread.join();
+      }
+      _done = false;
+      _thread = std::thread([this]() { DrainLoop(); });
+      _asynchronous = true;
+    } else {
+      _asynchronous = false;
+      _done = true;
+      _wake.notify_one();
+      _thread.join();
+      Flush();
+    }
+  }
+
+  void AsyncLogger::StopAtExit() {
+    // Don't join the thread. At exit it may be gone already, or, when
+    // unloading a DLL on Windows, waiting for the loader lock held by this
+    // thread. Same for the locks, a thread killed may have left them locked.
+    _asynchronous = false;
+    _done = true;
+    _wake.notify_one();
+    std::unique_lock<std::mutex> lock(_drain_mutex, std::try_to_lock);
+    if (lock.owns_lock()) {
+      while (TryDrainOne()) {}
+      ReportDropped();
+      _out.flush();
+      _err.flush();
+    }
+  }
+
+  void AsyncLogger::Write(const bool error, const std::string &message) {
+    if (_asynchronous.load(std::memory_order_relaxed)) {
+      if (!TryPush(error, message)) {
+        _dropped.fetch_add(1u, std::memory_order_relaxed);
+      }
+      return;
+    }
+    std::lock_guard<std::mutex> lock(_drain_mutex);
+    while (TryDrainOne()) {}
+    ReportDropped();
+    (error ? _err : _out) << message << std::flush;
+    _written.fetch_add(1u, std::memory_order_relaxed);
+  }
+
+  void AsyncLogger::Flush() {
+    const auto head = _head.load(std::memory_order_acquire);
+    std::lock_guard<std::mutex> lock(_drain_mutex);
+    while (_tail.load(std::memory_order_relaxed) < head) {
+      if (!TryDrainOne()) {
+        // Reserved but not copied yet.
+        std::this_thread::yield();
+      }
+    }
+    ReportDropped();
+    _out.flush();
+    _err.flush();
+  }
+
+  LogStatistics AsyncLogger::GetStatistics() const {
+    LogStatistics statistics;
+    statistics.written = _written.load(std::memory_order_relaxed);
+    statistics.suppressed = _suppressed.load(std::memory_order_relaxed);
+    statistics.dropped = _dropped.load(std::memory_order_relaxed);
+    return statistics;
+  }
+
+  bool AsyncLogger::TryPush(const bool error, const std::string &message) {
+    uint64_t position = _head.load(std::memory_order_relaxed);
+    Entry *entry;
+    for (;;) {
+      entry = &_ring[position % CAPACITY];
+      const auto sequence = entry->sequence.load(std::memory_order_acquire);
+      const auto difference = static_cast<int64_t>(sequence - position);
+      if (difference == 0) {
+        if (_head.compare_exchange_weak(position, position + 1u, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (difference < 0) {
+        return false; // Full.
+      } else {
+        position = _head.load(std::memory_order_relaxed);
+      }
+    }
+    entry->error = error;
+    entry->size = static_cast<uint32_t>(std::min(message.size(), MESSAGE_SIZE));
+    std::memcpy(entry->text, message.data(), entry->size);
+    if ((entry->size == MESSAGE_SIZE) && (message.size() > MESSAGE_SIZE)) {
+      entry->text[MESSAGE_SIZE - 1u] = '\n';
+    }
+    entry->sequence.store(position + 1u, std::memory_order_release);
+    // Wake up the thread before the ring fills up, once until it drains.
+    if ((position - _tail.load(std::memory_order_relaxed) >= CAPACITY / 2u) &&
+        !_wake_requested.exchange(true, std::memory_order_relaxed)) {
+      _wake.notify_one();
+    }
+    return true;
+  }
+
+  bool AsyncLogger::TryDrainOne() {
+    const auto position = _tail.load(std::memory_order_relaxed);
+    auto &entry = _ring[position % CAPACITY];
+    if (entry.sequence.load(std::memory_order_acquire) != position + 1u) {
+      return false;
+    }
+    ReportDropped();
+    (entry.error ? _err : _out).write(entry.text, entry.size);
+    entry.sequence.store(position + CAPACITY, std::memory_order_release);
+    _tail.store(position + 1u, std::memory_order_release);
+    _written.fetch_add(1u, std::memory_order_relaxed);
+    return true;
+  }
+
+  void AsyncLogger::ReportDropped() {
+    const auto dropped = _dropped.load(std::memory_order_relaxed);
+    if (dropped != _dropped_reported) {
+      _err << "WARNING: " << (dropped - _dropped_reported) << " log messages dropped, the log ring was full\n";
+      _dropped_reported = dropped;
+    }
+  }
+
+  void AsyncLogger::DrainLoop() {
+    while (!_done) {
+      _wake_requested.store(false, std::memory_order_relaxed);
+      bool drained = false;
+      {
+        std::lock_guard<std::mutex> lock(_drain_mutex);
+        while (TryDrainOne()) {
+          drained = true;
+        }
+        if (drained) {
+          _out.flush();
+          _err.flush();
+        }
+      }
+      if (!drained) {
+        std::unique_lock<std::mutex> lock(_wake_mutex);
+        _wake.wait_for(lock, DRAIN_INTERVAL, [this]() {
+          return _done.load() || _wake_requested.load(std::memory_order_relaxed);
+        });
+      }
+    }
+  }
+
+} // namespace logging
+} // namespace carla
@@ -0,0 +1,133 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+
+#include "carla/NonCopyable.h"
+
+namespace carla {
+namespace logging {
+
+  /// Number of messages suppressed and dropped so far.
+  struct LogStatistics {
+    uint64_t written = 0u;
+    /// Suppressed by the rate limiter of their call site.
+    uint64_t suppressed = 0u;
+    /// Dropped because the ring was full.
+    uint64_t dropped = 0u;
+  };
+
+  /// Writes the log messages from a background thread, so the threads logging
+  /// never block on the output stream.
+  ///
+  /// Messages are copied to a fixed-size ring, reserved without locks by the
+  /// threads logging, and drained in order by the background thread. If the
+  /// ring is full the message is dropped and counted; the number dropped is
+  /// written with the next message drained. Messages longer than MESSAGE_SIZE
+  /// are truncated.
+  class AsyncLogger : private NonCopyable {
+  public:
+
+    static constexpr size_t CAPACITY = 1024u;
+
+    static constexpr size_t MESSAGE_SIZE = 500u;
+
+    /// Logger writing to std::cout and std::cerr, never destroyed. It is
+    /// flushed at exit (see StopAtExit).
+    static AsyncLogger &GetInstance();
+
+    /// Messages are written to @a out, or to @a err if flagged as error.
+    AsyncLogger(std::ostream &out, std::ostream &err);
+
+    /// Drains the remaining messages.
+    ~AsyncLogger();
+
+    /// If not asynchronous, the messages are written directly by the thread
+    /// logging (after draining the ring).
+    void SetAsynchronous(bool asynchronous);
+
+    void Write(bool error, const std::string &message);
+
+    /// Block until every message written before the call has been drained.
+    void Flush();
+
+    /// Write the messages ready in the ring and switch to synchronous, without
+    /// joining the thread nor blocking on a lock. Meant for exit handlers.
+    void StopAtExit();
+
+    void CountSuppressed(uint64_t count) {
+      _suppressed.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    LogStatistics GetStatistics() const;
+
+  private:
+
+    struct Entry;
+
+    bool TryPush(bool error, const std::string &message);
+
+    /// Write the next message of the ring, if any. Only called with
+    /// _drain_mutex locked.
+    bool TryDrainOne();
+
+    /// Only called with _drain_mutex locked.
+    void ReportDropped();
+
+    void DrainLoop();
+
+    std::ostream &_out;
+
+    std::ostream &_err;
+
+    const std::unique_ptr<Entry[]> _ring;
+
+    /// Next position to reserve.
+    std::atomic<uint64_t> _head{0u};
+
+    /// Next position to drain.
+    std::atomic<uint64_t> _tail{0u};
+
+    std::atomic<bool> _asynchronous{false};
+
+    std::atomic<uint64_t> _written{0u};
+
+    std::atomic<uint64_t> _suppressed{0u};
+
+    std::atomic<uint64_t> _dropped{0u};
+
+    /// Dropped messages already reported.
+    uint64_t _dropped_reported = 0u;
+
+    /// Serializes the writes to the output streams.
+    std::mutex _drain_mutex;
+
+    std::mutex _wake_mutex;
+
+    std::condition_variable _wake;
+
+    std::atomic<bool> _done{false};
+
+    /// A thread logging woke up the thread, reset every time it drains.
+    std::atomic<bool> _wake_requested{false};
+
+    /// Serializes starting and stopping the thread.
+    std::mutex _thread_mutex;
+
+    std::thread _thread;
+  };
+
+} // namespace logging
+} // namespace carla
@@ -0,0 +1,122 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace carla {
+
+  /// Histogram of durations (or any unsigned value) with log-linear buckets:
+  /// every power of two is split into SUB_BUCKETS buckets of the same width,
+  /// so a percentile is within 1/SUB_BUCKETS of the actual value whatever its
+  /// magnitude. Fixed size, adding a value never allocates.
+  class LatencyHistogram {
+  public:
+
+    static constexpr uint32_t SUB_BUCKET_BITS = 3u;
+
+    static constexpr uint64_t SUB_BUCKETS = 1u << SUB_BUCKET_BITS;
+
+    static constexpr size_t NUMBER_OF_BUCKETS = (64u - SUB_BUCKET_BITS + 1u) * SUB_BUCKETS;
+
+    void Add(uint64_t value) {
+      ++_buckets[GetBucket(value)];
+      ++_count;
+      _sum += static_cast<double>(value);
+      _min = std::min(_min, value);
+      _max = std::max(_max, value);
+    }
+
+    /// Add the values of a histogram accumulated elsewhere, e.g. with atomic
+    /// counters: the count of each of the NUMBER_OF_BUCKETS @a buckets (see
+    /// GetBucket), and the sum, minimum and maximum of the values.
+    void Merge(const uint64_t *buckets, double sum, uint64_t min, uint64_t max) {
+      uint64_t count = 0u;
+      for (size_t i = 0u; i < NUMBER_OF_BUCKETS; ++i) {
+        _buckets[i] += buckets[i];
+        count += buckets[i];
+      }
+      if (count > 0u) {
+        _count += count;
+        _sum += sum;
+        _min = std::min(_min, min);
+        _max = std::max(_max, max);
+      }
+    }
+
+    void Clear() {
+      *this = LatencyHistogram();
+    }
+
+    uint64_t count() const {
+      return _count;
+    }
+
+    uint64_t min() const {
+      return _count > 0u ? _min : 0u;
+    }
+
+    uint64_t max() const {
+      return _max;
+    }
+
+    double mean() const {
+      return _count > 0u ? _sum / static_cast<double>(_count) : 0.0;
+    }
+
+    /// Smallest bucket bound not exceeded by @a percentile (0-100) percent of
+    /// the values added, zero if empty.
+    uint64_t Percentile(double percentile) const {
+      if (_count == 0u) {
+        return 0u;
+      }
+      const double rank = std::ceil(static_cast<double>(_count) * percentile / 100.0);
+      const uint64_t target = std::max<uint64_t>(1u, static_cast<uint64_t>(rank));
+      uint64_t accumulated = 0u;
+      for (size_t i = 0u; i < NUMBER_OF_BUCKETS; ++i) {
+        accumulated += _buckets[i];
+        if (accumulated >= target) {
+          return std::min(GetUpperBound(i), _max);
+        }
+      }
+      return _max;
+    }
+
+    /// Values below 2 * SUB_BUCKETS have a bucket each, from there on every
+    /// power of two shifts one more bit out.
+    static size_t GetBucket(uint64_t value) {
+      uint32_t shift = 0u;
+      while ((value >> shift) >= 2u * SUB_BUCKETS) {
+        ++shift;
+      }
+      return shift * SUB_BUCKETS + static_cast<size_t>(value >> shift);
+    }
+
+  private:
+
+    static uint64_t GetUpperBound(size_t bucket) {
+      const auto shift = static_cast<uint32_t>(std::max<size_t>(bucket / SUB_BUCKETS, 1u) - 1u);
+      const uint64_t lower = static_cast<uint64_t>(bucket - shift * SUB_BUCKETS) << shift;
+      return lower + ((uint64_t(1u) << shift) - 1u);
+    }
+
+    std::array<uint64_t, NUMBER_OF_BUCKETS> _buckets{};
+
+    uint64_t _count = 0u;
+
+    double _sum = 0.0;
+
+    uint64_t _min = std::numeric_limits<uint64_t>::max();
+
+    uint64_t _max = 0u;
+  };
+
+} // namespace carla
@@ -26,19 +26,31 @@
 //
 //  * log_debug
 //  * log_info
+//  * log_warning
 //  * log_error
 //  * log_critical
 //
+// The messages are formatted by the calling thread and written by the
+// background thread of logging::AsyncLogger; log_critical waits until written.
+//
 // And macros
 //
 //  * LOG_DEBUG_ONLY(/* code here */)
 //  * LOG_INFO_ONLY(/* code here */)
+//  * LOG_RATE_LIMITED(interval_ms, log_function, /* args */)
 
 // =============================================================================
 // -- Implementation of log functions ------------------------------------------
 // =============================================================================
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <iostream>
+#include <sstream>
+
+#include "carla/AsyncLogger.h"
+#include "carla/NonCopyable.h"
 
 namespace carla {
 
@@ -52,13 +64,62 @@ namespace logging {
     (void)expander{0, (void(out << ' ' << std::forward<Args>(args)),0)...};
   }
 
+  /// Format the message and pass it to the logger.
+  template <typename ... Args>
+  static void write(bool error, Args &&... args) {
+    std::ostringstream out;
+    print(out, std::forward<Args>(args)...);
+    AsyncLogger::GetInstance().Write(error, out.str());
+  }
+
+  /// Lets through one message per interval, the rest are suppressed and
+  /// counted. See LOG_RATE_LIMITED.
+  class RateLimiter : private NonCopyable {
+  public:
+
+    explicit RateLimiter(std::chrono::milliseconds interval)
+      : _interval(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(interval).count())) {}
+
+    /// Whether a message may be logged now. If so, @a suppressed is set to the
+    /// number of messages suppressed since the last one let through.
+    bool Allow(uint64_t &suppressed) {
+      const auto now = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch()).count());
+      auto next = _next.load(std::memory_order_relaxed);
+      if ((now >= next) && _next.compare_exchange_strong(next, now + _interval, std::memory_order_relaxed)) {
+        suppressed = _suppressed.exchange(0u, std::memory_order_relaxed);
+        return true;
+      }
+      _suppressed.fetch_add(1u, std::memory_order_relaxed);
+      AsyncLogger::GetInstance().CountSuppressed(1u);
+      return false;
+    }
+
+  private:
+
+    const uint64_t _interval;
+
+    std::atomic<uint64_t> _next{0u};
+
+    std::atomic<uint64_t> _suppressed{0u};
+  };
+
+  /// Appended to the messages let through by a RateLimiter.
+  struct Suppressed {
+    uint64_t count;
+  };
+
+  static inline std::ostream &operator<<(std::ostream &out, const Suppressed &suppressed) {
+    return out << '(' << suppressed.count << " similar messages suppressed)";
+  }
+
 } // namespace logging
 
 #if CARLA_SERVER_LOG_LEVEL <= CARLA_SERVER_LOG_LEVEL_DEBUG
 
   template <typename ... Args>
   static inline void log_debug(Args &&... args) {
-    logging::print(std::cout, "DEBUG:", std::forward<Args>(args)..., '\n');
+    logging::write(false, "DEBUG:", std::forward<Args>(args)..., '\n');
   }
 
 #else
@@ -72,7 +133,7 @@ namespace logging {
 
   template <typename ... Args>
   static inline void log_info(Args &&... args) {
-    logging::print(std::cout, "INFO: ", std::forward<Args>(args)..., '\n');
+    logging::write(false, "INFO: ", std::forward<Args>(args)..., '\n');
   }
 
 #else
@@ -86,7 +147,7 @@ namespace logging {
 
   template <typename ... Args>
   static inline void log_warning(Args &&... args) {
-    logging::print(std::cerr, "WARNING:", std::forward<Args>(args)..., '\n');
+    logging::write(true, "WARNING:", std::forward<Args>(args)..., '\n');
   }
 
 #else
@@ -100,7 +161,7 @@ namespace logging {
 
   template <typename ... Args>
   static inline void log_error(Args &&... args) {
-    logging::print(std::cerr, "ERROR:", std::forward<Args>(args)..., '\n');
+    logging::write(true, "ERROR:", std::forward<Args>(args)..., '\n');
   }
 
 #else
@@ -114,7 +175,8 @@ namespace logging {
 
   template <typename ... Args>
   static inline void log_critical(Args &&... args) {
-    logging::print(std::cerr, "CRITICAL:", std::forward<Args>(args)..., '\n');
+    logging::write(true, "CRITICAL:", std::forward<Args>(args)..., '\n');
+    logging::AsyncLogger::GetInstance().Flush();
   }
 
 #else
@@ -141,3 +203,19 @@ namespace logging {
 #else
 #  define LOG_INFO_ONLY(code)
 #endif
+
+/// Log with @a log_function at most once every @a interval_ms from this call
+/// site, the messages in between are suppressed and their number appended to
+/// the next one logged.
+#define LOG_RATE_LIMITED(interval_ms, log_function, ...) \
+    do { \
+      static ::carla::logging::RateLimiter carla_log_rate_limiter{std::chrono::milliseconds(interval_ms)}; \
+      uint64_t carla_log_suppressed = 0u; \
+      if (carla_log_rate_limiter.Allow(carla_log_suppressed)) { \
+        if (carla_log_suppressed == 0u) { \
+          log_function(__VA_ARGS__); \
+        } else { \
+          log_function(__VA_ARGS__, ::carla::logging::Suppressed{carla_log_suppressed}); \
+        } \
+      } \
+    } while (false)
@@ -0,0 +1,224 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/Profiler.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+#include "carla/Logging.h"
+
+namespace carla {
+
+  // ===========================================================================
+  // -- Static local functions -------------------------------------------------
+  // ===========================================================================
+
+  template <typename ... Args>
+  static inline void log_profiler(Args &&... args) {
+    logging::write(false, "PROFILER:", std::forward<Args>(args)..., '\n');
+  }
+
+  static double ToMilliseconds(const uint64_t nanoseconds) {
+    return 1e-6 * static_cast<double>(nanoseconds);
+  }
+
+  static double ToMicroseconds(const uint64_t nanoseconds) {
+    return 1e-3 * static_cast<double>(nanoseconds);
+  }
+
+  // ===========================================================================
+  // -- ProfilerData -----------------------------------------------------------
+  // ===========================================================================
+
+  ProfilerData::ProfilerData(std::string name) : _name(std::move(name)) {
+    Clear();
+  }
+
+  void ProfilerData::Annotate(const uint64_t nanoseconds) {
+    _buckets[LatencyHistogram::GetBucket(nanoseconds)].fetch_add(1u, std::memory_order_relaxed);
+    _sum.fetch_add(nanoseconds, std::memory_order_relaxed);
+    uint64_t min = _min.load(std::memory_order_relaxed);
+    while ((nanoseconds < min) &&
+           !_min.compare_exchange_weak(min, nanoseconds, std::memory_order_relaxed)) {}
+    uint64_t max = _max.load(std::memory_order_relaxed);
+    while ((nanoseconds > max) &&
+           !_max.compare_exchange_weak(max, nanoseconds, std::memory_order_relaxed)) {}
+  }
+
+  LatencyHistogram ProfilerData::GetHistogram() const {
+    std::array<uint64_t, LatencyHistogram::NUMBER_OF_BUCKETS> buckets;
+    for (auto i = 0u; i < buckets.size(); ++i) {
+      buckets[i] = _buckets[i].load(std::memory_order_relaxed);
+    }
+    LatencyHistogram histogram;
+    histogram.Merge(
+        buckets.data(),
+        static_cast<double>(_sum.load(std::memory_order_relaxed)),
+        _min.load(std::memory_order_relaxed),
+        _max.load(std::memory_order_relaxed));
+    return histogram;
+  }
+
+  void ProfilerData::Clear() {
+    for (auto &bucket : _buckets) {
+      bucket.store(0u, std::memory_order_relaxed);
+    }
+    _sum.store(0u, std::memory_order_relaxed);
+    _min.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+    _max.store(0u, std::memory_order_relaxed);
+  }
+
+  // ===========================================================================
+  // -- Profiler::ThreadTrace --------------------------------------------------
+  // ===========================================================================
+
+  /// Ring of the last scopes run by a thread. Only the thread writes, the
+  /// fields are atomic so the ring can be read while written; the oldest
+  /// events may be overwritten while read, those that make no sense are
+  /// skipped.
+  struct Profiler::ThreadTrace : private NonCopyable {
+    struct Event {
+      std::atomic<const ProfilerData *> data{nullptr};
+      std::atomic<uint64_t> begin{0u};
+      std::atomic<uint64_t> end{0u};
+    };
+
+    explicit ThreadTrace(const uint32_t id)
+      : id(id),
+        events(std::make_unique<Event[]>(TRACE_CAPACITY)) {}
+
+    const uint32_t id;
+
+    const std::unique_ptr<Event[]> events;
+
+    /// Number of events written so far.
+    std::atomic<uint64_t> size{0u};
+  };
+
+  // ===========================================================================
+  // -- Profiler ---------------------------------------------------------------
+  // ===========================================================================
+
+  constexpr size_t Profiler::TRACE_CAPACITY;
+
+  Profiler &Profiler::GetInstance() {
+    // Never destroyed, threads of the executor may still be running scopes at
+    // exit.
+    static Profiler *instance = []() {
+      std::atexit([]() {
+        if (GetInstance().IsEnabled()) {
+          GetInstance().PrintSummary();
+        }
+      });
+      return new Profiler();
+    }();
+    return *instance;
+  }
+
+  uint64_t Profiler::Now() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+  }
+
+  void Profiler::Enable(const bool enable, const bool trace) {
+    _trace = enable && trace;
+    _enabled = enable;
+  }
+
+  ProfilerData &Profiler::GetData(const std::string &name) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto &data : _data) {
+      if (data->name() == name) {
+        return *data;
+      }
+    }
+    _data.emplace_back(std::make_unique<ProfilerData>(name));
+    return *_data.back();
+  }
+
+  void Profiler::Record(ProfilerData &data, const uint64_t begin, const uint64_t end) {
+    data.Annotate(end - begin);
+    if (_trace.load(std::memory_order_relaxed)) {
+      auto &trace = GetThreadTrace();
+      const auto index = trace.size.load(std::memory_order_relaxed);
+      auto &event = trace.events[index % TRACE_CAPACITY];
+      event.data.store(&data, std::memory_order_relaxed);
+      event.begin.store(begin, std::memory_order_relaxed);
+      event.end.store(end, std::memory_order_relaxed);
+      trace.size.store(index + 1u, std::memory_order_release);
+    }
+  }
+
+  void Profiler::PrintSummary() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto &data : _data) {
+      const auto histogram = data->GetHistogram();
+      if (histogram.count() == 0u) {
+        continue;
+      }
+      data->Clear();
+      std::ostringstream out;
+      out << std::fixed << std::setprecision(3)
+          << histogram.count() << " times, mean " << ToMilliseconds(static_cast<uint64_t>(histogram.mean()))
+          << ", p50 " << ToMilliseconds(histogram.Percentile(50.0))
+          << ", p99 " << ToMilliseconds(histogram.Percentile(99.0))
+          << ", p99.9 " << ToMilliseconds(histogram.Percentile(99.9))
+          << ", max " << ToMilliseconds(histogram.max()) << " ms";
+      log_profiler(data->name() + ':', out.str());
+    }
+  }
+
+  void Profiler::WriteTrace(std::ostream &out, const uint64_t nanoseconds) const {
+    const uint64_t now = Now();
+    const uint64_t since = (now > nanoseconds ? now - nanoseconds : 0u);
+    std::lock_guard<std::mutex> lock(_mutex);
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first_event = true;
+    auto separator = [&]() -> const char * {
+      const char *result = (first_event ? "\n" : ",\n");
+      first_event = false;
+      return result;
+    };
+    for (auto &thread : _threads) {
+      out << separator()
+          << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread->id
+          << ",\"args\":{\"name\":\"thread " << thread->id << "\"}}";
+      const auto size = thread->size.load(std::memory_order_acquire);
+      const auto begin = (size > TRACE_CAPACITY ? size - TRACE_CAPACITY : 0u);
+      for (auto i = begin; i < size; ++i) {
+        const auto &event = thread->events[i % TRACE_CAPACITY];
+        const auto *data = event.data.load(std::memory_order_relaxed);
+        const auto event_begin = event.begin.load(std::memory_order_relaxed);
+        const auto event_end = event.end.load(std::memory_order_relaxed);
+        if ((data == nullptr) || (event_begin < since) || (event_end < event_begin) || (event_end > now)) {
+          continue;
+        }
+        out << separator()
+            << "{\"name\":\"" << data->name() << "\",\"cat\":\"carla\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread->id
+            << ",\"ts\":" << ToMicroseconds(event_begin - since)
+            << ",\"dur\":" << ToMicroseconds(event_end - event_begin) << '}';
+      }
+    }
+    out << "\n]}\n";
+  }
+
+  Profiler::ThreadTrace &Profiler::GetThreadTrace() {
+    static thread_local ThreadTrace *trace = nullptr;
+    if (trace == nullptr) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _threads.emplace_back(std::make_unique<ThreadTrace>(static_cast<uint32_t>(_threads.size() + 1u)));
+      trace = _threads.back().get();
+    }
+    return *trace;
+  }
+
+} // namespace carla
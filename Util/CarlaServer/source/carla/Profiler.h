@@ -6,103 +6,149 @@
 
 #pragma once
 
-// #define CARLA_WITH_PROFILER
-
-#ifdef CARLA_WITH_PROFILER
-
-#include <algorithm>
-#include <iomanip>
-#include <iostream>
-
-#include "carla/Logging.h"
+// Scopes are profiled only while the profiler is enabled at runtime (see
+// Profiler::Enable), define this to compile them out entirely.
+// #define CARLA_WITHOUT_PROFILER
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "carla/LatencyHistogram.h"
 #include "carla/NonCopyable.h"
-#include "carla/StopWatch.h"
 
 namespace carla {
 
-  template <typename ... Args>
-  static inline void log_profiler(Args &&... args) {
-    logging::print(std::cout, "PROFILER:", std::forward<Args>(args)..., '\n');
-  }
-
+  /// Durations of a profiled scope, in nanoseconds. Every thread running the
+  /// scope annotates the same data, aggregated without locks.
   class ProfilerData : private NonCopyable {
   public:
 
-    explicit ProfilerData(std::string name) : _name(std::move(name)) {}
+    explicit ProfilerData(std::string name);
 
-    ~ProfilerData() {
-      log_profiler(_name, ':', "annotated", _count, "times", std::fixed, std::setprecision(3));
-      if (_count > 0u) {
-        log_profiler(_name, ':', "average =", Average(), "ms");
-        log_profiler(_name, ':', "maximum =", Maximum(), "ms");
-        log_profiler(_name, ':', "minimum =", Minimum(), "ms");
-      }
+    const std::string &name() const {
+      return _name;
     }
 
-    void Annotate(const StopWatch &stop_watch) {
-      size_t elapsed_microseconds = stop_watch.GetElapsedTime<std::chrono::microseconds>();
-      ++_count;
-      _total_microseconds += elapsed_microseconds;
-      _max_elapsed = std::max(elapsed_microseconds, _max_elapsed);
-      _min_elapsed = std::min(elapsed_microseconds, _min_elapsed);
-    }
+    void Annotate(uint64_t nanoseconds);
 
-    float Average() const {
-      return ms(_total_microseconds) / static_cast<float>(_count);
-    }
+    /// Durations annotated since the last call to Clear.
+    LatencyHistogram GetHistogram() const;
 
-    float Maximum() const {
-      return ms(_max_elapsed);
-    }
+    void Clear();
+
+  private:
+
+    const std::string _name;
+
+    std::array<std::atomic<uint64_t>, LatencyHistogram::NUMBER_OF_BUCKETS> _buckets;
+
+    std::atomic<uint64_t> _sum;
+
+    std::atomic<uint64_t> _min;
+
+    std::atomic<uint64_t> _max;
+  };
 
-    float Minimum() const {
-      return ms(_min_elapsed);
+  /// Process-wide registry of the profiled scopes, disabled by default. If
+  /// enabled, the summary is printed at exit too.
+  ///
+  /// While enabled, the duration of every scope run is annotated in its
+  /// latency histogram. While tracing too, every thread keeps the last
+  /// TRACE_CAPACITY scopes it ran in a ring of its own, which can be written
+  /// as a Chrome trace-event JSON (chrome://tracing or Perfetto) to see the
+  /// scopes of every thread on one timeline.
+  class Profiler : private NonCopyable {
+  public:
+
+    /// Scopes kept per thread while tracing.
+    static constexpr size_t TRACE_CAPACITY = 32768u;
+
+    static Profiler &GetInstance();
+
+    /// Nanoseconds of a monotonic clock.
+    static uint64_t Now();
+
+    void Enable(bool enable, bool trace);
+
+    bool IsEnabled() const {
+      return _enabled.load(std::memory_order_relaxed);
     }
 
+    /// Data of the scope @a name, created on first use. Scopes with the same
+    /// name share the data (e.g., in every instantiation of a template). Never
+    /// destroyed.
+    ProfilerData &GetData(const std::string &name);
+
+    /// Called at the end of every scope run while enabled.
+    void Record(ProfilerData &data, uint64_t begin, uint64_t end);
+
+    /// Print the percentiles of every scope annotated, and clear them.
+    void PrintSummary();
+
+    /// Write the scopes run in the last @a nanoseconds (that are still in the
+    /// rings) as Chrome trace-event JSON.
+    void WriteTrace(std::ostream &out, uint64_t nanoseconds) const;
+
   private:
 
-    static inline float ms(size_t microseconds) {
-      return 1e-3f * static_cast<float>(microseconds);
-    }
+    struct ThreadTrace;
+
+    Profiler() = default;
 
-    std::string _name;
+    ThreadTrace &GetThreadTrace();
 
-    size_t _count = 0u;
+    std::atomic<bool> _enabled{false};
 
-    size_t _total_microseconds = 0u;
+    std::atomic<bool> _trace{false};
 
-    size_t _max_elapsed = 0u;
+    // -- Registry, guarded by _mutex ------------------------------------------
 
-    size_t _min_elapsed = -1;
+    mutable std::mutex _mutex;
+
+    std::vector<std::unique_ptr<ProfilerData>> _data;
+
+    /// Kept after the thread exits so its scopes can still be written.
+    std::vector<std::unique_ptr<ThreadTrace>> _threads;
   };
 
-  class ScopedProfiler {
+  class ScopedProfiler : private NonCopyable {
   public:
 
-    explicit ScopedProfiler(ProfilerData &parent) : _profiler(parent) {}
+    explicit ScopedProfiler(ProfilerData &data)
+      : _data(data),
+        _begin(Profiler::GetInstance().IsEnabled() ? Profiler::Now() : 0u) {}
 
     ~ScopedProfiler() {
-      _stop_watch.Stop();
-      _profiler.Annotate(_stop_watch);
+      if (_begin > 0u) {
+        Profiler::GetInstance().Record(_data, _begin, Profiler::Now());
+      }
     }
 
   private:
 
-    ProfilerData &_profiler;
+    ProfilerData &_data;
 
-    StopWatch _stop_watch;
+    const uint64_t _begin;
   };
 
 } // namespace carla
 
+#ifndef CARLA_WITHOUT_PROFILER
+
 #define CARLA_PROFILE_SCOPE(context, name) \
-    static thread_local ::carla::ProfilerData carla_profiler_ ## context ## _ ## name ## _data( \
-        #context "." #name); \
+    static ::carla::ProfilerData &carla_profiler_ ## context ## _ ## name ## _data = \
+        ::carla::Profiler::GetInstance().GetData(#context "." #name); \
     ::carla::ScopedProfiler carla_profiler_ ## context ## _ ## name ## _scoped_profiler( \
         carla_profiler_ ## context ## _ ## name ## _data);
 
-#else // CARLA_WITH_PROFILER
+#else // CARLA_WITHOUT_PROFILER
 
 #define CARLA_PROFILE_SCOPE(context, name)
 
-#endif // CARLA_WITH_PROFILER
+#endif // CARLA_WITHOUT_PROFILER
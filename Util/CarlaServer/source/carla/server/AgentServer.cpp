@@ -6,22 +6,270 @@
 
 #include "carla/server/AgentServer.h"
 
+#include <algorithm>
+
+#include "carla/Logging.h"
+
 namespace carla {
 namespace server {
 
+  // ===========================================================================
+  // -- Static local functions -------------------------------------------------
+  // ===========================================================================
+
+  template <typename T>
+  static void LogBufferStatistics(const char *stream, const RingBuffer<T> &buffer) {
+    if ((buffer.number_of_dropped_values() > 0u) || (buffer.number_of_blocked_writes() > 0u)) {
+      log_info(
+          stream, "stream:",
+          buffer.number_of_dropped_values(), "frames dropped,",
+          buffer.number_of_blocked_writes(), "writes blocked");
+    }
+  }
+
+  static std::unique_ptr<StreamBroadcaster> MakeObservers(
+      const StreamSettings &settings,
+      const uint32_t port_offset) {
+    if (settings.observers_port == 0u) {
+      return nullptr;
+    }
+    return std::make_unique<StreamBroadcaster>(
+        settings.observers_port + port_offset,
+        settings.max_observers,
+        settings.observers_buffer_depth,
+        settings.slow_observer_policy);
+  }
+
+  /// With control lookahead, the client may be (lookahead + 1) frames behind.
+  static uint32_t GetBufferDepth(const StreamSettings &settings) {
+    return std::max(settings.buffer_depth, settings.control_lookahead + 1u);
+  }
+
+  /// Time-stamps of the frame until queued, stamped now.
+  static FrameTimestamps MakeTimestamps(const carla_measurements &measurements) {
+    FrameTimestamps timestamps;
+    timestamps.tick = measurements.tick_timestamp;
+    timestamps.readback = measurements.readback_timestamp;
+    timestamps.queued = FrameTracer::Now();
+    return timestamps;
+  }
+
+  static void Discard(const carla_image &) {}
+
+  static void Discard(const carla_image_lease &lease) {
+    ReleaseImageLeases(const_array_view<carla_image_lease>(&lease, 1u));
+  }
+
+  // ===========================================================================
+  // -- AgentServer::SensorStream ----------------------------------------------
+  // ===========================================================================
+
+  /// A sensor stream runs its own jobs, with a thread of the executor reserved,
+  /// so a slow client of one sensor does not hold back the rest of them.
+  struct AgentServer::SensorStream : private NonCopyable {
+    SensorStream(
+        CarlaEncoder &encoder,
+        const StreamSettings &settings,
+        const uint32_t index,
+        const time_duration timeout)
+        : observers(MakeObservers(settings, 1u + index)),
+          server(encoder, observers.get(), settings.shared_memory_capacity),
+          data(timeout, GetBufferDepth(settings), settings.back_pressure, timeout) {}
+
+    const std::unique_ptr<StreamBroadcaster> observers;
+
+    AsyncServer<EncoderServer<SharedMemoryServer>> server;
+
+    StreamWriteTask<SensorMessage, RingBuffer<SensorMessage>> data;
+  };
+
+  // ===========================================================================
+  // -- AgentServer ------------------------------------------------------------
+  // ===========================================================================
+
   AgentServer::AgentServer(
       CarlaEncoder &encoder,
       const uint32_t out_port,
       const uint32_t in_port,
+      const uint32_t sensors_port,
+      const StreamSettings &settings,
       const time_duration timeout)
-      : _out(encoder),
+      : _agents_encoding(settings.agents_encoding),
+        _observers(MakeObservers(settings, 0u)),
+        _out(encoder, _observers.get(), settings.shared_memory_capacity),
         _in(encoder),
-        _measurements(timeout),
-        _control(timeout) {
+        _measurements(timeout, GetBufferDepth(settings), settings.back_pressure, timeout),
+        _control_lookahead(settings.control_lookahead),
+        // Without lookahead only the latest control is kept, as a DoubleBuffer.
+        // With lookahead every control is kept, the client cannot reply to more
+        // than (lookahead + 1) frames ahead of the one due.
+        _control(
+            timeout,
+            settings.control_lookahead + 1u,
+            (settings.control_lookahead > 0u ? BackPressurePolicy::Block : BackPressurePolicy::DropOldest),
+            timeout) {
+    _control.set_retry_on_timeout(settings.keep_connections);
     _out.Connect(out_port, timeout);
     _out.Execute(_measurements);
     _in.Connect(in_port, timeout);
     _in.Execute(_control);
+    _sensors.reserve(settings.number_of_sensor_streams);
+    for (auto i = 0u; i < settings.number_of_sensor_streams; ++i) {
+      _sensors.emplace_back(std::make_unique<SensorStream>(encoder, settings, i, timeout));
+      auto &stream = *_sensors.back();
+      stream.server.Connect(sensors_port + i, timeout);
+      stream.server.Execute(stream.data);
+    }
+  }
+
+  AgentServer::~AgentServer() {
+    LogBufferStatistics("measurements", *_measurements.buffer());
+    for (auto &sensor : _sensors) {
+      LogBufferStatistics("sensor", *sensor->data.buffer());
+    }
+    _tracer.LogSummary();
+  }
+
+  error_code AgentServer::ReadControl(carla_control &control, const timeout_t timeout) {
+    error_code ec = errc::try_again();
+    if (_control.TryGetResult(ec)) {
+      return ec;
+    }
+    if (_control_lookahead == 0u) {
+      auto reader = _control.buffer()->TryMakeReader(timeout);
+      if ((reader != nullptr) && !IsStale(*reader)) {
+        control = reader->values;
+        _tracer.RecordControl(reader->frame_number, reader->timestamp);
+        ec = errc::success();
+      }
+      return ec;
+    }
+    if (_frame_number < _first_frame_number + _control_lookahead) {
+      // The client has not been sent enough frames yet.
+      return errc::not_due();
+    }
+    const uint64_t due = _frame_number - _control_lookahead;
+    if (_control_frame_number >= due) {
+      // Applied already.
+      return errc::not_due();
+    }
+    while (_control_frame_number < due) {
+      if (!_has_next_control) {
+        auto reader = _control.buffer()->TryMakeReader(timeout);
+        if (reader == nullptr) {
+          break;
+        }
+        if (IsStale(*reader)) {
+          continue;
+        }
+        _next_control = *reader;
+        _has_next_control = true;
+        _tracer.RecordControl(_next_control.frame_number, _next_control.timestamp);
+      }
+      const uint64_t frame_number = (_next_control.frame_number > 0u ?
+          _next_control.frame_number :
+          _control_frame_number + 1u);
+      if (frame_number > due) {
+        log_debug("no control received for frame", due);
+        if (ec == errc::try_again()) {
+          // The client skipped it, there is no use in waiting.
+          ec = errc::not_due();
+        }
+        break;
+      }
+      // Late controls are applied as soon as they arrive, the latest wins.
+      _has_next_control = false;
+      _control_frame_number = frame_number;
+      control = _next_control.values;
+      ec = errc::success();
+    }
+    return ec;
+  }
+
+  uint64_t AgentServer::StartEpisode() {
+    _first_frame_number = _frame_number + 1u;
+    // The controls of the previous episode are not due anymore.
+    _control_frame_number = _frame_number;
+    _has_next_control = false;
+    log_info("new episode on the same agent connections, from frame", _first_frame_number);
+    return _first_frame_number;
+  }
+
+  bool AgentServer::IsAlive() const {
+    if (!_measurements.IsRunning() || !_control.IsRunning()) {
+      return false;
+    }
+    for (auto &sensor : _sensors) {
+      if (!sensor->data.IsRunning()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool AgentServer::IsStale(const ControlMessage &message) const {
+    // Untagged controls cannot be told apart, they are always applied.
+    return (message.frame_number > 0u) && (message.frame_number < _first_frame_number);
+  }
+
+  error_code AgentServer::WriteMeasurements(
+      const carla_measurements &measurements,
+      const_array_view<carla_image> images) {
+    return WriteFrame<carla_image>(measurements, images);
+  }
+
+  error_code AgentServer::WriteMeasurements(
+      const carla_measurements &measurements,
+      const_array_view<carla_image_lease> images) {
+    return WriteFrame<carla_image_lease>(measurements, images);
+  }
+
+  template <typename T>
+  error_code AgentServer::WriteFrame(
+      const carla_measurements &measurements,
+      const_array_view<T> images) {
+    error_code ec;
+    if (!_control.TryGetResult(ec)) {
+      ++_frame_number;
+      if (_sensors.empty()) {
+        auto writer = _measurements.buffer()->MakeWriter();
+        writer->set_agents_encoding(_agents_encoding);
+        writer->set_trace(&_tracer, MakeTimestamps(measurements));
+        writer->Write(measurements, images, _frame_number);
+      } else {
+        {
+          auto writer = _measurements.buffer()->MakeWriter();
+          writer->set_agents_encoding(_agents_encoding);
+          writer->set_trace(&_tracer, MakeTimestamps(measurements));
+          writer->Write(measurements, _frame_number);
+        }
+        WriteSensorData<T>(images);
+      }
+      ec = errc::success();
+    } else {
+      for (const auto &image : images) {
+        Discard(image);
+      }
+    }
+    return ec;
+  }
+
+  template <typename T>
+  void AgentServer::WriteSensorData(const_array_view<T> images) {
+    if (images.size() > _sensors.size()) {
+      LOG_RATE_LIMITED(1000, log_error, "received", images.size(), "images but only", _sensors.size(), "sensor streams");
+    }
+    for (auto i = 0u; i < images.size(); ++i) {
+      error_code ec;
+      // A sensor stream that failed (e.g., nobody connected to it) does not
+      // stop the agent, its data is dropped.
+      if ((i < _sensors.size()) && !_sensors[i]->data.TryGetResult(ec)) {
+        auto writer = _sensors[i]->data.buffer()->MakeWriter();
+        writer->Write(_frame_number, images[i]);
+      } else {
+        Discard(images[i]);
+      }
+    }
   }
 
 } // namespace server
@@ -6,10 +6,17 @@
 
 #pragma once
 
+#include <memory>
+#include <vector>
+
 #include "carla/NonCopyable.h"
 #include "carla/server/AsyncServer.h"
+#include "carla/server/ControlMessage.h"
+#include "carla/server/CoroutineTCPServer.h"
 #include "carla/server/EncoderServer.h"
-#include "carla/server/TCPServer.h"
+#include "carla/server/FrameTracer.h"
+#include "carla/server/SharedMemoryServer.h"
+#include "carla/server/StreamSettings.h"
 
 namespace carla {
 namespace server {
@@ -19,45 +26,106 @@ namespace server {
   class AgentServer : private NonCopyable {
   public:
 
+    /// If settings.number_of_sensor_streams is greater than zero, images are
+    /// not sent with the measurements; image i is sent through its own stream
+    /// listening at port (sensors_port + i), each stream running its own jobs.
+    /// If settings.observers_port is greater than zero, every stream accepts
+    /// observers too (see StreamBroadcaster). If
+    /// settings.shared_memory_capacity is greater than zero, the measurements
+    /// and the sensor data are written to shared memory (see
+    /// SharedMemoryServer). If settings.control_lookahead is greater than
+    /// zero, the streams keep at least (control_lookahead + 1) frames. If
+    /// settings.keep_connections is true, the control stream outlives the
+    /// client being idle, see StartEpisode.
     explicit AgentServer(
         CarlaEncoder &encoder,
         uint32_t out_port,
         uint32_t in_port,
+        uint32_t sensors_port,
+        const StreamSettings &settings,
         time_duration timeout);
 
+    ~AgentServer();
+
+    error_code WriteMeasurements(
+        const carla_measurements &measurements,
+        const_array_view<carla_image> images);
+
+    /// Same as above but the images are not copied, the leases are released
+    /// once sent, or right away if the connection is already closed.
     error_code WriteMeasurements(
         const carla_measurements &measurements,
-        const_array_view<carla_image> images) {
-      error_code ec;
-      if (!_control.TryGetResult(ec)) {
-        auto writer = _measurements.buffer()->MakeWriter();
-        writer->Write(measurements, images);
-        ec = errc::success();
-      }
-      return ec;
-    };
-
-    error_code ReadControl(carla_control &control, timeout_t timeout) {
-      error_code ec = errc::try_again();
-      if (!_control.TryGetResult(ec)) {
-        auto reader = _control.buffer()->TryMakeReader(timeout);
-        if (reader != nullptr) {
-          control = *reader;
-          ec = errc::success();
-        }
-      }
-      return ec;
-    }
+        const_array_view<carla_image_lease> images);
+
+    /// Without control lookahead, read the latest control received.
+    ///
+    /// With a lookahead of K frames, read the control replying to frame
+    /// (N - K), N being the last frame written, waiting up to @a timeout for
+    /// it. Controls are applied in order, each at most once; returns
+    /// try_again if it did not arrive in time, and not_due if there is none
+    /// due this frame or the client skipped it. Untagged controls are taken as
+    /// the reply to the next frame due.
+    error_code ReadControl(carla_control &control, timeout_t timeout);
+
+    /// Start a new episode on the same connections. Frame numbers keep
+    /// counting, the frames of the new episode start at the one returned;
+    /// controls replying to earlier frames are discarded from now on.
+    uint64_t StartEpisode();
+
+    /// Whether every stream is still connected, or waiting for the client to
+    /// connect.
+    bool IsAlive() const;
 
   private:
 
-    AsyncServer<EncoderServer<TCPServer>> _out;
+    struct SensorStream;
+
+    template <typename T>
+    error_code WriteFrame(const carla_measurements &measurements, const_array_view<T> images);
+
+    template <typename T>
+    void WriteSensorData(const_array_view<T> images);
+
+    /// Whether @a message replies to a frame of a previous episode.
+    bool IsStale(const ControlMessage &message) const;
+
+    /// Number of measurements written so far, used to tag the data of every
+    /// stream so the client can match them.
+    uint64_t _frame_number = 0u;
+
+    /// First frame of the current episode.
+    uint64_t _first_frame_number = 1u;
+
+    const AgentsEncoding _agents_encoding;
+
+    /// Time-stamps of the frames written and the controls received, its
+    /// summary is printed at the end of the episode. Outlives _out.
+    FrameTracer _tracer;
+
+    /// Observers of the measurements, null if disabled. Outlives _out.
+    const std::unique_ptr<StreamBroadcaster> _observers;
+
+    AsyncServer<EncoderServer<SharedMemoryServer>> _out;
+
+    /// The control is received by a read always posted, so every message is
+    /// ready to be decoded as soon as it arrives.
+    AsyncServer<EncoderServer<CoroutineTCPServer>> _in;
+
+    StreamWriteTask<MeasurementsMessage, RingBuffer<MeasurementsMessage>> _measurements;
+
+    const uint32_t _control_lookahead;
+
+    /// Last frame whose control was applied, with control lookahead.
+    uint64_t _control_frame_number = 0u;
+
+    /// Control read but not due yet, with control lookahead.
+    ControlMessage _next_control;
 
-    AsyncServer<EncoderServer<TCPServer>> _in;
+    bool _has_next_control = false;
 
-    StreamWriteTask<MeasurementsMessage> _measurements;
+    StreamReadTask<ControlMessage, RingBuffer<ControlMessage>> _control;
 
-    StreamReadTask<carla_control> _control;
+    std::vector<std::unique_ptr<SensorStream>> _sensors;
   };
 
 } // namespace server
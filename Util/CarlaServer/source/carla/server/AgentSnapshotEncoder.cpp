@@ -0,0 +1,267 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/server/AgentSnapshotEncoder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "carla/Debug.h"
+#include "carla/Profiler.h"
+
+namespace carla {
+namespace server {
+
+  // ===========================================================================
+  // -- Static local functions -------------------------------------------------
+  // ===========================================================================
+
+  static bool IsDynamic(const uint32_t type) {
+    return (type == CARLA_SERVER_AGENT_VEHICLE) || (type == CARLA_SERVER_AGENT_PEDESTRIAN);
+  }
+
+  static bool operator!=(const carla_vector3d &lhs, const carla_vector3d &rhs) {
+    return (lhs.x != rhs.x) || (lhs.y != rhs.y) || (lhs.z != rhs.z);
+  }
+
+  template <typename T>
+  static T Quantize(const float value, const float step) {
+    const double quantized = std::round(static_cast<double>(value) / step);
+    constexpr double min = std::numeric_limits<T>::min();
+    constexpr double max = std::numeric_limits<T>::max();
+    return static_cast<T>(std::min(max, std::max(min, quantized)));
+  }
+
+  static int32_t QuantizeLocation(const float value) {
+    return Quantize<int32_t>(value, AgentSnapshotEncoder::LOCATION_STEP);
+  }
+
+  static int16_t QuantizeOrientation(const float value) {
+    return Quantize<int16_t>(std::min(1.0f, std::max(-1.0f, value)), 1.0f / 32767.0f);
+  }
+
+  static int16_t QuantizeSpeed(const float value) {
+    return Quantize<int16_t>(value, 0.01f);
+  }
+
+  static bool FitsInt16(const int32_t value) {
+    return (value >= std::numeric_limits<int16_t>::min()) &&
+           (value <= std::numeric_limits<int16_t>::max());
+  }
+
+  // ===========================================================================
+  // -- AgentSnapshotEncoder ---------------------------------------------------
+  // ===========================================================================
+
+  constexpr uint32_t AgentSnapshotEncoder::VERSION;
+
+  constexpr float AgentSnapshotEncoder::LOCATION_STEP;
+
+  template <typename T>
+  void AgentSnapshotEncoder::Append(const T &value) {
+    const auto size = _buffer.size();
+    _buffer.resize(size + sizeof(T));
+    std::memcpy(_buffer.data() + size, &value, sizeof(T));
+  }
+
+  void AgentSnapshotEncoder::AppendPadding() {
+    _buffer.resize(_buffer.size() + (4u - _buffer.size() % 4u) % 4u, 0u);
+  }
+
+  bool AgentSnapshotEncoder::UpdateDescription(const carla_agent &agent) {
+    auto result = _descriptions.emplace(agent.id, Description{});
+    auto &description = result.first->second;
+    const bool is_new = result.second;
+    // Dynamic agents send their transform every frame anyway.
+    const bool changed = is_new || _key_frame ||
+        (description.type != agent.type) ||
+        (description.box_extent != agent.box_extent) ||
+        (!IsDynamic(agent.type) && (
+            (description.transform.location != agent.transform.location) ||
+            (description.transform.orientation != agent.transform.orientation) ||
+            (description.forward_speed != agent.forward_speed)));
+    if (changed) {
+      description.type = agent.type;
+      description.box_extent = agent.box_extent;
+      description.transform = agent.transform;
+      description.forward_speed = agent.forward_speed;
+    }
+    description.last_seen = _frame;
+    return changed;
+  }
+
+  void AgentSnapshotEncoder::WriteDescriptions(const_array_view<carla_agent> agents) {
+    for (auto i : _described) {
+      Append(agents[i].id);
+    }
+    for (auto i : _described) {
+      Append(agents[i].type);
+    }
+    for (auto i : _described) {
+      Append(agents[i].box_extent);
+    }
+    for (auto i : _described) {
+      Append(agents[i].transform.location);
+    }
+    for (auto i : _described) {
+      Append(agents[i].transform.orientation);
+    }
+    for (auto i : _described) {
+      Append(agents[i].forward_speed);
+    }
+  }
+
+  void AgentSnapshotEncoder::WriteDynamic(
+      const_array_view<carla_agent> agents,
+      const bool quantize,
+      uint32_t &flags) {
+    const bool same_ids = !_key_frame && (_ids == _previous_ids);
+    if (same_ids) {
+      flags |= SAME_IDS;
+    } else {
+      for (auto id : _ids) {
+        Append(id);
+      }
+    }
+    if (!quantize) {
+      for (auto i : _dynamic) {
+        Append(agents[i].transform.location);
+      }
+      for (auto i : _dynamic) {
+        Append(agents[i].transform.orientation);
+      }
+      for (auto i : _dynamic) {
+        Append(agents[i].forward_speed);
+      }
+      _previous_quantized = false;
+      return;
+    }
+    flags |= QUANTIZED;
+    _locations.clear();
+    _orientations.clear();
+    _speeds.clear();
+    for (auto i : _dynamic) {
+      const auto &transform = agents[i].transform;
+      _locations.emplace_back(QuantizeLocation(transform.location.x));
+      _locations.emplace_back(QuantizeLocation(transform.location.y));
+      _locations.emplace_back(QuantizeLocation(transform.location.z));
+      _orientations.emplace_back(QuantizeOrientation(transform.orientation.x));
+      _orientations.emplace_back(QuantizeOrientation(transform.orientation.y));
+      _orientations.emplace_back(QuantizeOrientation(transform.orientation.z));
+      _speeds.emplace_back(QuantizeSpeed(agents[i].forward_speed));
+    }
+    bool delta = same_ids && _previous_quantized;
+    for (auto i = 0u; delta && (i < _locations.size()); ++i) {
+      delta = FitsInt16(_locations[i] - _previous_locations[i]);
+    }
+    if (delta) {
+      flags |= DELTA;
+      // Only the agents that changed are sent.
+      _changed.clear();
+      const auto mask_offset = _buffer.size();
+      _buffer.resize(mask_offset + (_speeds.size() + 7u) / 8u, 0u);
+      for (auto i = 0u; i < _speeds.size(); ++i) {
+        const bool changed =
+            (_speeds[i] != _previous_speeds[i]) ||
+            !std::equal(
+                _locations.data() + 3u * i,
+                _locations.data() + 3u * i + 3u,
+                _previous_locations.data() + 3u * i) ||
+            !std::equal(
+                _orientations.data() + 3u * i,
+                _orientations.data() + 3u * i + 3u,
+                _previous_orientations.data() + 3u * i);
+        if (changed) {
+          _buffer[mask_offset + i / 8u] |= static_cast<unsigned char>(1u << (i % 8u));
+          _changed.emplace_back(i);
+        }
+      }
+      AppendPadding();
+      for (auto i : _changed) {
+        for (auto j = 3u * i; j < 3u * i + 3u; ++j) {
+          Append(static_cast<int16_t>(_locations[j] - _previous_locations[j]));
+        }
+      }
+      for (auto i : _changed) {
+        for (auto j = 3u * i; j < 3u * i + 3u; ++j) {
+          Append(_orientations[j]);
+        }
+      }
+      for (auto i : _changed) {
+        Append(_speeds[i]);
+      }
+    } else {
+      for (auto location : _locations) {
+        Append(location);
+      }
+      for (auto orientation : _orientations) {
+        Append(orientation);
+      }
+      for (auto speed : _speeds) {
+        Append(speed);
+      }
+    }
+    AppendPadding();
+    std::swap(_locations, _previous_locations);
+    std::swap(_orientations, _previous_orientations);
+    std::swap(_speeds, _previous_speeds);
+    _previous_quantized = true;
+  }
+
+  const_buffer AgentSnapshotEncoder::Encode(
+      const_array_view<carla_agent> agents,
+      const bool quantize) {
+    CARLA_PROFILE_SCOPE(AgentSnapshotEncoder, Encode);
+    ++_frame;
+    _key_frame = _key_frame_requested;
+    _key_frame_requested = false;
+    _described.clear();
+    _removed.clear();
+    _dynamic.clear();
+    _ids.clear();
+    for (auto i = 0u; i < agents.size(); ++i) {
+      const auto &agent = agents[i];
+      if (UpdateDescription(agent)) {
+        _described.emplace_back(i);
+      }
+      if (IsDynamic(agent.type)) {
+        _dynamic.emplace_back(i);
+        _ids.emplace_back(agent.id);
+      }
+    }
+    for (auto it = _descriptions.begin(); it != _descriptions.end();) {
+      if (it->second.last_seen != _frame) {
+        _removed.emplace_back(it->first);
+        it = _descriptions.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    // Header, flags are patched once known.
+    _buffer.clear();
+    Append(VERSION);
+    const auto flags_offset = _buffer.size();
+    Append(uint32_t(0u));
+    Append(static_cast<uint32_t>(_described.size()));
+    Append(static_cast<uint32_t>(_removed.size()));
+    Append(static_cast<uint32_t>(_dynamic.size()));
+    Append(LOCATION_STEP);
+    WriteDescriptions(agents);
+    for (auto id : _removed) {
+      Append(id);
+    }
+    uint32_t flags = 0u;
+    WriteDynamic(agents, quantize, flags);
+    std::memcpy(_buffer.data() + flags_offset, &flags, sizeof(flags));
+    std::swap(_ids, _previous_ids);
+    DEBUG_ASSERT(_buffer.size() % 4u == 0u);
+    return boost::asio::buffer(_buffer.data(), _buffer.size());
+  }
+
+} // namespace server
+} // namespace carla
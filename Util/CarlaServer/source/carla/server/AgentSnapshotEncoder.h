@@ -0,0 +1,164 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "carla/ArrayView.h"
+#include "carla/NonCopyable.h"
+#include "carla/server/CarlaServerAPI.h"
+#include "carla/server/ServerTraits.h"
+
+namespace carla {
+namespace server {
+
+  /// How the non-player agents are encoded in the measurements.
+  enum class AgentsEncoding {
+    /// One protobuf Agent message per agent.
+    Protobuf,
+    /// Packed snapshot, see AgentSnapshotEncoder.
+    Compact,
+    /// Packed snapshot with quantized, delta-encoded values.
+    CompactQuantized
+  };
+
+  /// Encodes the non-player agents as a packed binary snapshot, sent in the
+  /// "non_player_agents_snapshot" field of the measurements.
+  ///
+  /// Vehicles and pedestrians are "dynamic", their location, orientation and
+  /// speed is sent every frame as a struct of arrays. Everything else about an
+  /// agent (type, box extent, and the transform of the static ones, i.e.
+  /// traffic signs and lights) is sent in a "description" only the first frame
+  /// the agent appears, or if it changed (e.g., a traffic light switching
+  /// color). The encoder keeps the state of the previous frame, it must be
+  /// used for a single connection.
+  ///
+  /// Every value is little-endian, every section is aligned to 4 bytes.
+  ///
+  ///    header {
+  ///      uint32 version, uint32 flags, uint32 number_of_descriptions (D),
+  ///      uint32 number_of_removed (R), uint32 number_of_dynamic (N),
+  ///      float32 location_step
+  ///    }
+  ///    descriptions {
+  ///      uint32 id[D], uint32 type[D], float32 box_extent[D][3],
+  ///      float32 location[D][3], float32 orientation[D][3],
+  ///      float32 forward_speed[D]
+  ///    }
+  ///    removed { uint32 id[R] }
+  ///    dynamic {
+  ///      uint32 id[N], only if not SAME_IDS
+  ///      if not QUANTIZED:
+  ///        float32 location[N][3], float32 orientation[N][3],
+  ///        float32 forward_speed[N]
+  ///      if QUANTIZED and not DELTA:
+  ///        int32 location[N][3], in units of location_step
+  ///        int16 orientation[N][3], in units of 1/32767
+  ///        int16 forward_speed[N], in units of 0.01 km/h
+  ///        padding to 4 bytes
+  ///      if QUANTIZED and DELTA:
+  ///        uint8 changed[(N + 7) / 8], bit i (LSB first) set if the i-th
+  ///          agent changed since the previous frame; padding to 4 bytes
+  ///        only for the M agents that changed:
+  ///          int16 location[M][3], increments since the previous frame
+  ///          int16 orientation[M][3], int16 forward_speed[M]
+  ///          padding to 4 bytes
+  ///    }
+  ///
+  /// SAME_IDS means the dynamic agents are the same and in the same order as
+  /// in the previous frame, DELTA requires it. Types are the
+  /// CARLA_SERVER_AGENT_* values.
+  ///
+  /// A "key frame" has neither flag and describes every agent, it can be
+  /// decoded without the previous frames (removed ids may be unknown then).
+  class AgentSnapshotEncoder : private NonCopyable {
+  public:
+
+    static constexpr uint32_t VERSION = 1u;
+
+    enum Flags : uint32_t {
+      SAME_IDS  = 1u << 0,
+      QUANTIZED = 1u << 1,
+      DELTA     = 1u << 2
+    };
+
+    /// Quantization step of the locations, in centimeters.
+    static constexpr float LOCATION_STEP = 1.0f;
+
+    /// Encode @a agents, returns a buffer owned by the encoder valid until the
+    /// next call.
+    const_buffer Encode(const_array_view<carla_agent> agents, bool quantize);
+
+    /// Make the next frame a key frame, e.g. for a client joining late.
+    void RequestKeyFrame() {
+      _key_frame_requested = true;
+    }
+
+  private:
+
+    struct Description {
+      uint32_t type;
+      carla_vector3d box_extent;
+      carla_transform transform;
+      float forward_speed;
+      uint64_t last_seen;
+    };
+
+    template <typename T>
+    void Append(const T &value);
+
+    void AppendPadding();
+
+    /// Returns whether @a agent's description has to be sent.
+    bool UpdateDescription(const carla_agent &agent);
+
+    void WriteDescriptions(const_array_view<carla_agent> agents);
+
+    void WriteDynamic(const_array_view<carla_agent> agents, bool quantize, uint32_t &flags);
+
+    uint64_t _frame = 0u;
+
+    std::unordered_map<uint32_t, Description> _descriptions;
+
+    std::vector<uint32_t> _described;
+
+    std::vector<uint32_t> _removed;
+
+    std::vector<uint32_t> _dynamic;
+
+    std::vector<uint32_t> _ids;
+
+    std::vector<uint32_t> _previous_ids;
+
+    std::vector<int32_t> _locations;
+
+    std::vector<int32_t> _previous_locations;
+
+    std::vector<int16_t> _orientations;
+
+    std::vector<int16_t> _previous_orientations;
+
+    std::vector<int16_t> _speeds;
+
+    std::vector<int16_t> _previous_speeds;
+
+    std::vector<uint32_t> _changed;
+
+    bool _previous_quantized = false;
+
+    bool _key_frame_requested = false;
+
+    /// Whether the frame being encoded is a key frame.
+    bool _key_frame = false;
+
+    std::vector<unsigned char> _buffer;
+  };
+
+} // namespace server
+} // namespace carla
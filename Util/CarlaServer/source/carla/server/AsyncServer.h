@@ -20,9 +20,10 @@ namespace server {
   // ===========================================================================
 
   /// Asynchronous server. Every "Connect", "Write", and "Read" tasks are
-  /// submitted to a queue of asynchronous jobs. These jobs are executed in a
-  /// single separate thread in order of submission. The "Disconnect()" function
-  /// of the underlying server is assumed to be thread-safe.
+  /// submitted to a queue of asynchronous jobs. These jobs are executed one at
+  /// a time in order of submission, by the threads shared by every server (see
+  /// AsyncService). The "Disconnect()" function of the underlying server is
+  /// assumed to be thread-safe.
   template <typename SERVER>
   class AsyncServer : private NonCopyable {
   public:
@@ -46,11 +47,11 @@ namespace server {
     template <typename T>
     void Execute(WriteTask<T> &task);
 
-    template <typename T>
-    void Execute(StreamReadTask<T> &task);
+    template <typename T, typename B>
+    void Execute(StreamReadTask<T, B> &task);
 
-    template <typename T>
-    void Execute(StreamWriteTask<T> &task);
+    template <typename T, typename B>
+    void Execute(StreamWriteTask<T, B> &task);
 
   private:
 
@@ -109,9 +110,9 @@ namespace server {
   }
 
   template <typename S>
-  template <typename T>
-  void AsyncServer<S>::Execute(StreamReadTask<T> &task) {
-    auto job = [this, buffer=task.buffer(), timeout=task.timeout()]() {
+  template <typename T, typename B>
+  void AsyncServer<S>::Execute(StreamReadTask<T, B> &task) {
+    auto job = [this, buffer=task.buffer(), timeout=task.timeout(), retry=task.retry_on_timeout()]() {
       error_code ec;
       do {
         CARLA_PROFILE_SCOPE(AsyncServer, StreamRead);
@@ -119,8 +120,14 @@ namespace server {
           ec = errc::operation_aborted();
           break;
         }
-        auto writer = buffer->MakeWriter();
-        ec = _server.Read(*writer, timeout);
+        // Read first, so a read that fails does not publish a value.
+        T message;
+        ec = _server.Read(message, timeout);
+        if (!ec) {
+          *buffer->MakeWriter() = std::move(message);
+        } else if (retry && (ec == errc::timed_out())) {
+          ec = errc::success();
+        }
       } while (!ec);
       return ec;
     };
@@ -128,8 +135,8 @@ namespace server {
   }
 
   template <typename S>
-  template <typename T>
-  void AsyncServer<S>::Execute(StreamWriteTask<T> &task) {
+  template <typename T, typename B>
+  void AsyncServer<S>::Execute(StreamWriteTask<T, B> &task) {
     auto job = [this, buffer=task.buffer(), timeout=task.timeout()]() {
       error_code ec;
       do {
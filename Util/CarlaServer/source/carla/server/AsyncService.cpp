@@ -6,25 +6,52 @@
 
 #include "carla/Logging.h"
 #include "carla/server/AsyncService.h"
+#include "carla/server/Executor.h"
 
 namespace carla {
 namespace server {
 
   AsyncService::AsyncService() {
-    _thread = std::thread([this] {
-      while (!_queue.done()) {
-        job_type job;
-        if (_queue.WaitAndPop(job)) {
-          job();
-        }
-      }
-    });
+    Executor::GetInstance().Reserve(1u);
   }
 
   AsyncService::~AsyncService() {
-    _queue.set_done();
-    if (_thread.joinable()) {
-      _thread.join();
+    std::queue<Job> discarded;
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _done = true;
+      _idle.wait(lock, [this]() { return !_running; });
+      std::swap(discarded, _pending_jobs);
+    }
+    Executor::GetInstance().Release(1u);
+  }
+
+  void AsyncService::Push(Job job) {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _pending_jobs.push(std::move(job));
+      if (_running || _done) {
+        return;
+      }
+      _running = true;
+    }
+    Executor::GetInstance().Post([this]() { RunPendingJobs(); });
+  }
+
+  void AsyncService::RunPendingJobs() {
+    for (;;) {
+      Job job;
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_done || _pending_jobs.empty()) {
+          _running = false;
+          _idle.notify_all();
+          return;
+        }
+        job = std::move(_pending_jobs.front());
+        _pending_jobs.pop();
+      }
+      job();
     }
   }
 
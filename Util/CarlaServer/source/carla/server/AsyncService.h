@@ -6,30 +6,34 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
 #include <future>
+#include <mutex>
+#include <queue>
 #include <type_traits>
 
 #include "carla/NonCopyable.h"
-#include "carla/server/ThreadSafeQueue.h"
+#include "carla/server/Job.h"
 
 namespace carla {
 namespace server {
 
-  /// Asynchronous service. Posted tasks are executed in a single separate
-  /// thread in order of submission.
+  /// Asynchronous service. Posted tasks are executed in order of submission,
+  /// one at a time, by the threads of the process-wide Executor. The service
+  /// reserves one thread of the executor for as long as it lives, so its
+  /// tasks may block.
   class AsyncService : private NonCopyable {
-  private:
-
-    using job_type = std::function<void()>;
-
   public:
 
     AsyncService();
 
+    /// Tasks not yet started are discarded (their futures are left with a
+    /// broken promise), waits for the running one to finish.
     ~AsyncService();
 
     bool done() const {
-      return _queue.done();
+      return _done;
     }
 
     /// Post a task to be executed by the asynchronous process. Its return value
@@ -37,17 +41,30 @@ namespace server {
     /// through the returned std::future object.
     template <typename F, typename R = std::result_of_t<F()>>
     std::future<R> Post(F task) {
-      auto ptask = std::make_shared<std::packaged_task<R()>>(std::move(task));
-      auto future = ptask->get_future();
-      _queue.Push([ptask{std::move(ptask)}]() { (*ptask)(); });
+      std::packaged_task<R()> ptask(std::move(task));
+      auto future = ptask.get_future();
+      Push(std::move(ptask));
       return future;
     }
 
   private:
 
-    ThreadSafeQueue<job_type> _queue;
+    void Push(Job job);
+
+    /// Run by the executor, executes the pending jobs until there are none
+    /// left.
+    void RunPendingJobs();
+
+    std::atomic_bool _done{false};
+
+    std::mutex _mutex;
+
+    std::condition_variable _idle;
+
+    std::queue<Job> _pending_jobs;
 
-    std::thread _thread;
+    /// Whether RunPendingJobs is posted or running.
+    bool _running = false;
   };
 
 } // namespace server
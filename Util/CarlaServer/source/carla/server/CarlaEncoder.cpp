@@ -27,6 +27,10 @@ namespace server {
     return array_view::make_const(values.non_player_agents, values.number_of_non_player_agents);
   }
 
+  static void Parse(google::protobuf::MessageLite &message, const_array_view<char> data) {
+    message.ParseFromArray(data.data(), static_cast<int>(data.size()));
+  }
+
   static void Set(cs::Vector3D *lhs, const carla_vector3d &rhs) {
     DEBUG_ASSERT(lhs != nullptr);
     lhs->set_x(rhs.x);
@@ -94,6 +98,26 @@ namespace server {
     }
   }
 
+  static void Set(RequestNewEpisode &lhs, const cs::RequestNewEpisode &rhs) {
+    const std::string &file = rhs.ini_file();
+    auto data = std::make_unique<char[]>(file.size());
+    std::memcpy(data.get(), file.c_str(), file.size());
+    lhs.data = std::move(data);
+    lhs.values.ini_file = lhs.data.get();
+    lhs.values.ini_file_length = file.size();
+    lhs.keep_agent_connections = rhs.keep_agent_connections();
+  }
+
+  static void Set(WorldSnapshotRequest &lhs, const cs::WorldSnapshotRequest &rhs) {
+    lhs.values.restore = rhs.has_restore();
+    const std::string &snapshot = rhs.restore().snapshot();
+    auto data = std::make_unique<char[]>(snapshot.size());
+    std::memcpy(data.get(), snapshot.data(), snapshot.size());
+    lhs.data = std::move(data);
+    lhs.values.snapshot = lhs.data.get();
+    lhs.values.snapshot_size = static_cast<uint32_t>(snapshot.size());
+  }
+
   std::string CarlaEncoder::Encode(const carla_scene_description &values) {
     auto *message = _protobuf.CreateMessage<cs::SceneDescription>();
     DEBUG_ASSERT(message != nullptr);
@@ -103,20 +127,77 @@ namespace server {
     return Protobuf::Encode(*message);
   }
 
-  std::string CarlaEncoder::Encode(const carla_episode_ready &values) {
+  std::string CarlaEncoder::Encode(const EpisodeReady &values) {
     auto *message = _protobuf.CreateMessage<cs::EpisodeReady>();
     DEBUG_ASSERT(message != nullptr);
-    message->set_ready(values.ready);
+    message->set_ready(values.values.ready);
+    message->set_number_of_sensor_streams(values.values.number_of_sensor_streams);
+    message->set_shared_memory_streams(values.values.shared_memory_capacity > 0u);
+    message->set_agent_connections_kept(values.agent_connections_kept);
+    message->set_first_frame_number(values.first_frame_number);
+    for (auto &phase : values.phases) {
+      auto *item = message->add_phases();
+      item->set_name(phase.name);
+      item->set_milliseconds(phase.milliseconds);
+    }
     return Protobuf::Encode(*message);
   }
 
+  std::string CarlaEncoder::Encode(const WorldSnapshot &values) {
+    // Not in the arena either, it lives as long as the world server and the
+    // client may save and restore the world any number of times.
+    static thread_local cs::WorldSnapshot message;
+    message.set_success(values.values.success);
+    if (values.values.snapshot != nullptr) {
+      message.set_snapshot(values.values.snapshot, values.values.snapshot_size);
+    }
+    message.set_first_frame_number(values.first_frame_number);
+    auto result = Protobuf::Encode(message);
+    message.Clear();
+    return result;
+  }
+
   std::string CarlaEncoder::Encode(const carla_measurements &values) {
-    static thread_local auto *message = _protobuf.CreateMessage<cs::Measurements>();
-    DEBUG_ASSERT(message != nullptr);
-    message->set_platform_timestamp(values.platform_timestamp);
-    message->set_game_timestamp(values.game_timestamp);
+    return Encode(values, 0u);
+  }
+
+  std::string CarlaEncoder::Encode(
+      const carla_measurements &values,
+      const uint64_t frame_number) {
+    FrameTimestamps timestamps;
+    timestamps.tick = values.tick_timestamp;
+    timestamps.readback = values.readback_timestamp;
+    return Encode(values, frame_number, timestamps);
+  }
+
+  std::string CarlaEncoder::Encode(
+      const carla_measurements &values,
+      const uint64_t frame_number,
+      const FrameTimestamps &timestamps) {
+    // Reused by every call of this thread. Not in the arena, the threads of
+    // the executor outlive the encoder.
+    static thread_local cs::Measurements message;
+    SetMeasurements(message, values, frame_number, timestamps);
+    SetNonPlayerAgents(message, agents(values));
+    return Protobuf::Encode(message);
+  }
+
+  void CarlaEncoder::SetMeasurements(
+      cs::Measurements &message,
+      const carla_measurements &values,
+      const uint64_t frame_number,
+      const FrameTimestamps &timestamps) {
+    message.set_frame_number(frame_number);
+    message.set_platform_timestamp(values.platform_timestamp);
+    message.set_game_timestamp(values.game_timestamp);
+    auto *frame_timestamps = message.mutable_frame_timestamps();
+    DEBUG_ASSERT(frame_timestamps != nullptr);
+    frame_timestamps->set_tick(timestamps.tick);
+    frame_timestamps->set_readback(timestamps.readback);
+    frame_timestamps->set_queued(timestamps.queued);
+    frame_timestamps->set_encoding(timestamps.encoding);
     // Player measurements.
-    auto *player = message->mutable_player_measurements();
+    auto *player = message.mutable_player_measurements();
     DEBUG_ASSERT(player != nullptr);
     Set(player->mutable_transform(), values.player_measurements.transform);
     Set(player->mutable_acceleration(), values.player_measurements.acceleration);
@@ -127,36 +208,56 @@ namespace server {
     player->set_intersection_otherlane(values.player_measurements.intersection_otherlane);
     player->set_intersection_offroad(values.player_measurements.intersection_offroad);
     Set(player->mutable_autopilot_control(), values.player_measurements.autopilot_control);
-    // Non-player agents.
-    message->clear_non_player_agents(); // we need to clear as we cache the message.
-    for (auto &agent : agents(values)) {
-      Set(message->add_non_player_agents(), agent);
+  }
+
+  void CarlaEncoder::SetNonPlayerAgents(
+      cs::Measurements &message,
+      const const_array_view<carla_agent> agents) {
+    message.clear_non_player_agents(); // we need to clear as we cache the message.
+    for (auto &agent : agents) {
+      Set(message.add_non_player_agents(), agent);
     }
-    return Protobuf::Encode(*message);
   }
 
-  bool CarlaEncoder::Decode(const std::string &str, RequestNewEpisode &values) {
-    auto *message = _protobuf.CreateMessage<cs::RequestNewEpisode>();
-    DEBUG_ASSERT(message != nullptr);
-    message->ParseFromString(str);
-    if (message->IsInitialized()) {
-      const std::string &file = message->ini_file();
-      auto data = std::make_unique<char[]>(file.size());
-      std::memcpy(data.get(), file.c_str(), file.size());
-      values.data = std::move(data);
-      values.values.ini_file = values.data.get();
-      values.values.ini_file_length = file.size();
-      return true;
-    } else {
-      log_error("invalid protobuf message: request new episode");
-      return false;
+  bool CarlaEncoder::Decode(const const_array_view<char> frame, WorldRequest &values) {
+    // As the world snapshot above, not in the arena.
+    static thread_local cs::WorldRequest message;
+    Parse(message, frame);
+    bool success = true;
+    switch (message.request_case()) {
+      case cs::WorldRequest::kNewEpisode:
+        values.is_snapshot = false;
+        Set(values.new_episode, message.new_episode());
+        break;
+      case cs::WorldRequest::kSnapshot:
+        success = (message.snapshot().action_case() != cs::WorldSnapshotRequest::ACTION_NOT_SET);
+        if (success) {
+          values.is_snapshot = true;
+          Set(values.snapshot, message.snapshot());
+        }
+        break;
+      default: {
+        // Older clients send a bare RequestNewEpisode, its fields are all
+        // below the ones of WorldRequest.
+        static thread_local cs::RequestNewEpisode new_episode;
+        Parse(new_episode, frame);
+        values.is_snapshot = false;
+        Set(values.new_episode, new_episode);
+        new_episode.Clear();
+        break;
+      }
     }
+    message.Clear();
+    if (!success) {
+      log_error("invalid protobuf message: world request");
+    }
+    return success;
   }
 
-  bool CarlaEncoder::Decode(const std::string &str, carla_episode_start &values) {
+  bool CarlaEncoder::Decode(const const_array_view<char> frame, carla_episode_start &values) {
     auto *message = _protobuf.CreateMessage<cs::EpisodeStart>();
     DEBUG_ASSERT(message != nullptr);
-    message->ParseFromString(str);
+    Parse(*message, frame);
     if (message->IsInitialized()) {
       values.player_start_spot_index = message->player_start_spot_index();
       return true;
@@ -166,19 +267,22 @@ namespace server {
     }
   }
 
-  bool CarlaEncoder::Decode(const std::string &str, carla_control &values) {
-    static thread_local auto *message = _protobuf.CreateMessage<cs::Control>();
-    DEBUG_ASSERT(message != nullptr);
-    message->ParseFromString(str);
-    if (message->IsInitialized()) {
-      values.steer = message->steer();
-      values.throttle = message->throttle();
-      values.brake = message->brake();
-      values.hand_brake = message->hand_brake();
-      values.reverse = message->reverse();
+  bool CarlaEncoder::Decode(const const_array_view<char> frame, ControlMessage &values) {
+    // Decoded as soon as it arrives.
+    values.timestamp = FrameTracer::Now();
+    // As the measurements above, reused by every call of this thread.
+    static thread_local cs::Control message;
+    Parse(message, frame);
+    if (message.IsInitialized()) {
+      values.values.steer = message.steer();
+      values.values.throttle = message.throttle();
+      values.values.brake = message.brake();
+      values.values.hand_brake = message.hand_brake();
+      values.values.reverse = message.reverse();
+      values.frame_number = message.frame_number();
       return true;
     } else {
-      log_error("invalid protobuf message: control");
+      LOG_RATE_LIMITED(1000, log_error, "invalid protobuf message: control");
       return false;
     }
   }
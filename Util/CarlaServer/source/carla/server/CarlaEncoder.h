@@ -6,9 +6,18 @@
 
 #pragma once
 
+#include "carla/ArrayView.h"
 #include "carla/server/CarlaServerAPI.h"
+#include "carla/server/ControlMessage.h"
+#include "carla/server/EpisodeReady.h"
+#include "carla/server/FrameTracer.h"
 #include "carla/server/Protobuf.h"
-#include "carla/server/RequestNewEpisode.h"
+#include "carla/server/WorldRequest.h"
+#include "carla/server/WorldSnapshot.h"
+
+namespace carla_server {
+  class Measurements;
+} // namespace carla_server
 
 namespace carla {
 namespace server {
@@ -27,8 +36,8 @@ namespace server {
       return Protobuf::Encode(values);
     }
 
-    bool Decode(std::string message, std::string &values) {
-      values = std::move(message);
+    bool Decode(const_array_view<char> message, std::string &values) {
+      values.assign(message.begin(), message.end());
       return true;
     }
 
@@ -40,15 +49,46 @@ namespace server {
 
     std::string Encode(const carla_scene_description &values);
 
-    std::string Encode(const carla_episode_ready &values);
+    std::string Encode(const EpisodeReady &values);
+
+    std::string Encode(const WorldSnapshot &values);
 
     std::string Encode(const carla_measurements &values);
 
-    bool Decode(const std::string &message, RequestNewEpisode &values);
+    /// Same as above but tagging the measurements with @a frame_number.
+    std::string Encode(const carla_measurements &values, uint64_t frame_number);
+
+    /// Same as above, with the time-stamps of the stages the frame went
+    /// through.
+    std::string Encode(
+        const carla_measurements &values,
+        uint64_t frame_number,
+        const FrameTimestamps &timestamps);
+
+    /// Messages are parsed in place, @a message is not used after returning.
+    bool Decode(const_array_view<char> message, WorldRequest &values);
+
+    bool Decode(const_array_view<char> message, carla_episode_start &values);
 
-    bool Decode(const std::string &message, carla_episode_start &values);
+    bool Decode(const_array_view<char> message, ControlMessage &values);
+
+    /// @}
+    // =========================================================================
+    /// @name Partial encodings (see MeasurementsEncoder)
+    // =========================================================================
+    /// @{
 
-    bool Decode(const std::string &message, carla_control &values);
+    /// Set every field of @a message except the non-player agents.
+    static void SetMeasurements(
+        carla_server::Measurements &message,
+        const carla_measurements &values,
+        uint64_t frame_number,
+        const FrameTimestamps &timestamps);
+
+    /// Replace the non-player agents of @a message by @a agents.
+    static void SetNonPlayerAgents(
+        carla_server::Measurements &message,
+        const_array_view<carla_agent> agents);
 
     /// @}
 
@@ -4,10 +4,15 @@
 // This work is licensed under the terms of the MIT license.
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
+#include <fstream>
+
 #include "carla/Debug.h"
 #include "carla/Logging.h"
+#include "carla/Profiler.h"
 #include "carla/server/AgentServer.h"
 #include "carla/server/CarlaServer.h"
+#include "carla/server/Executor.h"
+#include "carla/server/FrameTracer.h"
 
 using namespace carla;
 using namespace carla::server;
@@ -28,6 +33,7 @@ const int32_t CARLA_SERVER_SUCCESS = errc::success().value();;
 const int32_t CARLA_SERVER_TRY_AGAIN = errc::try_again().value();
 const int32_t CARLA_SERVER_TIMED_OUT = errc::timed_out().value();
 const int32_t CARLA_SERVER_OPERATION_ABORTED = errc::operation_aborted().value();
+const int32_t CARLA_SERVER_NOT_DUE = errc::not_due().value();
 
 CarlaServerPtr carla_make_server() {
   return new carla::server::CarlaServer;
@@ -65,7 +71,7 @@ int32_t carla_read_request_new_episode(
   auto ec = Cast(self)->TryRead(values, timeout_t::milliseconds(timeout));
   if (!ec) {
     log_debug("received valid request new episode");
-    Cast(self)->KillAgentServer();
+    Cast(self)->EndEpisode();
   }
   return ec.value();
 }
@@ -87,14 +93,110 @@ int32_t carla_read_episode_start(
   return Cast(self)->TryRead(values, timeout_t::milliseconds(timeout)).value();
 }
 
+int32_t carla_read_world_snapshot_request(
+      CarlaServerPtr self,
+      carla_world_snapshot_request &values,
+      const uint32_t timeout) {
+  auto ec = Cast(self)->TryRead(values, timeout_t::milliseconds(timeout));
+  if (!ec) {
+    log_debug("received world snapshot request, restore =", values.restore);
+  }
+  return ec.value();
+}
+
+int32_t carla_write_world_snapshot(
+      CarlaServerPtr self,
+      const carla_world_snapshot &values,
+      const uint32_t timeout) {
+  CARLA_PROFILE_SCOPE(C_API, WriteWorldSnapshot);
+  auto result = Cast(self)->Write(values);
+  error_code ec = errc::timed_out();
+  future::wait_and_get(result, ec, timeout_t::milliseconds(timeout));
+  return ec.value();
+}
+
+void carla_set_stream_buffering(
+      CarlaServerPtr self,
+      const uint32_t depth,
+      const bool block_when_full) {
+  Cast(self)->SetStreamBuffering(
+      depth,
+      block_when_full ? BackPressurePolicy::Block : BackPressurePolicy::DropOldest);
+}
+
+void carla_set_control_lookahead(
+      CarlaServerPtr self,
+      const uint32_t lookahead) {
+  Cast(self)->SetControlLookahead(lookahead);
+}
+
+void carla_set_non_player_agents_encoding(
+      CarlaServerPtr self,
+      const bool compact,
+      const bool quantize) {
+  Cast(self)->SetNonPlayerAgentsEncoding(
+      !compact ? AgentsEncoding::Protobuf :
+      !quantize ? AgentsEncoding::Compact :
+      AgentsEncoding::CompactQuantized);
+}
+
+void carla_set_observers(
+      CarlaServerPtr self,
+      const uint32_t port,
+      const uint32_t max_observers,
+      const uint32_t buffer_depth,
+      const bool disconnect_slow) {
+  Cast(self)->SetObservers(
+      port,
+      max_observers,
+      buffer_depth,
+      disconnect_slow ? SlowObserverPolicy::Disconnect : SlowObserverPolicy::DropFrames);
+}
+
+void carla_set_server_threads(
+      const uint32_t number_of_threads,
+      const uint32_t *cpus,
+      const uint32_t number_of_cpus) {
+  Executor::GetInstance().Configure(
+      number_of_threads,
+      cpus != nullptr ?
+          std::vector<uint32_t>(cpus, cpus + number_of_cpus) :
+          std::vector<uint32_t>());
+}
+
+uint64_t carla_get_timestamp() {
+  return FrameTracer::Now();
+}
+
+void carla_set_profiler(const bool enabled, const bool trace) {
+  Profiler::GetInstance().Enable(enabled, trace);
+}
+
+void carla_print_profiler_summary() {
+  Profiler::GetInstance().PrintSummary();
+}
+
+int32_t carla_write_profiler_trace(const char *file_path, const uint32_t milliseconds) {
+  std::ofstream file(file_path);
+  if (file) {
+    Profiler::GetInstance().WriteTrace(file, 1000000u * static_cast<uint64_t>(milliseconds));
+  }
+  if (!file) {
+    log_error("failed to write profiler trace", file_path);
+    return boost::system::errc::io_error;
+  }
+  return CARLA_SERVER_SUCCESS;
+}
+
 int32_t carla_write_episode_ready(
       CarlaServerPtr self,
       const carla_episode_ready &values,
       const uint32_t timeout) {
   if (values.ready) {
-    Cast(self)->StartAgentServer();
+    Cast(self)->StartAgentServer(values.number_of_sensor_streams, values.shared_memory_capacity);
   } else {
     log_error("start agent server cancelled: episode_ready = false");
+    Cast(self)->KillAgentServer();
   }
   error_code ec = errc::timed_out();
   auto result = Cast(self)->Write(values);
@@ -132,3 +234,20 @@ int32_t carla_write_measurements(
         carla::const_array_view<carla_image>(images, number_of_images)).value();
   }
 }
+
+int32_t carla_write_measurements_zero_copy(
+      CarlaServerPtr self,
+      const carla_measurements &values,
+      const struct carla_image_lease *images,
+      const uint32_t number_of_images) {
+  CARLA_PROFILE_SCOPE(C_API, WriteMeasurementsZeroCopy);
+  const carla::const_array_view<carla_image_lease> leases(images, number_of_images);
+  auto agent = Cast(self)->GetAgentServer();
+  if (agent == nullptr) {
+    log_debug("trying to write measurements but agent server is missing");
+    carla::server::ReleaseImageLeases(leases);
+    return CARLA_SERVER_OPERATION_ABORTED;
+  } else {
+    return agent->WriteMeasurements(values, leases).value();
+  }
+}
@@ -0,0 +1,27 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstdint>
+
+#include "carla/server/CarlaServerAPI.h"
+
+namespace carla {
+namespace server {
+
+  /// A carla_control as received, tagged with the number of the frame of the
+  /// measurements it replies to.
+  struct ControlMessage {
+    carla_control values;
+    /// Zero if the client did not tag it.
+    uint64_t frame_number = 0u;
+    /// When it was received, in nanoseconds of FrameTracer::Now().
+    uint64_t timestamp = 0u;
+  };
+
+} // namespace server
+} // namespace carla
@@ -0,0 +1,217 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/server/CoroutineTCPServer.h"
+
+#include <boost/asio/write.hpp>
+#include <boost/system/system_error.hpp>
+
+#include "carla/Logging.h"
+
+#include <boost/asio/yield.hpp>
+
+using namespace boost::asio::ip;
+
+namespace carla {
+namespace server {
+
+#define LOG_PREFIX "tcpserver", _port, ':'
+
+  // ===========================================================================
+  // -- CoroutineTCPServer -----------------------------------------------------
+  // ===========================================================================
+
+  constexpr uint32_t CoroutineTCPServer::MAX_FRAME_SIZE;
+  constexpr size_t CoroutineTCPServer::MAX_QUEUED_FRAMES;
+  constexpr size_t CoroutineTCPServer::INITIAL_RECEIVE_BUFFER_SIZE;
+
+  CoroutineTCPServer::CoroutineTCPServer()
+      : _service(),
+        _work(_service),
+        _acceptor(_service),
+        _socket(_service),
+        _deadline(_service),
+        _reader(INITIAL_RECEIVE_BUFFER_SIZE),
+        _read_error(boost::asio::error::not_connected) {}
+
+  CoroutineTCPServer::~CoroutineTCPServer() {
+    CloseConnection();
+  }
+
+  void CoroutineTCPServer::Disconnect() {
+    log_debug(LOG_PREFIX, "request close connection");
+    _service.post([this]() { CloseConnection(); });
+  }
+
+  error_code CoroutineTCPServer::Connect(const uint32_t port, const time_duration timeout) {
+    if (_acceptor.is_open() || _socket.is_open()) {
+      log_error(LOG_PREFIX, "already connected");
+      return boost::asio::error::already_connected;
+    }
+    _port = port;
+    try {
+      _acceptor = tcp::acceptor(_service, tcp::endpoint(tcp::v4(), port));
+    } catch (const boost::system::system_error &exception) {
+      log_error(LOG_PREFIX, "unable to accept connection:", exception.what());
+      return exception.code();
+    }
+
+    bool finished = false;
+    error_code ec;
+    _acceptor.async_accept(_socket, [&](const error_code &result) {
+      finished = true;
+      ec = result;
+    });
+    if (!RunUntil([&]() { return finished; }, timeout)) {
+      CloseConnection();
+      RunUntil([&]() { return finished; }, boost::posix_time::pos_infin);
+      ec = errc::timed_out();
+    }
+    // Only one connection is accepted.
+    error_code ignored;
+    _acceptor.close(ignored);
+
+    if (ec) {
+      log_error(LOG_PREFIX, "connection failed:", ec.message());
+      return ec;
+    }
+    log_info(LOG_PREFIX, "connected");
+    _socket.set_option(tcp::no_delay(true), ignored);
+    _reader.Clear();
+    _read_error = error_code();
+    _read_paused = false;
+    _read_coroutine = boost::asio::coroutine();
+    ReadLoop();
+    return ec;
+  }
+
+  error_code CoroutineTCPServer::ReadFrame(
+      const_array_view<char> &frame,
+      const time_duration timeout) {
+    if (_read_paused) {
+      // Resumed here, receiving may move the frame popped last time.
+      _read_paused = false;
+      ReadLoop();
+    }
+    auto ready = [this]() { return (_reader.GetNumberOfFrames() > 0u) || _read_error; };
+    if (!RunUntil(ready, timeout)) {
+      return errc::timed_out();
+    }
+    if (_reader.GetNumberOfFrames() == 0u) {
+      return _read_error;
+    }
+    frame = _reader.Pop();
+    return errc::success();
+  }
+
+  error_code CoroutineTCPServer::ReadFrame(std::string &frame, const time_duration timeout) {
+    const_array_view<char> view;
+    auto ec = ReadFrame(view, timeout);
+    if (!ec) {
+      frame.assign(view.begin(), view.end());
+    }
+    return ec;
+  }
+
+  error_code CoroutineTCPServer::Write(const_buffer buffer, const time_duration timeout) {
+    return WriteSequence(boost::asio::buffer(buffer), timeout);
+  }
+
+  error_code CoroutineTCPServer::Write(
+      const std::vector<const_buffer> &buffers,
+      const time_duration timeout) {
+    return WriteSequence(buffers, timeout);
+  }
+
+  template <typename ConstBufferSequence>
+  error_code CoroutineTCPServer::WriteSequence(
+      const ConstBufferSequence &buffers,
+      const time_duration timeout) {
+    bool finished = false;
+    error_code ec;
+    boost::asio::async_write(_socket, buffers, [&](const error_code &result, size_t) {
+      finished = true;
+      ec = result;
+    });
+    if (!RunUntil([&]() { return finished; }, timeout)) {
+      log_info(LOG_PREFIX, "write timed out");
+      CloseConnection();
+      RunUntil([&]() { return finished; }, boost::posix_time::pos_infin);
+      ec = errc::timed_out();
+    }
+    if (ec) {
+      log_error(LOG_PREFIX, "error writing message:", ec.message());
+    }
+    return ec;
+  }
+
+  template <typename F>
+  bool CoroutineTCPServer::RunUntil(F done, const time_duration timeout) {
+    // Run whatever is ready without arming the deadline.
+    _service.poll();
+    if (done() || (timeout <= time_duration())) {
+      // A zero time-out does not block.
+      return done();
+    }
+    const uint64_t operation = ++_operation;
+    if (!timeout.is_pos_infinity()) {
+      _deadline.expires_from_now(timeout);
+      _deadline.async_wait([this, operation](const error_code &ec) {
+        if (!ec) {
+          _expired_operation = operation;
+        }
+      });
+    }
+    while (!done() && (_expired_operation != operation)) {
+      _service.run_one();
+    }
+    _deadline.cancel();
+    return done();
+  }
+
+  void CoroutineTCPServer::CloseConnection() {
+    if (_acceptor.is_open() || _socket.is_open()) {
+      log_info(LOG_PREFIX, "disconnecting");
+    }
+    error_code ignored;
+    _acceptor.close(ignored);
+    _socket.close(ignored);
+  }
+
+  void CoroutineTCPServer::ReadLoop(error_code ec, const size_t bytes_transferred) {
+    if (!ec) {
+      reenter (_read_coroutine) {
+        for (;;) {
+          yield _socket.async_read_some(
+              _reader.Prepare(),
+              [this](const error_code &error, size_t bytes) { ReadLoop(error, bytes); });
+          if (!_reader.Commit(bytes_transferred)) {
+            ec.assign(boost::system::errc::illegal_byte_sequence, boost::system::system_category());
+            break;
+          }
+          if (_reader.GetNumberOfFrames() >= MAX_QUEUED_FRAMES) {
+            // Resumed by ReadFrame.
+            _read_paused = true;
+            yield;
+          }
+        }
+      }
+    }
+    if (ec) {
+      if (ec != boost::asio::error::operation_aborted) {
+        log_info(LOG_PREFIX, "error reading message:", ec.message());
+      }
+      _read_error = ec;
+      CloseConnection();
+    }
+  }
+
+#undef LOG_PREFIX
+
+} // namespace server
+} // namespace carla
+
+#include <boost/asio/unyield.hpp>
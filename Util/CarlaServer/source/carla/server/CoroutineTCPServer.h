@@ -0,0 +1,120 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <boost/asio/coroutine.hpp>
+#include <boost/asio/deadline_timer.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/ip/tcp.hpp>
+
+#include "carla/NonCopyable.h"
+#include "carla/server/FrameReader.h"
+#include "carla/server/ServerTraits.h"
+
+namespace carla {
+namespace server {
+
+  /// TCP server built on a stackless coroutine, a drop-in replacement of
+  /// TCPServer for connections that mostly receive.
+  ///
+  /// Once connected, a read is always posted: a coroutine receives as much
+  /// data as available into a FrameReader, which splits it into frames
+  /// [(uint32_t)size, data] in place. Like TCPServer, the io_service is run by the thread calling
+  /// Connect, ReadFrame, and Write, so these must not be called concurrently.
+  /// ReadFrame does not touch the socket if a frame is already queued, and
+  /// arms the deadline only if none arrives right away.
+  ///
+  /// Time-outs apply to each call only. A ReadFrame that times out leaves the
+  /// connection untouched, the frame is returned by the next call. A Write that
+  /// times out closes the connection though, the peer would be left with a
+  /// partial message.
+  class CoroutineTCPServer : private NonCopyable {
+  public:
+
+    /// Frames larger than this are considered a protocol error.
+    static constexpr uint32_t MAX_FRAME_SIZE = FrameReader::MAX_FRAME_SIZE;
+
+    /// The read coroutine pauses when this many frames are waiting.
+    static constexpr size_t MAX_QUEUED_FRAMES = 1024u;
+
+    static constexpr size_t INITIAL_RECEIVE_BUFFER_SIZE = 64u * 1024u;
+
+    CoroutineTCPServer();
+
+    ~CoroutineTCPServer();
+
+    /// Posts a job to disconnect the server.
+    void Disconnect();
+
+    error_code Connect(uint32_t port, time_duration timeout);
+
+    /// Pop the next frame received, without its size prefix. With a zero
+    /// @a timeout it only returns the frames already received.
+    ///
+    /// @a frame points to the receive buffer, it is valid until the next call
+    /// to any function of the server.
+    error_code ReadFrame(const_array_view<char> &frame, time_duration timeout);
+
+    /// Same as above but copying the frame.
+    error_code ReadFrame(std::string &frame, time_duration timeout);
+
+    error_code Write(const_buffer buffer, time_duration timeout);
+
+    /// Gather-write the sequence of buffers as a single operation.
+    error_code Write(const std::vector<const_buffer> &buffers, time_duration timeout);
+
+  private:
+
+    template <typename ConstBufferSequence>
+    error_code WriteSequence(const ConstBufferSequence &buffers, time_duration timeout);
+
+    /// Run the io_service until @a done returns true or @a timeout expires.
+    /// Returns whether it is done.
+    template <typename F>
+    bool RunUntil(F done, time_duration timeout);
+
+    void CloseConnection();
+
+    /// The read coroutine.
+    void ReadLoop(error_code ec = error_code(), size_t bytes_transferred = 0u);
+
+    boost::asio::io_service _service;
+
+    /// Keeps the io_service running while idle.
+    boost::asio::io_service::work _work;
+
+    boost::asio::ip::tcp::acceptor _acceptor;
+
+    boost::asio::ip::tcp::socket _socket;
+
+    boost::asio::deadline_timer _deadline;
+
+    /// Incremented every time the deadline is armed, so an expiry handler
+    /// running late does not affect the next operation.
+    uint64_t _operation = 0u;
+
+    uint64_t _expired_operation = 0u;
+
+    uint32_t _port = 0u;
+
+    // -- Read coroutine -------------------------------------------------------
+
+    boost::asio::coroutine _read_coroutine;
+
+    FrameReader _reader;
+
+    /// Set when the read coroutine stops, returned once the frames are read.
+    error_code _read_error;
+
+    bool _read_paused = false;
+  };
+
+} // namespace server
+} // namespace carla
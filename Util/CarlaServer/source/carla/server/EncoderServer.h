@@ -6,17 +6,26 @@
 
 #pragma once
 
+#include <memory>
+#include <vector>
+
 #include "carla/NonCopyable.h"
 #include "carla/Logging.h"
+#include "carla/Profiler.h"
 #include "carla/server/CarlaEncoder.h"
+#include "carla/server/ImageCompressor.h"
+#include "carla/server/MeasurementsEncoder.h"
 #include "carla/server/MeasurementsMessage.h"
+#include "carla/server/SensorMessage.h"
 #include "carla/server/ServerTraits.h"
+#include "carla/server/StreamBroadcaster.h"
 
 namespace carla {
 namespace server {
 
   /// Wrapper around a server for encoding and decoding the messages with a
-  /// CarlaEncoder.
+  /// CarlaEncoder. Measurements and sensor messages written are published to
+  /// the broadcaster too, if any.
   template <typename SERVER>
   class EncoderServer : private NonCopyable {
   public:
@@ -29,6 +38,13 @@ namespace server {
       : _server(std::forward<Args>(args)...),
         _encoder(encoder) {}
 
+    /// @a broadcaster, if not null, must outlive the server.
+    template<typename... Args>
+    EncoderServer(encoder_type &encoder, StreamBroadcaster *broadcaster, Args&&... args)
+      : _server(std::forward<Args>(args)...),
+        _encoder(encoder),
+        _broadcaster(broadcaster) {}
+
     error_code Connect(uint32_t port, time_duration timeout) {
       return _server.Connect(port, timeout);
     }
@@ -37,14 +53,12 @@ namespace server {
       _server.Disconnect();
     }
 
-    /// @warning Since every received message consists of two Reads, the timeout
-    /// applies to each individual Read. Effectively, it may wait twice the
-    /// timeout.
+    /// The message is decoded in place, from the receive buffer of the server.
     template <typename T>
     error_code Read(T &values, time_duration timeout) {
-      std::string string;
-      auto ec = ReadString(string, timeout);
-      if (!ec && !_encoder.Decode(string, values)) {
+      const_array_view<char> frame;
+      auto ec = _server.ReadFrame(frame, timeout);
+      if (!ec && !_encoder.Decode(frame, values)) {
         ec.assign(
             boost::system::errc::illegal_byte_sequence,
             boost::system::system_category());
@@ -58,31 +72,69 @@ namespace server {
       return _server.Write(boost::asio::buffer(string), timeout);
     }
 
-    /// @warning This operation consists of two Writes, the timeout applies to
-    /// each individual Write. Effectively, it may wait twice the timeout.
+    /// Encoded measurements and images are sent in a single gather-write,
+    /// leased images are released once the write has finished. Images that
+    /// requested it are compressed here, in the thread writing to the socket.
+    /// The frame is recorded by the tracer of the message, if any, once
+    /// written.
     error_code Write(const MeasurementsMessage &values, time_duration timeout) {
-      const auto string = _encoder.Encode(values.measurements());
-      auto ec = _server.Write(boost::asio::buffer(string), timeout);
-      if (!ec) {
-        ec = _server.Write(values.images(), timeout);
+      CARLA_PROFILE_SCOPE(EncoderServer, WriteMeasurements);
+      if (_measurements_encoder == nullptr) {
+        // Only the streams sending measurements need the workers.
+        _measurements_encoder = std::make_unique<MeasurementsEncoder>();
+      }
+      const bool broadcast = (_broadcaster != nullptr) && _broadcaster->HasObservers();
+      // Compact snapshots depend on the previous ones, unless it is a key
+      // frame.
+      bool key_frame = (values.agents_encoding() == AgentsEncoding::Protobuf);
+      if (broadcast && !key_frame && _broadcaster->TakeKeyFrameRequest()) {
+        _measurements_encoder->RequestKeyFrame();
+        key_frame = true;
+      }
+      auto timestamps = values.timestamps();
+      timestamps.encoding = FrameTracer::Now();
+      _sequence.clear();
+      _measurements_encoder->Encode(
+          values.measurements(),
+          values.frame_number(),
+          timestamps,
+          _sequence,
+          values.agents_encoding());
+      _compressor.Encode(values.images(), _sequence);
+      timestamps.encoded = FrameTracer::Now();
+      auto ec = WriteAndPublish(broadcast, key_frame, timeout);
+      _sequence.clear();
+      values.ReleaseImages();
+      if (!ec && (values.tracer() != nullptr)) {
+        timestamps.written = FrameTracer::Now();
+        values.tracer()->RecordFrame(values.frame_number(), timestamps);
       }
       return ec;
     }
 
+    /// Sensor messages are already encoded (unless compression was
+    /// requested), the leased image is released once the write has finished.
+    error_code Write(const SensorMessage &values, time_duration timeout) {
+      CARLA_PROFILE_SCOPE(EncoderServer, WriteSensorData);
+      _sequence.clear();
+      _compressor.Encode(values, _sequence);
+      const bool broadcast = (_broadcaster != nullptr) && _broadcaster->HasObservers();
+      auto ec = WriteAndPublish(broadcast, true, timeout);
+      _sequence.clear();
+      values.ReleaseLease();
+      return ec;
+    }
+
   private:
 
-    error_code ReadString(std::string &string, time_duration timeout) {
-       // Get the message's size.
-      uint32_t message_size;
-      auto ec = _server.Read(boost::asio::buffer(&message_size, sizeof(uint32_t)), timeout);
-      if (ec) {
-        return ec;
+    /// The observers copy the sequence while it is written to the client.
+    error_code WriteAndPublish(bool broadcast, bool key_frame, time_duration timeout) {
+      if (broadcast) {
+        _broadcaster->Publish(_sequence, key_frame);
       }
-      // Knowing the size now we can Read the message.
-      auto buffer = std::make_unique<char[]>(message_size);
-      ec = _server.Read(boost::asio::buffer(buffer.get(), message_size), timeout);
-      if (!ec) {
-        string.assign(buffer.get(), message_size);
+      auto ec = _server.Write(_sequence, timeout);
+      if (broadcast) {
+        _broadcaster->WaitUntilPublished();
       }
       return ec;
     }
@@ -90,6 +142,15 @@ namespace server {
     server_type _server;
 
     encoder_type &_encoder;
+
+    StreamBroadcaster *_broadcaster = nullptr;
+
+    /// Reused between writes to avoid allocating the sequence of buffers.
+    std::vector<const_buffer> _sequence;
+
+    ImageCompressor _compressor;
+
+    std::unique_ptr<MeasurementsEncoder> _measurements_encoder;
   };
 
 } // namespace server
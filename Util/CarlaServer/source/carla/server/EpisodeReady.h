@@ -0,0 +1,36 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "carla/server/CarlaServerAPI.h"
+
+namespace carla {
+namespace server {
+
+  struct EpisodePhase {
+    std::string name;
+    float milliseconds;
+  };
+
+  /// Holds the data of a carla_episode_ready plus the agent server's, sent
+  /// to the client in the EpisodeReady message.
+  struct EpisodeReady {
+    carla_episode_ready values;
+    /// The agent connections of the previous episode are kept.
+    bool agent_connections_kept = false;
+    /// Frames before this one belong to previous episodes.
+    uint64_t first_frame_number = 1u;
+    /// Copy of the phases in values, which are not kept.
+    std::vector<EpisodePhase> phases;
+  };
+
+} // namespace server
+} // namespace carla
@@ -0,0 +1,201 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/server/Executor.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "carla/Debug.h"
+#include "carla/Logging.h"
+
+#if defined(_WIN32)
+#  ifndef WIN32_LEAN_AND_MEAN
+#    define WIN32_LEAN_AND_MEAN
+#  endif
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#elif defined(__linux__)
+#  include <pthread.h>
+#  include <sched.h>
+#endif
+
+namespace carla {
+namespace server {
+
+  // ===========================================================================
+  // -- Static local functions -------------------------------------------------
+  // ===========================================================================
+
+  /// Restrict @a thread to @a cpus, or let it run on any CPU if empty.
+  static void SetAffinity(std::thread &thread, const std::vector<uint32_t> &cpus) {
+#if defined(_WIN32)
+    DWORD_PTR mask = 0u;
+    for (auto cpu : cpus) {
+      if (cpu < 8u * sizeof(DWORD_PTR)) {
+        mask |= DWORD_PTR(1u) << cpu;
+      }
+    }
+    if (mask == 0u) {
+      DWORD_PTR system_mask;
+      GetProcessAffinityMask(GetCurrentProcess(), &mask, &system_mask);
+    }
+    if (SetThreadAffinityMask(thread.native_handle(), mask) == 0u) {
+      log_error("failed to set the CPU affinity of a server thread");
+    }
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (auto cpu : cpus) {
+      if (cpu < CPU_SETSIZE) {
+        CPU_SET(cpu, &set);
+      }
+    }
+    if (CPU_COUNT(&set) == 0) {
+      if (cpus.empty()) {
+        sched_getaffinity(0, sizeof(set), &set);
+      } else {
+        log_error("invalid CPUs for the server threads");
+        return;
+      }
+    }
+    if (pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) != 0) {
+      log_error("failed to set the CPU affinity of a server thread");
+    }
+#else
+    if (!cpus.empty()) {
+      log_warning("CPU affinity of the server threads not supported on this platform");
+    }
+#endif
+  }
+
+  // ===========================================================================
+  // -- Executor ---------------------------------------------------------------
+  // ===========================================================================
+
+  constexpr size_t Executor::QUEUE_CAPACITY;
+
+  Executor &Executor::GetInstance() {
+    // Never destroyed, joining the threads at exit may deadlock (see
+    // StopAtExit).
+    static Executor *instance = []() {
+      std::atexit([]() { GetInstance().StopAtExit(); });
+      return new Executor();
+    }();
+    return *instance;
+  }
+
+  Executor::Executor() : _queue(QUEUE_CAPACITY) {}
+
+  Executor::~Executor() {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _done = true;
+    }
+    _condition.notify_all();
+    std::lock_guard<std::mutex> lock(_threads_mutex);
+    for (auto &thread : _threads) {
+      if (thread.joinable()) {
+        thread.join();
+      }
+    }
+  }
+
+  void Executor::StopAtExit() {
+    // Don't join the threads. At exit they may be gone already, or, when
+    // unloading a DLL on Windows, waiting for the loader lock held by this
+    // thread. Don't block on the mutex either, a thread killed may hold it.
+    _done = true;
+    std::unique_lock<std::mutex> lock(_mutex, std::try_to_lock);
+    _condition.notify_all();
+  }
+
+  void Executor::Configure(const size_t number_of_threads, std::vector<uint32_t> cpus) {
+    std::lock_guard<std::mutex> lock(_threads_mutex);
+    _min_number_of_threads = number_of_threads;
+    _cpus = std::move(cpus);
+    for (auto &thread : _threads) {
+      SetAffinity(thread, _cpus);
+    }
+    Grow(std::max(_min_number_of_threads, _number_of_reserved_threads));
+  }
+
+  void Executor::Reserve(const size_t count) {
+    std::lock_guard<std::mutex> lock(_threads_mutex);
+    _number_of_reserved_threads += count;
+    if (_number_of_reserved_threads > _threads.size()) {
+      if (_threads.size() >= _min_number_of_threads) {
+        log_debug("growing server thread pool to", _number_of_reserved_threads, "threads");
+      }
+      Grow(std::max(_min_number_of_threads, _number_of_reserved_threads));
+    }
+  }
+
+  void Executor::Release(const size_t count) {
+    std::lock_guard<std::mutex> lock(_threads_mutex);
+    DEBUG_ASSERT(_number_of_reserved_threads >= count);
+    _number_of_reserved_threads -= count;
+  }
+
+  size_t Executor::GetNumberOfThreads() const {
+    std::lock_guard<std::mutex> lock(_threads_mutex);
+    return _threads.size();
+  }
+
+  void Executor::Post(Job job) {
+    while (!_queue.TryPush(std::move(job))) {
+      std::this_thread::yield();
+    }
+    // Pairs with the fence in Run, either this thread sees the sleeping thread
+    // or the sleeping thread sees the job.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_number_of_sleeping_threads > 0u) {
+      // Taking the lock ensures a thread about to sleep is already waiting.
+      std::lock_guard<std::mutex> lock(_mutex);
+      _condition.notify_one();
+    }
+  }
+
+  void Executor::Run() {
+    Job job;
+    for (;;) {
+      if (_queue.TryPop(job)) {
+        job();
+        job = Job();
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(_mutex);
+      ++_number_of_sleeping_threads;
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (!_queue.TryPop(job)) {
+        if (_done) {
+          --_number_of_sleeping_threads;
+          return;
+        }
+        _condition.wait(lock);
+      }
+      --_number_of_sleeping_threads;
+      lock.unlock();
+      if (job) {
+        job();
+        job = Job();
+      }
+    }
+  }
+
+  void Executor::Grow(const size_t number_of_threads) {
+    while (_threads.size() < number_of_threads) {
+      _threads.emplace_back([this]() { Run(); });
+      if (!_cpus.empty()) {
+        SetAffinity(_threads.back(), _cpus);
+      }
+    }
+  }
+
+} // namespace server
+} // namespace carla
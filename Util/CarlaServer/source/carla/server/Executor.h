@@ -0,0 +1,102 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "carla/NonCopyable.h"
+#include "carla/server/Job.h"
+#include "carla/server/LockFreeQueue.h"
+
+namespace carla {
+namespace server {
+
+  /// Process-wide pool of threads shared by every server. Threads are created
+  /// on demand and live until the process exits, so launching and killing the
+  /// agent server every episode does not create nor destroy any thread.
+  ///
+  /// Jobs go through a lock-free queue, the mutex is only taken to put idle
+  /// threads to sleep and to wake them up.
+  ///
+  /// Some jobs block for long periods (a stream job lasts a whole episode),
+  /// the users of the pool reserve a thread for each job that may be running
+  /// at the same time. The pool grows to the number of threads reserved if
+  /// the configured number of threads is not enough.
+  class Executor : private NonCopyable {
+  public:
+
+    static constexpr size_t QUEUE_CAPACITY = 1024u;
+
+    /// The pool shared by every server, never destroyed. Its threads are
+    /// stopped at exit (see StopAtExit).
+    static Executor &GetInstance();
+
+    Executor();
+
+    ~Executor();
+
+    /// Set the minimum number of threads of the pool and the CPUs they are
+    /// allowed to run on, an empty @a cpus lets them run on any CPU. Can be
+    /// called at any time, the threads are never destroyed though.
+    void Configure(size_t number_of_threads, std::vector<uint32_t> cpus);
+
+    /// Reserve @a count threads, started here if the pool is too small.
+    void Reserve(size_t count);
+
+    /// Give back threads reserved with Reserve.
+    void Release(size_t count);
+
+    size_t GetNumberOfThreads() const;
+
+    /// Ask the threads to finish once the queue is empty, without joining
+    /// them nor blocking on a lock. Meant for exit handlers.
+    void StopAtExit();
+
+    /// Post @a job to be executed by any thread of the pool. Never blocks
+    /// unless the queue is full.
+    void Post(Job job);
+
+  private:
+
+    void Run();
+
+    /// Start threads until there are at least @a number_of_threads. Requires
+    /// _threads_mutex.
+    void Grow(size_t number_of_threads);
+
+    LockFreeQueue<Job> _queue;
+
+    // -- Sleeping threads -----------------------------------------------------
+
+    std::mutex _mutex;
+
+    std::condition_variable _condition;
+
+    std::atomic<size_t> _number_of_sleeping_threads{0u};
+
+    std::atomic_bool _done{false};
+
+    // -- Threads, guarded by _threads_mutex -----------------------------------
+
+    mutable std::mutex _threads_mutex;
+
+    std::vector<std::thread> _threads;
+
+    size_t _min_number_of_threads = 0u;
+
+    size_t _number_of_reserved_threads = 0u;
+
+    std::vector<uint32_t> _cpus;
+  };
+
+} // namespace server
+} // namespace carla
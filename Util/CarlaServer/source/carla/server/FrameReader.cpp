@@ -0,0 +1,100 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/server/FrameReader.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "carla/Debug.h"
+#include "carla/Logging.h"
+
+namespace carla {
+namespace server {
+
+  // ===========================================================================
+  // -- Static local functions -------------------------------------------------
+  // ===========================================================================
+
+  static inline uint32_t LoadSize(const char *data) {
+    uint32_t size;
+    std::memcpy(&size, data, sizeof(uint32_t));
+    return size;
+  }
+
+  // ===========================================================================
+  // -- FrameReader ------------------------------------------------------------
+  // ===========================================================================
+
+  constexpr uint32_t FrameReader::MAX_FRAME_SIZE;
+  constexpr size_t FrameReader::MIN_RECEIVE_SIZE;
+
+  FrameReader::FrameReader(const size_t initial_capacity)
+    : _buffer(std::max(initial_capacity, MIN_RECEIVE_SIZE)) {}
+
+  void FrameReader::Clear() {
+    _begin = 0u;
+    _parsed = 0u;
+    _end = 0u;
+    _missing = sizeof(uint32_t);
+    _frames = 0u;
+  }
+
+  mutable_buffer FrameReader::Prepare() {
+    if (_begin == _end) {
+      // Nothing left to read, start over at the beginning.
+      Clear();
+    }
+    const size_t required = std::max(_missing, MIN_RECEIVE_SIZE);
+    if (_buffer.size() - _end < required) {
+      // Move the data left to read to the beginning.
+      if (_begin > 0u) {
+        std::memmove(_buffer.data(), _buffer.data() + _begin, _end - _begin);
+        _parsed -= _begin;
+        _end -= _begin;
+        _begin = 0u;
+      }
+      if (_buffer.size() - _end < required) {
+        _buffer.resize(std::max(_end + required, 2u * _buffer.size()));
+      }
+    }
+    return boost::asio::buffer(_buffer.data() + _end, _buffer.size() - _end);
+  }
+
+  bool FrameReader::Commit(const size_t bytes) {
+    DEBUG_ASSERT(_end + bytes <= _buffer.size());
+    _end += bytes;
+    for (;;) {
+      const size_t available = _end - _parsed;
+      if (available < sizeof(uint32_t)) {
+        _missing = sizeof(uint32_t) - available;
+        return true;
+      }
+      const uint32_t size = LoadSize(_buffer.data() + _parsed);
+      if (size > MAX_FRAME_SIZE) {
+        log_error("invalid message size", size);
+        return false;
+      }
+      if (available - sizeof(uint32_t) < size) {
+        _missing = sizeof(uint32_t) + size - available;
+        return true;
+      }
+      _parsed += sizeof(uint32_t) + size;
+      ++_frames;
+    }
+  }
+
+  const_array_view<char> FrameReader::Pop() {
+    DEBUG_ASSERT(_frames > 0u);
+    const uint32_t size = LoadSize(_buffer.data() + _begin);
+    const char *data = _buffer.data() + _begin + sizeof(uint32_t);
+    _begin += sizeof(uint32_t) + size;
+    --_frames;
+    return array_view::make_const(data, size);
+  }
+
+} // namespace server
+} // namespace carla
@@ -0,0 +1,77 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <vector>
+
+#include "carla/ArrayView.h"
+#include "carla/NonCopyable.h"
+#include "carla/server/ServerTraits.h"
+
+namespace carla {
+namespace server {
+
+  /// Read-ahead buffer splitting a stream of bytes into frames
+  /// [(uint32_t)size, data] in place.
+  ///
+  /// Data is received into the buffer returned by Prepare, as much as the
+  /// socket has available, and the frames are popped as views into the buffer;
+  /// no allocation or copy per frame. A view popped is valid until the next
+  /// call to Prepare or Clear, which may move the data left to read to the
+  /// beginning of the buffer (or grow it to fit a frame).
+  class FrameReader : private NonCopyable {
+  public:
+
+    /// Frames larger than this are considered a protocol error.
+    static constexpr uint32_t MAX_FRAME_SIZE = 64u * 1024u * 1024u;
+
+    /// Prepare never returns a buffer smaller than this.
+    static constexpr size_t MIN_RECEIVE_SIZE = 4u * 1024u;
+
+    explicit FrameReader(size_t initial_capacity = 64u * 1024u);
+
+    /// Discard all the data received.
+    void Clear();
+
+    /// Buffer to receive the next bytes into.
+    mutable_buffer Prepare();
+
+    /// Add @a bytes received into the buffer returned by Prepare. Returns
+    /// false if the data received is not a valid frame.
+    bool Commit(size_t bytes);
+
+    /// Number of complete frames waiting to be popped.
+    size_t GetNumberOfFrames() const {
+      return _frames;
+    }
+
+    /// Pop the next complete frame, without its size prefix.
+    ///
+    /// @pre GetNumberOfFrames() > 0.
+    const_array_view<char> Pop();
+
+  private:
+
+    std::vector<char> _buffer;
+
+    /// Beginning of the next frame to pop.
+    size_t _begin = 0u;
+
+    /// End of the complete frames.
+    size_t _parsed = 0u;
+
+    /// End of the data received.
+    size_t _end = 0u;
+
+    /// Bytes missing to complete the partial frame at _parsed.
+    size_t _missing = sizeof(uint32_t);
+
+    size_t _frames = 0u;
+  };
+
+} // namespace server
+} // namespace carla
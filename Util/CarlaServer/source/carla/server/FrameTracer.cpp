@@ -0,0 +1,126 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/server/FrameTracer.h"
+
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+#include "carla/Logging.h"
+#include "carla/Profiler.h"
+
+namespace carla {
+namespace server {
+
+  // ===========================================================================
+  // -- Static local functions -------------------------------------------------
+  // ===========================================================================
+
+  /// The summary is printed whatever the log level, as the profiler does.
+  template <typename ... Args>
+  static inline void log_frames(Args &&... args) {
+    logging::write(false, "FRAMES:", std::forward<Args>(args)..., '\n');
+  }
+
+  static const char *GetName(const FrameTracer::Latency latency) {
+    switch (latency) {
+      case FrameTracer::Latency::TickToReadback:   return "tick to readback";
+      case FrameTracer::Latency::ReadbackToQueued: return "readback to queued";
+      case FrameTracer::Latency::QueuedToEncoding: return "queued to encoding";
+      case FrameTracer::Latency::Encoding:         return "encoding";
+      case FrameTracer::Latency::EncodedToWritten: return "encoded to written";
+      case FrameTracer::Latency::Total:            return "tick to written";
+      case FrameTracer::Latency::RoundTrip:        return "written to control";
+      default:                                     return "invalid";
+    }
+  }
+
+  /// Percentiles of @a histogram in milliseconds.
+  static std::string ToString(const LatencyHistogram &histogram) {
+    const auto ms = [](uint64_t ns) { return 1e-6 * static_cast<double>(ns); };
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3)
+        << "p50 " << ms(histogram.Percentile(50.0))
+        << ", p90 " << ms(histogram.Percentile(90.0))
+        << ", p99 " << ms(histogram.Percentile(99.0))
+        << ", max " << ms(histogram.max()) << " ms";
+    return out.str();
+  }
+
+  // ===========================================================================
+  // -- FrameTracer ------------------------------------------------------------
+  // ===========================================================================
+
+  constexpr size_t FrameTracer::WRITTEN_HISTORY;
+
+  uint64_t FrameTracer::Now() {
+    return Profiler::Now();
+  }
+
+  void FrameTracer::RecordFrame(const uint64_t frame_number, const FrameTimestamps &timestamps) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    ++_frames_written;
+    if (frame_number > _last_frame_number + 1u) {
+      _frames_dropped += frame_number - _last_frame_number - 1u;
+    }
+    _last_frame_number = frame_number;
+    _written[frame_number % WRITTEN_HISTORY] = {{frame_number, timestamps.written}};
+    Add(Latency::TickToReadback, timestamps.tick, timestamps.readback);
+    Add(Latency::ReadbackToQueued, timestamps.readback, timestamps.queued);
+    Add(Latency::QueuedToEncoding, timestamps.queued, timestamps.encoding);
+    Add(Latency::Encoding, timestamps.encoding, timestamps.encoded);
+    Add(Latency::EncodedToWritten, timestamps.encoded, timestamps.written);
+    Add(Latency::Total, timestamps.tick, timestamps.written);
+  }
+
+  void FrameTracer::RecordControl(const uint64_t frame_number, const uint64_t timestamp) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto &written = _written[frame_number % WRITTEN_HISTORY];
+    // Untagged controls, or replying to frames too old to remember.
+    if ((frame_number > 0u) && (written[0u] == frame_number)) {
+      Add(Latency::RoundTrip, written[1u], timestamp);
+    }
+  }
+
+  uint64_t FrameTracer::GetNumberOfFramesWritten() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _frames_written;
+  }
+
+  uint64_t FrameTracer::GetNumberOfDroppedFrames() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _frames_dropped;
+  }
+
+  LatencyHistogram FrameTracer::GetLatency(const Latency latency) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _latencies[static_cast<size_t>(latency)];
+  }
+
+  void FrameTracer::LogSummary() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_frames_written == 0u) {
+      return;
+    }
+    log_frames(_frames_written, "frames written,", _frames_dropped, "frames dropped");
+    for (auto i = 0u; i < _latencies.size(); ++i) {
+      const auto &histogram = _latencies[i];
+      if (histogram.count() > 0u) {
+        log_frames(GetName(static_cast<Latency>(i)) + std::string(":"), ToString(histogram));
+      }
+    }
+  }
+
+  void FrameTracer::Add(const Latency latency, const uint64_t begin, const uint64_t end) {
+    // Stages not stamped are skipped.
+    if ((begin > 0u) && (end >= begin)) {
+      _latencies[static_cast<size_t>(latency)].Add(end - begin);
+    }
+  }
+
+} // namespace server
+} // namespace carla
@@ -0,0 +1,101 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+
+#include "carla/LatencyHistogram.h"
+#include "carla/NonCopyable.h"
+
+namespace carla {
+namespace server {
+
+  /// Time-stamps of the stages a frame went through, in nanoseconds of
+  /// FrameTracer::Now(). Zero if the stage was not stamped.
+  struct FrameTimestamps {
+    /// The game ticked (stamped by the caller).
+    uint64_t tick = 0u;
+    /// Its images were read back and handed to the server (stamped by the
+    /// caller).
+    uint64_t readback = 0u;
+    /// Written into the buffer of the stream.
+    uint64_t queued = 0u;
+    /// Taken from the buffer to be encoded.
+    uint64_t encoding = 0u;
+    /// Encoded, images compressed included.
+    uint64_t encoded = 0u;
+    /// Written to the socket (or to shared memory).
+    uint64_t written = 0u;
+  };
+
+  /// Collects the time-stamps of the frames sent by an agent server, and of
+  /// the controls replying to them, into per-stage latency histograms.
+  /// Thread-safe, frames are recorded by the stream and controls by the game
+  /// thread.
+  class FrameTracer : private NonCopyable {
+  public:
+
+    enum class Latency : size_t {
+      TickToReadback,
+      ReadbackToQueued,
+      QueuedToEncoding,
+      Encoding,
+      EncodedToWritten,
+      /// From the game tick to the frame written.
+      Total,
+      /// From the frame written to receiving the control replying to it.
+      RoundTrip,
+      SIZE
+    };
+
+    /// Nanoseconds of a monotonic clock, the same as carla_get_timestamp and
+    /// the profiler.
+    static uint64_t Now();
+
+    /// Record the frame @a frame_number once written. Frames are written in
+    /// order, a gap in the numbers counts as dropped frames.
+    void RecordFrame(uint64_t frame_number, const FrameTimestamps &timestamps);
+
+    /// Record a control replying to @a frame_number, received at
+    /// @a timestamp.
+    void RecordControl(uint64_t frame_number, uint64_t timestamp);
+
+    uint64_t GetNumberOfFramesWritten() const;
+
+    uint64_t GetNumberOfDroppedFrames() const;
+
+    LatencyHistogram GetLatency(Latency latency) const;
+
+    /// Print the frames written and dropped, and the latency percentiles of
+    /// every stage.
+    void LogSummary() const;
+
+  private:
+
+    /// Frames written recently, to match the controls replying to them.
+    static constexpr size_t WRITTEN_HISTORY = 64u;
+
+    void Add(Latency latency, uint64_t begin, uint64_t end);
+
+    mutable std::mutex _mutex;
+
+    std::array<LatencyHistogram, static_cast<size_t>(Latency::SIZE)> _latencies;
+
+    uint64_t _last_frame_number = 0u;
+
+    uint64_t _frames_written = 0u;
+
+    uint64_t _frames_dropped = 0u;
+
+    /// Frame number and time written, indexed by frame number.
+    std::array<std::array<uint64_t, 2u>, WRITTEN_HISTORY> _written{};
+  };
+
+} // namespace server
+} // namespace carla
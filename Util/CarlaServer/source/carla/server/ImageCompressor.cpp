@@ -0,0 +1,252 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/server/ImageCompressor.h"
+
+#include <cstring>
+
+#include <zlib.h>
+
+#include "carla/Debug.h"
+#include "carla/Logging.h"
+#include "carla/Profiler.h"
+#include "carla/server/ImagesMessage.h"
+#include "carla/server/SensorMessage.h"
+
+namespace carla {
+namespace server {
+
+  // ===========================================================================
+  // -- Static local functions -------------------------------------------------
+  // ===========================================================================
+
+  /// Image types as defined by the post-processing effect of the camera.
+  static constexpr uint32_t IMAGE_TYPE_DEPTH = 2u;
+
+  static constexpr uint32_t PADDING[1u] = {0u};
+
+  static size_t GetImageSize(const carla_image &image) {
+    return sizeof(uint32_t) * image.width * image.height;
+  }
+
+  static size_t GetPadding(const size_t size) {
+    return (sizeof(uint32_t) - (size % sizeof(uint32_t))) % sizeof(uint32_t);
+  }
+
+  static ImageCodec GetCodec(const carla_image &image) {
+    if (image.compression == CARLA_SERVER_IMAGE_COMPRESSION_NONE) {
+      return ImageCodec::None;
+    }
+    return (image.type == IMAGE_TYPE_DEPTH ? ImageCodec::DeflateDepth : ImageCodec::DeflateSub);
+  }
+
+  static uint32_t GetTypeWithCodec(const carla_image &image, const ImageCodec codec) {
+    return (image.type & 0xFFFFu) | (static_cast<uint32_t>(codec) << 16u);
+  }
+
+  static void FilterSub(const carla_image &image, std::vector<unsigned char> &output) {
+    const size_t number_of_pixels = image.width * image.height;
+    output.resize(4u * number_of_pixels);
+    const auto *input = reinterpret_cast<const unsigned char *>(image.data);
+    for (auto channel = 0u; channel < 4u; ++channel) {
+      unsigned char *plane = output.data() + channel * number_of_pixels;
+      for (auto y = 0u; y < image.height; ++y) {
+        const unsigned char *row = input + 4u * y * image.width + channel;
+        unsigned char *out = plane + y * image.width;
+        unsigned char left = 0u;
+        for (auto x = 0u; x < image.width; ++x) {
+          const unsigned char value = row[4u * x];
+          out[x] = static_cast<unsigned char>(value - left);
+          left = value;
+        }
+      }
+    }
+  }
+
+  static void FilterDepth(const carla_image &image, std::vector<unsigned char> &output) {
+    const size_t number_of_pixels = image.width * image.height;
+    output.resize(4u * number_of_pixels);
+    const auto *input = reinterpret_cast<const unsigned char *>(image.data);
+    for (auto y = 0u; y < image.height; ++y) {
+      uint32_t left = 0u;
+      for (auto x = 0u; x < image.width; ++x) {
+        const size_t i = y * image.width + x;
+        const unsigned char *bgra = input + 4u * i;
+        const uint32_t value =
+            static_cast<uint32_t>(bgra[2u]) |
+            (static_cast<uint32_t>(bgra[1u]) << 8u) |
+            (static_cast<uint32_t>(bgra[0u]) << 16u) |
+            (static_cast<uint32_t>(bgra[3u]) << 24u);
+        const uint32_t residual = value - left;
+        left = value;
+        for (auto byte = 0u; byte < 4u; ++byte) {
+          output[byte * number_of_pixels + i] = static_cast<unsigned char>(residual >> (8u * byte));
+        }
+      }
+    }
+  }
+
+  // ===========================================================================
+  // -- ImageCompressor::Stream ------------------------------------------------
+  // ===========================================================================
+
+  /// zlib stream, initialized once and reset for every image.
+  struct ImageCompressor::Stream : private NonCopyable {
+    Stream() {
+      std::memset(&stream, 0, sizeof(stream));
+      valid = (Z_OK == deflateInit(&stream, Z_BEST_SPEED));
+      if (!valid) {
+        log_error("failed to initialize zlib stream");
+      }
+    }
+
+    ~Stream() {
+      if (valid) {
+        deflateEnd(&stream);
+      }
+    }
+
+    /// Returns the compressed size, zero on failure.
+    size_t Deflate(
+        const unsigned char *input,
+        const size_t input_size,
+        std::vector<unsigned char> &output) {
+      if (!valid || (Z_OK != deflateReset(&stream))) {
+        return 0u;
+      }
+      output.resize(deflateBound(&stream, input_size));
+      stream.next_in = const_cast<unsigned char *>(input);
+      stream.avail_in = static_cast<uInt>(input_size);
+      stream.next_out = output.data();
+      stream.avail_out = static_cast<uInt>(output.size());
+      if (Z_STREAM_END != deflate(&stream, Z_FINISH)) {
+        return 0u;
+      }
+      return stream.total_out;
+    }
+
+    z_stream stream;
+
+    bool valid;
+  };
+
+  // ===========================================================================
+  // -- ImageCompressor --------------------------------------------------------
+  // ===========================================================================
+
+  ImageCompressor::ImageCompressor() : _stream(std::make_unique<Stream>()) {}
+
+  ImageCompressor::~ImageCompressor() {}
+
+  const_buffer ImageCompressor::Compress(
+      const carla_image &image,
+      const size_t index,
+      ImageCodec &codec) {
+    CARLA_PROFILE_SCOPE(ImageCompressor, Compress);
+    const auto raw = boost::asio::buffer(image.data, GetImageSize(image));
+    codec = GetCodec(image);
+    if ((codec == ImageCodec::None) || (boost::asio::buffer_size(raw) == 0u)) {
+      codec = ImageCodec::None;
+      return raw;
+    }
+    DEBUG_ASSERT(image.data != nullptr);
+    if (codec == ImageCodec::DeflateDepth) {
+      FilterDepth(image, _filtered);
+    } else {
+      FilterSub(image, _filtered);
+    }
+    if (_outputs.size() <= index) {
+      _outputs.resize(index + 1u);
+    }
+    auto &output = _outputs[index];
+    const auto size = _stream->Deflate(_filtered.data(), GetImageSize(image), output);
+    if ((size == 0u) || (size >= GetImageSize(image))) {
+      codec = ImageCodec::None;
+      return raw;
+    }
+    return boost::asio::buffer(output.data(), size);
+  }
+
+  void ImageCompressor::Encode(
+      const ImagesMessage &message,
+      std::vector<const_buffer> &sequence) {
+    if (!message.compressed()) {
+      sequence.insert(sequence.end(), message.buffers().begin(), message.buffers().end());
+      return;
+    }
+    const auto images = message.images();
+    // Headers are filled first, the sequence points into them.
+    _headers.resize(1u + 4u * images.size());
+    const auto size_index = sequence.size();
+    sequence.emplace_back(boost::asio::buffer(_headers.data(), sizeof(uint32_t)));
+    uint32_t total_size = 0u;
+    for (auto i = 0u; i < images.size(); ++i) {
+      const auto &image = images[i];
+      ImageCodec codec;
+      const auto data = Compress(image, i, codec);
+      const auto data_size = boost::asio::buffer_size(data);
+      uint32_t *header = _headers.data() + 1u + 4u * i;
+      header[0u] = image.width;
+      header[1u] = image.height;
+      header[2u] = GetTypeWithCodec(image, codec);
+      header[3u] = static_cast<uint32_t>(data_size);
+      const size_t header_size = (codec == ImageCodec::None ? 3u : 4u) * sizeof(uint32_t);
+      const size_t padding = (codec == ImageCodec::None ? 0u : GetPadding(data_size));
+      sequence.emplace_back(boost::asio::buffer(header, header_size));
+      if (data_size > 0u) {
+        sequence.emplace_back(data);
+      }
+      if (padding > 0u) {
+        sequence.emplace_back(boost::asio::buffer(PADDING, padding));
+      }
+      total_size += static_cast<uint32_t>(header_size + data_size + padding);
+    }
+    _headers[0u] = total_size;
+    DEBUG_ASSERT(boost::asio::buffer_cast<const void *>(sequence[size_index]) == _headers.data());
+    (void) size_index;
+  }
+
+  void ImageCompressor::Encode(
+      const SensorMessage &message,
+      std::vector<const_buffer> &sequence) {
+    if (!message.compressed()) {
+      sequence.insert(sequence.end(), message.buffers().begin(), message.buffers().end());
+      return;
+    }
+    const auto &image = message.image();
+    ImageCodec codec;
+    const auto data = Compress(image, 0u, codec);
+    const auto data_size = boost::asio::buffer_size(data);
+    const size_t header_size =
+        (codec == ImageCodec::None ? SensorMessage::HEADER_SIZE : _sensor_header.size());
+    const size_t padding = (codec == ImageCodec::None ? 0u : GetPadding(data_size));
+    const uint32_t size = static_cast<uint32_t>(
+        header_size - sizeof(uint32_t) + data_size + padding);
+    const uint64_t frame_number = message.frame_number();
+    const uint32_t words[] = {
+      image.width,
+      image.height,
+      GetTypeWithCodec(image, codec),
+      static_cast<uint32_t>(data_size)
+    };
+    auto begin = _sensor_header.data();
+    std::memcpy(begin, &size, sizeof(size));
+    begin += sizeof(size);
+    std::memcpy(begin, &frame_number, sizeof(frame_number));
+    begin += sizeof(frame_number);
+    std::memcpy(begin, words, sizeof(words));
+    static_assert(sizeof(uint32_t) + sizeof(uint64_t) + sizeof(words) == sizeof(_sensor_header), "");
+    sequence.emplace_back(boost::asio::buffer(_sensor_header.data(), header_size));
+    if (data_size > 0u) {
+      sequence.emplace_back(data);
+    }
+    if (padding > 0u) {
+      sequence.emplace_back(boost::asio::buffer(PADDING, padding));
+    }
+  }
+
+} // namespace server
+} // namespace carla
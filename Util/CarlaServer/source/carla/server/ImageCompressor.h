@@ -0,0 +1,84 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "carla/NonCopyable.h"
+#include "carla/server/CarlaServerAPI.h"
+#include "carla/server/ServerTraits.h"
+
+namespace carla {
+namespace server {
+
+  class ImagesMessage;
+  class SensorMessage;
+
+  /// Codec of an image as sent in its header.
+  enum class ImageCodec : uint32_t {
+    None = 0u,
+    /// Byte planes B, G, R, A, each byte minus the one to its left (as PNG
+    /// "Sub" filter), compressed with zlib. Used for RGB and semantic
+    /// segmentation, where labels come in long runs.
+    DeflateSub = 1u,
+    /// Byte planes of the difference between each pixel and the one to its
+    /// left, pixels taken as the 32-bit integer R | G << 8 | B << 16 | A << 24
+    /// so the 24-bit packed depth is continuous. Compressed with zlib.
+    DeflateDepth = 2u
+  };
+
+  /// Losslessly compresses the images that requested it. Meant to be used in
+  /// the thread writing to the socket, every output buffer is owned by the
+  /// compressor and reused between calls.
+  ///
+  /// A compressed image replaces its header {width, height, type} by
+  ///
+  ///    {
+  ///      width, height, type | codec << 16, compressed size in bytes,
+  ///      compressed data padded with zeros to a multiple of 4 bytes
+  ///    }
+  ///
+  /// If compressing does not reduce the size, the image is sent uncompressed
+  /// with codec None.
+  class ImageCompressor : private NonCopyable {
+  public:
+
+    ImageCompressor();
+
+    ~ImageCompressor();
+
+    /// Append the buffers of @a message to @a sequence, compressing the images
+    /// that requested it. The buffers are valid until the next call.
+    void Encode(const ImagesMessage &message, std::vector<const_buffer> &sequence);
+
+    /// @copydoc Encode(const ImagesMessage &, std::vector<const_buffer> &)
+    void Encode(const SensorMessage &message, std::vector<const_buffer> &sequence);
+
+    /// Compress the pixels of @a image into the output buffer number @a index.
+    /// Returns the compressed data, or the raw pixels if @a codec is None.
+    const_buffer Compress(const carla_image &image, size_t index, ImageCodec &codec);
+
+  private:
+
+    struct Stream;
+
+    std::unique_ptr<Stream> _stream;
+
+    std::vector<unsigned char> _filtered;
+
+    std::vector<std::vector<unsigned char>> _outputs;
+
+    std::vector<uint32_t> _headers;
+
+    std::array<unsigned char, 28u> _sensor_header;
+  };
+
+} // namespace server
+} // namespace carla
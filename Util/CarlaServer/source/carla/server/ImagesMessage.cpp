@@ -14,13 +14,28 @@
 namespace carla {
 namespace server {
 
+  static constexpr size_t HEADER_SIZE = 3u * sizeof(uint32_t); // width, height, type.
+
+  static size_t GetImageSize(const carla_image &image) {
+    return sizeof(uint32_t) * image.width * image.height;
+  }
+
   static size_t GetSizeOfBuffer(const_array_view<carla_image> images) {
     size_t total = 0u;
     for (const auto &image : images) {
-      total += 3u; // width, height, type.
-      total += image.width * image.height;
+      total += HEADER_SIZE;
+      total += GetImageSize(image);
+    }
+    return total;
+  }
+
+  static size_t GetSizeOfBuffer(const_array_view<carla_image_lease> images) {
+    size_t total = 0u;
+    for (const auto &lease : images) {
+      total += HEADER_SIZE;
+      total += GetImageSize(lease.image);
     }
-    return total * sizeof(uint32_t);
+    return total;
   }
 
   static size_t WriteSizeToBuffer(unsigned char *buffer, uint32_t size) {
@@ -28,26 +43,91 @@ namespace server {
     return sizeof(uint32_t);
   }
 
+  static size_t WriteHeaderToBuffer(unsigned char *buffer, const carla_image &image) {
+    auto begin = buffer;
+    begin += WriteSizeToBuffer(begin, image.width);
+    begin += WriteSizeToBuffer(begin, image.height);
+    begin += WriteSizeToBuffer(begin, image.type);
+    return std::distance(buffer, begin);
+  }
+
   static size_t WriteImageToBuffer(unsigned char *buffer, const carla_image &image) {
-    const auto size = sizeof(uint32_t) * image.width * image.height;
+    const auto size = GetImageSize(image);
     DEBUG_ASSERT(image.data != nullptr);
     std::memcpy(buffer, image.data, size);
     return size;
   }
 
+  static bool RequestedCompression(const carla_image &image) {
+    return image.compression != CARLA_SERVER_IMAGE_COMPRESSION_NONE;
+  }
+
+  void ReleaseImageLeases(const_array_view<carla_image_lease> leases) {
+    for (const auto &lease : leases) {
+      if (lease.release != nullptr) {
+        lease.release(lease.user_data);
+      }
+    }
+  }
+
+  ImagesMessage::~ImagesMessage() {
+    ReleaseLeases();
+  }
+
   void ImagesMessage::Write(const_array_view<carla_image> images) {
+    ReleaseLeases();
     const size_t buffer_size = GetSizeOfBuffer(images);
     Reset(sizeof(uint32_t) + buffer_size); // header + buffer.
 
+    _compressed = false;
     auto begin = _buffer.get();
     begin += WriteSizeToBuffer(begin, buffer_size);
     for (const auto &image : images) {
-      begin += WriteSizeToBuffer(begin, image.width);
-      begin += WriteSizeToBuffer(begin, image.height);
-      begin += WriteSizeToBuffer(begin, image.type);
+      begin += WriteHeaderToBuffer(begin, image);
+      _images.emplace_back(image);
+      _images.back().data = reinterpret_cast<const uint32_t *>(begin);
+      _compressed |= RequestedCompression(image);
       begin += WriteImageToBuffer(begin, image);
     }
     DEBUG_ASSERT(std::distance(_buffer.get(), begin) == _size);
+    _buffers.emplace_back(boost::asio::buffer(_buffer.get(), _size));
+  }
+
+  void ImagesMessage::Write(const_array_view<carla_image_lease> images) {
+    ReleaseLeases();
+    _leases.assign(images.begin(), images.end());
+    const size_t buffer_size = GetSizeOfBuffer(images);
+    Reset(sizeof(uint32_t) + HEADER_SIZE * images.size()); // headers only.
+
+    // Each image header is sent together with the header that precedes it,
+    // so the sequence is {size + header0, data0, header1, data1, ...}.
+    _compressed = false;
+    auto begin = _buffer.get();
+    auto chunk_begin = begin;
+    begin += WriteSizeToBuffer(begin, buffer_size);
+    for (const auto &lease : _leases) {
+      _images.emplace_back(lease.image);
+      _compressed |= RequestedCompression(lease.image);
+      begin += WriteHeaderToBuffer(begin, lease.image);
+      _buffers.emplace_back(boost::asio::buffer(chunk_begin, std::distance(chunk_begin, begin)));
+      chunk_begin = begin;
+      const auto size = GetImageSize(lease.image);
+      if (size > 0u) {
+        DEBUG_ASSERT(lease.image.data != nullptr);
+        _buffers.emplace_back(boost::asio::buffer(lease.image.data, size));
+      }
+    }
+    if (_leases.empty()) {
+      _buffers.emplace_back(boost::asio::buffer(_buffer.get(), _size));
+    }
+    DEBUG_ASSERT(std::distance(_buffer.get(), begin) == _size);
+  }
+
+  void ImagesMessage::ReleaseLeases() const {
+    _buffers.clear();
+    _images.clear();
+    ReleaseImageLeases(const_array_view<carla_image_lease>(_leases.data(), _leases.size()));
+    _leases.clear();
   }
 
   void ImagesMessage::Reset(const uint32_t count) {
@@ -8,6 +8,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <vector>
 
 #include "carla/ArrayView.h"
 #include "carla/NonCopyable.h"
@@ -28,9 +29,18 @@ namespace server {
   ///      ...
   ///    }
   ///
+  /// Images that requested compression are laid out differently, see
+  /// ImageCompressor.
+  ///
+  /// The message is exposed as a sequence of buffers to be gather-written to
+  /// the socket. Copied images are laid out in a single contiguous buffer,
+  /// leased images are not copied, only their headers are, and the sequence
+  /// interleaves headers and the caller's pixel data.
   class ImagesMessage : private NonCopyable {
   public:
 
+    ~ImagesMessage();
+
     /// Allocates a new buffer if the capacity is not enough to hold the images,
     /// but it does not allocate a smaller one if the capacity is greater than
     /// the size of the images.
@@ -39,10 +49,34 @@ namespace server {
     /// buffer of images, so memory allocation occurs only once.
     void Write(const_array_view<carla_image> images);
 
-    const_buffer buffer() const {
-      return boost::asio::buffer(_buffer.get(), _size);
+    /// Keeps a reference to the leased images without copying their data. The
+    /// leases are released on ReleaseLeases(), on the next Write, or on
+    /// destruction, whatever happens first.
+    void Write(const_array_view<carla_image_lease> images);
+
+    const std::vector<const_buffer> &buffers() const {
+      return _buffers;
+    }
+
+    /// The images in this message, their data points to the pixels to be sent.
+    const_array_view<carla_image> images() const {
+      return const_array_view<carla_image>(_images.data(), _images.size());
+    }
+
+    /// Whether any of the images requested compression. If so, buffers() holds
+    /// the uncompressed message and the message has to be re-encoded with an
+    /// ImageCompressor.
+    bool compressed() const {
+      return _compressed;
     }
 
+    /// Release the leased images, if any. Meant to be called once the buffers
+    /// have been written to the socket, after this call buffers() is empty.
+    ///
+    /// It is const as it is called by the consumer of the message, the message
+    /// is not going to be read again until it is re-written.
+    void ReleaseLeases() const;
+
   private:
 
     void Reset(uint32_t count);
@@ -52,7 +86,18 @@ namespace server {
     uint32_t _size = 0u;
 
     uint32_t _capacity = 0u;
+
+    mutable std::vector<const_buffer> _buffers;
+
+    mutable std::vector<carla_image_lease> _leases;
+
+    mutable std::vector<carla_image> _images;
+
+    bool _compressed = false;
   };
 
+  /// Release every lease in @a leases.
+  void ReleaseImageLeases(const_array_view<carla_image_lease> leases);
+
 } // namespace server
 } // namespace carla
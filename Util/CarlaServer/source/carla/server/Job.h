@@ -0,0 +1,66 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "carla/Debug.h"
+
+namespace carla {
+namespace server {
+
+  /// A move-only callable with signature void(). Unlike std::function it can
+  /// hold move-only callables, like a std::packaged_task, so jobs are never
+  /// copied on their way to the thread that runs them.
+  class Job {
+  public:
+
+    Job() = default;
+
+    template <
+        typename F,
+        typename = std::enable_if_t<!std::is_same<std::decay_t<F>, Job>::value>>
+    Job(F &&callable)
+      : _callable(std::make_unique<Callable<std::decay_t<F>>>(std::forward<F>(callable))) {}
+
+    Job(Job &&) = default;
+
+    Job &operator=(Job &&) = default;
+
+    explicit operator bool() const {
+      return _callable != nullptr;
+    }
+
+    void operator()() {
+      DEBUG_ASSERT(_callable != nullptr);
+      _callable->Invoke();
+    }
+
+  private:
+
+    struct CallableBase {
+      virtual ~CallableBase() = default;
+      virtual void Invoke() = 0;
+    };
+
+    template <typename F>
+    struct Callable final : CallableBase {
+      explicit Callable(F &&f) : callable(std::move(f)) {}
+      explicit Callable(const F &f) : callable(f) {}
+      void Invoke() final {
+        callable();
+      }
+      F callable;
+    };
+
+    std::unique_ptr<CallableBase> _callable;
+  };
+
+} // namespace server
+} // namespace carla
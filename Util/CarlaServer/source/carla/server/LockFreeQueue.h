@@ -0,0 +1,111 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+#include "carla/Debug.h"
+#include "carla/NonCopyable.h"
+
+namespace carla {
+namespace server {
+
+  /// A bounded lock-free queue for multiple producers and multiple consumers.
+  /// Values are moved in and out, never copied.
+  ///
+  /// From Dmitry Vyukov's bounded MPMC queue: every cell keeps a sequence
+  /// number telling whether it is ready to be written or read at the current
+  /// lap around the buffer, producers and consumers claim a cell by advancing
+  /// their position with a compare-and-swap.
+  template <typename T>
+  class LockFreeQueue : private NonCopyable {
+  public:
+
+    /// @a capacity must be a power of two.
+    explicit LockFreeQueue(size_t capacity)
+      : _cells(std::make_unique<Cell[]>(capacity)),
+        _mask(capacity - 1u) {
+      DEBUG_ASSERT((capacity >= 2u) && ((capacity & _mask) == 0u));
+      for (size_t i = 0u; i < capacity; ++i) {
+        _cells[i].sequence.store(i, std::memory_order_relaxed);
+      }
+    }
+
+    size_t capacity() const {
+      return _mask + 1u;
+    }
+
+    /// Returns false if the queue is full, in which case @a value is left
+    /// untouched.
+    bool TryPush(T &&value) {
+      Cell *cell;
+      size_t position = _enqueue_position.load(std::memory_order_relaxed);
+      for (;;) {
+        cell = &_cells[position & _mask];
+        const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        const auto difference = static_cast<std::ptrdiff_t>(sequence - position);
+        if (difference == 0) {
+          if (_enqueue_position.compare_exchange_weak(position, position + 1u, std::memory_order_relaxed)) {
+            break;
+          }
+        } else if (difference < 0) {
+          return false;
+        } else {
+          position = _enqueue_position.load(std::memory_order_relaxed);
+        }
+      }
+      cell->value = std::move(value);
+      cell->sequence.store(position + 1u, std::memory_order_release);
+      return true;
+    }
+
+    /// Returns false if the queue is empty.
+    bool TryPop(T &value) {
+      Cell *cell;
+      size_t position = _dequeue_position.load(std::memory_order_relaxed);
+      for (;;) {
+        cell = &_cells[position & _mask];
+        const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        const auto difference = static_cast<std::ptrdiff_t>(sequence - (position + 1u));
+        if (difference == 0) {
+          if (_dequeue_position.compare_exchange_weak(position, position + 1u, std::memory_order_relaxed)) {
+            break;
+          }
+        } else if (difference < 0) {
+          return false;
+        } else {
+          position = _dequeue_position.load(std::memory_order_relaxed);
+        }
+      }
+      value = std::move(cell->value);
+      cell->value = T();
+      cell->sequence.store(position + _mask + 1u, std::memory_order_release);
+      return true;
+    }
+
+  private:
+
+    struct Cell {
+      std::atomic<size_t> sequence;
+      T value;
+    };
+
+    const std::unique_ptr<Cell[]> _cells;
+
+    const size_t _mask;
+
+    /// Producers and consumers do not share a cache line.
+    alignas(64) std::atomic<size_t> _enqueue_position{0u};
+
+    alignas(64) std::atomic<size_t> _dequeue_position{0u};
+  };
+
+} // namespace server
+} // namespace carla
@@ -0,0 +1,230 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/server/MeasurementsEncoder.h"
+
+#include <algorithm>
+#include <thread>
+
+#include "carla/ArrayView.h"
+#include "carla/Debug.h"
+#include "carla/Profiler.h"
+#include "carla/server/CarlaEncoder.h"
+#include "carla/server/Executor.h"
+#include "carla/server/Protobuf.h"
+
+#include "carla/server/carla_server.pb.h"
+
+namespace carla {
+namespace server {
+
+  /// Below this many agents per piece it is not worth waking up the workers.
+  static constexpr size_t MIN_AGENTS_PER_PIECE = 128u;
+
+  static constexpr uint32_t MAX_DEFAULT_NUMBER_OF_WORKERS = 3u;
+
+  /// Field number of "non_player_agents_snapshot" in the Measurements message.
+  static constexpr uint32_t SNAPSHOT_FIELD_NUMBER = 6u;
+
+  /// Protobuf wire type of length-delimited fields.
+  static constexpr uint32_t WIRE_TYPE_LENGTH_DELIMITED = 2u;
+
+  /// Write the tag and the varint-encoded @a length of a length-delimited
+  /// field, returns the number of bytes written.
+  template <size_t N>
+  static size_t WriteFieldHeader(std::array<unsigned char, N> &output, uint32_t length) {
+    static_assert(N >= 6u, "not enough space for a field header");
+    size_t size = 0u;
+    output[size++] = static_cast<unsigned char>(
+        (SNAPSHOT_FIELD_NUMBER << 3u) | WIRE_TYPE_LENGTH_DELIMITED);
+    do {
+      unsigned char byte = length & 0x7Fu;
+      length >>= 7u;
+      if (length != 0u) {
+        byte |= 0x80u;
+      }
+      output[size++] = byte;
+    } while (length != 0u);
+    return size;
+  }
+
+  // ===========================================================================
+  // -- MeasurementsEncoder::Piece ---------------------------------------------
+  // ===========================================================================
+
+  /// A slice of the non-player agents (the first piece holds the rest of the
+  /// measurements too), with its own arena-allocated message and output
+  /// buffer.
+  struct MeasurementsEncoder::Piece : private NonCopyable {
+    Piece() : message(protobuf.CreateMessage<carla_server::Measurements>()) {
+      DEBUG_ASSERT(message != nullptr);
+    }
+
+    Protobuf protobuf;
+
+    carla_server::Measurements *message;
+
+    std::vector<unsigned char> buffer;
+
+    size_t size = 0u;
+  };
+
+  // ===========================================================================
+  // -- MeasurementsEncoder ----------------------------------------------------
+  // ===========================================================================
+
+  uint32_t MeasurementsEncoder::GetDefaultNumberOfWorkers() {
+    const uint32_t cores = std::thread::hardware_concurrency();
+    return std::min(cores > 1u ? cores - 1u : 0u, MAX_DEFAULT_NUMBER_OF_WORKERS);
+  }
+
+  MeasurementsEncoder::MeasurementsEncoder(const uint32_t number_of_workers)
+    : _number_of_workers(number_of_workers) {
+    _pieces.reserve(number_of_workers + 1u);
+    for (auto i = 0u; i < number_of_workers + 1u; ++i) {
+      _pieces.emplace_back(std::make_unique<Piece>());
+    }
+    Executor::GetInstance().Reserve(_number_of_workers);
+  }
+
+  MeasurementsEncoder::~MeasurementsEncoder() {
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _job_finished.wait(lock, [this]() { return _running_workers == 0u; });
+    }
+    Executor::GetInstance().Release(_number_of_workers);
+  }
+
+  void MeasurementsEncoder::Encode(
+      const carla_measurements &values,
+      const uint64_t frame_number,
+      const FrameTimestamps &timestamps,
+      std::vector<const_buffer> &sequence,
+      const AgentsEncoding agents_encoding) {
+    CARLA_PROFILE_SCOPE(MeasurementsEncoder, Encode);
+    const bool split_agents = (agents_encoding == AgentsEncoding::Protobuf);
+    const size_t number_of_pieces = (!split_agents ? 1u : std::max<size_t>(1u, std::min(
+        _pieces.size(),
+        values.number_of_non_player_agents / MIN_AGENTS_PER_PIECE)));
+    uint64_t generation;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _values = &values;
+      _frame_number = frame_number;
+      _timestamps = timestamps;
+      _split_agents = split_agents;
+      _number_of_pieces = number_of_pieces;
+      _next_piece = 0u;
+      _pending_pieces = number_of_pieces;
+      generation = ++_generation;
+    }
+    if (number_of_pieces > 1u) {
+      PostWorkers(number_of_pieces - 1u, generation);
+    }
+    // This thread works too.
+    EncodePieces(generation);
+    const_buffer snapshot;
+    size_t snapshot_field_header_size = 0u;
+    if (!split_agents) {
+      snapshot = _snapshot_encoder.Encode(
+          array_view::make_const(values.non_player_agents, values.number_of_non_player_agents),
+          agents_encoding == AgentsEncoding::CompactQuantized);
+      snapshot_field_header_size = WriteFieldHeader(
+          _snapshot_field_header,
+          static_cast<uint32_t>(boost::asio::buffer_size(snapshot)));
+    }
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _job_finished.wait(lock, [this]() { return _pending_pieces == 0u; });
+      _values = nullptr;
+    }
+    size_t total_size = snapshot_field_header_size + boost::asio::buffer_size(snapshot);
+    for (auto i = 0u; i < number_of_pieces; ++i) {
+      total_size += _pieces[i]->size;
+    }
+    _size_prefix = static_cast<uint32_t>(total_size);
+    sequence.emplace_back(boost::asio::buffer(&_size_prefix, sizeof(_size_prefix)));
+    for (auto i = 0u; i < number_of_pieces; ++i) {
+      const auto &piece = *_pieces[i];
+      sequence.emplace_back(boost::asio::buffer(piece.buffer.data(), piece.size));
+    }
+    if (snapshot_field_header_size > 0u) {
+      sequence.emplace_back(boost::asio::buffer(_snapshot_field_header.data(), snapshot_field_header_size));
+      sequence.emplace_back(snapshot);
+    }
+  }
+
+  void MeasurementsEncoder::PostWorkers(const size_t count, const uint64_t generation) {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _running_workers += count;
+    }
+    for (auto i = 0u; i < count; ++i) {
+      // If the worker starts late it finds no piece left and returns.
+      Executor::GetInstance().Post([this, generation]() {
+        EncodePieces(generation);
+        std::lock_guard<std::mutex> lock(_mutex);
+        DEBUG_ASSERT(_running_workers > 0u);
+        if (--_running_workers == 0u) {
+          _job_finished.notify_all();
+        }
+      });
+    }
+  }
+
+  void MeasurementsEncoder::EncodePieces(const uint64_t generation) {
+    for (;;) {
+      size_t index;
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if ((generation != _generation) || (_next_piece >= _number_of_pieces)) {
+          return;
+        }
+        index = _next_piece++;
+      }
+      // The job cannot change until every piece is done.
+      EncodePiece(index);
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        DEBUG_ASSERT(_pending_pieces > 0u);
+        if (--_pending_pieces == 0u) {
+          _job_finished.notify_all();
+        }
+      }
+    }
+  }
+
+  void MeasurementsEncoder::EncodePiece(const size_t index) {
+    DEBUG_ASSERT(_values != nullptr);
+    DEBUG_ASSERT(index < _number_of_pieces);
+    const auto &values = *_values;
+    auto &piece = *_pieces[index];
+    auto &message = *piece.message;
+    // Split the agents evenly, the first pieces take the remainder.
+    const size_t total = (_split_agents ? values.number_of_non_player_agents : 0u);
+    const size_t quotient = total / _number_of_pieces;
+    const size_t remainder = total % _number_of_pieces;
+    const size_t begin = index * quotient + std::min(index, remainder);
+    const size_t size = quotient + (index < remainder ? 1u : 0u);
+    if (index == 0u) {
+      CarlaEncoder::SetMeasurements(message, values, _frame_number, _timestamps);
+    } else {
+      // Clearing keeps the allocated agents in the arena for reuse.
+      message.Clear();
+    }
+    CarlaEncoder::SetNonPlayerAgents(
+        message,
+        array_view::make_const(values.non_player_agents + begin, size));
+    DEBUG_ASSERT(message.IsInitialized());
+    piece.size = message.ByteSizeLong();
+    if (piece.buffer.size() < piece.size) {
+      piece.buffer.resize(piece.size);
+    }
+    message.SerializeWithCachedSizesToArray(piece.buffer.data());
+  }
+
+} // namespace server
+} // namespace carla
@@ -0,0 +1,118 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "carla/NonCopyable.h"
+#include "carla/server/AgentSnapshotEncoder.h"
+#include "carla/server/CarlaServerAPI.h"
+#include "carla/server/FrameTracer.h"
+#include "carla/server/ServerTraits.h"
+
+namespace carla {
+namespace server {
+
+  /// Encodes measurements splitting the non-player agents among a few workers,
+  /// jobs posted to the process-wide Executor.
+  ///
+  /// Repeated fields of a protobuf message can be serialized in pieces, the
+  /// concatenation of the pieces parses as a single message. Each piece is
+  /// serialized by a worker into its own buffer, and the buffers are sent with
+  /// a single gather-write as
+  ///
+  ///    [(uint32_t)message size, piece 0, piece 1, ...]
+  ///
+  /// which is the same encoding as Protobuf::Encode. Messages and buffers are
+  /// allocated once and reused every frame.
+  ///
+  /// With a compact agents encoding, the agents are not split but packed by an
+  /// AgentSnapshotEncoder, and appended as one more piece holding the
+  /// "non_player_agents_snapshot" field.
+  class MeasurementsEncoder : private NonCopyable {
+  public:
+
+    /// Default number of workers, besides the thread calling Encode.
+    static uint32_t GetDefaultNumberOfWorkers();
+
+    explicit MeasurementsEncoder(uint32_t number_of_workers = GetDefaultNumberOfWorkers());
+
+    ~MeasurementsEncoder();
+
+    /// Encode @a values and append the resulting buffers to @a sequence. The
+    /// buffers are owned by the encoder, valid until the next call.
+    void Encode(
+        const carla_measurements &values,
+        uint64_t frame_number,
+        const FrameTimestamps &timestamps,
+        std::vector<const_buffer> &sequence,
+        AgentsEncoding agents_encoding = AgentsEncoding::Protobuf);
+
+    /// With a compact agents encoding, make the next snapshot self-contained
+    /// (see AgentSnapshotEncoder::RequestKeyFrame).
+    void RequestKeyFrame() {
+      _snapshot_encoder.RequestKeyFrame();
+    }
+
+  private:
+
+    struct Piece;
+
+    /// Post @a count jobs helping with the pieces of the job @a generation.
+    void PostWorkers(size_t count, uint64_t generation);
+
+    /// Encode pieces of the job @a generation until there are none left.
+    void EncodePieces(uint64_t generation);
+
+    void EncodePiece(size_t index);
+
+    // -- Pieces, written only by the thread that takes them --------------------
+
+    std::vector<std::unique_ptr<Piece>> _pieces;
+
+    uint32_t _size_prefix = 0u;
+
+    AgentSnapshotEncoder _snapshot_encoder;
+
+    /// Tag and length of the snapshot field.
+    std::array<unsigned char, 6u> _snapshot_field_header;
+
+    // -- Current job, guarded by _mutex ---------------------------------------
+
+    std::mutex _mutex;
+
+    std::condition_variable _job_finished;
+
+    const carla_measurements *_values = nullptr;
+
+    uint64_t _frame_number = 0u;
+
+    FrameTimestamps _timestamps;
+
+    bool _split_agents = true;
+
+    size_t _number_of_pieces = 0u;
+
+    size_t _next_piece = 0u;
+
+    size_t _pending_pieces = 0u;
+
+    uint64_t _generation = 0u;
+
+    /// Worker jobs posted and not yet finished.
+    size_t _running_workers = 0u;
+
+    const uint32_t _number_of_workers;
+  };
+
+} // namespace server
+} // namespace carla
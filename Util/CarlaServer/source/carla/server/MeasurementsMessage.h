@@ -7,8 +7,10 @@
 #pragma once
 
 #include "carla/NonCopyable.h"
+#include "carla/server/AgentSnapshotEncoder.h"
 #include "carla/server/CarlaMeasurements.h"
 #include "carla/server/CarlaServerAPI.h"
+#include "carla/server/FrameTracer.h"
 #include "carla/server/ImagesMessage.h"
 
 namespace carla {
@@ -19,21 +21,80 @@ namespace server {
 
     void Write(
         const carla_measurements &measurements,
-        const_array_view<carla_image> images) {
+        const_array_view<carla_image> images,
+        uint64_t frame_number = 0u) {
+      _frame_number = frame_number;
       _measurements.Write(measurements);
       _images.Write(images);
     }
 
+    void Write(
+        const carla_measurements &measurements,
+        const_array_view<carla_image_lease> images,
+        uint64_t frame_number = 0u) {
+      _frame_number = frame_number;
+      _measurements.Write(measurements);
+      _images.Write(images);
+    }
+
+    /// Measurements only, the images are sent through their own streams.
+    void Write(const carla_measurements &measurements, uint64_t frame_number) {
+      _frame_number = frame_number;
+      _measurements.Write(measurements);
+      _images.ReleaseLeases();
+    }
+
+    uint64_t frame_number() const {
+      return _frame_number;
+    }
+
+    AgentsEncoding agents_encoding() const {
+      return _agents_encoding;
+    }
+
+    void set_agents_encoding(AgentsEncoding agents_encoding) {
+      _agents_encoding = agents_encoding;
+    }
+
+    /// Time-stamps of the stages the frame went through before being queued.
+    const FrameTimestamps &timestamps() const {
+      return _timestamps;
+    }
+
+    /// Tracer to record the frame once written, may be null.
+    FrameTracer *tracer() const {
+      return _tracer;
+    }
+
+    void set_trace(FrameTracer *tracer, const FrameTimestamps &timestamps) {
+      _tracer = tracer;
+      _timestamps = timestamps;
+    }
+
     const carla_measurements &measurements() const {
       return _measurements.measurements();
     }
 
-    const_buffer images() const {
-      return _images.buffer();
+    /// Empty if the images are sent through sensor streams.
+    const ImagesMessage &images() const {
+      return _images;
+    }
+
+    /// Release the leased images once they have been sent.
+    void ReleaseImages() const {
+      _images.ReleaseLeases();
     }
 
   private:
 
+    uint64_t _frame_number = 0u;
+
+    AgentsEncoding _agents_encoding = AgentsEncoding::Protobuf;
+
+    FrameTracer *_tracer = nullptr;
+
+    FrameTimestamps _timestamps;
+
     CarlaMeasurements _measurements;
 
     ImagesMessage _images;
@@ -20,6 +20,8 @@ namespace server {
   struct RequestNewEpisode {
     carla_request_new_episode values;
     std::unique_ptr<const char[]> data;
+    /// The client asks to keep the agent connections for the new episode.
+    bool keep_agent_connections = false;
   };
 
 } // namespace server
@@ -0,0 +1,109 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/server/RingBuffer.h"
+
+#include "carla/Debug.h"
+
+// Two rings of slot indices are kept. The ready ring is pushed by the producer
+// and popped by the consumer, and also by the producer when it needs to drop
+// the oldest value, so its tail is advanced with a compare-and-swap. The free
+// ring is pushed by the consumer once done reading and popped by the producer.
+//
+// Head and tail are monotonically increasing counters, so a stale tail always
+// fails the compare-and-swap even if its cell has been reused.
+
+namespace carla {
+namespace server {
+namespace detail {
+
+  constexpr uint32_t RingBufferState::NONE;
+
+  RingBufferState::RingBufferState(const uint32_t depth)
+    : _depth(depth > 0u ? depth : 1u),
+      _ready(std::make_unique<std::atomic<uint32_t>[]>(_depth + 1u)),
+      _ready_head(0u),
+      _ready_tail(0u),
+      _free(std::make_unique<std::atomic<uint32_t>[]>(number_of_slots())),
+      _free_head(number_of_slots()),
+      _free_tail(0u) {
+    for (auto i = 0u; i < number_of_slots(); ++i) {
+      _free[i].store(i, std::memory_order_relaxed);
+    }
+  }
+
+  bool RingBufferState::full() const {
+    const auto head = _ready_head.load(std::memory_order_relaxed);
+    const auto tail = _ready_tail.load(std::memory_order_acquire);
+    return (head - tail) >= _depth;
+  }
+
+  uint32_t RingBufferState::StartWriting(bool &dropped) {
+    dropped = false;
+    uint32_t slot = NONE;
+    if (StealOldest(slot)) {
+      // We own the oldest value now, no need to return it to the free ring.
+      dropped = true;
+      return slot;
+    }
+    // There are at most (depth - 1) slots ready and one being read, so there
+    // are at least two free slots.
+    const auto tail = _free_tail.load(std::memory_order_relaxed);
+    const auto head = _free_head.load(std::memory_order_acquire);
+    DEBUG_ASSERT(tail != head);
+    (void) head;
+    slot = _free[tail % number_of_slots()].load(std::memory_order_relaxed);
+    _free_tail.store(tail + 1u, std::memory_order_release);
+    return slot;
+  }
+
+  void RingBufferState::EndWriting(const uint32_t slot) {
+    const auto head = _ready_head.load(std::memory_order_relaxed);
+    DEBUG_ASSERT(head - _ready_tail.load(std::memory_order_relaxed) < _depth);
+    _ready[head % (_depth + 1u)].store(slot, std::memory_order_relaxed);
+    _ready_head.store(head + 1u, std::memory_order_release);
+  }
+
+  uint32_t RingBufferState::StartReading() {
+    uint32_t slot = NONE;
+    return (PopReady(slot) ? slot : NONE);
+  }
+
+  void RingBufferState::EndReading(const uint32_t slot) {
+    const auto head = _free_head.load(std::memory_order_relaxed);
+    _free[head % number_of_slots()].store(slot, std::memory_order_relaxed);
+    _free_head.store(head + 1u, std::memory_order_release);
+  }
+
+  bool RingBufferState::StealOldest(uint32_t &slot) {
+    // Only the producer moves the head.
+    const auto head = _ready_head.load(std::memory_order_relaxed);
+    auto tail = _ready_tail.load(std::memory_order_acquire);
+    while ((head - tail) >= _depth) {
+      slot = _ready[tail % (_depth + 1u)].load(std::memory_order_relaxed);
+      if (_ready_tail.compare_exchange_weak(tail, tail + 1u, std::memory_order_acq_rel)) {
+        return true;
+      }
+      // The consumer may have popped it, if so there is room now and nothing
+      // to drop.
+    }
+    return false;
+  }
+
+  bool RingBufferState::PopReady(uint32_t &slot) {
+    auto tail = _ready_tail.load(std::memory_order_acquire);
+    while (tail != _ready_head.load(std::memory_order_acquire)) {
+      slot = _ready[tail % (_depth + 1u)].load(std::memory_order_relaxed);
+      if (_ready_tail.compare_exchange_weak(tail, tail + 1u, std::memory_order_acq_rel)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+} // namespace detail
+} // namespace server
+} // namespace carla
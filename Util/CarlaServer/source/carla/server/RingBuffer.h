@@ -0,0 +1,222 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include "carla/NonCopyable.h"
+#include "carla/server/ServerTraits.h"
+
+namespace carla {
+namespace server {
+
+  /// What the producer does when a RingBuffer is full.
+  enum class BackPressurePolicy {
+    /// Discard the oldest value not yet read.
+    DropOldest,
+    /// Wait until the consumer frees a slot, or the time-out is met, in which
+    /// case the oldest value is discarded.
+    Block
+  };
+
+namespace detail {
+
+  /// Keeps the state of a lock-free ring of slot indices for one producer and
+  /// one consumer.
+  ///
+  /// There are depth + 2 slots, at any time each of them is either free, ready
+  /// to be read (at most depth of them), being written (at most one), or being
+  /// read (at most one). When dropping, the producer steals the oldest ready
+  /// slot, this is the only operation in which both threads compete for the
+  /// same index.
+  class RingBufferState : private NonCopyable {
+  public:
+
+    static constexpr uint32_t NONE = ~uint32_t(0u);
+
+    explicit RingBufferState(uint32_t depth);
+
+    uint32_t depth() const {
+      return _depth;
+    }
+
+    uint32_t number_of_slots() const {
+      return _depth + 2u;
+    }
+
+    /// Whether there are depth values waiting to be read.
+    bool full() const;
+
+    /// Never returns NONE. If the buffer is full, the oldest ready slot is
+    /// reused and @a dropped is set to true.
+    uint32_t StartWriting(bool &dropped);
+
+    void EndWriting(uint32_t slot);
+
+    /// Returns NONE if there is nothing to read yet.
+    uint32_t StartReading();
+
+    void EndReading(uint32_t slot);
+
+  private:
+
+    /// If the buffer is full, pop the oldest ready slot. Returns false if the
+    /// consumer made room meanwhile.
+    bool StealOldest(uint32_t &slot);
+
+    bool PopReady(uint32_t &slot);
+
+    const uint32_t _depth;
+
+    /// Slots ready to be read, in order of writing.
+    std::unique_ptr<std::atomic<uint32_t>[]> _ready;
+
+    std::atomic<uint64_t> _ready_head;
+
+    std::atomic<uint64_t> _ready_tail;
+
+    /// Slots returned by the consumer.
+    std::unique_ptr<std::atomic<uint32_t>[]> _free;
+
+    std::atomic<uint64_t> _free_head;
+
+    std::atomic<uint64_t> _free_tail;
+  };
+
+} // namespace detail
+
+  /// A bounded thread-safe ring buffer for one producer and one consumer.
+  /// Drop-in replacement of DoubleBuffer that keeps up to depth values not yet
+  /// read, values are read in order of writing.
+  ///
+  /// With depth 1 and BackPressurePolicy::DropOldest it behaves as a
+  /// DoubleBuffer, only the latest value is kept.
+  template <typename T>
+  class RingBuffer : private detail::RingBufferState {
+  public:
+
+    explicit RingBuffer(
+        uint32_t depth = 1u,
+        BackPressurePolicy policy = BackPressurePolicy::DropOldest,
+        timeout_t block_timeout = timeout_t::milliseconds(10000u))
+      : detail::RingBufferState(depth),
+        _policy(policy),
+        _block_timeout(block_timeout),
+        _done(false),
+        _number_of_dropped_values(0u),
+        _number_of_blocked_writes(0u),
+        _buffer(std::make_unique<T[]>(number_of_slots())) {}
+
+    ~RingBuffer() { set_done(); }
+
+    using detail::RingBufferState::depth;
+
+    BackPressurePolicy policy() const {
+      return _policy;
+    }
+
+    bool done() const {
+      return _done;
+    }
+
+    void set_done() {
+      _done = true;
+      Notify();
+    }
+
+    /// Number of values discarded before being read.
+    uint64_t number_of_dropped_values() const {
+      return _number_of_dropped_values;
+    }
+
+    /// Number of writes that had to wait for the consumer.
+    uint64_t number_of_blocked_writes() const {
+      return _number_of_blocked_writes;
+    }
+
+    /// Returns an unique_ptr to the oldest value not yet read. The given slot
+    /// will be locked for reading until the unique_ptr is destroyed.
+    ///
+    /// Blocks until there is some data to read, or the time-out is met.
+    ///
+    /// Returns nullptr if the time-out was met, or the RingBuffer is marked as
+    /// done.
+    auto TryMakeReader(timeout_t timeout) {
+      const auto deleter = [this](const T *ptr) {
+        if (ptr) {
+          EndReading(static_cast<uint32_t>(ptr - _buffer.get()));
+          Notify();
+        }
+      };
+      uint32_t slot = NONE;
+      {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _condition.wait_for(lock, timeout.to_chrono(), [&] {
+          slot = StartReading();
+          return _done || (slot != NONE);
+        });
+      }
+      const T *pointer = (slot != NONE ? &_buffer[slot] : nullptr);
+      return std::unique_ptr<const T, decltype(deleter)>(pointer, deleter);
+    }
+
+    /// Returns an unique_ptr to the slot to be written. The given slot will be
+    /// locked for writing until the unique_ptr is destroyed.
+    ///
+    /// Never returns nullptr.
+    auto MakeWriter() {
+      if ((_policy == BackPressurePolicy::Block) && full()) {
+        ++_number_of_blocked_writes;
+        std::unique_lock<std::mutex> lock(_mutex);
+        _condition.wait_for(lock, _block_timeout.to_chrono(), [this] {
+          return _done || !full();
+        });
+      }
+      bool dropped = false;
+      const auto slot = StartWriting(dropped);
+      if (dropped) {
+        ++_number_of_dropped_values;
+      }
+      const auto deleter = [this](T *ptr) {
+        EndWriting(static_cast<uint32_t>(ptr - _buffer.get()));
+        Notify();
+      };
+      return std::unique_ptr<T, decltype(deleter)>(&_buffer[slot], deleter);
+    }
+
+  private:
+
+    /// Taking the lock before notifying ensures a waiting thread either sees
+    /// the new state or receives the notification.
+    void Notify() {
+      { std::lock_guard<std::mutex> lock(_mutex); }
+      _condition.notify_all();
+    }
+
+    const BackPressurePolicy _policy;
+
+    const timeout_t _block_timeout;
+
+    std::mutex _mutex;
+
+    std::condition_variable _condition;
+
+    std::atomic_bool _done;
+
+    std::atomic<uint64_t> _number_of_dropped_values;
+
+    std::atomic<uint64_t> _number_of_blocked_writes;
+
+    const std::unique_ptr<T[]> _buffer;
+  };
+
+} // namespace server
+} // namespace carla
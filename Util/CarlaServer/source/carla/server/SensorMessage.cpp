@@ -0,0 +1,87 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/server/SensorMessage.h"
+
+#include <cstring>
+
+#include "carla/Debug.h"
+#include "carla/Logging.h"
+
+namespace carla {
+namespace server {
+
+  constexpr size_t SensorMessage::HEADER_SIZE;
+
+  static size_t GetImageSize(const carla_image &image) {
+    return sizeof(uint32_t) * image.width * image.height;
+  }
+
+  template <typename T>
+  static size_t WriteValueToBuffer(unsigned char *buffer, const T value) {
+    std::memcpy(buffer, &value, sizeof(T));
+    return sizeof(T);
+  }
+
+  SensorMessage::~SensorMessage() {
+    ReleaseLease();
+  }
+
+  void SensorMessage::Write(const uint64_t frame_number, const carla_image &image) {
+    ReleaseLease();
+    WriteHeader(frame_number, image);
+    const auto size = GetImageSize(image);
+    if (size > 0u) {
+      if (_capacity < size) {
+        log_info("allocating sensor buffer of", size, "bytes");
+        _data = std::make_unique<unsigned char[]>(size);
+        _capacity = size;
+      }
+      DEBUG_ASSERT(image.data != nullptr);
+      std::memcpy(_data.get(), image.data, size);
+      _buffers.emplace_back(boost::asio::buffer(_data.get(), size));
+    }
+    _image.data = reinterpret_cast<const uint32_t *>(_data.get());
+  }
+
+  void SensorMessage::Write(const uint64_t frame_number, const carla_image_lease &image) {
+    ReleaseLease();
+    _lease = image;
+    _has_lease = true;
+    WriteHeader(frame_number, image.image);
+    const auto size = GetImageSize(image.image);
+    if (size > 0u) {
+      DEBUG_ASSERT(image.image.data != nullptr);
+      _buffers.emplace_back(boost::asio::buffer(image.image.data, size));
+    }
+  }
+
+  void SensorMessage::ReleaseLease() const {
+    _buffers.clear();
+    if (_has_lease) {
+      _has_lease = false;
+      if (_lease.release != nullptr) {
+        _lease.release(_lease.user_data);
+      }
+    }
+  }
+
+  void SensorMessage::WriteHeader(const uint64_t frame_number, const carla_image &image) {
+    _frame_number = frame_number;
+    _image = image;
+    const auto size = HEADER_SIZE - sizeof(uint32_t) + GetImageSize(image);
+    auto begin = _header.data();
+    begin += WriteValueToBuffer<uint32_t>(begin, size);
+    begin += WriteValueToBuffer<uint64_t>(begin, frame_number);
+    begin += WriteValueToBuffer<uint32_t>(begin, image.width);
+    begin += WriteValueToBuffer<uint32_t>(begin, image.height);
+    begin += WriteValueToBuffer<uint32_t>(begin, image.type);
+    DEBUG_ASSERT(std::distance(_header.data(), begin) == HEADER_SIZE);
+    _buffers.emplace_back(boost::asio::buffer(_header.data(), _header.size()));
+  }
+
+} // namespace server
+} // namespace carla
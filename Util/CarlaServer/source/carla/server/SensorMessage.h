@@ -0,0 +1,97 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "carla/NonCopyable.h"
+#include "carla/server/CarlaServerAPI.h"
+#include "carla/server/ServerTraits.h"
+
+namespace carla {
+namespace server {
+
+  /// Encodes a single image to be sent through its own sensor stream.
+  ///
+  /// The message has the following layout
+  ///
+  ///    {
+  ///      uint32 size,
+  ///      uint64 frame number,
+  ///      uint32 width, uint32 height, uint32 type, color[0], color[1],...
+  ///    }
+  ///
+  /// where size counts every byte after itself. The frame number matches the
+  /// one of the measurements sent the same frame, so clients can put the
+  /// streams back together. Compressed images follow the layout described in
+  /// ImageCompressor.
+  class SensorMessage : private NonCopyable {
+  public:
+
+    static constexpr size_t HEADER_SIZE =
+        sizeof(uint32_t) + sizeof(uint64_t) + 3u * sizeof(uint32_t);
+
+    ~SensorMessage();
+
+    /// Copies the image, the buffer is reused if it has enough capacity.
+    void Write(uint64_t frame_number, const carla_image &image);
+
+    /// Keeps a reference to the leased image without copying its data. The
+    /// lease is released on ReleaseLease(), on the next Write, or on
+    /// destruction, whatever happens first.
+    void Write(uint64_t frame_number, const carla_image_lease &image);
+
+    uint64_t frame_number() const {
+      return _frame_number;
+    }
+
+    const std::vector<const_buffer> &buffers() const {
+      return _buffers;
+    }
+
+    /// The image of this message, its data points to the pixels to be sent.
+    const carla_image &image() const {
+      return _image;
+    }
+
+    /// Whether the image requested compression. If so, buffers() holds the
+    /// uncompressed message and the message has to be re-encoded with an
+    /// ImageCompressor.
+    bool compressed() const {
+      return _image.compression != CARLA_SERVER_IMAGE_COMPRESSION_NONE;
+    }
+
+    /// Release the leased image, if any. Meant to be called once the buffers
+    /// have been written to the socket, after this call buffers() is empty.
+    void ReleaseLease() const;
+
+  private:
+
+    void WriteHeader(uint64_t frame_number, const carla_image &image);
+
+    uint64_t _frame_number = 0u;
+
+    carla_image _image = {};
+
+    std::array<unsigned char, HEADER_SIZE> _header;
+
+    std::unique_ptr<unsigned char[]> _data = nullptr;
+
+    size_t _capacity = 0u;
+
+    mutable std::vector<const_buffer> _buffers;
+
+    mutable carla_image_lease _lease = {};
+
+    mutable bool _has_lease = false;
+  };
+
+} // namespace server
+} // namespace carla
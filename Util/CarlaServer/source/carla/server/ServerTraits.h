@@ -45,6 +45,12 @@ namespace errc {
     return boost::asio::error::basic_errors::operation_aborted;
   }
 
+  /// Nothing to read yet, and waiting would not help, e.g. no control is due
+  /// this frame.
+  static inline error_code not_due() {
+    return boost::asio::error::basic_errors::in_progress;
+  }
+
 } // namespace errc
 
   using time_duration = boost::posix_time::time_duration;
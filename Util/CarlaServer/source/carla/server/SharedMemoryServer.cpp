@@ -0,0 +1,242 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/server/SharedMemoryServer.h"
+
+#include <cstring>
+
+#include "carla/Logging.h"
+#include "carla/Profiler.h"
+
+#if !defined(_WIN32)
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+namespace carla {
+namespace server {
+
+#define LOG_PREFIX "shared memory", _name, ':'
+
+  // ===========================================================================
+  // -- Static local functions -------------------------------------------------
+  // ===========================================================================
+
+  template <typename T>
+  static void Store(unsigned char *destination, const T value) {
+    std::memcpy(destination, &value, sizeof(T));
+  }
+
+  // ===========================================================================
+  // -- SharedMemoryServer -----------------------------------------------------
+  // ===========================================================================
+
+  constexpr uint32_t SharedMemoryServer::MAGIC;
+  constexpr uint32_t SharedMemoryServer::VERSION;
+  constexpr size_t SharedMemoryServer::HEADER_SIZE;
+
+  SharedMemoryServer::SharedMemoryServer(const size_t capacity)
+      : _capacity(capacity) {}
+
+  SharedMemoryServer::~SharedMemoryServer() {
+    UnmapMemory();
+  }
+
+  error_code SharedMemoryServer::Connect(const uint32_t port, const time_duration timeout) {
+    if (_capacity > 0u) {
+      auto ec = MapMemory(port);
+      if (ec) {
+        return ec;
+      }
+    }
+    auto ec = _socket.Connect(port, timeout);
+    if (!ec && (_capacity > 0u)) {
+      const auto size = static_cast<uint32_t>(_name.size());
+      std::vector<const_buffer> hello = {
+        boost::asio::buffer(&size, sizeof(size)),
+        boost::asio::buffer(_name)
+      };
+      ec = _socket.Write(hello, timeout);
+    }
+    return ec;
+  }
+
+  error_code SharedMemoryServer::Write(const_buffer buffer, const time_duration timeout) {
+    if (_memory == nullptr) {
+      return _socket.Write(buffer, timeout);
+    }
+    return WriteSequence(boost::asio::buffer(buffer), timeout);
+  }
+
+  error_code SharedMemoryServer::Write(
+      const std::vector<const_buffer> &buffers,
+      const time_duration timeout) {
+    if (_memory == nullptr) {
+      return _socket.Write(buffers, timeout);
+    }
+    return WriteSequence(buffers, timeout);
+  }
+
+  template <typename ConstBufferSequence>
+  error_code SharedMemoryServer::WriteSequence(
+      const ConstBufferSequence &buffers,
+      const time_duration timeout) {
+    CARLA_PROFILE_SCOPE(SharedMemoryServer, Write);
+    const size_t size = boost::asio::buffer_size(buffers);
+    size_t offset;
+    auto ec = Allocate(size, timeout, offset);
+    if (ec) {
+      return ec;
+    }
+    unsigned char *destination = _memory + HEADER_SIZE + offset;
+    for (const auto &buffer : buffers) {
+      const auto buffer_size = boost::asio::buffer_size(buffer);
+      std::memcpy(destination, boost::asio::buffer_cast<const unsigned char *>(buffer), buffer_size);
+      destination += buffer_size;
+    }
+    _regions.push_back(Region{offset, size});
+    _head = offset + size;
+    Store(_notification.data(), static_cast<uint32_t>(2u * sizeof(uint64_t)));
+    Store(_notification.data() + sizeof(uint32_t), static_cast<uint64_t>(offset));
+    Store(_notification.data() + sizeof(uint32_t) + sizeof(uint64_t), static_cast<uint64_t>(size));
+    return _socket.Write(boost::asio::buffer(_notification), timeout);
+  }
+
+  error_code SharedMemoryServer::Allocate(
+      const size_t size,
+      const time_duration timeout,
+      size_t &offset) {
+    if (size > _capacity) {
+      LOG_RATE_LIMITED(1000, log_error, LOG_PREFIX, "message of", size, "bytes does not fit in", _capacity, "bytes");
+      return boost::asio::error::message_size;
+    }
+    // Take the releases already received (a zero time-out does not block),
+    // then wait for more if needed.
+    auto ec = Release(time_duration());
+    if (ec && (ec != errc::timed_out())) {
+      return ec;
+    }
+    while (!Fits(size, offset)) {
+      ec = Release(timeout);
+      if (ec) {
+        if (ec == errc::timed_out()) {
+          LOG_RATE_LIMITED(1000, log_info, LOG_PREFIX, "client not releasing memory");
+        }
+        return ec;
+      }
+    }
+    return errc::success();
+  }
+
+  bool SharedMemoryServer::Fits(const size_t size, size_t &offset) const {
+    if (_regions.empty()) {
+      offset = 0u;
+      return true;
+    }
+    const size_t tail = _regions.front().offset;
+    if (_head > tail) {
+      // Free at the end, and at the beginning up to the tail.
+      if (_head + size <= _capacity) {
+        offset = _head;
+        return true;
+      }
+      offset = 0u;
+      return (size <= tail);
+    }
+    // Free between the head and the tail, none if the ring is full.
+    offset = _head;
+    return (_head < tail) && (_head + size <= tail);
+  }
+
+  error_code SharedMemoryServer::Release(const time_duration timeout) {
+    const_array_view<char> message;
+    auto ec = _socket.ReadFrame(message, timeout);
+    if (ec) {
+      return ec;
+    }
+    // Only the first one waits.
+    do {
+      if (!_regions.empty()) {
+        _regions.pop_front();
+      }
+    } while (!_socket.ReadFrame(message, time_duration()));
+    return errc::success();
+  }
+
+#if defined(_WIN32)
+
+  error_code SharedMemoryServer::MapMemory(uint32_t) {
+    log_error("shared memory streams are not supported on this platform");
+    return boost::asio::error::operation_not_supported;
+  }
+
+  void SharedMemoryServer::UnmapMemory() {}
+
+#else
+
+  static error_code LastError() {
+    return error_code(errno, boost::system::system_category());
+  }
+
+  error_code SharedMemoryServer::MapMemory(const uint32_t port) {
+    UnmapMemory();
+    _name = "/carla-" + std::to_string(getpid()) + "-" + std::to_string(port);
+    // A leftover of a crashed server with the same pid.
+    shm_unlink(_name.c_str());
+    _file = shm_open(_name.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+    const size_t size = HEADER_SIZE + _capacity;
+    error_code ec;
+    if (_file < 0) {
+      ec = LastError();
+    } else if (ftruncate(_file, static_cast<off_t>(size)) != 0) {
+      ec = LastError();
+    } else {
+      void *memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, _file, 0);
+      if (memory == MAP_FAILED) {
+        ec = LastError();
+      } else {
+        _memory = static_cast<unsigned char *>(memory);
+      }
+    }
+    if (ec) {
+      log_error(LOG_PREFIX, "unable to map", size, "bytes:", ec.message());
+      UnmapMemory();
+      return ec;
+    }
+    std::memset(_memory, 0, HEADER_SIZE);
+    Store(_memory, MAGIC);
+    Store(_memory + sizeof(uint32_t), VERSION);
+    Store(_memory + 2u * sizeof(uint32_t), static_cast<uint64_t>(_capacity));
+    _head = 0u;
+    _regions.clear();
+    log_debug(LOG_PREFIX, "mapped", size, "bytes");
+    return ec;
+  }
+
+  void SharedMemoryServer::UnmapMemory() {
+    if (_memory != nullptr) {
+      munmap(_memory, HEADER_SIZE + _capacity);
+      _memory = nullptr;
+    }
+    if (_file >= 0) {
+      close(_file);
+      _file = -1;
+    }
+    if (!_name.empty()) {
+      // The client keeps its own mapping.
+      shm_unlink(_name.c_str());
+      _name.clear();
+    }
+  }
+
+#endif // _WIN32
+
+#undef LOG_PREFIX
+
+} // namespace server
+} // namespace carla
@@ -0,0 +1,127 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <array>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "carla/NonCopyable.h"
+#include "carla/server/CoroutineTCPServer.h"
+#include "carla/server/ServerTraits.h"
+
+namespace carla {
+namespace server {
+
+  /// Server writing the data to a ring in shared memory instead of the
+  /// socket, for clients running on the same machine. The data is copied once,
+  /// into the ring, and the client reads it in place.
+  ///
+  /// The socket is still used to signal the client, messages in it are
+  /// [(uint32_t)size, data] as usual:
+  ///
+  ///    [server] name of the shared memory object, once connected
+  ///    [server] (uint64_t)offset, (uint64_t)size of each region written
+  ///    [client] empty message, once it is done with the oldest region
+  ///
+  /// The shared memory starts with a header of HEADER_SIZE bytes,
+  ///
+  ///    uint32 magic, uint32 version, uint64 capacity
+  ///
+  /// followed by the ring of capacity bytes; offsets are relative to the
+  /// ring. Each Write is a single contiguous region, holding exactly the bytes
+  /// that would have been sent through the socket. Regions are never
+  /// overwritten until released by the client, a Write waits (up to its
+  /// time-out) for room.
+  ///
+  /// With a capacity of zero, everything is sent through the socket, i.e., it
+  /// is a plain TCP server.
+  class SharedMemoryServer : private NonCopyable {
+  public:
+
+    static constexpr uint32_t MAGIC = 0x4d485343u; // "CSHM"
+
+    static constexpr uint32_t VERSION = 1u;
+
+    static constexpr size_t HEADER_SIZE = 64u;
+
+    explicit SharedMemoryServer(size_t capacity = 0u);
+
+    ~SharedMemoryServer();
+
+    /// Posts a job to disconnect the server.
+    void Disconnect() {
+      _socket.Disconnect();
+    }
+
+    error_code Connect(uint32_t port, time_duration timeout);
+
+    error_code ReadFrame(const_array_view<char> &frame, time_duration timeout) {
+      return _socket.ReadFrame(frame, timeout);
+    }
+
+    error_code ReadFrame(std::string &frame, time_duration timeout) {
+      return _socket.ReadFrame(frame, timeout);
+    }
+
+    error_code Write(const_buffer buffer, time_duration timeout);
+
+    /// Write the sequence of buffers as a single region.
+    error_code Write(const std::vector<const_buffer> &buffers, time_duration timeout);
+
+    /// Name of the shared memory object, empty if not mapped.
+    const std::string &GetName() const {
+      return _name;
+    }
+
+  private:
+
+    template <typename ConstBufferSequence>
+    error_code WriteSequence(const ConstBufferSequence &buffers, time_duration timeout);
+
+    /// Find room for @a size bytes, waiting up to @a timeout for the client to
+    /// release regions.
+    error_code Allocate(size_t size, time_duration timeout, size_t &offset);
+
+    /// Returns whether @a size bytes fit in the ring, and where.
+    bool Fits(size_t size, size_t &offset) const;
+
+    /// Release the regions the client is done with, waiting up to @a timeout
+    /// for the first one.
+    error_code Release(time_duration timeout);
+
+    error_code MapMemory(uint32_t port);
+
+    void UnmapMemory();
+
+    const size_t _capacity;
+
+    CoroutineTCPServer _socket;
+
+    std::string _name;
+
+    int _file = -1;
+
+    unsigned char *_memory = nullptr;
+
+    /// Next offset to write at.
+    size_t _head = 0u;
+
+    struct Region {
+      size_t offset;
+      size_t size;
+    };
+
+    /// Regions written and not yet released, oldest first.
+    std::deque<Region> _regions;
+
+    std::array<unsigned char, sizeof(uint32_t) + 2u * sizeof(uint64_t)> _notification;
+  };
+
+} // namespace server
+} // namespace carla
@@ -0,0 +1,233 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/server/StreamBroadcaster.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <boost/asio/write.hpp>
+#include <boost/system/system_error.hpp>
+
+#include "carla/Logging.h"
+#include "carla/Profiler.h"
+
+using namespace boost::asio::ip;
+
+namespace carla {
+namespace server {
+
+#define LOG_PREFIX "observers", _port, ':'
+
+  // ===========================================================================
+  // -- StreamBroadcaster::Observer --------------------------------------------
+  // ===========================================================================
+
+  struct StreamBroadcaster::Observer : private NonCopyable {
+    explicit Observer(boost::asio::io_service &service) : socket(service) {}
+
+    tcp::socket socket;
+
+    /// Frames waiting, not including the one being written.
+    std::deque<Frame> queue;
+
+    Frame writing;
+
+    bool waiting_for_key_frame = true;
+  };
+
+  // ===========================================================================
+  // -- StreamBroadcaster ------------------------------------------------------
+  // ===========================================================================
+
+  StreamBroadcaster::StreamBroadcaster(
+      const uint32_t port,
+      const uint32_t max_observers,
+      const uint32_t buffer_depth,
+      const SlowObserverPolicy policy)
+      : _port(port),
+        _max_observers(max_observers),
+        _buffer_depth(std::max(1u, buffer_depth)),
+        _policy(policy),
+        _service(),
+        _work(std::make_unique<boost::asio::io_service::work>(_service)),
+        _acceptor(_service) {
+    try {
+      _acceptor = tcp::acceptor(_service, tcp::endpoint(tcp::v4(), port));
+      Accept();
+    } catch (const boost::system::system_error &exception) {
+      log_error(LOG_PREFIX, "unable to accept observers:", exception.what());
+    }
+    _running = _thread.Post([this]() { _service.run(); });
+  }
+
+  StreamBroadcaster::~StreamBroadcaster() {
+    _service.post([this]() {
+      error_code ignored;
+      _acceptor.close(ignored);
+      auto observers = _observers;
+      for (auto &observer : observers) {
+        Disconnect(observer);
+      }
+    });
+    // Once the pending operations are aborted, run() returns.
+    _work.reset();
+    _running.wait();
+    if (_number_of_dropped_frames > 0u) {
+      log_info(LOG_PREFIX, _number_of_dropped_frames, "frames dropped");
+    }
+  }
+
+  void StreamBroadcaster::Publish(
+      const std::vector<const_buffer> &buffers,
+      const bool key_frame) {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _publishing = true;
+    }
+    _service.post([this, &buffers, key_frame]() {
+      Broadcast(buffers, key_frame);
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _publishing = false;
+      }
+      _published.notify_one();
+    });
+  }
+
+  void StreamBroadcaster::WaitUntilPublished() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _published.wait(lock, [this]() { return !_publishing; });
+  }
+
+  void StreamBroadcaster::Accept() {
+    auto observer = std::make_shared<Observer>(_service);
+    _acceptor.async_accept(observer->socket, [this, observer](const error_code &ec) {
+      if (ec) {
+        if (ec != boost::asio::error::operation_aborted) {
+          log_error(LOG_PREFIX, "accept failed:", ec.message());
+        }
+        return;
+      }
+      if (_observers.size() >= _max_observers) {
+        log_warning(LOG_PREFIX, "too many observers, connection refused");
+        error_code ignored;
+        observer->socket.close(ignored);
+      } else {
+        log_info(LOG_PREFIX, "observer connected");
+        error_code ignored;
+        observer->socket.set_option(tcp::no_delay(true), ignored);
+        _observers.emplace_back(observer);
+        ++_number_of_observers;
+        _key_frame_requested = true;
+      }
+      Accept();
+    });
+  }
+
+  void StreamBroadcaster::Broadcast(
+      const std::vector<const_buffer> &buffers,
+      const bool key_frame) {
+    CARLA_PROFILE_SCOPE(StreamBroadcaster, Broadcast);
+    if (_observers.empty()) {
+      return;
+    }
+    auto frame = MakeFrame();
+    frame->resize(boost::asio::buffer_size(buffers));
+    size_t offset = 0u;
+    for (const auto &buffer : buffers) {
+      const auto size = boost::asio::buffer_size(buffer);
+      std::memcpy(frame->data() + offset, boost::asio::buffer_cast<const unsigned char *>(buffer), size);
+      offset += size;
+    }
+    auto observers = _observers;
+    for (auto &observer : observers) {
+      Queue(observer, frame, key_frame);
+    }
+  }
+
+  std::shared_ptr<std::vector<unsigned char>> StreamBroadcaster::MakeFrame() {
+    // The frames are only shared by this thread, so use_count is reliable.
+    for (auto &frame : _frame_pool) {
+      if (frame.use_count() == 1) {
+        return frame;
+      }
+    }
+    _frame_pool.emplace_back(std::make_shared<std::vector<unsigned char>>());
+    return _frame_pool.back();
+  }
+
+  void StreamBroadcaster::Queue(
+      const std::shared_ptr<Observer> &observer,
+      const Frame &frame,
+      const bool key_frame) {
+    if (observer->waiting_for_key_frame) {
+      if (!key_frame) {
+        return;
+      }
+      observer->waiting_for_key_frame = false;
+    }
+    if (observer->queue.size() >= _buffer_depth) {
+      if (_policy == SlowObserverPolicy::Disconnect) {
+        log_warning(LOG_PREFIX, "observer too slow, disconnecting");
+        Disconnect(observer);
+        return;
+      }
+      if (key_frame) {
+        // Drop the oldest, the rest still decode.
+        observer->queue.pop_front();
+        ++_number_of_dropped_frames;
+      } else {
+        // The frame depends on the ones dropped, start over at a key frame.
+        _number_of_dropped_frames += observer->queue.size() + 1u;
+        observer->queue.clear();
+        observer->waiting_for_key_frame = true;
+        _key_frame_requested = true;
+        return;
+      }
+    }
+    observer->queue.emplace_back(frame);
+    WriteNext(observer);
+  }
+
+  void StreamBroadcaster::WriteNext(const std::shared_ptr<Observer> &observer) {
+    if ((observer->writing != nullptr) || observer->queue.empty()) {
+      return;
+    }
+    observer->writing = std::move(observer->queue.front());
+    observer->queue.pop_front();
+    boost::asio::async_write(
+        observer->socket,
+        boost::asio::buffer(*observer->writing),
+        [this, observer](const error_code &ec, size_t) {
+          observer->writing = nullptr;
+          if (ec) {
+            // Unless we closed it ourselves.
+            if (observer->socket.is_open()) {
+              log_info(LOG_PREFIX, "observer disconnected:", ec.message());
+            }
+            Disconnect(observer);
+          } else {
+            WriteNext(observer);
+          }
+        });
+  }
+
+  void StreamBroadcaster::Disconnect(const std::shared_ptr<Observer> &observer) {
+    if (!observer->socket.is_open()) {
+      return;
+    }
+    error_code ignored;
+    observer->socket.close(ignored);
+    observer->queue.clear();
+    _observers.remove(observer);
+    --_number_of_observers;
+  }
+
+#undef LOG_PREFIX
+
+} // namespace server
+} // namespace carla
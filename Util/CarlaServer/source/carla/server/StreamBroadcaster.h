@@ -0,0 +1,147 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/ip/tcp.hpp>
+
+#include "carla/NonCopyable.h"
+#include "carla/server/AsyncService.h"
+#include "carla/server/ServerTraits.h"
+
+namespace carla {
+namespace server {
+
+  /// What to do with an observer that does not keep up with the stream.
+  enum class SlowObserverPolicy {
+    /// Drop the frames it has not received yet.
+    DropFrames,
+    /// Close its connection.
+    Disconnect
+  };
+
+  /// Sends a copy of every frame written to a stream to read-only "observer"
+  /// clients, connected at a port of their own.
+  ///
+  /// The frames are encoded once, the thread writing them to the primary
+  /// client publishes the encoded buffers here. The buffers are copied by the
+  /// broadcaster's thread while the primary write is in progress, and queued
+  /// for every observer. Each observer has a queue of up to buffer_depth
+  /// frames, what happens when it is full depends on the SlowObserverPolicy;
+  /// either way the primary client is never held back by an observer.
+  ///
+  /// Frames that depend on the previous ones (see AgentSnapshotEncoder) are
+  /// not "key frames". An observer joining, or dropping frames, waits for the
+  /// next key frame, which the writer is asked for through
+  /// TakeKeyFrameRequest.
+  class StreamBroadcaster : private NonCopyable {
+  public:
+
+    /// Accepts up to @a max_observers at @a port.
+    StreamBroadcaster(
+        uint32_t port,
+        uint32_t max_observers,
+        uint32_t buffer_depth,
+        SlowObserverPolicy policy);
+
+    /// Disconnects every observer, frames not yet sent are dropped.
+    ~StreamBroadcaster();
+
+    uint32_t GetNumberOfObservers() const {
+      return _number_of_observers;
+    }
+
+    bool HasObservers() const {
+      return GetNumberOfObservers() > 0u;
+    }
+
+    /// Returns whether an observer is waiting for a key frame, and clears the
+    /// request.
+    bool TakeKeyFrameRequest() {
+      return _key_frame_requested.exchange(false);
+    }
+
+    /// Copy @a buffers as a single frame and queue it for every observer. The
+    /// copy is made asynchronously, @a buffers must be kept alive until
+    /// WaitUntilPublished returns.
+    void Publish(const std::vector<const_buffer> &buffers, bool key_frame);
+
+    /// Wait until the frame published is copied.
+    void WaitUntilPublished();
+
+  private:
+
+    using Frame = std::shared_ptr<const std::vector<unsigned char>>;
+
+    struct Observer;
+
+    void Accept();
+
+    void Broadcast(const std::vector<const_buffer> &buffers, bool key_frame);
+
+    /// Returns a frame buffer no observer is using anymore, or a new one.
+    std::shared_ptr<std::vector<unsigned char>> MakeFrame();
+
+    void Queue(const std::shared_ptr<Observer> &observer, const Frame &frame, bool key_frame);
+
+    void WriteNext(const std::shared_ptr<Observer> &observer);
+
+    void Disconnect(const std::shared_ptr<Observer> &observer);
+
+    const uint32_t _port;
+
+    const uint32_t _max_observers;
+
+    const uint32_t _buffer_depth;
+
+    const SlowObserverPolicy _policy;
+
+    std::atomic<uint32_t> _number_of_observers{0u};
+
+    /// The first frame is requested as key frame, even if nobody is waiting,
+    /// so an encoder that already sent frames starts over.
+    std::atomic_bool _key_frame_requested{true};
+
+    // -- Accessed only by the broadcaster's thread ----------------------------
+
+    boost::asio::io_service _service;
+
+    std::unique_ptr<boost::asio::io_service::work> _work;
+
+    boost::asio::ip::tcp::acceptor _acceptor;
+
+    std::list<std::shared_ptr<Observer>> _observers;
+
+    std::vector<std::shared_ptr<std::vector<unsigned char>>> _frame_pool;
+
+    uint64_t _number_of_dropped_frames = 0u;
+
+    // -- Publishing, guarded by _mutex ----------------------------------------
+
+    std::mutex _mutex;
+
+    std::condition_variable _published;
+
+    bool _publishing = false;
+
+    /// Runs the io_service, with a thread of the executor reserved.
+    AsyncService _thread;
+
+    std::future<void> _running;
+  };
+
+} // namespace server
+} // namespace carla
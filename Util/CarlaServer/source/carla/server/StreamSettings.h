@@ -0,0 +1,59 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstdint>
+
+#include "carla/server/AgentSnapshotEncoder.h"
+#include "carla/server/RingBuffer.h"
+#include "carla/server/StreamBroadcaster.h"
+
+namespace carla {
+namespace server {
+
+  /// Settings of the streams an AgentServer sends to its client.
+  struct StreamSettings {
+    /// If greater than zero, each image is sent through its own stream.
+    uint32_t number_of_sensor_streams = 0u;
+
+    /// Number of frames each stream keeps while the client is not reading.
+    uint32_t buffer_depth = 1u;
+
+    BackPressurePolicy back_pressure = BackPressurePolicy::DropOldest;
+
+    AgentsEncoding agents_encoding = AgentsEncoding::Protobuf;
+
+    /// If greater than zero, read-only observers of the measurements are
+    /// accepted at this port, and observers of sensor stream i at port
+    /// (observers_port + 1 + i).
+    uint32_t observers_port = 0u;
+
+    /// Maximum number of observers per stream.
+    uint32_t max_observers = 4u;
+
+    /// Number of frames queued for each observer.
+    uint32_t observers_buffer_depth = 4u;
+
+    SlowObserverPolicy slow_observer_policy = SlowObserverPolicy::DropFrames;
+
+    /// Number of frames the simulation may run ahead of the controls received
+    /// (pipelined synchronous mode), zero to apply the latest control.
+    uint32_t control_lookahead = 0u;
+
+    /// If greater than zero, the streams are written to shared memory rings of
+    /// this many bytes, for clients on the same machine.
+    uint32_t shared_memory_capacity = 0u;
+
+    /// If true, the client keeps the agent connections across episodes (see
+    /// WorldServer::StartAgentServer), and may not send controls while the
+    /// next episode loads; a control read that times out does not end the
+    /// stream.
+    bool keep_connections = false;
+  };
+
+} // namespace server
+} // namespace carla
@@ -110,6 +110,7 @@ namespace server {
       Disconnect(); // Will disconnect on the next run.
     } else {
       log_info(LOG_PREFIX, "connected");
+      _reader.Clear();
     }
     return ec;
   }
@@ -131,12 +132,65 @@ namespace server {
     return ec;
   }
 
+  error_code TCPServer::ReadFrame(const_array_view<char> &frame, time_duration timeout) {
+    if (_reader.GetNumberOfFrames() == 0u) {
+      _deadline.expires_from_now(timeout);
+      do {
+        error_code ec = boost::asio::error::would_block;
+        size_t bytes_transferred = 0u;
+        _socket.async_read_some(
+            _reader.Prepare(),
+            [&](const error_code &result, size_t bytes) {
+              ec = result;
+              bytes_transferred = bytes;
+            });
+        do {
+          _service.run_one();
+        } while (ec == boost::asio::error::would_block);
+        if (ec) {
+          log_error(LOG_PREFIX, "error reading message:", ec.message());
+          return ec;
+        }
+        if (!_reader.Commit(bytes_transferred)) {
+          CloseConnection(_acceptor, _socket);
+          return error_code(
+              boost::system::errc::illegal_byte_sequence,
+              boost::system::system_category());
+        }
+      } while (_reader.GetNumberOfFrames() == 0u);
+    }
+    frame = _reader.Pop();
+    return errc::success();
+  }
+
+  error_code TCPServer::ReadFrame(std::string &frame, time_duration timeout) {
+    const_array_view<char> view;
+    auto ec = ReadFrame(view, timeout);
+    if (!ec) {
+      frame.assign(view.begin(), view.end());
+    }
+    return ec;
+  }
+
   error_code TCPServer::Write(const_buffer buffer, time_duration timeout) {
-    log_debug(LOG_PREFIX, "sending from buffer of length", boost::asio::buffer_size(buffer));
+    return WriteSequence(boost::asio::buffer(buffer), timeout);
+  }
+
+  error_code TCPServer::Write(
+      const std::vector<const_buffer> &buffers,
+      const time_duration timeout) {
+    return WriteSequence(buffers, timeout);
+  }
+
+  template <typename ConstBufferSequence>
+  error_code TCPServer::WriteSequence(
+      const ConstBufferSequence &buffers,
+      const time_duration timeout) {
+    log_debug(LOG_PREFIX, "sending from buffer of length", boost::asio::buffer_size(buffers));
     _deadline.expires_from_now(timeout);
 
     error_code ec = boost::asio::error::would_block;
-    boost::asio::async_write(_socket, boost::asio::buffer(buffer), var(ec) = _1);
+    boost::asio::async_write(_socket, buffers, var(ec) = _1);
 
     do {
       _service.run_one();
@@ -6,11 +6,15 @@
 
 #pragma once
 
+#include <string>
+#include <vector>
+
 #include <boost/asio/deadline_timer.hpp>
 #include <boost/asio/io_service.hpp>
 #include <boost/asio/ip/tcp.hpp>
 
 #include "carla/NonCopyable.h"
+#include "carla/server/FrameReader.h"
 #include "carla/server/ServerTraits.h"
 
 namespace carla {
@@ -30,12 +34,31 @@ namespace server {
 
     error_code Connect(uint32_t port, time_duration timeout);
 
+    /// Read exactly the size of @a buffer from the socket. Not to be mixed
+    /// with ReadFrame, the data ReadFrame received ahead is not returned here.
     error_code Read(mutable_buffer buffer, time_duration timeout);
 
+    /// Read a message [(uint32_t)size, data] and return its data. As much data
+    /// as available is received at once, the following messages are returned
+    /// without touching the socket.
+    ///
+    /// @a frame points to the receive buffer, it is valid until the next call
+    /// to ReadFrame.
+    error_code ReadFrame(const_array_view<char> &frame, time_duration timeout);
+
+    /// Same as above but copying the frame.
+    error_code ReadFrame(std::string &frame, time_duration timeout);
+
     error_code Write(const_buffer buffer, time_duration timeout);
 
+    /// Gather-write the sequence of buffers as a single operation.
+    error_code Write(const std::vector<const_buffer> &buffers, time_duration timeout);
+
   private:
 
+    template <typename ConstBufferSequence>
+    error_code WriteSequence(const ConstBufferSequence &buffers, time_duration timeout);
+
     void CheckDeadline();
 
     boost::asio::io_service _service;
@@ -45,6 +68,8 @@ namespace server {
     boost::asio::ip::tcp::socket _socket;
 
     boost::asio::deadline_timer _deadline;
+
+    FrameReader _reader;
   };
 
 } // namespace server
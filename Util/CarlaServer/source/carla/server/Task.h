@@ -8,6 +8,7 @@
 
 #include "carla/server/DoubleBuffer.h"
 #include "carla/server/Future.h"
+#include "carla/server/RingBuffer.h"
 #include "carla/server/ServerTraits.h"
 
 namespace carla {
@@ -171,27 +172,32 @@ namespace detail {
 namespace detail {
 
   /// Base class for tasks that continuously read/write from/to a buffer.
-  template <typename T>
+  /// BUFFER may be a DoubleBuffer<T> or a RingBuffer<T>, any extra argument
+  /// of the constructor is forwarded to the buffer.
+  template <typename T, typename BUFFER>
   class StreamTask : public detail::Task<error_code> {
   public:
 
-    StreamTask() : _buffer(std::make_shared<DoubleBuffer<T>>()) {}
+    using buffer_type = BUFFER;
+
+    StreamTask() : _buffer(std::make_shared<BUFFER>()) {}
 
-    explicit StreamTask(time_duration timeout)
+    template <typename... Args>
+    explicit StreamTask(time_duration timeout, Args &&... args)
         : Task(timeout),
-          _buffer(std::make_shared<DoubleBuffer<T>>()) {}
+          _buffer(std::make_shared<BUFFER>(std::forward<Args>(args)...)) {}
 
     ~StreamTask() {
       _buffer->set_done();
     }
 
-    std::shared_ptr<DoubleBuffer<T>> buffer() {
+    std::shared_ptr<BUFFER> buffer() {
       return _buffer;
     }
 
   private:
 
-    const std::shared_ptr<DoubleBuffer<T>> _buffer;
+    const std::shared_ptr<BUFFER> _buffer;
   };
 
 } // namespace detail
@@ -201,14 +207,29 @@ namespace detail {
   // ===========================================================================
 
   /// Continuously read from a server and write to the buffer.
-  template <typename T>
-  class StreamReadTask : public detail::StreamTask<T> {
+  template <typename T, typename BUFFER = DoubleBuffer<T>>
+  class StreamReadTask : public detail::StreamTask<T, BUFFER> {
   public:
 
     StreamReadTask() = default;
 
-    explicit StreamReadTask(time_duration timeout)
-        : detail::StreamTask<T>(timeout) {}
+    template <typename... Args>
+    explicit StreamReadTask(time_duration timeout, Args &&... args)
+        : detail::StreamTask<T, BUFFER>(timeout, std::forward<Args>(args)...) {}
+
+    /// If set, a read that times out is retried instead of ending the stream,
+    /// for clients that may stay idle longer than the time-out.
+    void set_retry_on_timeout(bool retry) {
+      _retry_on_timeout = retry;
+    }
+
+    bool retry_on_timeout() const {
+      return _retry_on_timeout;
+    }
+
+  private:
+
+    bool _retry_on_timeout = false;
   };
 
   // ===========================================================================
@@ -216,14 +237,15 @@ namespace detail {
   // ===========================================================================
 
   /// Continuously read from the buffer and write to a server.
-  template <typename T>
-  class StreamWriteTask : public detail::StreamTask<T> {
+  template <typename T, typename BUFFER = DoubleBuffer<T>>
+  class StreamWriteTask : public detail::StreamTask<T, BUFFER> {
   public:
 
     StreamWriteTask() = default;
 
-    explicit StreamWriteTask(time_duration timeout)
-        : detail::StreamTask<T>(timeout) {}
+    template <typename... Args>
+    explicit StreamWriteTask(time_duration timeout, Args &&... args)
+        : detail::StreamTask<T, BUFFER>(timeout, std::forward<Args>(args)...) {}
   };
 
 } // namespace server
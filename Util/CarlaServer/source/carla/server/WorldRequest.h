@@ -0,0 +1,26 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/server/RequestNewEpisode.h"
+#include "carla/server/WorldSnapshotRequest.h"
+
+namespace carla {
+namespace server {
+
+  /// A request read from the world port, either for a new episode or for a
+  /// world snapshot.
+  struct WorldRequest {
+    /// If true, the client asked to save or restore a world snapshot and
+    /// snapshot holds the request, otherwise new_episode does.
+    bool is_snapshot = false;
+    RequestNewEpisode new_episode;
+    WorldSnapshotRequest snapshot;
+  };
+
+} // namespace server
+} // namespace carla
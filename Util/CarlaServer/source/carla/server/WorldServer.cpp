@@ -51,10 +51,11 @@ namespace server {
   // ===========================================================================
 
   WorldServer::Protocol::Protocol(const time_duration timeout)
-      : request_new_episode(timeout),
+      : request(timeout),
         scene_description(timeout),
         episode_start(timeout),
-        episode_ready(timeout) {}
+        episode_ready(timeout),
+        world_snapshot(timeout) {}
 
   // ===========================================================================
   // --  -------------------------------------------------
@@ -82,10 +83,19 @@ namespace server {
   error_code WorldServer::TryRead(
       carla_request_new_episode &request_new_episode,
       const timeout_t timeout) {
-    auto ec = carla::server::TryRead(_protocol.request_new_episode, _new_episode_data, timeout);
-    if (!ec) {
-      request_new_episode = _new_episode_data.values;
+    auto ec = TryReadRequest(timeout);
+    if (ec) {
+      return ec;
     }
+    if (_request.is_snapshot) {
+      return errc::try_again();
+    }
+    _new_episode_data = std::move(_request.new_episode);
+    _has_request = false;
+    request_new_episode = _new_episode_data.values;
+    _world_server.Execute(_protocol.scene_description);
+    _world_server.Execute(_protocol.episode_start);
+    _world_server.Execute(_protocol.episode_ready);
     return ec;
   }
 
@@ -102,11 +112,79 @@ namespace server {
 
   std::future<error_code> WorldServer::Write(
       const carla_episode_ready &episode_ready) {
-    return carla::server::Write(_protocol.episode_ready, episode_ready);
+    EpisodeReady message;
+    message.values = episode_ready;
+    message.agent_connections_kept = episode_ready.ready && _agent_connections_kept;
+    message.first_frame_number = _first_frame_number;
+    // The write is asynchronous, the phases may be gone by then.
+    message.phases.reserve(episode_ready.number_of_phases);
+    for (auto i = 0u; i < episode_ready.number_of_phases; ++i) {
+      const auto &phase = episode_ready.phases[i];
+      message.phases.push_back({phase.name != nullptr ? phase.name : "", phase.milliseconds});
+    }
+    message.values.phases = nullptr;
+    message.values.number_of_phases = 0u;
+    return carla::server::Write(_protocol.episode_ready, message);
+  }
+
+  error_code WorldServer::TryRead(
+      carla_world_snapshot_request &snapshot_request,
+      const timeout_t timeout) {
+    auto ec = TryReadRequest(timeout);
+    if (ec) {
+      return ec;
+    }
+    if (!_request.is_snapshot) {
+      return errc::try_again();
+    }
+    _snapshot_request = std::move(_request.snapshot);
+    _has_request = false;
+    snapshot_request = _snapshot_request.values;
+    return ec;
+  }
+
+  std::future<error_code> WorldServer::Write(
+      const carla_world_snapshot &world_snapshot) {
+    WorldSnapshot message;
+    message.values = world_snapshot;
+    if (world_snapshot.success &&
+        _snapshot_request.values.restore &&
+        (_agent_server != nullptr)) {
+      message.first_frame_number = _agent_server->StartEpisode();
+    }
+    _protocol.world_snapshot = WriteTask<WorldSnapshot>(_timeout);
+    _world_server.Execute(_protocol.world_snapshot);
+    auto result = carla::server::Write(_protocol.world_snapshot, message);
+    ExecuteReadRequest();
+    return result;
   }
 
-  void WorldServer::StartAgentServer() {
-    _agent_server = std::make_unique<AgentServer>(_encoder, _port + 1u, _port + 2u, _timeout);
+  void WorldServer::StartAgentServer(
+      const uint32_t number_of_sensor_streams,
+      const uint32_t shared_memory_capacity) {
+    _agent_connections_kept =
+        _new_episode_data.keep_agent_connections &&
+        (_agent_server != nullptr) &&
+        (_stream_settings.number_of_sensor_streams == number_of_sensor_streams) &&
+        (_stream_settings.shared_memory_capacity == shared_memory_capacity) &&
+        _agent_server->IsAlive();
+    if (_agent_connections_kept) {
+      _first_frame_number = _agent_server->StartEpisode();
+      return;
+    }
+    // Release the ports before listening again.
+    KillAgentServer();
+    _stream_settings.number_of_sensor_streams = number_of_sensor_streams;
+    _stream_settings.shared_memory_capacity = shared_memory_capacity;
+    _stream_settings.keep_connections = _new_episode_data.keep_agent_connections;
+    _first_frame_number = 1u;
+    _agent_server = std::make_unique<AgentServer>(
+        _encoder,
+        _port + 1u,
+        _port + 2u,
+        _port + 3u,
+        _stream_settings,
+        _timeout);
   }
 
   void WorldServer::KillAgentServer() {
@@ -114,19 +192,34 @@ namespace server {
   }
 
   void WorldServer::ResetProtocol() {
-    Protocol protocol(_timeout);
-    // Here we need to wait forever for the new episode, as it will take as long
-    // as the current episode lasts.
-    protocol.request_new_episode.set_timeout(boost::posix_time::pos_infin);
-    ExecuteProtocol(std::move(protocol));
+    _protocol = Protocol(_timeout);
+    ExecuteReadRequest();
   }
 
   void WorldServer::ExecuteProtocol(Protocol &&protocol) {
     _protocol = std::move(protocol);
-    _world_server.Execute(_protocol.request_new_episode);
-    _world_server.Execute(_protocol.scene_description);
-    _world_server.Execute(_protocol.episode_start);
-    _world_server.Execute(_protocol.episode_ready);
+    _has_request = false;
+    _world_server.Execute(_protocol.request);
+  }
+
+  error_code WorldServer::TryReadRequest(const timeout_t timeout) {
+    if (_has_request) {
+      return errc::success();
+    }
+    if (!_protocol.request.valid()) {
+      // Taken already, the episode or the snapshot is not done yet.
+      return errc::try_again();
+    }
+    auto ec = carla::server::TryRead(_protocol.request, _request, timeout);
+    _has_request = !ec;
+    return ec;
+  }
+
+  void WorldServer::ExecuteReadRequest() {
+    // Here we need to wait forever for the new episode, as it will take as long
+    // as the current episode lasts.
+    _protocol.request = ReadTask<WorldRequest>(boost::posix_time::pos_infin);
+    _world_server.Execute(_protocol.request);
   }
 
 } // namespace server
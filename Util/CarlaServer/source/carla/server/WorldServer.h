@@ -10,6 +10,7 @@
 #include "carla/server/AsyncServer.h"
 #include "carla/server/CarlaEncoder.h"
 #include "carla/server/EncoderServer.h"
+#include "carla/server/StreamSettings.h"
 #include "carla/server/TCPServer.h"
 
 namespace carla {
@@ -37,11 +38,29 @@ namespace server {
 
     error_code TryRead(carla_episode_start &episode_start, timeout_t timeout);
 
+    /// Sent with the agent connections kept and the first frame number of the
+    /// agent server started last.
     std::future<error_code> Write(const carla_episode_ready &episode_ready);
 
+    /// Returns try_again while the request pending is for a new episode.
+    error_code TryRead(carla_world_snapshot_request &snapshot_request, timeout_t timeout);
+
+    /// Reply to the snapshot request read last, then wait for the next
+    /// request. After restoring, the agent server starts a new episode on the
+    /// same connections, so the client can tell the frames before.
+    std::future<error_code> Write(const carla_world_snapshot &world_snapshot);
+
     /// This assumes you have entered the loop of write measurements, read
     /// control.
-    void StartAgentServer();
+    ///
+    /// Sensor streams, if any, listen at ports starting at (world_port + 3).
+    ///
+    /// If the client asked to keep its agent connections, the agent server of
+    /// the previous episode is kept if still alive and the streams are the
+    /// same; it starts a new episode instead (see AgentServer::StartEpisode).
+    void StartAgentServer(
+        uint32_t number_of_sensor_streams = 0u,
+        uint32_t shared_memory_capacity = 0u);
 
     AgentServer *GetAgentServer() {
       return _agent_server.get();
@@ -49,22 +68,66 @@ namespace server {
 
     void KillAgentServer();
 
+    /// Called once a new episode is requested. Kills the agent server, unless
+    /// the client asked to keep its agent connections.
+    void EndEpisode() {
+      if (!_new_episode_data.keep_agent_connections) {
+        KillAgentServer();
+      }
+    }
+
+    /// Buffering of the agent streams, takes effect when the next agent server
+    /// starts.
+    void SetStreamBuffering(uint32_t depth, BackPressurePolicy back_pressure) {
+      _stream_settings.buffer_depth = depth;
+      _stream_settings.back_pressure = back_pressure;
+    }
+
+    void SetNonPlayerAgentsEncoding(AgentsEncoding agents_encoding) {
+      _stream_settings.agents_encoding = agents_encoding;
+    }
+
+    void SetControlLookahead(uint32_t lookahead) {
+      _stream_settings.control_lookahead = lookahead;
+    }
+
+    void SetObservers(
+        uint32_t port,
+        uint32_t max_observers,
+        uint32_t buffer_depth,
+        SlowObserverPolicy policy) {
+      _stream_settings.observers_port = port;
+      _stream_settings.max_observers = max_observers;
+      _stream_settings.observers_buffer_depth = buffer_depth;
+      _stream_settings.slow_observer_policy = policy;
+    }
+
     void ResetProtocol();
 
   private:
 
+    /// The tasks following the request are posted once it is read, since it
+    /// may be for a world snapshot instead of a new episode.
     struct Protocol {
       Protocol() = default;
       explicit Protocol(time_duration timeout);
 
-      ReadTask<RequestNewEpisode> request_new_episode;
+      ReadTask<WorldRequest> request;
       WriteTask<carla_scene_description> scene_description;
       ReadTask<carla_episode_start> episode_start;
-      WriteTask<carla_episode_ready> episode_ready;
+      WriteTask<EpisodeReady> episode_ready;
+      WriteTask<WorldSnapshot> world_snapshot;
     };
 
     void ExecuteProtocol(Protocol &&protocol);
 
+    /// Read the next request into _request, if not read yet.
+    error_code TryReadRequest(timeout_t timeout);
+
+    /// Post the read of the next request, the new episode may take as long as
+    /// the current episode lasts.
+    void ExecuteReadRequest();
+
     uint32_t _port;
 
     time_duration _timeout;
@@ -77,7 +140,21 @@ namespace server {
 
     std::unique_ptr<AgentServer> _agent_server;
 
+    StreamSettings _stream_settings;
+
+    /// Request read but not taken yet by TryRead.
+    WorldRequest _request;
+
+    bool _has_request = false;
+
     RequestNewEpisode _new_episode_data;
+
+    WorldSnapshotRequest _snapshot_request;
+
+    /// Of the agent server started last.
+    bool _agent_connections_kept = false;
+
+    uint64_t _first_frame_number = 1u;
   };
 
 } // namespace server
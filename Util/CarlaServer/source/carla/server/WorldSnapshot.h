@@ -0,0 +1,25 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstdint>
+
+#include "carla/server/CarlaServerAPI.h"
+
+namespace carla {
+namespace server {
+
+  /// Holds the data of a carla_world_snapshot plus the agent server's, sent
+  /// to the client in the WorldSnapshot message.
+  struct WorldSnapshot {
+    carla_world_snapshot values;
+    /// After restoring, frames before this one belong to the world before.
+    uint64_t first_frame_number = 0u;
+  };
+
+} // namespace server
+} // namespace carla
@@ -0,0 +1,25 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB), and the INTEL Visual Computing Lab.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <memory>
+
+#include "carla/server/CarlaServerAPI.h"
+
+namespace carla {
+namespace server {
+
+  /// Holds the data of a carla_world_snapshot_request. As with
+  /// RequestNewEpisode, the snapshot to restore is hold in memory until the
+  /// next call to carla_read_world_snapshot_request().
+  struct WorldSnapshotRequest {
+    carla_world_snapshot_request values;
+    std::unique_ptr<const char[]> data;
+  };
+
+} // namespace server
+} // namespace carla
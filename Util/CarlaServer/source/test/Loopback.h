@@ -0,0 +1,30 @@
+#pragma once
+
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/ip/tcp.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+/// The tests and benchmarks of the servers connect a client of their own
+/// through the loopback interface.
+
+/// Connect a socket to @a port on the loopback interface, retrying every
+/// @a retry_interval until the server under test is listening.
+inline boost::asio::ip::tcp::socket ConnectLoopback(
+    boost::asio::io_service &service,
+    const uint32_t port,
+    const std::chrono::microseconds retry_interval = std::chrono::milliseconds(10)) {
+  using boost::asio::ip::tcp;
+  const tcp::endpoint endpoint(boost::asio::ip::address_v4::loopback(), static_cast<unsigned short>(port));
+  boost::system::error_code ec;
+  for (;;) {
+    tcp::socket socket(service);
+    socket.connect(endpoint, ec);
+    if (!ec) {
+      return socket;
+    }
+    std::this_thread::sleep_for(retry_interval);
+  }
+}
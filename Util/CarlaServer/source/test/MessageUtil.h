@@ -0,0 +1,34 @@
+#pragma once
+
+#include <carla/server/ServerTraits.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+/// Helpers to inspect the encoded messages in the tests.
+
+/// Concatenate the contents of @a buffers.
+inline std::string Flatten(const std::vector<carla::server::const_buffer> &buffers) {
+  std::string result;
+  for (const auto &buffer : buffers) {
+    result.append(
+        boost::asio::buffer_cast<const char *>(buffer),
+        boost::asio::buffer_size(buffer));
+  }
+  return result;
+}
+
+/// Read a value of type T at @a offset of @a str.
+template <typename T>
+inline T ReadValue(const std::string &str, size_t offset) {
+  T value;
+  std::memcpy(&value, str.data() + offset, sizeof(T));
+  return value;
+}
+
+/// Release callback of carla_image_lease, counts the calls in the int pointed
+/// to by @a user_data.
+inline void CountRelease(void *user_data) {
+  ++*static_cast<int *>(user_data);
+}
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+
+#include <carla/server/AgentServer.h>
+#include <carla/server/CarlaEncoder.h>
+#include <carla/server/Protobuf.h>
+#include <carla/server/carla_server.pb.h>
+
+#include <boost/asio/write.hpp>
+
+#include <thread>
+
+#include "Loopback.h"
+
+using namespace carla::server;
+using namespace boost::posix_time;
+using boost::asio::ip::tcp;
+
+static constexpr uint32_t PORT = 4140u;
+static const auto TIMEOUT = seconds(10);
+
+/// Client of the measurements and control streams of an AgentServer, the
+/// measurements are never read.
+class AgentClient {
+public:
+
+  explicit AgentClient(uint32_t port)
+    : _measurements(ConnectLoopback(_service, port)),
+      _control(ConnectLoopback(_service, port + 1u)) {}
+
+  void SendControl(uint64_t frame_number, float steer) {
+    carla_server::Control control;
+    control.set_steer(steer);
+    control.set_frame_number(frame_number);
+    boost::asio::write(_control, boost::asio::buffer(Protobuf::Encode(control)));
+  }
+
+private:
+
+  boost::asio::io_service _service;
+
+  tcp::socket _measurements;
+
+  tcp::socket _control;
+};
+
+static error_code WriteFrame(AgentServer &server) {
+  const carla_measurements measurements{};
+  return server.WriteMeasurements(measurements, carla::const_array_view<carla_image>());
+}
+
+TEST(AgentServer, ControlIsAppliedLookaheadFramesLater) {
+  CarlaEncoder encoder;
+  StreamSettings settings;
+  settings.control_lookahead = 2u;
+  AgentServer server(encoder, PORT, PORT + 1u, PORT + 2u, settings, TIMEOUT);
+  AgentClient client(PORT);
+
+  // The client replies to every frame at once, the server does not apply them
+  // until due.
+  for (auto frame = 1u; frame <= 6u; ++frame) {
+    client.SendControl(frame, 0.1f * frame);
+  }
+  carla_control control;
+  for (auto frame = 1u; frame <= 6u; ++frame) {
+    ASSERT_FALSE(WriteFrame(server));
+    if (frame <= settings.control_lookahead) {
+      ASSERT_EQ(server.ReadControl(control, timeout_t()), errc::not_due());
+    } else {
+      ASSERT_FALSE(server.ReadControl(control, timeout_t::milliseconds(10000u)));
+      ASSERT_FLOAT_EQ(control.steer, 0.1f * (frame - settings.control_lookahead));
+    }
+    // Each control is applied once.
+    ASSERT_EQ(server.ReadControl(control, timeout_t()), errc::not_due());
+  }
+}
+
+TEST(AgentServer, LateAndSkippedControls) {
+  CarlaEncoder encoder;
+  StreamSettings settings;
+  settings.control_lookahead = 1u;
+  AgentServer server(encoder, PORT + 3u, PORT + 4u, PORT + 5u, settings, TIMEOUT);
+  AgentClient client(PORT + 3u);
+
+  carla_control control;
+  ASSERT_FALSE(WriteFrame(server));
+  ASSERT_FALSE(WriteFrame(server));
+  // The control of frame 1 is due, but late.
+  ASSERT_EQ(server.ReadControl(control, timeout_t::milliseconds(50u)), errc::try_again());
+  ASSERT_FALSE(WriteFrame(server));
+  // Frame 2 is due now, the late control of frame 1 is applied too.
+  client.SendControl(1u, 0.1f);
+  client.SendControl(2u, 0.2f);
+  ASSERT_FALSE(server.ReadControl(control, timeout_t::milliseconds(10000u)));
+  ASSERT_FLOAT_EQ(control.steer, 0.2f);
+  // The client skips frame 3, its control of frame 4 waits until due.
+  client.SendControl(4u, 0.4f);
+  ASSERT_FALSE(WriteFrame(server));
+  ASSERT_EQ(server.ReadControl(control, timeout_t::milliseconds(10000u)), errc::not_due());
+  ASSERT_FALSE(WriteFrame(server));
+  ASSERT_FALSE(server.ReadControl(control, timeout_t()));
+  ASSERT_FLOAT_EQ(control.steer, 0.4f);
+}
+
+TEST(AgentServer, NewEpisodeOnTheSameConnections) {
+  CarlaEncoder encoder;
+  StreamSettings settings;
+  settings.keep_connections = true;
+  AgentServer server(encoder, PORT + 6u, PORT + 7u, PORT + 8u, settings, milliseconds(200));
+  AgentClient client(PORT + 6u);
+
+  ASSERT_FALSE(WriteFrame(server));
+  ASSERT_FALSE(WriteFrame(server));
+  ASSERT_EQ(server.StartEpisode(), 3u);
+  // The client does not send controls while the episode loads, for longer
+  // than the time-out.
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  ASSERT_TRUE(server.IsAlive());
+  ASSERT_FALSE(WriteFrame(server));
+  // The late reply to the previous episode is discarded.
+  client.SendControl(2u, 0.2f);
+  client.SendControl(3u, 0.3f);
+  carla_control control;
+  error_code ec;
+  do {
+    ec = server.ReadControl(control, timeout_t::milliseconds(100u));
+  } while (ec == errc::try_again());
+  ASSERT_FALSE(ec);
+  ASSERT_FLOAT_EQ(control.steer, 0.3f);
+}
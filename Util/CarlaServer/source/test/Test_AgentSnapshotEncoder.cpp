@@ -0,0 +1,281 @@
+#include <gtest/gtest.h>
+
+#include <carla/server/AgentSnapshotEncoder.h>
+#include <carla/server/CarlaEncoder.h>
+
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <vector>
+
+using carla::server::AgentSnapshotEncoder;
+
+/// Minimal decoder keeping the state between frames, as a client would.
+class SnapshotDecoder {
+public:
+
+  struct Frame {
+    uint32_t flags;
+    uint32_t number_of_descriptions;
+    uint32_t number_of_removed;
+    size_t number_of_changed = 0u;
+    std::vector<carla_agent> dynamic;
+  };
+
+  Frame Decode(const carla::server::const_buffer &buffer) {
+    _data = boost::asio::buffer_cast<const unsigned char *>(buffer);
+    _size = boost::asio::buffer_size(buffer);
+    _offset = 0u;
+    Frame frame;
+    EXPECT_EQ(Read<uint32_t>(), AgentSnapshotEncoder::VERSION);
+    frame.flags = Read<uint32_t>();
+    const auto D = frame.number_of_descriptions = Read<uint32_t>();
+    const auto R = frame.number_of_removed = Read<uint32_t>();
+    const auto N = Read<uint32_t>();
+    const auto step = Read<float>();
+    // Descriptions.
+    std::vector<uint32_t> ids(D);
+    for (auto &id : ids) { id = Read<uint32_t>(); }
+    for (auto i = 0u; i < D; ++i) { descriptions[ids[i]].id = ids[i]; }
+    for (auto id : ids) { descriptions[id].type = Read<uint32_t>(); }
+    for (auto id : ids) { descriptions[id].box_extent = Read<carla_vector3d>(); }
+    for (auto id : ids) { descriptions[id].transform.location = Read<carla_vector3d>(); }
+    for (auto id : ids) { descriptions[id].transform.orientation = Read<carla_vector3d>(); }
+    for (auto id : ids) { descriptions[id].forward_speed = Read<float>(); }
+    for (auto i = 0u; i < R; ++i) { descriptions.erase(Read<uint32_t>()); }
+    // Dynamic.
+    if ((frame.flags & AgentSnapshotEncoder::SAME_IDS) == 0u) {
+      _ids.resize(N);
+      for (auto &id : _ids) { id = Read<uint32_t>(); }
+    }
+    EXPECT_EQ(_ids.size(), N);
+    frame.dynamic.resize(N);
+    for (auto i = 0u; i < N; ++i) {
+      frame.dynamic[i] = descriptions[_ids[i]];
+    }
+    if ((frame.flags & AgentSnapshotEncoder::QUANTIZED) == 0u) {
+      for (auto &agent : frame.dynamic) { agent.transform.location = Read<carla_vector3d>(); }
+      for (auto &agent : frame.dynamic) { agent.transform.orientation = Read<carla_vector3d>(); }
+      for (auto &agent : frame.dynamic) { agent.forward_speed = Read<float>(); }
+    } else if ((frame.flags & AgentSnapshotEncoder::DELTA) == 0u) {
+      _locations.resize(3u * N);
+      _orientations.resize(3u * N);
+      _speeds.resize(N);
+      for (auto &location : _locations) { location = Read<int32_t>(); }
+      for (auto &orientation : _orientations) { orientation = Read<int16_t>(); }
+      for (auto &speed : _speeds) { speed = Read<int16_t>(); }
+      Dequantize(frame, step);
+      _offset += (4u - _offset % 4u) % 4u;
+    } else {
+      std::vector<uint32_t> changed;
+      for (auto i = 0u; i < N; ++i) {
+        if ((_data[_offset + i / 8u] >> (i % 8u)) & 1u) {
+          changed.emplace_back(i);
+        }
+      }
+      _offset += (N + 7u) / 8u;
+      _offset += (4u - _offset % 4u) % 4u;
+      for (auto i : changed) {
+        for (auto j = 0u; j < 3u; ++j) { _locations[3u * i + j] += Read<int16_t>(); }
+      }
+      for (auto i : changed) {
+        for (auto j = 0u; j < 3u; ++j) { _orientations[3u * i + j] = Read<int16_t>(); }
+      }
+      for (auto i : changed) { _speeds[i] = Read<int16_t>(); }
+      frame.number_of_changed = changed.size();
+      Dequantize(frame, step);
+      _offset += (4u - _offset % 4u) % 4u;
+    }
+    EXPECT_EQ(_offset, _size);
+    return frame;
+  }
+
+  std::map<uint32_t, carla_agent> descriptions;
+
+private:
+
+  void Dequantize(Frame &frame, float step) {
+    for (auto i = 0u; i < frame.dynamic.size(); ++i) {
+      auto &agent = frame.dynamic[i];
+      agent.transform.location = {step * _locations[3u*i], step * _locations[3u*i+1u], step * _locations[3u*i+2u]};
+      agent.transform.orientation = {
+        _orientations[3u*i] / 32767.0f,
+        _orientations[3u*i+1u] / 32767.0f,
+        _orientations[3u*i+2u] / 32767.0f};
+      agent.forward_speed = _speeds[i] * 0.01f;
+    }
+  }
+
+  template <typename T>
+  T Read() {
+    T value;
+    EXPECT_LE(_offset + sizeof(T), _size);
+    std::memcpy(&value, _data + _offset, sizeof(T));
+    _offset += sizeof(T);
+    return value;
+  }
+
+  const unsigned char *_data = nullptr;
+  size_t _size = 0u;
+  size_t _offset = 0u;
+  std::vector<uint32_t> _ids;
+  std::vector<int32_t> _locations;
+  std::vector<int16_t> _orientations;
+  std::vector<int16_t> _speeds;
+};
+
+static std::vector<carla_agent> MakeScene(uint32_t vehicles, uint32_t pedestrians, uint32_t signs) {
+  std::vector<carla_agent> agents;
+  uint32_t id = 100u;
+  auto add = [&](uint32_t type, uint32_t count) {
+    for (auto i = 0u; i < count; ++i, ++id) {
+      carla_agent agent = {};
+      agent.id = id;
+      agent.type = type;
+      agent.transform.location = {10000.0f + 123.25f * id, -5000.0f + 7.5f * id, 38.0f};
+      agent.transform.orientation = {0.6f, 0.8f, 0.0f};
+      agent.box_extent = {200.0f, 90.0f, 70.0f};
+      agent.forward_speed = 0.25f * (id % 200u);
+      agents.emplace_back(agent);
+    }
+  };
+  add(CARLA_SERVER_AGENT_VEHICLE, vehicles);
+  add(CARLA_SERVER_AGENT_PEDESTRIAN, pedestrians);
+  add(CARLA_SERVER_AGENT_SPEEDLIMITSIGN, signs / 2u);
+  add(CARLA_SERVER_AGENT_TRAFFICLIGHT_GREEN, signs - signs / 2u);
+  return agents;
+}
+
+static void Move(std::vector<carla_agent> &agents) {
+  for (auto &agent : agents) {
+    // Pedestrians stand still.
+    if (agent.type == CARLA_SERVER_AGENT_VEHICLE) {
+      agent.transform.location.x += 55.5f;
+      agent.transform.location.y -= 3.0f;
+      agent.forward_speed += 1.0f;
+    }
+  }
+}
+
+static carla::const_array_view<carla_agent> View(const std::vector<carla_agent> &agents) {
+  return carla::const_array_view<carla_agent>(agents.data(), agents.size());
+}
+
+static void ExpectDynamic(
+    const std::vector<carla_agent> &agents,
+    const SnapshotDecoder::Frame &frame,
+    float tolerance) {
+  size_t index = 0u;
+  for (const auto &agent : agents) {
+    if ((agent.type != CARLA_SERVER_AGENT_VEHICLE) && (agent.type != CARLA_SERVER_AGENT_PEDESTRIAN)) {
+      continue;
+    }
+    ASSERT_LT(index, frame.dynamic.size());
+    const auto &decoded = frame.dynamic[index++];
+    ASSERT_EQ(decoded.id, agent.id);
+    ASSERT_EQ(decoded.type, agent.type);
+    ASSERT_EQ(decoded.box_extent.x, agent.box_extent.x);
+    ASSERT_NEAR(decoded.transform.location.x, agent.transform.location.x, tolerance);
+    ASSERT_NEAR(decoded.transform.location.y, agent.transform.location.y, tolerance);
+    ASSERT_NEAR(decoded.transform.location.z, agent.transform.location.z, tolerance);
+    ASSERT_NEAR(decoded.transform.orientation.x, agent.transform.orientation.x, 1e-4f);
+    ASSERT_NEAR(decoded.transform.orientation.y, agent.transform.orientation.y, 1e-4f);
+    ASSERT_NEAR(decoded.forward_speed, agent.forward_speed, 0.01f);
+  }
+  ASSERT_EQ(index, frame.dynamic.size());
+}
+
+TEST(AgentSnapshotEncoder, StaticAgentsAreSentOnce) {
+  auto agents = MakeScene(3u, 2u, 4u);
+  AgentSnapshotEncoder encoder;
+  SnapshotDecoder decoder;
+
+  auto frame = decoder.Decode(encoder.Encode(View(agents), false));
+  ASSERT_EQ(frame.number_of_descriptions, agents.size());
+  ASSERT_EQ(frame.flags & AgentSnapshotEncoder::QUANTIZED, 0u);
+  ExpectDynamic(agents, frame, 0.0f);
+
+  Move(agents);
+  frame = decoder.Decode(encoder.Encode(View(agents), false));
+  ASSERT_EQ(frame.number_of_descriptions, 0u);
+  ASSERT_NE(frame.flags & AgentSnapshotEncoder::SAME_IDS, 0u);
+  ExpectDynamic(agents, frame, 0.0f);
+
+  // A traffic light changes and a vehicle goes away.
+  agents.back().type = CARLA_SERVER_AGENT_TRAFFICLIGHT_RED;
+  const auto removed_id = agents.front().id;
+  agents.erase(agents.begin());
+  frame = decoder.Decode(encoder.Encode(View(agents), false));
+  ASSERT_EQ(frame.number_of_descriptions, 1u);
+  ASSERT_EQ(frame.number_of_removed, 1u);
+  ASSERT_EQ(frame.flags & AgentSnapshotEncoder::SAME_IDS, 0u);
+  ASSERT_EQ(decoder.descriptions.count(removed_id), 0u);
+  ASSERT_EQ(decoder.descriptions.at(agents.back().id).type, CARLA_SERVER_AGENT_TRAFFICLIGHT_RED);
+  ASSERT_EQ(decoder.descriptions.size(), agents.size());
+  ExpectDynamic(agents, frame, 0.0f);
+}
+
+TEST(AgentSnapshotEncoder, QuantizedDelta) {
+  auto agents = MakeScene(30u, 20u, 10u);
+  AgentSnapshotEncoder encoder;
+  SnapshotDecoder decoder;
+
+  auto frame = decoder.Decode(encoder.Encode(View(agents), true));
+  ASSERT_NE(frame.flags & AgentSnapshotEncoder::QUANTIZED, 0u);
+  ASSERT_EQ(frame.flags & AgentSnapshotEncoder::DELTA, 0u);
+  ExpectDynamic(agents, frame, AgentSnapshotEncoder::LOCATION_STEP);
+
+  for (auto i = 0u; i < 50u; ++i) {
+    Move(agents);
+    frame = decoder.Decode(encoder.Encode(View(agents), true));
+    ASSERT_NE(frame.flags & AgentSnapshotEncoder::DELTA, 0u);
+    ASSERT_EQ(frame.number_of_changed, 30u);
+    // Deltas of quantized values do not accumulate error.
+    ExpectDynamic(agents, frame, AgentSnapshotEncoder::LOCATION_STEP);
+  }
+
+  // A jump too big for a delta falls back to absolute values.
+  agents.front().transform.location.x += 1e6f;
+  frame = decoder.Decode(encoder.Encode(View(agents), true));
+  ASSERT_EQ(frame.flags & AgentSnapshotEncoder::DELTA, 0u);
+  ExpectDynamic(agents, frame, AgentSnapshotEncoder::LOCATION_STEP);
+}
+
+TEST(AgentSnapshotEncoder, KeyFrameDecodesWithoutHistory) {
+  auto agents = MakeScene(30u, 20u, 10u);
+  AgentSnapshotEncoder encoder;
+  SnapshotDecoder decoder;
+  for (auto i = 0u; i < 5u; ++i) {
+    Move(agents);
+    decoder.Decode(encoder.Encode(View(agents), true));
+  }
+
+  // A client joining late only sees the frames from the key frame on.
+  SnapshotDecoder late_decoder;
+  Move(agents);
+  encoder.RequestKeyFrame();
+  auto frame = late_decoder.Decode(encoder.Encode(View(agents), true));
+  ASSERT_EQ(frame.flags & (AgentSnapshotEncoder::SAME_IDS | AgentSnapshotEncoder::DELTA), 0u);
+  ASSERT_EQ(frame.number_of_descriptions, agents.size());
+  ExpectDynamic(agents, frame, AgentSnapshotEncoder::LOCATION_STEP);
+
+  Move(agents);
+  frame = late_decoder.Decode(encoder.Encode(View(agents), true));
+  ASSERT_NE(frame.flags & AgentSnapshotEncoder::DELTA, 0u);
+  ExpectDynamic(agents, frame, AgentSnapshotEncoder::LOCATION_STEP);
+}
+
+TEST(AgentSnapshotEncoder, SmallerThanProtobuf) {
+  using namespace carla::server;
+  auto agents = MakeScene(300u, 500u, 200u);
+  carla_measurements measurements = {};
+  measurements.non_player_agents = agents.data();
+  measurements.number_of_non_player_agents = agents.size();
+
+  AgentSnapshotEncoder encoder;
+  encoder.Encode(View(agents), true);
+  Move(agents);
+  const auto snapshot_size = boost::asio::buffer_size(encoder.Encode(View(agents), true));
+  const auto protobuf_size = CarlaEncoder().Encode(measurements).size();
+  ASSERT_LT(5u * snapshot_size, protobuf_size);
+}
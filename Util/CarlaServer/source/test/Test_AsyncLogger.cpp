@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+
+#include <carla/Logging.h>
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using carla::logging::AsyncLogger;
+using carla::logging::RateLimiter;
+
+TEST(AsyncLogger, MessagesOfEveryThreadAreWrittenInOrder) {
+  constexpr auto number_of_threads = 4u;
+  constexpr auto number_of_messages = 200u;
+  std::ostringstream out;
+  std::ostringstream err;
+  AsyncLogger logger(out, err);
+  std::vector<std::thread> threads;
+  for (auto i = 0u; i < number_of_threads; ++i) {
+    threads.emplace_back([&logger, i]() {
+      for (auto j = 0u; j < number_of_messages; ++j) {
+        logger.Write(false, std::to_string(i) + ' ' + std::to_string(j) + '\n');
+        if (j % 50u == 0u) {
+          std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  logger.Flush();
+
+  const auto statistics = logger.GetStatistics();
+  ASSERT_EQ(statistics.written + statistics.dropped, number_of_threads * number_of_messages);
+  std::vector<int> last(number_of_threads, -1);
+  std::istringstream lines(out.str());
+  uint64_t count = 0u;
+  unsigned thread;
+  int message;
+  while (lines >> thread >> message) {
+    ASSERT_LT(thread, number_of_threads);
+    ASSERT_GT(message, last[thread]);
+    last[thread] = message;
+    ++count;
+  }
+  ASSERT_EQ(count, statistics.written);
+  if (statistics.dropped > 0u) {
+    ASSERT_NE(err.str().find("log messages dropped"), std::string::npos);
+  }
+}
+
+TEST(AsyncLogger, SynchronousWritesDirectly) {
+  std::ostringstream out;
+  std::ostringstream err;
+  AsyncLogger logger(out, err);
+  logger.Write(false, "first\n");
+  logger.SetAsynchronous(false);
+  ASSERT_EQ(out.str(), "first\n");
+  logger.Write(true, "second\n");
+  ASSERT_EQ(err.str(), "second\n");
+  ASSERT_EQ(logger.GetStatistics().written, 2u);
+}
+
+TEST(AsyncLogger, StopAtExitWritesWithoutJoining) {
+  std::ostringstream out;
+  std::ostringstream err;
+  AsyncLogger logger(out, err);
+  logger.Write(false, "first\n");
+  logger.StopAtExit();
+  ASSERT_EQ(out.str(), "first\n");
+  logger.Write(false, "second\n");
+  ASSERT_EQ(out.str(), "first\nsecond\n");
+}
+
+TEST(AsyncLogger, LongMessagesAreTruncated) {
+  std::ostringstream out;
+  std::ostringstream err;
+  AsyncLogger logger(out, err);
+  logger.Write(false, std::string(2u * AsyncLogger::MESSAGE_SIZE, 'x'));
+  logger.Flush();
+  ASSERT_EQ(out.str().size(), AsyncLogger::MESSAGE_SIZE);
+  ASSERT_EQ(out.str().back(), '\n');
+}
+
+TEST(AsyncLogger, RateLimiterCountsSuppressed) {
+  RateLimiter limiter(std::chrono::milliseconds(50));
+  uint64_t suppressed = 42u;
+  ASSERT_TRUE(limiter.Allow(suppressed));
+  ASSERT_EQ(suppressed, 0u);
+  for (auto i = 0u; i < 10u; ++i) {
+    ASSERT_FALSE(limiter.Allow(suppressed));
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(60));
+  ASSERT_TRUE(limiter.Allow(suppressed));
+  ASSERT_EQ(suppressed, 10u);
+  ASSERT_GE(AsyncLogger::GetInstance().GetStatistics().suppressed, 10u);
+}
@@ -53,7 +53,7 @@ TEST(CarlaServerAPI, SimBlocking) {
   constexpr uint32_t ImageSizeY = 200u;
   const uint32_t image0[ImageSizeX*ImageSizeY] = {0u};
   const carla_image images[] = {
-    {ImageSizeX, ImageSizeY, 1u, image0}
+    {ImageSizeX, ImageSizeY, 1u, image0, CARLA_SERVER_IMAGE_COMPRESSION_NONE}
   };
 
   const carla_transform start_locations[] = {
@@ -93,7 +93,7 @@ TEST(CarlaServerAPI, SimBlocking) {
     }
     {
       test_log("sending episode ready...");
-      const carla_episode_ready values{true};
+      const carla_episode_ready values{true, 0u, 0u, nullptr, 0u};
       ASSERT_EQ(S, carla_write_episode_ready(CarlaServer, values, TIMEOUT));
     }
 
@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+
+#include <carla/server/CoroutineTCPServer.h>
+
+#include <boost/asio/connect.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+
+#include <algorithm>
+#include <future>
+#include <string>
+#include <thread>
+
+#include "Loopback.h"
+
+using namespace carla::server;
+using namespace boost::posix_time;
+using boost::asio::ip::tcp;
+
+static constexpr uint32_t PORT = 4100u;
+static const auto TIMEOUT = seconds(10);
+
+static std::string MakeFrame(const std::string &data) {
+  const auto size = static_cast<uint32_t>(data.size());
+  std::string frame(reinterpret_cast<const char *>(&size), sizeof(size));
+  return frame + data;
+}
+
+/// Connects @a server and a client socket to each other.
+static void ConnectClient(
+    CoroutineTCPServer &server,
+    boost::asio::io_service &service,
+    tcp::socket &client,
+    const uint32_t port) {
+  auto connected = std::async(std::launch::async, [&]() {
+    return server.Connect(port, TIMEOUT);
+  });
+  client = ConnectLoopback(service, port);
+  ASSERT_FALSE(connected.get());
+}
+
+TEST(CoroutineTCPServer, FramesArriveWhole) {
+  CoroutineTCPServer server;
+  boost::asio::io_service service;
+  tcp::socket client(service);
+  ConnectClient(server, service, client, PORT);
+
+  // Send the frames in uneven pieces, several frames per piece or several
+  // pieces per frame.
+  std::string stream;
+  for (auto i = 0u; i < 200u; ++i) {
+    stream += MakeFrame(std::string(i * 37u, static_cast<char>('a' + i % 26u)));
+  }
+  auto sent = std::async(std::launch::async, [&]() {
+    size_t begin = 0u;
+    for (size_t piece = 1u; begin < stream.size(); piece = (piece * 7u) % 9973u) {
+      const auto size = std::min(piece, stream.size() - begin);
+      boost::asio::write(client, boost::asio::buffer(stream.data() + begin, size));
+      begin += size;
+    }
+  });
+  for (auto i = 0u; i < 200u; ++i) {
+    std::string frame;
+    ASSERT_FALSE(server.ReadFrame(frame, TIMEOUT));
+    ASSERT_EQ(frame, std::string(i * 37u, static_cast<char>('a' + i % 26u)));
+  }
+  sent.get();
+}
+
+TEST(CoroutineTCPServer, ReadTimeOutKeepsConnection) {
+  CoroutineTCPServer server;
+  boost::asio::io_service service;
+  tcp::socket client(service);
+  ConnectClient(server, service, client, PORT + 1u);
+
+  std::string frame;
+  ASSERT_EQ(server.ReadFrame(frame, milliseconds(50)), errc::timed_out());
+
+  const std::string message = MakeFrame("Hello server!");
+  boost::asio::write(client, boost::asio::buffer(message));
+  ASSERT_FALSE(server.ReadFrame(frame, TIMEOUT));
+  ASSERT_EQ(frame, "Hello server!");
+
+  const std::string answer = MakeFrame("Hello client!");
+  ASSERT_FALSE(server.Write(boost::asio::buffer(answer), TIMEOUT));
+  std::string received(answer.size(), '\0');
+  boost::asio::read(client, boost::asio::buffer(&received[0u], received.size()));
+  ASSERT_EQ(received, answer);
+}
+
+TEST(CoroutineTCPServer, AsyncDisconnect) {
+  CoroutineTCPServer server;
+  boost::asio::io_service service;
+  tcp::socket client(service);
+  ConnectClient(server, service, client, PORT + 2u);
+
+  auto result = std::async(std::launch::async, [&]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    server.Disconnect();
+  });
+  std::string frame;
+  ASSERT_TRUE(server.ReadFrame(frame, TIMEOUT)) << "we received something, and we shouldn't";
+  result.get();
+  ASSERT_TRUE(server.Write(boost::asio::buffer(frame), TIMEOUT));
+}
+
+TEST(CoroutineTCPServer, InvalidFrameClosesConnection) {
+  CoroutineTCPServer server;
+  boost::asio::io_service service;
+  tcp::socket client(service);
+  ConnectClient(server, service, client, PORT + 3u);
+
+  const uint32_t size = CoroutineTCPServer::MAX_FRAME_SIZE + 1u;
+  boost::asio::write(client, boost::asio::buffer(&size, sizeof(size)));
+  std::string frame;
+  ASSERT_TRUE(server.ReadFrame(frame, TIMEOUT));
+}
+
+TEST(CoroutineTCPServer, ConnectionTimedOut) {
+  CoroutineTCPServer server;
+  ASSERT_EQ(server.Connect(PORT + 4u, milliseconds(100)), errc::timed_out());
+  std::string frame;
+  ASSERT_TRUE(server.ReadFrame(frame, TIMEOUT));
+}
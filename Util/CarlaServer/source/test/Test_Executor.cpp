@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+
+#include <carla/server/AsyncService.h>
+#include <carla/server/Executor.h>
+#include <carla/server/LockFreeQueue.h>
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <vector>
+
+TEST(Executor, LockFreeQueueMultipleProducersAndConsumers) {
+  using namespace carla::server;
+
+  LockFreeQueue<std::unique_ptr<size_t>> queue(64u);
+  constexpr size_t numberOfProducers = 4u;
+  constexpr size_t numberOfValues = 20000u;
+  std::atomic<size_t> sum{0u};
+  std::atomic<size_t> count{0u};
+
+  std::vector<std::future<void>> threads;
+  for (size_t p = 0u; p < numberOfProducers; ++p) {
+    threads.emplace_back(std::async(std::launch::async, [&, p]() {
+      for (size_t i = 0u; i < numberOfValues; ++i) {
+        auto value = std::make_unique<size_t>(p * numberOfValues + i);
+        while (!queue.TryPush(std::move(value))) {
+          std::this_thread::yield();
+        }
+      }
+    }));
+    threads.emplace_back(std::async(std::launch::async, [&]() {
+      std::unique_ptr<size_t> value;
+      while (count < numberOfProducers * numberOfValues) {
+        if (queue.TryPop(value)) {
+          ASSERT_TRUE(value != nullptr);
+          sum += *value;
+          ++count;
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    }));
+  }
+  for (auto &thread : threads) {
+    thread.get();
+  }
+  const size_t total = numberOfProducers * numberOfValues;
+  ASSERT_EQ(count, total);
+  ASSERT_EQ(sum, total * (total - 1u) / 2u);
+}
+
+TEST(Executor, MoveOnlyJobs) {
+  using namespace carla::server;
+
+  auto value = std::make_unique<int>(42);
+  std::promise<int> promise;
+  auto future = promise.get_future();
+  Executor::GetInstance().Reserve(1u);
+  Executor::GetInstance().Post([value{std::move(value)}, &promise]() {
+    promise.set_value(*value);
+  });
+  ASSERT_EQ(future.get(), 42);
+  Executor::GetInstance().Release(1u);
+}
+
+TEST(Executor, StopAtExitLetsTheThreadsFinishTheQueue) {
+  using namespace carla::server;
+
+  std::atomic<int> count{0};
+  {
+    Executor executor;
+    executor.Reserve(2u);
+    for (auto i = 0; i < 100; ++i) {
+      executor.Post([&count]() { ++count; });
+    }
+    executor.StopAtExit();
+    executor.Release(2u);
+    // The destructor joins threads that are finishing on their own.
+  }
+  ASSERT_EQ(count, 100);
+}
+
+TEST(Executor, AsyncServiceKeepsOrder) {
+  using namespace carla::server;
+
+  AsyncService service;
+  std::vector<size_t> order;
+  std::vector<std::future<size_t>> results;
+  for (size_t i = 0u; i < 1000u; ++i) {
+    results.emplace_back(service.Post([&order, i]() {
+      order.push_back(i);
+      return i;
+    }));
+  }
+  for (size_t i = 0u; i < results.size(); ++i) {
+    ASSERT_EQ(results[i].get(), i);
+  }
+  ASSERT_EQ(order.size(), results.size());
+  for (size_t i = 0u; i < order.size(); ++i) {
+    ASSERT_EQ(order[i], i);
+  }
+}
+
+TEST(Executor, ThreadsAreReusedBetweenServices) {
+  using namespace carla::server;
+
+  auto &executor = Executor::GetInstance();
+  // Services blocking at the same time get a thread each.
+  auto run_blocking_services = [](size_t count) {
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::atomic<size_t> started{0u};
+    std::vector<std::unique_ptr<AsyncService>> services;
+    std::vector<std::future<void>> results;
+    for (size_t i = 0u; i < count; ++i) {
+      services.emplace_back(std::make_unique<AsyncService>());
+      results.emplace_back(services.back()->Post([&started, released]() {
+        ++started;
+        released.wait();
+      }));
+    }
+    while (started < count) {
+      std::this_thread::yield();
+    }
+    release.set_value();
+    for (auto &result : results) {
+      result.get();
+    }
+  };
+
+  run_blocking_services(6u);
+  const size_t number_of_threads = executor.GetNumberOfThreads();
+  ASSERT_GE(number_of_threads, 6u);
+  for (auto i = 0u; i < 10u; ++i) {
+    run_blocking_services(6u);
+  }
+  ASSERT_EQ(executor.GetNumberOfThreads(), number_of_threads);
+}
+
+TEST(Executor, DestroyingServiceDiscardsPendingTasks) {
+  using namespace carla::server;
+
+  std::future<void> pending;
+  {
+    std::promise<void> started;
+    AsyncService service;
+    service.Post([&]() {
+      started.set_value();
+      while (!service.done()) {
+        std::this_thread::yield();
+      }
+    });
+    pending = service.Post([]() {});
+    started.get_future().wait();
+  }
+  ASSERT_THROW(pending.get(), std::future_error);
+}
@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+
+#include <carla/server/FrameReader.h>
+#include <carla/server/Protobuf.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+using namespace carla::server;
+
+static std::string ToString(const carla::const_array_view<char> &view) {
+  return std::string(view.begin(), view.end());
+}
+
+/// Copy @a size bytes of @a stream from @a begin into the reader, in as many
+/// pieces as it takes.
+static bool Receive(FrameReader &reader, const std::string &stream, size_t begin, size_t size) {
+  while (size > 0u) {
+    auto buffer = reader.Prepare();
+    const auto bytes = std::min(size, boost::asio::buffer_size(buffer));
+    std::memcpy(boost::asio::buffer_cast<char *>(buffer), stream.data() + begin, bytes);
+    if (!reader.Commit(bytes)) {
+      return false;
+    }
+    begin += bytes;
+    size -= bytes;
+  }
+  return true;
+}
+
+TEST(FrameReader, FramesSplitInPieces) {
+  FrameReader reader(16u);
+  std::string stream;
+  for (auto i = 0u; i < 200u; ++i) {
+    stream += Protobuf::Encode(std::string(i * 101u, static_cast<char>('a' + i % 26u)));
+  }
+  size_t begin = 0u;
+  auto i = 0u;
+  for (size_t piece = 1u; begin < stream.size(); piece = (piece * 7u) % 19997u) {
+    const auto size = std::min(piece, stream.size() - begin);
+    ASSERT_TRUE(Receive(reader, stream, begin, size));
+    begin += size;
+    for (; reader.GetNumberOfFrames() > 0u; ++i) {
+      ASSERT_EQ(ToString(reader.Pop()), std::string(i * 101u, static_cast<char>('a' + i % 26u)));
+    }
+  }
+  ASSERT_EQ(i, 200u);
+}
+
+TEST(FrameReader, EmptyFrames) {
+  FrameReader reader;
+  const auto stream = Protobuf::Encode("") + Protobuf::Encode("") + Protobuf::Encode("x");
+  ASSERT_TRUE(Receive(reader, stream, 0u, stream.size()));
+  ASSERT_EQ(reader.GetNumberOfFrames(), 3u);
+  ASSERT_TRUE(reader.Pop().empty());
+  ASSERT_TRUE(reader.Pop().empty());
+  ASSERT_EQ(ToString(reader.Pop()), "x");
+}
+
+TEST(FrameReader, InvalidSize) {
+  FrameReader reader;
+  const uint32_t size = FrameReader::MAX_FRAME_SIZE + 1u;
+  const std::string stream(reinterpret_cast<const char *>(&size), sizeof(size));
+  ASSERT_FALSE(Receive(reader, stream, 0u, stream.size()));
+}
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#include <carla/LatencyHistogram.h>
+#include <carla/server/CarlaEncoder.h>
+#include <carla/server/FrameTracer.h>
+#include <carla/server/carla_server.pb.h>
+
+using namespace carla::server;
+using carla::LatencyHistogram;
+
+TEST(LatencyHistogram, Percentiles) {
+  LatencyHistogram histogram;
+  ASSERT_EQ(histogram.Percentile(50.0), 0u);
+  for (uint64_t i = 1u; i <= 1000u; ++i) {
+    histogram.Add(i * 1000u);
+  }
+  ASSERT_EQ(histogram.count(), 1000u);
+  ASSERT_EQ(histogram.min(), 1000u);
+  ASSERT_EQ(histogram.max(), 1000000u);
+  ASSERT_DOUBLE_EQ(histogram.mean(), 500500.0);
+  // Within one sub-bucket of the actual value.
+  const auto expect_near = [&](double percentile, uint64_t expected) {
+    const auto value = histogram.Percentile(percentile);
+    ASSERT_GE(value, expected);
+    ASSERT_LE(value, expected + expected / LatencyHistogram::SUB_BUCKETS);
+  };
+  expect_near(50.0, 500000u);
+  expect_near(90.0, 900000u);
+  expect_near(99.0, 990000u);
+  ASSERT_EQ(histogram.Percentile(100.0), 1000000u);
+}
+
+TEST(LatencyHistogram, SmallAndHugeValues) {
+  LatencyHistogram histogram;
+  for (uint64_t i = 0u; i < 16u; ++i) {
+    histogram.Add(i);
+  }
+  // Small values are exact.
+  ASSERT_EQ(histogram.Percentile(50.0), 7u);
+  histogram.Add(std::numeric_limits<uint64_t>::max());
+  ASSERT_EQ(histogram.Percentile(100.0), std::numeric_limits<uint64_t>::max());
+}
+
+TEST(FrameTracer, LatenciesAndDroppedFrames) {
+  FrameTracer tracer;
+  const uint64_t ms = 1000000u;
+  for (uint64_t frame = 1u; frame <= 21u; ++frame) {
+    if (frame % 5u == 0u) {
+      continue; // Dropped.
+    }
+    FrameTimestamps timestamps;
+    timestamps.tick = frame * 100u * ms;
+    timestamps.readback = timestamps.tick + 2u * ms;
+    timestamps.queued = timestamps.readback + 1u * ms;
+    timestamps.encoding = timestamps.queued + 1u * ms;
+    timestamps.encoded = timestamps.encoding + 3u * ms;
+    timestamps.written = timestamps.encoded + 1u * ms;
+    tracer.RecordFrame(frame, timestamps);
+    tracer.RecordControl(frame, timestamps.written + 10u * ms);
+  }
+  // Untagged, or replying to a frame never written.
+  tracer.RecordControl(0u, 1u);
+  tracer.RecordControl(5u, 1u);
+  ASSERT_EQ(tracer.GetNumberOfFramesWritten(), 17u);
+  ASSERT_EQ(tracer.GetNumberOfDroppedFrames(), 4u);
+  const auto total = tracer.GetLatency(FrameTracer::Latency::Total);
+  ASSERT_EQ(total.count(), 17u);
+  ASSERT_EQ(total.max(), 8u * ms);
+  ASSERT_EQ(tracer.GetLatency(FrameTracer::Latency::Encoding).max(), 3u * ms);
+  const auto round_trip = tracer.GetLatency(FrameTracer::Latency::RoundTrip);
+  ASSERT_EQ(round_trip.count(), 17u);
+  ASSERT_EQ(round_trip.min(), 10u * ms);
+  tracer.LogSummary();
+}
+
+TEST(FrameTracer, StagesNotStampedAreSkipped) {
+  FrameTracer tracer;
+  FrameTimestamps timestamps;
+  timestamps.queued = FrameTracer::Now();
+  timestamps.encoding = timestamps.queued + 10u;
+  timestamps.encoded = timestamps.encoding + 10u;
+  timestamps.written = timestamps.encoded + 10u;
+  tracer.RecordFrame(1u, timestamps);
+  ASSERT_EQ(tracer.GetLatency(FrameTracer::Latency::TickToReadback).count(), 0u);
+  ASSERT_EQ(tracer.GetLatency(FrameTracer::Latency::Total).count(), 0u);
+  ASSERT_EQ(tracer.GetLatency(FrameTracer::Latency::EncodedToWritten).count(), 1u);
+}
+
+TEST(FrameTracer, TimestampsAreEncoded) {
+  carla_measurements values = {};
+  values.tick_timestamp = 1u;
+  values.readback_timestamp = 2u;
+  FrameTimestamps timestamps;
+  timestamps.tick = values.tick_timestamp;
+  timestamps.readback = values.readback_timestamp;
+  timestamps.queued = 3u;
+  timestamps.encoding = 4u;
+  carla_server::Measurements message;
+  CarlaEncoder::SetMeasurements(message, values, 42u, timestamps);
+  ASSERT_EQ(message.frame_number(), 42u);
+  ASSERT_EQ(message.frame_timestamps().tick(), 1u);
+  ASSERT_EQ(message.frame_timestamps().readback(), 2u);
+  ASSERT_EQ(message.frame_timestamps().queued(), 3u);
+  ASSERT_EQ(message.frame_timestamps().encoding(), 4u);
+}
@@ -0,0 +1,202 @@
+#include <gtest/gtest.h>
+
+#include <carla/server/ImageCompressor.h>
+#include <carla/server/ImagesMessage.h>
+#include <carla/server/SensorMessage.h>
+
+#include "MessageUtil.h"
+
+#include <zlib.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+static uint32_t MakeBGRA(uint32_t r, uint32_t g, uint32_t b, uint32_t a) {
+  return b | (g << 8u) | (r << 16u) | (a << 24u);
+}
+
+/// Reverse the filters of ImageCompressor, returns the pixels as BGRA.
+static std::vector<uint32_t> Decompress(
+    uint32_t codec,
+    uint32_t width,
+    uint32_t height,
+    const char *data,
+    size_t size) {
+  using namespace carla::server;
+  const size_t number_of_pixels = width * height;
+  std::vector<unsigned char> planes(4u * number_of_pixels);
+  uLongf planes_size = planes.size();
+  EXPECT_EQ(Z_OK, uncompress(
+      planes.data(),
+      &planes_size,
+      reinterpret_cast<const Bytef *>(data),
+      size));
+  EXPECT_EQ(planes_size, planes.size());
+  std::vector<uint32_t> result(number_of_pixels);
+  for (auto y = 0u; y < height; ++y) {
+    uint32_t left = 0u;
+    unsigned char left_bytes[4u] = {0u};
+    for (auto x = 0u; x < width; ++x) {
+      const size_t i = y * width + x;
+      uint32_t residual = 0u;
+      for (auto byte = 0u; byte < 4u; ++byte) {
+        residual |= static_cast<uint32_t>(planes[byte * number_of_pixels + i]) << (8u * byte);
+      }
+      if (codec == static_cast<uint32_t>(ImageCodec::DeflateDepth)) {
+        left += residual;
+        result[i] = MakeBGRA(left & 0xFFu, (left >> 8u) & 0xFFu, (left >> 16u) & 0xFFu, left >> 24u);
+      } else {
+        EXPECT_EQ(codec, static_cast<uint32_t>(ImageCodec::DeflateSub));
+        uint32_t value = 0u;
+        for (auto byte = 0u; byte < 4u; ++byte) {
+          left_bytes[byte] = static_cast<unsigned char>(left_bytes[byte] + (residual >> (8u * byte)));
+          value |= static_cast<uint32_t>(left_bytes[byte]) << (8u * byte);
+        }
+        result[i] = value;
+      }
+    }
+  }
+  return result;
+}
+
+static std::vector<uint32_t> MakeDepthImage(uint32_t width, uint32_t height) {
+  std::vector<uint32_t> data(width * height);
+  for (auto y = 0u; y < height; ++y) {
+    for (auto x = 0u; x < width; ++x) {
+      // Depth is packed as R + G * 256 + B * 256 * 256.
+      const uint32_t depth = 1000u + 37u * y + 3u * x;
+      data[y * width + x] = MakeBGRA(depth & 0xFFu, (depth >> 8u) & 0xFFu, depth >> 16u, 255u);
+    }
+  }
+  return data;
+}
+
+static std::vector<uint32_t> MakeSegmentationImage(uint32_t width, uint32_t height) {
+  std::vector<uint32_t> data(width * height);
+  for (auto y = 0u; y < height; ++y) {
+    for (auto x = 0u; x < width; ++x) {
+      const uint32_t label = (x < width / 3u ? 7u : (y < height / 2u ? 1u : 10u));
+      data[y * width + x] = MakeBGRA(label, 0u, 0u, 255u);
+    }
+  }
+  return data;
+}
+
+static std::vector<uint32_t> MakeNoiseImage(uint32_t width, uint32_t height) {
+  std::vector<uint32_t> data(width * height);
+  uint32_t state = 12345u;
+  for (auto &pixel : data) {
+    // xorshift32.
+    state ^= state << 13u;
+    state ^= state >> 17u;
+    state ^= state << 5u;
+    pixel = state;
+  }
+  return data;
+}
+
+TEST(ImageCompressor, ImagesAreLossless) {
+  using namespace carla::server;
+
+  constexpr uint32_t width = 64u;
+  constexpr uint32_t height = 48u;
+  const auto depth = MakeDepthImage(width, height);
+  const auto segmentation = MakeSegmentationImage(width, height);
+  const auto noise = MakeNoiseImage(width, height);
+  const carla_image images[] = {
+    {width, height, 2u, depth.data(), CARLA_SERVER_IMAGE_COMPRESSION_DEFLATE},
+    {width, height, 3u, segmentation.data(), CARLA_SERVER_IMAGE_COMPRESSION_DEFLATE},
+    {width, height, 1u, noise.data(), CARLA_SERVER_IMAGE_COMPRESSION_DEFLATE},
+    {width, height, 1u, noise.data(), CARLA_SERVER_IMAGE_COMPRESSION_NONE}
+  };
+  const std::vector<uint32_t> *expected[] = {&depth, &segmentation, &noise, &noise};
+
+  ImagesMessage message;
+  message.Write(carla::const_array_view<carla_image>(images, 4u));
+  ASSERT_TRUE(message.compressed());
+
+  ImageCompressor compressor;
+  std::vector<const_buffer> sequence;
+  // Twice, buffers are reused between calls.
+  for (auto n = 0u; n < 2u; ++n) {
+    sequence.clear();
+    compressor.Encode(message, sequence);
+    const auto encoded = Flatten(sequence);
+    ASSERT_EQ(ReadValue<uint32_t>(encoded, 0u), encoded.size() - sizeof(uint32_t));
+    ASSERT_LT(encoded.size(), Flatten(message.buffers()).size());
+
+    size_t offset = sizeof(uint32_t);
+    for (auto i = 0u; i < 4u; ++i) {
+      ASSERT_EQ(ReadValue<uint32_t>(encoded, offset), width);
+      ASSERT_EQ(ReadValue<uint32_t>(encoded, offset + 4u), height);
+      const auto type_and_codec = ReadValue<uint32_t>(encoded, offset + 8u);
+      ASSERT_EQ(type_and_codec & 0xFFFFu, images[i].type);
+      const auto codec = type_and_codec >> 16u;
+      const size_t image_size = sizeof(uint32_t) * width * height;
+      if (i < 2u) {
+        // Ground-truth images compress well.
+        ASSERT_NE(codec, 0u);
+        const size_t size = ReadValue<uint32_t>(encoded, offset + 12u);
+        ASSERT_LT(size, image_size / 10u);
+        const auto pixels = Decompress(codec, width, height, encoded.data() + offset + 16u, size);
+        ASSERT_EQ(pixels, *expected[i]);
+        offset += 16u + size + (4u - size % 4u) % 4u;
+      } else {
+        // Noise does not compress, sent raw; as does an image not requesting it.
+        ASSERT_EQ(codec, 0u);
+        ASSERT_EQ(0, std::memcmp(encoded.data() + offset + 12u, expected[i]->data(), image_size));
+        offset += 12u + image_size;
+      }
+    }
+    ASSERT_EQ(offset, encoded.size());
+  }
+}
+
+TEST(ImageCompressor, UncompressedMessagesAreUnchanged) {
+  using namespace carla::server;
+
+  const auto noise = MakeNoiseImage(8u, 8u);
+  const carla_image image = {8u, 8u, 1u, noise.data(), CARLA_SERVER_IMAGE_COMPRESSION_NONE};
+
+  ImagesMessage images;
+  images.Write(carla::const_array_view<carla_image>(&image, 1u));
+  SensorMessage sensor;
+  sensor.Write(7u, image);
+
+  ImageCompressor compressor;
+  std::vector<const_buffer> sequence;
+  compressor.Encode(images, sequence);
+  ASSERT_EQ(Flatten(sequence), Flatten(images.buffers()));
+  sequence.clear();
+  compressor.Encode(sensor, sequence);
+  ASSERT_EQ(Flatten(sequence), Flatten(sensor.buffers()));
+}
+
+TEST(ImageCompressor, SensorMessageIsLossless) {
+  using namespace carla::server;
+
+  constexpr uint32_t width = 30u;
+  constexpr uint32_t height = 20u;
+  const auto depth = MakeDepthImage(width, height);
+  const carla_image image = {width, height, 2u, depth.data(), CARLA_SERVER_IMAGE_COMPRESSION_DEFLATE};
+
+  SensorMessage message;
+  message.Write(42u, image);
+  ASSERT_TRUE(message.compressed());
+
+  ImageCompressor compressor;
+  std::vector<const_buffer> sequence;
+  compressor.Encode(message, sequence);
+  const auto encoded = Flatten(sequence);
+  ASSERT_EQ(ReadValue<uint32_t>(encoded, 0u), encoded.size() - sizeof(uint32_t));
+  ASSERT_EQ(ReadValue<uint64_t>(encoded, 4u), 42u);
+  ASSERT_EQ(ReadValue<uint32_t>(encoded, 12u), width);
+  ASSERT_EQ(ReadValue<uint32_t>(encoded, 16u), height);
+  const auto type_and_codec = ReadValue<uint32_t>(encoded, 20u);
+  ASSERT_EQ(type_and_codec & 0xFFFFu, 2u);
+  ASSERT_EQ(type_and_codec >> 16u, static_cast<uint32_t>(ImageCodec::DeflateDepth));
+  const size_t size = ReadValue<uint32_t>(encoded, 24u);
+  ASSERT_EQ(encoded.size(), 28u + size + (4u - size % 4u) % 4u);
+  ASSERT_EQ(Decompress(type_and_codec >> 16u, width, height, encoded.data() + 28u, size), depth);
+}
@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+
+#include <carla/server/ImagesMessage.h>
+
+#include "MessageUtil.h"
+
+#include <cstring>
+#include <numeric>
+#include <string>
+#include <vector>
+
+TEST(ImagesMessage, LeasedImagesMatchCopiedImages) {
+  using namespace carla::server;
+
+  std::vector<uint32_t> data0(4u * 3u);
+  std::vector<uint32_t> data1(2u * 5u);
+  std::iota(data0.begin(), data0.end(), 0u);
+  std::iota(data1.begin(), data1.end(), 100u);
+
+  const carla_image images[] = {
+    {4u, 3u, 1u, data0.data(), CARLA_SERVER_IMAGE_COMPRESSION_NONE},
+    {2u, 5u, 2u, data1.data(), CARLA_SERVER_IMAGE_COMPRESSION_NONE}
+  };
+
+  ImagesMessage copied;
+  copied.Write(carla::const_array_view<carla_image>(images, 2u));
+  ASSERT_EQ(copied.buffers().size(), 1u);
+
+  int released = 0;
+  const carla_image_lease leases[] = {
+    {images[0u], CountRelease, &released},
+    {images[1u], CountRelease, &released}
+  };
+
+  {
+    ImagesMessage leased;
+    leased.Write(carla::const_array_view<carla_image_lease>(leases, 2u));
+    ASSERT_EQ(leased.buffers().size(), 4u);
+    ASSERT_EQ(Flatten(copied.buffers()), Flatten(leased.buffers()));
+    ASSERT_EQ(released, 0);
+
+    leased.ReleaseLeases();
+    ASSERT_EQ(released, 2);
+    ASSERT_TRUE(leased.buffers().empty());
+
+    // Leases are released on destruction too.
+    leased.Write(carla::const_array_view<carla_image_lease>(leases, 2u));
+  }
+  ASSERT_EQ(released, 4);
+}
+
+TEST(ImagesMessage, NoImages) {
+  using namespace carla::server;
+
+  ImagesMessage copied;
+  copied.Write(carla::const_array_view<carla_image>(nullptr, 0u));
+  ImagesMessage leased;
+  leased.Write(carla::const_array_view<carla_image_lease>(nullptr, 0u));
+
+  const auto expected = std::string(sizeof(uint32_t), '\0');
+  ASSERT_EQ(Flatten(copied.buffers()), expected);
+  ASSERT_EQ(Flatten(leased.buffers()), expected);
+}
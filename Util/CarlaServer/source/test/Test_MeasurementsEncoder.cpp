@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+
+#include <carla/server/CarlaEncoder.h>
+#include <carla/server/MeasurementsEncoder.h>
+#include <carla/server/carla_server.pb.h>
+
+#include "MessageUtil.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+/// Parse and re-serialize the message so field order does not matter.
+static std::string Canonicalize(const std::string &encoded) {
+  uint32_t size;
+  std::memcpy(&size, encoded.data(), sizeof(size));
+  EXPECT_EQ(size, encoded.size() - sizeof(size));
+  carla_server::Measurements message;
+  EXPECT_TRUE(message.ParseFromArray(encoded.data() + sizeof(size), size));
+  return message.SerializeAsString();
+}
+
+static std::vector<carla_agent> MakeAgents(uint32_t count) {
+  std::vector<carla_agent> agents(count);
+  for (auto i = 0u; i < count; ++i) {
+    auto &agent = agents[i];
+    agent.id = i + 1u;
+    agent.type = (i % 2u == 0u ? CARLA_SERVER_AGENT_VEHICLE : CARLA_SERVER_AGENT_PEDESTRIAN);
+    agent.transform.location = {1.0f * i, 2.0f * i, 0.5f};
+    agent.transform.orientation = {1.0f, 0.0f, 0.0f};
+    agent.box_extent = {2.0f, 1.0f, 1.5f};
+    agent.forward_speed = 0.1f * i;
+  }
+  return agents;
+}
+
+TEST(MeasurementsEncoder, MatchesCarlaEncoder) {
+  using namespace carla::server;
+
+  CarlaEncoder encoder;
+  for (auto number_of_workers : {0u, 1u, 3u}) {
+    MeasurementsEncoder measurements_encoder(number_of_workers);
+    for (auto number_of_agents : {0u, 1u, 200u, 1001u}) {
+      const auto agents = MakeAgents(number_of_agents);
+      carla_measurements values = {};
+      values.platform_timestamp = 12345u;
+      values.game_timestamp = 678u;
+      values.player_measurements.forward_speed = 3.0f;
+      values.player_measurements.collision_other = 1.0f;
+      values.non_player_agents = agents.data();
+      values.number_of_non_player_agents = number_of_agents;
+
+      std::vector<const_buffer> sequence;
+      // Twice, messages and buffers are reused between calls.
+      for (auto n = 0u; n < 2u; ++n) {
+        sequence.clear();
+        measurements_encoder.Encode(values, 42u + n, FrameTimestamps(), sequence);
+        ASSERT_EQ(
+            Canonicalize(Flatten(sequence)),
+            Canonicalize(encoder.Encode(values, 42u + n)));
+      }
+    }
+  }
+}
+
+TEST(MeasurementsEncoder, CompactAgents) {
+  using namespace carla::server;
+
+  const auto agents = MakeAgents(500u);
+  carla_measurements values = {};
+  values.game_timestamp = 678u;
+  values.non_player_agents = agents.data();
+  values.number_of_non_player_agents = agents.size();
+
+  MeasurementsEncoder measurements_encoder(3u);
+  AgentSnapshotEncoder snapshot_encoder;
+  for (auto n = 0u; n < 2u; ++n) {
+    std::vector<const_buffer> sequence;
+    measurements_encoder.Encode(values, 42u, FrameTimestamps(), sequence, AgentsEncoding::CompactQuantized);
+    const auto encoded = Flatten(sequence);
+    carla_server::Measurements message;
+    ASSERT_TRUE(message.ParseFromArray(encoded.data() + sizeof(uint32_t), encoded.size() - sizeof(uint32_t)));
+    ASSERT_EQ(message.frame_number(), 42u);
+    ASSERT_EQ(message.game_timestamp(), 678u);
+    ASSERT_EQ(message.non_player_agents_size(), 0);
+    const auto snapshot = snapshot_encoder.Encode(
+        carla::const_array_view<carla_agent>(agents.data(), agents.size()),
+        true);
+    ASSERT_EQ(
+        message.non_player_agents_snapshot(),
+        std::string(boost::asio::buffer_cast<const char *>(snapshot), boost::asio::buffer_size(snapshot)));
+  }
+}
@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+
+#include <carla/Profiler.h>
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using carla::Profiler;
+
+static size_t Count(const std::string &string, const std::string &substring) {
+  size_t count = 0u;
+  for (auto i = string.find(substring); i != std::string::npos; i = string.find(substring, i + 1u)) {
+    ++count;
+  }
+  return count;
+}
+
+static void ProfiledFunction() {
+  CARLA_PROFILE_SCOPE(Test_Profiler, ProfiledFunction);
+  std::this_thread::sleep_for(std::chrono::microseconds(100));
+}
+
+/// The profiler is process-wide, disable it and forget what the previous tests
+/// recorded.
+static Profiler &ResetProfiler() {
+  auto &profiler = Profiler::GetInstance();
+  profiler.Enable(false, false);
+  profiler.GetData("Test_Profiler.ProfiledFunction").Clear();
+  return profiler;
+}
+
+TEST(Profiler, DisabledRecordsNothing) {
+  auto &profiler = ResetProfiler();
+  ASSERT_FALSE(profiler.IsEnabled());
+  ProfiledFunction();
+  ASSERT_EQ(profiler.GetData("Test_Profiler.ProfiledFunction").GetHistogram().count(), 0u);
+}
+
+TEST(Profiler, ScopesAreAggregatedAcrossThreads) {
+  constexpr auto number_of_threads = 4u;
+  constexpr auto number_of_calls = 50u;
+  auto &profiler = ResetProfiler();
+  const auto start = Profiler::Now();
+  profiler.Enable(true, true);
+  std::vector<std::thread> threads;
+  for (auto i = 0u; i < number_of_threads; ++i) {
+    threads.emplace_back([]() {
+      for (auto j = 0u; j < number_of_calls; ++j) {
+        ProfiledFunction();
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  profiler.Enable(false, false);
+
+  const auto histogram = profiler.GetData("Test_Profiler.ProfiledFunction").GetHistogram();
+  ASSERT_EQ(histogram.count(), number_of_threads * number_of_calls);
+  ASSERT_GE(histogram.min(), 100000u);
+  ASSERT_GE(histogram.Percentile(99.9), histogram.Percentile(50.0));
+
+  std::ostringstream trace;
+  // Only the scopes of this test, not those still in the rings from previous
+  // runs.
+  profiler.WriteTrace(trace, Profiler::Now() - start);
+  const auto json = trace.str();
+  ASSERT_EQ(json.front(), '{');
+  ASSERT_EQ(Count(json, "\"name\":\"Test_Profiler.ProfiledFunction\""), number_of_threads * number_of_calls);
+  ASSERT_GE(Count(json, "\"name\":\"thread_name\""), number_of_threads);
+
+  profiler.PrintSummary();
+  ASSERT_EQ(profiler.GetData("Test_Profiler.ProfiledFunction").GetHistogram().count(), 0u);
+}
@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+
+#include <carla/server/RingBuffer.h>
+
+#include <atomic>
+#include <future>
+#include <string>
+
+TEST(RingBuffer, DropOldest) {
+  using namespace carla::server;
+
+  RingBuffer<size_t> buffer(3u, BackPressurePolicy::DropOldest);
+  for (size_t i = 0u; i < 10u; ++i) {
+    auto writer = buffer.MakeWriter();
+    ASSERT_TRUE(writer != nullptr);
+    *writer = i;
+  }
+  ASSERT_EQ(buffer.number_of_dropped_values(), 7u);
+  ASSERT_EQ(buffer.number_of_blocked_writes(), 0u);
+
+  const timeout_t timeout = timeout_t::milliseconds(1u);
+  for (size_t i = 7u; i < 10u; ++i) {
+    auto reader = buffer.TryMakeReader(timeout);
+    ASSERT_TRUE(reader != nullptr);
+    ASSERT_EQ(*reader, i);
+  }
+  ASSERT_TRUE(buffer.TryMakeReader(timeout) == nullptr);
+}
+
+TEST(RingBuffer, DropOldestWhileReading) {
+  using namespace carla::server;
+
+  RingBuffer<size_t> buffer(1u, BackPressurePolicy::DropOldest);
+  *buffer.MakeWriter() = 1u;
+  const timeout_t timeout = timeout_t::milliseconds(1u);
+  {
+    auto reader = buffer.TryMakeReader(timeout);
+    ASSERT_TRUE(reader != nullptr);
+    // The slot being read must not be overwritten.
+    for (size_t i = 2u; i < 10u; ++i) {
+      *buffer.MakeWriter() = i;
+      ASSERT_EQ(*reader, 1u);
+    }
+  }
+  auto reader = buffer.TryMakeReader(timeout);
+  ASSERT_TRUE(reader != nullptr);
+  ASSERT_EQ(*reader, 9u);
+}
+
+TEST(RingBuffer, DropOldestWithAConcurrentConsumer) {
+  using namespace carla::server;
+
+  RingBuffer<size_t> buffer(2u, BackPressurePolicy::DropOldest);
+
+  constexpr size_t numberOfWrites = 100000u;
+
+  std::atomic_bool done{false};
+  auto result_writer = std::async(std::launch::async, [&](){
+    for (size_t i = 1u; i <= numberOfWrites; ++i) {
+      *buffer.MakeWriter() = i;
+    }
+    done = true;
+  });
+
+  // Values are read in order, and every value not read was counted as
+  // dropped, not more.
+  size_t numberOfReads = 0u;
+  size_t last = 0u;
+  const timeout_t timeout = timeout_t::milliseconds(1u);
+  for (;;) {
+    const bool was_done = done;
+    auto reader = buffer.TryMakeReader(timeout);
+    if (reader == nullptr) {
+      if (was_done) {
+        break;
+      }
+      continue;
+    }
+    ASSERT_GT(*reader, last);
+    last = *reader;
+    ++numberOfReads;
+  }
+
+  result_writer.get();
+  ASSERT_EQ(last, numberOfWrites);
+  ASSERT_EQ(numberOfReads + buffer.number_of_dropped_values(), numberOfWrites);
+}
+
+TEST(RingBuffer, BlockIsLossless) {
+  using namespace carla::server;
+
+  RingBuffer<std::string> buffer(
+      4u,
+      BackPressurePolicy::Block,
+      timeout_t::milliseconds(10000u));
+
+  constexpr size_t numberOfWrites = 1000u;
+
+  auto result_writer = std::async(std::launch::async, [&](){
+    for (size_t i = 0u; i < numberOfWrites; ++i) {
+      auto writer = buffer.MakeWriter();
+      ASSERT_TRUE(writer != nullptr);
+      *writer = std::to_string(i);
+    }
+  });
+
+  const timeout_t timeout = timeout_t::milliseconds(1000u);
+
+  auto result_reader = std::async(std::launch::async, [&](){
+    for (size_t i = 0u; i < numberOfWrites; ++i) {
+      auto reader = buffer.TryMakeReader(timeout);
+      ASSERT_TRUE(reader != nullptr);
+      ASSERT_EQ(*reader, std::to_string(i));
+    }
+  });
+
+  result_writer.get();
+  result_reader.get();
+  ASSERT_EQ(buffer.number_of_dropped_values(), 0u);
+}
+
+TEST(RingBuffer, BlockTimesOut) {
+  using namespace carla::server;
+
+  RingBuffer<size_t> buffer(
+      1u,
+      BackPressurePolicy::Block,
+      timeout_t::milliseconds(1u));
+  *buffer.MakeWriter() = 1u;
+  *buffer.MakeWriter() = 2u;
+  ASSERT_EQ(buffer.number_of_blocked_writes(), 1u);
+  ASSERT_EQ(buffer.number_of_dropped_values(), 1u);
+  auto reader = buffer.TryMakeReader(timeout_t::milliseconds(1u));
+  ASSERT_TRUE(reader != nullptr);
+  ASSERT_EQ(*reader, 2u);
+}
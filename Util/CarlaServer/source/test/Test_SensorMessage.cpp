@@ -0,0 +1,51 @@
+#include <gtest/gtest.h>
+
+#include <carla/server/SensorMessage.h>
+
+#include "MessageUtil.h"
+
+#include <cstring>
+#include <numeric>
+#include <string>
+#include <vector>
+
+TEST(SensorMessage, LeasedImageMatchesCopiedImage) {
+  using namespace carla::server;
+
+  std::vector<uint32_t> data(4u * 3u);
+  std::iota(data.begin(), data.end(), 0u);
+  const carla_image image = {4u, 3u, 2u, data.data(), CARLA_SERVER_IMAGE_COMPRESSION_NONE};
+
+  SensorMessage copied;
+  copied.Write(42u, image);
+  ASSERT_EQ(copied.frame_number(), 42u);
+
+  const auto message = Flatten(copied.buffers());
+  const auto image_size = sizeof(uint32_t) * data.size();
+  ASSERT_EQ(message.size(), SensorMessage::HEADER_SIZE + image_size);
+  ASSERT_EQ(ReadValue<uint32_t>(message, 0u), message.size() - sizeof(uint32_t));
+  ASSERT_EQ(ReadValue<uint64_t>(message, 4u), 42u);
+  ASSERT_EQ(ReadValue<uint32_t>(message, 12u), image.width);
+  ASSERT_EQ(ReadValue<uint32_t>(message, 16u), image.height);
+  ASSERT_EQ(ReadValue<uint32_t>(message, 20u), image.type);
+  ASSERT_EQ(0, std::memcmp(message.data() + SensorMessage::HEADER_SIZE, data.data(), image_size));
+
+  int released = 0;
+  const carla_image_lease lease = {image, CountRelease, &released};
+  {
+    SensorMessage leased;
+    leased.Write(42u, lease);
+    ASSERT_EQ(Flatten(leased.buffers()), message);
+    ASSERT_EQ(released, 0);
+
+    leased.ReleaseLease();
+    ASSERT_EQ(released, 1);
+    ASSERT_TRUE(leased.buffers().empty());
+
+    // Leases are released when overwritten and on destruction too.
+    leased.Write(43u, lease);
+    leased.Write(44u, lease);
+    ASSERT_EQ(released, 2);
+  }
+  ASSERT_EQ(released, 3);
+}
@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+
+#include <carla/server/SharedMemoryServer.h>
+
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+
+#include <cstring>
+#include <future>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "Loopback.h"
+
+using namespace carla::server;
+using namespace boost::posix_time;
+using boost::asio::ip::tcp;
+
+static constexpr uint32_t PORT = 4120u;
+static const auto TIMEOUT = seconds(10);
+
+/// Client side of the protocol, as the Python client does it.
+class SharedMemoryClient {
+public:
+
+  SharedMemoryClient(SharedMemoryServer &server, const uint32_t port) : _socket(_service) {
+    auto connected = std::async(std::launch::async, [&]() {
+      return server.Connect(port, TIMEOUT);
+    });
+    _socket = ConnectLoopback(_service, port);
+    EXPECT_FALSE(connected.get());
+  }
+
+  ~SharedMemoryClient() {
+    if ((_memory != nullptr) && (_memory != MAP_FAILED)) {
+      munmap(_memory, _size);
+    }
+  }
+
+  void Map() {
+    const auto name = ReadMessage();
+    const int file = shm_open(name.c_str(), O_RDONLY, 0);
+    ASSERT_GE(file, 0);
+    _size = static_cast<size_t>(lseek(file, 0, SEEK_END));
+    _memory = mmap(nullptr, _size, PROT_READ, MAP_SHARED, file, 0);
+    close(file);
+    ASSERT_NE(_memory, MAP_FAILED);
+    uint32_t magic;
+    std::memcpy(&magic, _memory, sizeof(magic));
+    ASSERT_EQ(magic, SharedMemoryServer::MAGIC);
+  }
+
+  std::string ReadMessage() {
+    uint32_t size;
+    boost::asio::read(_socket, boost::asio::buffer(&size, sizeof(size)));
+    std::string message(size, '\0');
+    boost::asio::read(_socket, boost::asio::buffer(&message[0u], size));
+    return message;
+  }
+
+  /// Read the next region from the shared memory, returns its offset.
+  uint64_t ReadRegion(std::string &data) {
+    const auto notification = ReadMessage();
+    uint64_t offset, size;
+    std::memcpy(&offset, notification.data(), sizeof(offset));
+    std::memcpy(&size, notification.data() + sizeof(offset), sizeof(size));
+    const auto *begin = static_cast<const unsigned char *>(_memory) + SharedMemoryServer::HEADER_SIZE + offset;
+    data.assign(reinterpret_cast<const char *>(begin), size);
+    return offset;
+  }
+
+  void Release() {
+    const uint32_t empty = 0u;
+    boost::asio::write(_socket, boost::asio::buffer(&empty, sizeof(empty)));
+  }
+
+private:
+
+  boost::asio::io_service _service;
+  tcp::socket _socket;
+  void *_memory = nullptr;
+  size_t _size = 0u;
+};
+
+TEST(SharedMemoryServer, RegionsAreGathered) {
+  SharedMemoryServer server(1024u * 1024u);
+  SharedMemoryClient client(server, PORT);
+  client.Map();
+  for (auto i = 0u; i < 100u; ++i) {
+    const std::string head(i, 'h');
+    const std::string tail(10u * i, static_cast<char>('a' + i % 26u));
+    std::vector<const_buffer> sequence = {boost::asio::buffer(head), boost::asio::buffer(tail)};
+    ASSERT_FALSE(server.Write(sequence, TIMEOUT));
+    std::string data;
+    client.ReadRegion(data);
+    ASSERT_EQ(data, head + tail);
+    client.Release();
+  }
+}
+
+TEST(SharedMemoryServer, WaitsForTheClientToRelease) {
+  SharedMemoryServer server(1000u);
+  SharedMemoryClient client(server, PORT + 1u);
+  client.Map();
+  const std::string a(400u, 'a');
+  const std::string b(400u, 'b');
+  const std::string c(400u, 'c');
+  ASSERT_FALSE(server.Write(boost::asio::buffer(a), TIMEOUT));
+  ASSERT_FALSE(server.Write(boost::asio::buffer(b), TIMEOUT));
+  // No room until the client releases the first region.
+  ASSERT_EQ(server.Write(boost::asio::buffer(c), milliseconds(50)), errc::timed_out());
+  std::string data;
+  ASSERT_EQ(client.ReadRegion(data), 0u);
+  ASSERT_EQ(data, a);
+  client.Release();
+  // Wraps around to the beginning.
+  ASSERT_FALSE(server.Write(boost::asio::buffer(c), TIMEOUT));
+  ASSERT_EQ(client.ReadRegion(data), 400u);
+  ASSERT_EQ(data, b);
+  ASSERT_EQ(client.ReadRegion(data), 0u);
+  ASSERT_EQ(data, c);
+}
+
+TEST(SharedMemoryServer, MessageTooBig) {
+  SharedMemoryServer server(100u);
+  SharedMemoryClient client(server, PORT + 2u);
+  client.Map();
+  const std::string message(101u, 'x');
+  ASSERT_EQ(server.Write(boost::asio::buffer(message), TIMEOUT), boost::asio::error::message_size);
+}
+
+TEST(SharedMemoryServer, ZeroCapacityIsPlainTCP) {
+  SharedMemoryServer server;
+  SharedMemoryClient client(server, PORT + 3u);
+  ASSERT_TRUE(server.GetName().empty());
+  const std::string message("\x05\x00\x00\x00Hello", 9u);
+  ASSERT_FALSE(server.Write(boost::asio::buffer(message), TIMEOUT));
+  ASSERT_EQ(client.ReadMessage(), "Hello");
+}
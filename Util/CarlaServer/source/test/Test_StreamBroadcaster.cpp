@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+
+#include <carla/server/StreamBroadcaster.h>
+
+#include <boost/asio/read.hpp>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace carla::server;
+using boost::asio::ip::tcp;
+
+// These tests connect observers of their own through the loopback interface.
+static constexpr uint32_t PORT = 4110u;
+
+static tcp::socket ConnectObserver(
+    StreamBroadcaster &broadcaster,
+    boost::asio::io_service &service,
+    const uint32_t port) {
+  const auto expected = broadcaster.GetNumberOfObservers() + 1u;
+  const tcp::endpoint endpoint(boost::asio::ip::address_v4::loopback(), static_cast<unsigned short>(port));
+  tcp::socket socket(service);
+  socket.connect(endpoint);
+  while (broadcaster.GetNumberOfObservers() < expected) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return socket;
+}
+
+/// Publish @a data split in two buffers, as a writer would.
+static void Publish(StreamBroadcaster &broadcaster, const std::string &data, bool key_frame) {
+  const auto half = data.size() / 2u;
+  std::vector<const_buffer> buffers = {
+    boost::asio::buffer(data.data(), half),
+    boost::asio::buffer(data.data() + half, data.size() - half)
+  };
+  broadcaster.Publish(buffers, key_frame);
+  broadcaster.WaitUntilPublished();
+}
+
+static std::string Receive(tcp::socket &socket, size_t size) {
+  std::string data(size, '\0');
+  boost::asio::read(socket, boost::asio::buffer(&data[0u], size));
+  return data;
+}
+
+TEST(StreamBroadcaster, EveryObserverReceivesEveryFrame) {
+  StreamBroadcaster broadcaster(PORT, 4u, 16u, SlowObserverPolicy::Disconnect);
+  boost::asio::io_service service;
+  std::vector<tcp::socket> observers;
+  for (auto i = 0u; i < 3u; ++i) {
+    observers.emplace_back(ConnectObserver(broadcaster, service, PORT));
+  }
+  for (auto i = 0u; i < 10u; ++i) {
+    Publish(broadcaster, std::string(100u, static_cast<char>('a' + i)), true);
+  }
+  for (auto &observer : observers) {
+    for (auto i = 0u; i < 10u; ++i) {
+      ASSERT_EQ(Receive(observer, 100u), std::string(100u, static_cast<char>('a' + i)));
+    }
+  }
+  ASSERT_EQ(broadcaster.GetNumberOfObservers(), 3u);
+}
+
+TEST(StreamBroadcaster, ObserverStartsAtKeyFrame) {
+  StreamBroadcaster broadcaster(PORT + 1u, 4u, 16u, SlowObserverPolicy::DropFrames);
+  broadcaster.TakeKeyFrameRequest();
+  boost::asio::io_service service;
+  auto observer = ConnectObserver(broadcaster, service, PORT + 1u);
+  ASSERT_TRUE(broadcaster.TakeKeyFrameRequest());
+  ASSERT_FALSE(broadcaster.TakeKeyFrameRequest());
+  Publish(broadcaster, "delta0", false);
+  Publish(broadcaster, "key001", true);
+  Publish(broadcaster, "delta1", false);
+  ASSERT_EQ(Receive(observer, 12u), "key001delta1");
+}
+
+TEST(StreamBroadcaster, TooManyObservers) {
+  StreamBroadcaster broadcaster(PORT + 2u, 1u, 16u, SlowObserverPolicy::DropFrames);
+  boost::asio::io_service service;
+  auto observer = ConnectObserver(broadcaster, service, PORT + 2u);
+  const tcp::endpoint endpoint(boost::asio::ip::address_v4::loopback(), static_cast<unsigned short>(PORT + 2u));
+  tcp::socket refused(service);
+  refused.connect(endpoint);
+  char data;
+  boost::system::error_code ec;
+  boost::asio::read(refused, boost::asio::buffer(&data, 1u), ec);
+  ASSERT_EQ(ec, boost::asio::error::eof);
+  ASSERT_EQ(broadcaster.GetNumberOfObservers(), 1u);
+}
+
+// The observers below never read, the frames are big enough to fill the
+// socket buffers.
+static const std::string BIG_FRAME(1024u * 1024u, 'x');
+
+TEST(StreamBroadcaster, SlowObserverIsDisconnected) {
+  StreamBroadcaster broadcaster(PORT + 3u, 4u, 2u, SlowObserverPolicy::Disconnect);
+  boost::asio::io_service service;
+  auto observer = ConnectObserver(broadcaster, service, PORT + 3u);
+  for (auto i = 0u; (i < 1000u) && broadcaster.HasObservers(); ++i) {
+    Publish(broadcaster, BIG_FRAME, true);
+  }
+  ASSERT_FALSE(broadcaster.HasObservers());
+}
+
+TEST(StreamBroadcaster, SlowObserverDropsFrames) {
+  StreamBroadcaster broadcaster(PORT + 4u, 4u, 2u, SlowObserverPolicy::DropFrames);
+  boost::asio::io_service service;
+  auto observer = ConnectObserver(broadcaster, service, PORT + 4u);
+  ASSERT_TRUE(broadcaster.TakeKeyFrameRequest());
+  Publish(broadcaster, BIG_FRAME, true);
+  bool requested = false;
+  for (auto i = 0u; (i < 1000u) && !requested; ++i) {
+    Publish(broadcaster, BIG_FRAME, false);
+    requested = broadcaster.TakeKeyFrameRequest();
+  }
+  // Dropping a frame the next ones depend on requires a key frame.
+  ASSERT_TRUE(requested);
+  ASSERT_EQ(broadcaster.GetNumberOfObservers(), 1u);
+}
@@ -0,0 +1,285 @@
+#include <gtest/gtest.h>
+
+#include <carla/server/AgentServer.h>
+#include <carla/server/Protobuf.h>
+#include <carla/server/WorldServer.h>
+#include <carla/server/carla_server.pb.h>
+
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+
+#include <memory>
+#include <string>
+
+#include "Loopback.h"
+
+using namespace carla::server;
+using namespace boost::posix_time;
+using boost::asio::ip::tcp;
+
+static constexpr uint32_t PORT = 4130u;
+static const auto TIMEOUT = seconds(10);
+
+/// Client of the world port of a WorldServer.
+class WorldClient {
+public:
+
+  explicit WorldClient(uint32_t port) : _socket(ConnectLoopback(_service, port)) {}
+
+  void Write(const google::protobuf::MessageLite &message) {
+    boost::asio::write(_socket, boost::asio::buffer(Protobuf::Encode(message)));
+  }
+
+  void Read(google::protobuf::MessageLite &message) {
+    uint32_t size = 0u;
+    boost::asio::read(_socket, boost::asio::buffer(&size, sizeof(size)));
+    std::string data(size, '\0');
+    boost::asio::read(_socket, boost::asio::buffer(&data[0], size));
+    ASSERT_TRUE(message.ParseFromString(data));
+  }
+
+private:
+
+  boost::asio::io_service _service;
+
+  tcp::socket _socket;
+};
+
+static std::string ToString(const carla_world_snapshot_request &request) {
+  return std::string(request.snapshot, request.snapshot_size);
+}
+
+/// Run the protocol of a new episode up to the client reading the
+/// EpisodeReady, with the agent server started.
+static void StartEpisode(WorldServer &server, WorldClient &client) {
+  {
+    carla_server::WorldRequest request;
+    request.mutable_new_episode()->set_ini_file("[CARLA/Server]");
+    client.Write(request);
+  }
+  {
+    carla_request_new_episode new_episode;
+    ASSERT_FALSE(server.TryRead(new_episode, timeout_t::milliseconds(10000u)));
+    const carla_transform start_spot{};
+    const carla_scene_description scene_description{&start_spot, 1u};
+    ASSERT_FALSE(server.Write(scene_description).get());
+  }
+  {
+    carla_server::SceneDescription scene_description;
+    client.Read(scene_description);
+    carla_server::EpisodeStart episode_start;
+    client.Write(episode_start);
+  }
+  {
+    carla_episode_start episode_start;
+    ASSERT_FALSE(server.TryRead(episode_start, timeout_t::milliseconds(10000u)));
+    server.StartAgentServer();
+    const carla_episode_ready episode_ready{true, 0u, 0u, nullptr, 0u};
+    ASSERT_FALSE(server.Write(episode_ready).get());
+    server.ResetProtocol();
+  }
+  {
+    carla_server::EpisodeReady episode_ready;
+    client.Read(episode_ready);
+    ASSERT_TRUE(episode_ready.ready());
+  }
+}
+
+static error_code WriteFrame(AgentServer &server) {
+  const carla_measurements measurements{};
+  return server.WriteMeasurements(measurements, carla::const_array_view<carla_image>());
+}
+
+static void SendControl(tcp::socket &socket, uint64_t frame_number, float steer) {
+  carla_server::Control control;
+  control.set_steer(steer);
+  control.set_frame_number(frame_number);
+  boost::asio::write(socket, boost::asio::buffer(Protobuf::Encode(control)));
+}
+
+TEST(WorldServer, SnapshotRequestsBetweenEpisodes) {
+  WorldServer server;
+  auto connected = server.Connect(PORT, TIMEOUT);
+  WorldClient client(PORT);
+  ASSERT_FALSE(connected.get());
+
+  const std::string blob("\0snapshot\xff", 10u);
+  {
+    carla_server::WorldRequest request;
+    request.mutable_snapshot()->mutable_save();
+    client.Write(request);
+  }
+  {
+    // Not a new episode, the request is kept for the right read.
+    carla_request_new_episode new_episode;
+    ASSERT_EQ(server.TryRead(new_episode, timeout_t::milliseconds(10000u)), errc::try_again());
+    carla_world_snapshot_request request;
+    ASSERT_FALSE(server.TryRead(request, timeout_t()));
+    ASSERT_FALSE(request.restore);
+    ASSERT_EQ(server.TryRead(request, timeout_t()), errc::try_again());
+    const carla_world_snapshot reply{true, blob.data(), static_cast<uint32_t>(blob.size())};
+    ASSERT_FALSE(server.Write(reply).get());
+  }
+  {
+    carla_server::WorldSnapshot reply;
+    client.Read(reply);
+    ASSERT_TRUE(reply.success());
+    ASSERT_EQ(reply.snapshot(), blob);
+    ASSERT_EQ(reply.first_frame_number(), 0u);
+  }
+
+  {
+    carla_server::WorldRequest request;
+    request.mutable_snapshot()->mutable_restore()->set_snapshot(blob);
+    client.Write(request);
+  }
+  {
+    carla_world_snapshot_request request;
+    ASSERT_FALSE(server.TryRead(request, timeout_t::milliseconds(10000u)));
+    ASSERT_TRUE(request.restore);
+    ASSERT_EQ(ToString(request), blob);
+    const carla_world_snapshot reply{false, nullptr, 0u};
+    ASSERT_FALSE(server.Write(reply).get());
+  }
+  {
+    carla_server::WorldSnapshot reply;
+    client.Read(reply);
+    ASSERT_FALSE(reply.success());
+    ASSERT_TRUE(reply.snapshot().empty());
+  }
+
+  // The protocol of a new episode goes on as usual afterwards.
+  {
+    carla_server::WorldRequest request;
+    request.mutable_new_episode()->set_ini_file("[CARLA/Server]");
+    client.Write(request);
+  }
+  {
+    carla_world_snapshot_request request;
+    ASSERT_EQ(server.TryRead(request, timeout_t::milliseconds(10000u)), errc::try_again());
+    carla_request_new_episode new_episode;
+    ASSERT_FALSE(server.TryRead(new_episode, timeout_t()));
+    ASSERT_EQ(std::string(new_episode.ini_file, new_episode.ini_file_length), "[CARLA/Server]");
+    const carla_transform start_spot{};
+    const carla_scene_description scene_description{&start_spot, 1u};
+    ASSERT_FALSE(server.Write(scene_description).get());
+  }
+  {
+    carla_server::SceneDescription scene_description;
+    client.Read(scene_description);
+    ASSERT_EQ(scene_description.player_start_spots_size(), 1);
+  }
+}
+
+TEST(WorldServer, EpisodeReadyReportsThePhases) {
+  WorldServer server;
+  auto connected = server.Connect(PORT, TIMEOUT);
+  WorldClient client(PORT);
+  ASSERT_FALSE(connected.get());
+
+  {
+    carla_server::WorldRequest request;
+    request.mutable_new_episode()->set_ini_file("[CARLA/Server]");
+    client.Write(request);
+  }
+  {
+    carla_request_new_episode new_episode;
+    ASSERT_FALSE(server.TryRead(new_episode, timeout_t::milliseconds(10000u)));
+    const carla_transform start_spot{};
+    const carla_scene_description scene_description{&start_spot, 1u};
+    ASSERT_FALSE(server.Write(scene_description).get());
+  }
+  {
+    carla_server::SceneDescription scene_description;
+    client.Read(scene_description);
+    carla_server::EpisodeStart episode_start;
+    client.Write(episode_start);
+  }
+  {
+    carla_episode_start episode_start;
+    ASSERT_FALSE(server.TryRead(episode_start, timeout_t::milliseconds(10000u)));
+    // The phases are copied, they may be gone before the message is sent.
+    std::string name = "LoadLevel";
+    auto phases = std::make_unique<carla_episode_phase[]>(2u);
+    phases[0u] = {name.c_str(), 1500.0f};
+    phases[1u] = {"Other", 2.5f};
+    carla_episode_ready episode_ready{true, 0u, 0u, phases.get(), 2u};
+    auto result = server.Write(episode_ready);
+    name.assign(name.size(), '\0');
+    phases = nullptr;
+    ASSERT_FALSE(result.get());
+  }
+  {
+    carla_server::EpisodeReady episode_ready;
+    client.Read(episode_ready);
+    ASSERT_TRUE(episode_ready.ready());
+    ASSERT_EQ(episode_ready.phases_size(), 2);
+    ASSERT_EQ(episode_ready.phases(0).name(), "LoadLevel");
+    ASSERT_EQ(episode_ready.phases(0).milliseconds(), 1500.0f);
+    ASSERT_EQ(episode_ready.phases(1).name(), "Other");
+    ASSERT_EQ(episode_ready.phases(1).milliseconds(), 2.5f);
+  }
+}
+
+TEST(WorldServer, BareRequestNewEpisodeOfOlderClients) {
+  WorldServer server;
+  auto connected = server.Connect(PORT, TIMEOUT);
+  WorldClient client(PORT);
+  ASSERT_FALSE(connected.get());
+
+  {
+    carla_server::RequestNewEpisode request;
+    request.set_ini_file("[CARLA/Server]");
+    client.Write(request);
+  }
+  {
+    carla_world_snapshot_request request;
+    ASSERT_EQ(server.TryRead(request, timeout_t::milliseconds(10000u)), errc::try_again());
+    carla_request_new_episode new_episode;
+    ASSERT_FALSE(server.TryRead(new_episode, timeout_t()));
+    ASSERT_EQ(std::string(new_episode.ini_file, new_episode.ini_file_length), "[CARLA/Server]");
+  }
+}
+
+TEST(WorldServer, RestoreStartsANewEpisodeOnTheAgentConnections) {
+  WorldServer server;
+  auto connected = server.Connect(PORT, TIMEOUT);
+  WorldClient client(PORT);
+  ASSERT_FALSE(connected.get());
+  StartEpisode(server, client);
+  auto *agent_server = server.GetAgentServer();
+  ASSERT_NE(agent_server, nullptr);
+  boost::asio::io_service service;
+  auto measurements = ConnectLoopback(service, PORT + 1u);
+  auto control = ConnectLoopback(service, PORT + 2u);
+
+  ASSERT_FALSE(WriteFrame(*agent_server));
+  ASSERT_FALSE(WriteFrame(*agent_server));
+  {
+    carla_server::WorldRequest request;
+    request.mutable_snapshot()->mutable_restore()->set_snapshot("snapshot");
+    client.Write(request);
+  }
+  {
+    carla_world_snapshot_request request;
+    ASSERT_FALSE(server.TryRead(request, timeout_t::milliseconds(10000u)));
+    ASSERT_TRUE(request.restore);
+    const carla_world_snapshot reply{true, nullptr, 0u};
+    ASSERT_FALSE(server.Write(reply).get());
+  }
+  {
+    carla_server::WorldSnapshot reply;
+    client.Read(reply);
+    ASSERT_TRUE(reply.success());
+    ASSERT_EQ(reply.first_frame_number(), 3u);
+  }
+
+  // The reply to the last frame before restoring arrives late, it is dropped.
+  ASSERT_FALSE(WriteFrame(*agent_server));
+  carla_control values;
+  SendControl(control, 2u, 0.2f);
+  ASSERT_EQ(agent_server->ReadControl(values, timeout_t::milliseconds(10000u)), errc::try_again());
+  SendControl(control, 3u, 0.3f);
+  ASSERT_FALSE(agent_server->ReadControl(values, timeout_t::milliseconds(10000u)));
+  ASSERT_FLOAT_EQ(values.steer, 0.3f);
+}